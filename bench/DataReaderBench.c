@@ -0,0 +1,714 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+/* Required for realpath and posix_fadvise. Must precede all system headers */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "DataReader.h"
+#include "DataStats.h"
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define BENCH_DEFAULT_SIZES "1K,1M,64M,1G"
+#define BENCH_DEFAULT_DATA "compressible,random"
+#define BENCH_DEFAULT_SOURCES "file,pipe"
+#define BENCH_DEFAULT_BUFFERS "4K,64K,1M"
+#define BENCH_DEFAULT_ENGINES "stdio,kernel,mmap,pipeline,uring"
+#define BENCH_DEFAULT_DURABILITY "none"
+#define BENCH_DEFAULT_DIRECTORY "./build/bench"
+#define BENCH_DEFAULT_TOLERANCE 10.0
+#define BENCH_INPUT_FILE "input.bin"
+#define BENCH_OUTPUT_DIRECTORY "output"
+#define BENCH_SEGMENT_SIZE "1G"
+#define BENCH_BLOCK_SIZE (1024 * 1024)
+#define BENCH_MAX_ITEMS 16
+#define BENCH_LIST_LENGTH 256
+#define BENCH_MAX_CAPTURE_ARGUMENTS 32
+#define BENCH_KEY_LENGTH 256
+#define BENCH_SEED 0x9E3779B97F4A7C15ULL
+#define BYTES_PER_GIGABYTE (1024.0 * 1024.0 * 1024.0)
+#define BYTES_PER_MEGABYTE (1024.0 * 1024.0)
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Comma separated list, split in place */
+typedef struct
+{
+    char text[BENCH_LIST_LENGTH];
+    char* items[BENCH_MAX_ITEMS];
+    unsigned int count;
+} BENCH_LIST;
+
+/* Kind of synthetic input */
+typedef enum
+{
+    BENCH_DATA_COMPRESSIBLE = 0,    /* Repeated log lines */
+    BENCH_DATA_RANDOM,              /* Incompressible pseudo random bytes */
+    BENCH_DATA_MAX /*This item should always be at the end*/
+} BENCH_DATA;
+
+/* Settings of a benchmark run */
+typedef struct
+{
+    BENCH_LIST sizes;
+    BENCH_LIST data;
+    BENCH_LIST sources;
+    BENCH_LIST buffers;
+    BENCH_LIST engines;
+    BENCH_LIST durability;
+    char directory[MAX_FILEPATH_LENGTH];
+    unsigned int repeat;
+    bool cold;                      /* Drop the input from the page cache before each capture */
+    const char* baseline;           /* Results of a previous run to compare with */
+    double tolerance;               /* Allowed throughput loss against the baseline in percent */
+    char* captureArguments[BENCH_MAX_CAPTURE_ARGUMENTS];
+    int captureArgumentCount;       /* Arguments after "--", passed to every capture */
+} BENCH_CONFIG;
+
+/* A single measured capture */
+typedef struct
+{
+    ERROR_TYPE result;
+    double seconds;
+    double cpuSeconds;
+    CAPTURE_STATS stats;
+} BENCH_RESULT;
+
+/*----------------------------------------------------------------------------------*/
+/* Static variables */
+static const char* fl_DataNames[BENCH_DATA_MAX] = { "compressible", "random" };
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static bool parseArguments(int pArgc, char* pArgv[], BENCH_CONFIG* pConfig);
+static bool splitList(BENCH_LIST* pList, const char* pText);
+static bool parseSize(const char* pString, unsigned long long* pBytes);
+static int findData(const char* pName);
+static bool generateData(FILE* pOutput, unsigned long long pSize, BENCH_DATA pData);
+static void fillRandom(char* pBuffer, unsigned int pSize, unsigned long long* pState);
+static void fillLogLines(char* pBuffer, unsigned int pSize);
+static bool runCapture(const BENCH_CONFIG* pConfig, const char* pInput, unsigned long long pSize, BENCH_DATA pData,
+                       const char* pBuffer, const char* pEngine, const char* pDurability, BENCH_RESULT* pResult);
+static double getCpuSeconds(void);
+static void removeTree(const char* pPath, bool pRemoveRoot);
+static bool compareBaseline(const char* pBaseline, const char* pKey, double pMegabytesPerSecond, double pTolerance,
+                            double* pBaselineRate);
+static void usage(void);
+/*----------------------------------------------------------------------------------*/
+/* main() start */
+int main(int argc, char* argv[])
+{
+    BENCH_CONFIG config;
+    char inputFile[MAX_FILEPATH_LENGTH + sizeof(BENCH_INPUT_FILE)];
+    unsigned int regressions = 0;
+    unsigned int failures = 0;
+    unsigned int s, d, i, b, e, y, r;
+    if(!parseArguments(argc - 1, &argv[1], &config))
+    {
+        usage();
+        return 2;
+    }
+    sprintf(inputFile, "%s%c%s", config.directory, PATH_DELIMITER, BENCH_INPUT_FILE);
+    for(s = 0; s < config.sizes.count; s++)
+    {
+        unsigned long long size = 0;
+        (void)parseSize(config.sizes.items[s], &size);
+        for(d = 0; d < config.data.count; d++)
+        {
+            BENCH_DATA data = (BENCH_DATA)findData(config.data.items[d]);
+            for(i = 0; i < config.sources.count; i++)
+            {
+                bool pipeSource = !strcmp(config.sources.items[i], "pipe");
+                if(!pipeSource)
+                {
+                    /* One input file serves all buffer sizes and engines */
+                    FILE* input = fopen(inputFile, "wb");
+                    bool generated = (input != NULL) && generateData(input, size, data);
+                    if((input == NULL) || (fclose(input) != 0) || !generated)
+                    {
+                        fprintf(stderr, "Unable to generate %s\n", inputFile);
+                        remove(inputFile);
+                        return 2;
+                    }
+                }
+                for(b = 0; b < config.buffers.count; b++)
+                {
+                    for(e = 0; e < config.engines.count; e++)
+                    {
+                        for(y = 0; y < config.durability.count; y++)
+                        {
+                            for(r = 0; r < config.repeat; r++)
+                            {
+                                BENCH_RESULT result;
+                                char key[BENCH_KEY_LENGTH];
+                                double rate;
+                                double baselineRate = 0.0;
+                                bool regressed = false;
+                                if(!runCapture(&config, pipeSource ? NULL : inputFile, size, data, config.buffers.items[b],
+                                               config.engines.items[e], config.durability.items[y], &result))
+                                {
+                                    return 2;
+                                }
+                                rate = result.seconds ? ((double)size / BYTES_PER_MEGABYTE) / result.seconds : 0.0;
+                                /* The key leads every line, so a baseline is matched by prefix */
+                                snprintf(key, sizeof(key),
+                                         "{\"size\":%llu,\"data\":\"%s\",\"source\":\"%s\",\"buffer\":\"%s\",\"engine\":\"%s\","
+                                         "\"durability\":\"%s\"",
+                                         size, fl_DataNames[data], config.sources.items[i], config.buffers.items[b],
+                                         config.engines.items[e], config.durability.items[y]);
+                                if(config.baseline != NULL)
+                                {
+                                    regressed = compareBaseline(config.baseline, key, rate, config.tolerance, &baselineRate);
+                                }
+                                printf("%s,\"repeat\":%u,\"result\":%d,\"seconds\":%.6f,\"mbps\":%.2f,\"cpu_seconds\":%.6f,"
+                                       "\"cpu_seconds_per_gb\":%.4f,\"bytes_read\":%llu,\"bytes_written\":%llu,"
+                                       "\"reads\":%llu,\"writes\":%llu,\"syncs\":%llu,\"read_p99_ns\":%llu,\"write_p99_ns\":%llu,"
+                                       "\"sync_p99_ns\":%llu,\"segments\":%u,\"baseline_mbps\":%.2f,\"regression\":%s}\n",
+                                       key, r + 1, (int)result.result, result.seconds, rate, result.cpuSeconds,
+                                       size ? result.cpuSeconds / ((double)size / BYTES_PER_GIGABYTE) : 0.0,
+                                       result.stats.reads.bytes, result.stats.writes.bytes, result.stats.reads.calls,
+                                       result.stats.writes.calls, result.stats.syncs.calls,
+                                       DataStats_Percentile(&result.stats.reads, 99),
+                                       DataStats_Percentile(&result.stats.writes, 99),
+                                       DataStats_Percentile(&result.stats.syncs, 99), result.stats.segments,
+                                       baselineRate, regressed ? "true" : "false");
+                                fflush(stdout);
+                                regressions = regressions + (regressed ? 1 : 0);
+                                failures = failures + ((result.result != ERROR_NOERROR) ? 1 : 0);
+                            }
+                        }
+                    }
+                }
+                if(!pipeSource)
+                {
+                    remove(inputFile);
+                }
+            }
+        }
+    }
+    fprintf(stderr, "%u failed captures, %u regressions\n", failures, regressions);
+    return((failures || regressions) ? 1 : 0);
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : parseArguments
+ * Inputs       : int pArgc - number of arguments, without the program name
+ *                char* pArgv[] - arguments
+ *                BENCH_CONFIG* pConfig - Loaded with the settings
+ * Outputs      : True if all arguments are valid. False otherwise
+ * Description  : Starts from the defaults. Arguments after "--" are handed to
+ *                every capture unchanged
+ -----------------------------------------------------------------------------------*/
+static bool parseArguments(int pArgc, char* pArgv[], BENCH_CONFIG* pConfig)
+{
+    char directory[MAX_FILEPATH_LENGTH] = BENCH_DEFAULT_DIRECTORY;
+    unsigned int j;
+    int i;
+    memset(pConfig, 0, sizeof(BENCH_CONFIG));
+    pConfig->repeat = 1;
+    pConfig->tolerance = BENCH_DEFAULT_TOLERANCE;
+    (void)splitList(&pConfig->sizes, BENCH_DEFAULT_SIZES);
+    (void)splitList(&pConfig->data, BENCH_DEFAULT_DATA);
+    (void)splitList(&pConfig->sources, BENCH_DEFAULT_SOURCES);
+    (void)splitList(&pConfig->buffers, BENCH_DEFAULT_BUFFERS);
+    (void)splitList(&pConfig->engines, BENCH_DEFAULT_ENGINES);
+    (void)splitList(&pConfig->durability, BENCH_DEFAULT_DURABILITY);
+    for(i = 0; i < pArgc; i++)
+    {
+        const char* value = (i + 1) < pArgc ? pArgv[i + 1] : NULL;
+        bool valid = true;
+        if(!strcmp(pArgv[i], "--"))
+        {
+            for(i = i + 1; (i < pArgc) && (pConfig->captureArgumentCount < BENCH_MAX_CAPTURE_ARGUMENTS); i++)
+            {
+                pConfig->captureArguments[pConfig->captureArgumentCount++] = pArgv[i];
+            }
+            valid = (i == pArgc);
+            break;
+        }
+        else if(!strcmp(pArgv[i], "-cold"))
+        {
+            pConfig->cold = true;
+            continue;
+        }
+        else if(value == NULL)
+        {
+            return false;
+        }
+        else if(!strcmp(pArgv[i], "-sizes"))
+        {
+            valid = splitList(&pConfig->sizes, value);
+        }
+        else if(!strcmp(pArgv[i], "-data"))
+        {
+            valid = splitList(&pConfig->data, value);
+        }
+        else if(!strcmp(pArgv[i], "-sources"))
+        {
+            valid = splitList(&pConfig->sources, value);
+        }
+        else if(!strcmp(pArgv[i], "-buffers"))
+        {
+            valid = splitList(&pConfig->buffers, value);
+        }
+        else if(!strcmp(pArgv[i], "-engines"))
+        {
+            valid = splitList(&pConfig->engines, value);
+        }
+        else if(!strcmp(pArgv[i], "-durability"))
+        {
+            valid = splitList(&pConfig->durability, value);
+        }
+        else if(!strcmp(pArgv[i], "-o"))
+        {
+            valid = strlen(value) < sizeof(directory);
+            if(valid)
+            {
+                strcpy(directory, value);
+            }
+        }
+        else if(!strcmp(pArgv[i], "-repeat"))
+        {
+            pConfig->repeat = (unsigned int)atoi(value);
+            valid = pConfig->repeat > 0;
+        }
+        else if(!strcmp(pArgv[i], "-baseline"))
+        {
+            pConfig->baseline = value;
+        }
+        else if(!strcmp(pArgv[i], "-tolerance"))
+        {
+            pConfig->tolerance = atof(value);
+            valid = (pConfig->tolerance >= 0.0) && (pConfig->tolerance < 100.0);
+        }
+        else
+        {
+            valid = false;
+        }
+        if(!valid)
+        {
+            return false;
+        }
+        i++;
+    }
+    for(j = 0; j < pConfig->sizes.count; j++)
+    {
+        unsigned long long size;
+        if(!parseSize(pConfig->sizes.items[j], &size))
+        {
+            return false;
+        }
+    }
+    for(j = 0; j < pConfig->data.count; j++)
+    {
+        if(findData(pConfig->data.items[j]) < 0)
+        {
+            return false;
+        }
+    }
+    for(j = 0; j < pConfig->sources.count; j++)
+    {
+        if(strcmp(pConfig->sources.items[j], "file") && strcmp(pConfig->sources.items[j], "pipe"))
+        {
+            return false;
+        }
+    }
+    /* Captures need an absolute output path */
+    (void)mkdir(directory, 0755);
+    return(realpath(directory, pConfig->directory) != NULL) &&
+          ((strlen(pConfig->directory) + sizeof(BENCH_OUTPUT_DIRECTORY) + 1) < MAX_FILEPATH_LENGTH);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : splitList
+ * Inputs       : BENCH_LIST* pList - Loaded with the items
+ *                const char* pText - comma separated items
+ * Outputs      : True if the list has 1 to BENCH_MAX_ITEMS items. False otherwise
+ * Description  : Replaces the previous items of the list
+ -----------------------------------------------------------------------------------*/
+static bool splitList(BENCH_LIST* pList, const char* pText)
+{
+    char* item;
+    char* next = NULL;
+    if(strlen(pText) >= sizeof(pList->text))
+    {
+        return false;
+    }
+    strcpy(pList->text, pText);
+    pList->count = 0;
+    for(item = strtok_r(pList->text, ",", &next); item != NULL; item = strtok_r(NULL, ",", &next))
+    {
+        if(pList->count == BENCH_MAX_ITEMS)
+        {
+            return false;
+        }
+        pList->items[pList->count++] = item;
+    }
+    return(pList->count > 0);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : parseSize
+ * Inputs       : const char* pString - size with an optional K, M or G suffix
+ *                unsigned long long* pBytes - Loaded with the size in bytes
+ * Outputs      : True for a valid size. False otherwise
+ * Description  : Suffixes are binary multiples, as for the capture sizes
+ -----------------------------------------------------------------------------------*/
+static bool parseSize(const char* pString, unsigned long long* pBytes)
+{
+    char* end = NULL;
+    unsigned long long size = strtoull(pString, &end, 10);
+    if(end == pString)
+    {
+        return false;
+    }
+    switch(*end)
+    {
+    case 'G':
+    case 'g':
+        size = size * 1024;
+        /* fall through */
+    case 'M':
+    case 'm':
+        size = size * 1024;
+        /* fall through */
+    case 'K':
+    case 'k':
+        size = size * 1024;
+        end++;
+        break;
+
+    default:
+        break;
+    }
+    *pBytes = size;
+    return(*end == NULL_CHARACTER);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : findData
+ * Inputs       : const char* pName - name of the kind of input
+ * Outputs      : BENCH_DATA of the name. -1 if unknown
+ * Description  : Names are listed in fl_DataNames
+ -----------------------------------------------------------------------------------*/
+static int findData(const char* pName)
+{
+    int i;
+    for(i = 0; i < BENCH_DATA_MAX; i++)
+    {
+        if(!strcmp(pName, fl_DataNames[i]))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : generateData
+ * Inputs       : FILE* pOutput - file or pipe to be filled
+ *                unsigned long long pSize - bytes to be generated
+ *                BENCH_DATA pData - kind of input
+ * Outputs      : True if all bytes are written. False otherwise
+ * Description  : The same seed gives the same input in every run, so results of
+ *                two builds are comparable. Generated in blocks much faster than
+ *                captures run, so a pipe source is not limited by its writer
+ -----------------------------------------------------------------------------------*/
+static bool generateData(FILE* pOutput, unsigned long long pSize, BENCH_DATA pData)
+{
+    unsigned long long state = BENCH_SEED;
+    char* block = malloc(BENCH_BLOCK_SIZE);
+    bool written = (block != NULL);
+    if(written && (pData == BENCH_DATA_COMPRESSIBLE))
+    {
+        fillLogLines(block, BENCH_BLOCK_SIZE);
+    }
+    while(written && pSize)
+    {
+        unsigned int size = pSize < BENCH_BLOCK_SIZE ? (unsigned int)pSize : BENCH_BLOCK_SIZE;
+        if(pData == BENCH_DATA_RANDOM)
+        {
+            fillRandom(block, size, &state);
+        }
+        written = (fwrite(block, sizeof(char), size, pOutput) == size);
+        pSize = pSize - size;
+    }
+    free(block);
+    return written;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : fillRandom
+ * Inputs       : char* pBuffer - buffer to be filled
+ *                unsigned int pSize - size of the buffer in bytes
+ *                unsigned long long* pState - xorshift64* state. Updated
+ * Outputs      :
+ * Description  : Incompressible data
+ -----------------------------------------------------------------------------------*/
+static void fillRandom(char* pBuffer, unsigned int pSize, unsigned long long* pState)
+{
+    unsigned int i;
+    for(i = 0; i < pSize; i = i + sizeof(unsigned long long))
+    {
+        unsigned long long value;
+        *pState ^= *pState >> 12;
+        *pState ^= *pState << 25;
+        *pState ^= *pState >> 27;
+        value = *pState * 0x2545F4914F6CDD1DULL;
+        memcpy(pBuffer + i, &value, (pSize - i) < sizeof(value) ? (pSize - i) : sizeof(value));
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : fillLogLines
+ * Inputs       : char* pBuffer - buffer to be filled
+ *                unsigned int pSize - size of the buffer in bytes
+ * Outputs      :
+ * Description  : Text log lines differing only in their counters, which compress
+ *                well. The block is repeated for the whole input
+ -----------------------------------------------------------------------------------*/
+static void fillLogLines(char* pBuffer, unsigned int pSize)
+{
+    static const char* levels[] = { "INFO", "INFO", "INFO", "DEBUG", "WARN" };
+    unsigned int filled = 0;
+    unsigned int line;
+    for(line = 0; filled < pSize; line++)
+    {
+        char text[128];
+        int length = snprintf(text, sizeof(text),
+                              "2026-01-01T00:%02u:%02u.%06u %-5s capture worker=%u sequence=%u status=ok bytes=%u\n",
+                              (line / 60000) % 60, (line / 1000) % 60, (line * 997) % 1000000, levels[line % 5],
+                              line % 8, line, (line * 4096) % 65536);
+        unsigned int copy = (unsigned int)length < (pSize - filled) ? (unsigned int)length : (pSize - filled);
+        memcpy(pBuffer + filled, text, copy);
+        filled = filled + copy;
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : runCapture
+ * Inputs       : const BENCH_CONFIG* pConfig - settings of the run
+ *                const char* pInput - input file. NULL - generated into a pipe
+ *                unsigned long long pSize - size of the input in bytes
+ *                BENCH_DATA pData - kind of input generated into the pipe
+ *                const char* pBuffer - I/O buffer size argument
+ *                const char* pEngine - copy engine argument
+ *                const char* pDurability - durability policy argument
+ *                BENCH_RESULT* pResult - Loaded with the measurements
+ * Outputs      : False if the capture cannot be set up. True otherwise, with the
+ *                result of the capture in pResult
+ * Description  : Runs one capture on its own context. A pipe source is written by
+ *                a child process on stdin, so its CPU time is not counted. The
+ *                output is removed afterwards
+ -----------------------------------------------------------------------------------*/
+static bool runCapture(const BENCH_CONFIG* pConfig, const char* pInput, unsigned long long pSize, BENCH_DATA pData,
+                       const char* pBuffer, const char* pEngine, const char* pDurability, BENCH_RESULT* pResult)
+{
+    char output[MAX_FILEPATH_LENGTH];
+    char writeFile[MAX_FILEPATH_LENGTH] = { NULL_CHARACTER };
+    char* arguments[12 + BENCH_MAX_CAPTURE_ARGUMENTS] =
+        { "-p", output, "-e", (char*)pEngine, "-b", (char*)pBuffer, "-s", BENCH_SEGMENT_SIZE, "-r", "on",
+          "-y", (char*)pDurability };
+    int argumentCount = 12;
+    DATA_READER_CONTEXT* context = DataReader_ContextCreate();
+    unsigned long long started;
+    double cpu;
+    pid_t writer = -1;
+    int savedInput = -1;
+    int i;
+    memset(pResult, 0, sizeof(BENCH_RESULT));
+    if(context == NULL)
+    {
+        return false;
+    }
+    if(snprintf(output, sizeof(output), "%s%c%s", pConfig->directory, PATH_DELIMITER, BENCH_OUTPUT_DIRECTORY) >=
+       (int)sizeof(output))
+    {
+        /* The output directory would not fit the write path */
+        DataReader_ContextDestroy(context);
+        return false;
+    }
+    (void)mkdir(output, 0755);
+    for(i = 0; i < pConfig->captureArgumentCount; i++)
+    {
+        arguments[argumentCount++] = pConfig->captureArguments[i];
+    }
+    pResult->result = DataReader_ContextParseArguments(context, argumentCount, arguments);
+    if(pResult->result != ERROR_NOERROR)
+    {
+        DataReader_ContextDestroy(context);
+        return true;
+    }
+    if((pInput != NULL) && pConfig->cold)
+    {
+        /* Clean pages are dropped without privileges */
+        int descriptor = open(pInput, O_RDONLY);
+        if(descriptor >= 0)
+        {
+            (void)posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+            close(descriptor);
+        }
+    }
+    if(pInput == NULL)
+    {
+        int pipeFds[2];
+        if(pipe(pipeFds) != 0)
+        {
+            DataReader_ContextDestroy(context);
+            return false;
+        }
+        fflush(stdout);
+        writer = fork();
+        if(writer == 0)
+        {
+            FILE* stream;
+            close(pipeFds[0]);
+            stream = fdopen(pipeFds[1], "wb");
+            _exit(((stream != NULL) && generateData(stream, pSize, pData) && (fclose(stream) == 0)) ? 0 : 1);
+        }
+        close(pipeFds[1]);
+        savedInput = dup(STDIN_FILENO);
+        if((writer < 0) || (savedInput < 0) || (dup2(pipeFds[0], STDIN_FILENO) < 0))
+        {
+            close(pipeFds[0]);
+            DataReader_ContextDestroy(context);
+            return false;
+        }
+        close(pipeFds[0]);
+        clearerr(stdin);
+    }
+    cpu = getCpuSeconds();
+    started = DataStats_Now();
+    pResult->result = DataReader_ContextReadData(context, (pInput != NULL) ? pInput : "", writeFile, sizeof(writeFile));
+    pResult->seconds = (double)(DataStats_Now() - started) / 1e9;
+    pResult->cpuSeconds = getCpuSeconds() - cpu;
+    DataReader_ContextGetCaptureStats(context, &pResult->stats);
+    if(pInput == NULL)
+    {
+        /* Unblocks the writer if the capture stopped early */
+        (void)dup2(savedInput, STDIN_FILENO);
+        close(savedInput);
+        clearerr(stdin);
+        (void)waitpid(writer, NULL, 0);
+    }
+    DataReader_ContextDestroy(context);
+    removeTree(output, false);
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : getCpuSeconds
+ * Inputs       :
+ * Outputs      : User and system time of all threads of the process in seconds
+ * Description  : Covers the reader and worker threads of the engines
+ -----------------------------------------------------------------------------------*/
+static double getCpuSeconds(void)
+{
+    struct rusage usage;
+    (void)getrusage(RUSAGE_SELF, &usage);
+    return((double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec / 1e6 +
+           (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec / 1e6);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : removeTree
+ * Inputs       : const char* pPath - directory to be emptied
+ *                bool pRemoveRoot - remove the directory itself too
+ * Outputs      :
+ * Description  : Removes the output of a capture, including chunk stores
+ -----------------------------------------------------------------------------------*/
+static void removeTree(const char* pPath, bool pRemoveRoot)
+{
+    DIR* directory = opendir(pPath);
+    struct dirent* entry;
+    while((directory != NULL) && ((entry = readdir(directory)) != NULL))
+    {
+        char path[2 * MAX_FILEPATH_LENGTH];
+        struct stat entryStat;
+        if(!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+        {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s%c%s", pPath, PATH_DELIMITER, entry->d_name);
+        if((lstat(path, &entryStat) == 0) && S_ISDIR(entryStat.st_mode))
+        {
+            removeTree(path, true);
+        }
+        else
+        {
+            remove(path);
+        }
+    }
+    if(directory != NULL)
+    {
+        closedir(directory);
+    }
+    if(pRemoveRoot)
+    {
+        (void)rmdir(pPath);
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : compareBaseline
+ * Inputs       : const char* pBaseline - results of a previous run
+ *                const char* pKey - leading fields of the current result
+ *                double pMegabytesPerSecond - throughput of the current result
+ *                double pTolerance - allowed loss in percent
+ *                double* pBaselineRate - Loaded with the mean baseline throughput.
+ *                                        0 if the baseline has no such capture
+ * Outputs      : True if the throughput is below the baseline by more than the
+ *                tolerance
+ * Description  : Averages all repeats of the same capture in the baseline
+ -----------------------------------------------------------------------------------*/
+static bool compareBaseline(const char* pBaseline, const char* pKey, double pMegabytesPerSecond, double pTolerance,
+                            double* pBaselineRate)
+{
+    char line[1024];
+    double total = 0.0;
+    unsigned int matches = 0;
+    FILE* baseline = fopen(pBaseline, "r");
+    *pBaselineRate = 0.0;
+    while((baseline != NULL) && (fgets(line, sizeof(line), baseline) != NULL))
+    {
+        const char* rate = strstr(line, "\"mbps\":");
+        if(!strncmp(line, pKey, strlen(pKey)) && (line[strlen(pKey)] == ',') && (rate != NULL))
+        {
+            total = total + atof(rate + strlen("\"mbps\":"));
+            matches++;
+        }
+    }
+    if(baseline != NULL)
+    {
+        fclose(baseline);
+    }
+    if(!matches)
+    {
+        return false;
+    }
+    *pBaselineRate = total / matches;
+    return(pMegabytesPerSecond < (*pBaselineRate * (100.0 - pTolerance) / 100.0));
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : usage
+ * Inputs       :
+ * Outputs      :
+ * Description  : Prints the benchmark arguments
+ -----------------------------------------------------------------------------------*/
+static void usage(void)
+{
+    fprintf(stderr, "DataReaderBench [options] [-- capture arguments]\n");
+    fprintf(stderr, "-sizes     : Input sizes with K, M or G suffix (default %s)\n", BENCH_DEFAULT_SIZES);
+    fprintf(stderr, "-data      : Kinds of input: compressible, random (default %s)\n", BENCH_DEFAULT_DATA);
+    fprintf(stderr, "-sources   : Input sources: file, pipe (default %s)\n", BENCH_DEFAULT_SOURCES);
+    fprintf(stderr, "-buffers   : I/O buffer sizes (default %s)\n", BENCH_DEFAULT_BUFFERS);
+    fprintf(stderr, "-engines   : Copy engines (default %s)\n", BENCH_DEFAULT_ENGINES);
+    fprintf(stderr, "-durability: Durability policies, as for -y of a capture (default %s)\n", BENCH_DEFAULT_DURABILITY);
+    fprintf(stderr, "-repeat    : Captures per combination (default 1)\n");
+    fprintf(stderr, "-cold      : Drop the input file from the page cache before each capture\n");
+    fprintf(stderr, "-o         : Work directory for inputs and outputs (default %s)\n", BENCH_DEFAULT_DIRECTORY);
+    fprintf(stderr, "-baseline  : Results of a previous run. Slower captures are regressions\n");
+    fprintf(stderr, "-tolerance : Allowed throughput loss against the baseline in percent (default %.0f)\n",
+            BENCH_DEFAULT_TOLERANCE);
+    fprintf(stderr, "Prints one JSON line per capture. Exit status 1 on failed captures or regressions\n");
+}
+/*----------------------------------------------------------------------------------*/
@@ -0,0 +1,21 @@
+#!/bin/sh
+## Definitions
+BUILD_FOLDER=./build/bench
+EXECUTABLE=DataReaderBench
+BENCH_FILES=./bench/*.c
+SOURCE_FILES=$(ls ./src/*.c | grep -v main.c)
+INCLUDE_FOLDER=./inc
+BENCH_EXECUTABLE=$BUILD_FOLDER/$EXECUTABLE
+RESULTS_FILE=${RESULTS_FILE:-$BUILD_FOLDER/results.jsonl}
+## GCC build
+echo "******************** DataReader Benchmark Build Start *************************"
+mkdir -p $BUILD_FOLDER
+gcc -Wall -O2 -D_FILE_OFFSET_BITS=64 -I$INCLUDE_FOLDER $BENCH_FILES $SOURCE_FILES -o $BENCH_EXECUTABLE -pthread || exit 2
+echo "******************** DataReader Benchmark Build End ***************************"
+## Results are JSON lines on stdout. Progress and the summary go to stderr
+## Example: ./benchmark.sh -sizes 1G,50G -engines stdio,uring -baseline previous.jsonl
+$BENCH_EXECUTABLE -o $BUILD_FOLDER "$@" > $RESULTS_FILE
+STATUS=$?
+cat $RESULTS_FILE
+echo "Results saved to $RESULTS_FILE"
+exit $STATUS
@@ -7,6 +7,6 @@
 :: GCC build 
 @echo ******************** DataReader Build Start *************************
 @if not exist %$FINAL_OUTPUT% md %$BUILD_FOLDER%
-@gcc -Wall -I%$INCLUDE_FOLDER% %$SOURCE_FILES% -o %$FINAL_OUTPUT%
+@gcc -Wall -D_FILE_OFFSET_BITS=64 -I%$INCLUDE_FOLDER% %$SOURCE_FILES% -o %$FINAL_OUTPUT% -pthread
 @echo ******************** DataReader Build End ***************************
 @pause
\ No newline at end of file
@@ -2,14 +2,14 @@
 @SET $BUILD_FOLDER=.\build\test
 @SET $EXECUTABLE=DataReaderTest.exe
 @SET $TEST_CASES=.\test\*.c
-@SET $TEST_FILE=.\src\DataReader.c
+@SET $TEST_FILE=.\src\DataReader.c .\src\DataEngine.c .\src\DataWriter.c .\src\DataPipeline.c .\src\DataUring.c .\src\DataBatch.c .\src\DataCompress.c .\src\DataChecksum.c .\src\DataDedup.c .\src\DataFrame.c .\src\DataLines.c .\src\DataStats.c .\src\DataTee.c .\src\DataDaemon.c .\src\DataFollow.c .\src\DataCheckpoint.c .\src\DataParallel.c
 @SET $INCLUDE_FOLDER=.\inc
 @SET $TEST_LIBRARY=.\test\lib\*.c
 @SET $TEST_EXECUTABLE=%$BUILD_FOLDER%\%$EXECUTABLE%
 :: TESTCASE BUILD
 @if not exist %$BUILD_FOLDER% mkdir %$BUILD_FOLDER%
 @echo ******************** DataReader Unit Test Build Start *************************
-@gcc -Wall -I%$INCLUDE_FOLDER% %$TEST_LIBRARY% %$TEST_CASES% %$TEST_FILE% -o %$TEST_EXECUTABLE%
+@gcc -Wall -D_FILE_OFFSET_BITS=64 -I%$INCLUDE_FOLDER% %$TEST_LIBRARY% %$TEST_CASES% %$TEST_FILE% -o %$TEST_EXECUTABLE% -pthread
 @echo ******************** DataReader Unit Test Build End ***************************
 @if not exist %$TEST_EXECUTABLE% goto _END
 @echo Build Successful
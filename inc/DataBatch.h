@@ -0,0 +1,119 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdio.h>
+#include "DataReader.h"
+
+#ifndef DATA_BATCH_H
+#define DATA_BATCH_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define BATCH_WORKERS_PER_DEVICE 4
+#define BATCH_MANIFEST_COMMENT '#'
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* One input of a batch and the result of its capture */
+typedef struct
+{
+    char input[MAX_FILEPATH_LENGTH];        /* Path of the input file */
+    char output[MAX_FILEPATH_LENGTH];       /* First output file of the capture */
+    ERROR_TYPE result;                      /* Result of the capture or the check */
+    unsigned long long size;                /* Size of the input in bytes */
+    unsigned long long elapsed;             /* Duration of the capture in microseconds */
+} BATCH_ITEM;
+
+/* Inputs of a batch */
+typedef struct
+{
+    BATCH_ITEM* items;
+    unsigned int count;
+    unsigned int capacity;
+} BATCH_LIST;
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataBatch_Add
+ * Inputs       : BATCH_LIST* pList - list to be extended. Zero initialized when empty
+ *                const char* pInput - path of the input file
+ * Outputs      : returns -
+ *                ERROR_NOERROR - input added
+ *                ERROR_PATHTOOLONG - path exceeds max length
+ *                ERROR_MEMORY_ALLOCATION - list cannot be extended
+ * Description  : Appends an input file to the batch
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataBatch_Add(BATCH_LIST* pList, const char* pInput);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataBatch_LoadManifest
+ * Inputs       : BATCH_LIST* pList - list to be extended
+ *                const char* pManifest - path of the manifest file
+ * Outputs      : returns -
+ *                ERROR_NOERROR - all inputs of the manifest added
+ *                ERROR_READ_FILEOPEN - manifest cannot be opened
+ *                ERROR_PATHTOOLONG - a line exceeds max path length
+ *                ERROR_MEMORY_ALLOCATION - list cannot be extended
+ * Description  : Appends the inputs listed in a manifest file, one path per line.
+ *                Empty lines and lines starting with '#' are skipped
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataBatch_LoadManifest(BATCH_LIST* pList, const char* pManifest);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataBatch_DefaultWorkers
+ * Inputs       : const BATCH_LIST* pList - inputs of the batch
+ * Outputs      : returns -
+ *                Number of workers to use
+ * Description  : Sizes the worker pool to the cores of the machine, limited to
+ *                BATCH_WORKERS_PER_DEVICE per storage device holding inputs so
+ *                that a single disk is not flooded with competing streams
+ -----------------------------------------------------------------------------------*/
+extern unsigned int DataBatch_DefaultWorkers(const BATCH_LIST* pList);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataBatch_Run
+ * Inputs       : BATCH_LIST* pList - inputs of the batch. Loaded with the results
+ *                unsigned int pWorkers - number of captures run at the same time
+ * Outputs      : returns -
+ *                Number of inputs whose capture failed
+ * Description  : Captures all inputs with DataReader_ReadData() on a pool of
+ *                worker threads. The calling thread is one of the workers, so the
+ *                batch completes even if no thread can be started
+ -----------------------------------------------------------------------------------*/
+extern unsigned int DataBatch_Run(BATCH_LIST* pList, unsigned int pWorkers);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataBatch_Verify
+ * Inputs       : BATCH_LIST* pList - files to be verified. Loaded with the results
+ *                unsigned int pWorkers - number of files checked at the same time
+ * Outputs      : returns -
+ *                Number of files that failed the check
+ * Description  : Checks all files against their CRC32C sidecars with
+ *                DataChecksum_Verify() on the same worker pool as DataBatch_Run()
+ -----------------------------------------------------------------------------------*/
+extern unsigned int DataBatch_Verify(BATCH_LIST* pList, unsigned int pWorkers);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataBatch_Restore
+ * Inputs       : BATCH_LIST* pList - recipes to be restored. Loaded with the results
+ *                unsigned int pWorkers - number of files restored at the same time
+ * Outputs      : returns -
+ *                Number of recipes that could not be restored
+ * Description  : Rebuilds the captures of deduplicated recipes with
+ *                DataDedup_Restore() on the same worker pool as DataBatch_Run().
+ *                Each capture is written next to its recipe as a .dat file
+ -----------------------------------------------------------------------------------*/
+extern unsigned int DataBatch_Restore(BATCH_LIST* pList, unsigned int pWorkers);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataBatch_Report
+ * Inputs       : const BATCH_LIST* pList - inputs of a completed batch
+ *                FILE* pStream - stream the report is printed to
+ * Outputs      :
+ * Description  : Prints one line per input with its output file, result, size
+ *                and throughput, followed by a summary
+ -----------------------------------------------------------------------------------*/
+extern void DataBatch_Report(const BATCH_LIST* pList, FILE* pStream);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataBatch_Free
+ * Inputs       : BATCH_LIST* pList - list to be released
+ * Outputs      :
+ * Description  : Releases the inputs of the batch
+ -----------------------------------------------------------------------------------*/
+extern void DataBatch_Free(BATCH_LIST* pList);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_BATCH_H */
@@ -0,0 +1,107 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdio.h>
+#include "DataReader.h"
+#include "DataWriter.h"
+
+#ifndef DATA_CHECKPOINT_H
+#define DATA_CHECKPOINT_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define CHECKPOINT_EXTENSION ".ckp"
+#define CHECKPOINT_TITLE "# DataReader checkpoint"
+/* Input bytes captured between two saved checkpoints */
+#define CHECKPOINT_INTERVAL (64ULL * 1024ULL * 1024ULL)
+/* Output bytes compared with the input before a capture is resumed */
+#define CHECKPOINT_OVERLAP (64 * 1024)
+#define CHECKPOINT_STAMP_LENGTH 64
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Identity of an input and the part of it already captured */
+typedef struct
+{
+    char source[MAX_FILEPATH_LENGTH];       /* Input path as given to the capture */
+    unsigned long long device;
+    unsigned long long inode;
+    unsigned long long size;                /* Input size when the checkpoint was taken */
+    unsigned long long modified;            /* Input modification time in nanoseconds */
+    unsigned long long offset;              /* Input bytes captured */
+    char stamp[CHECKPOINT_STAMP_LENGTH];    /* Time stamp naming the output files */
+    unsigned int segment;                   /* Sequence number of the current output file */
+    unsigned long long segmentStart;        /* Input offset of its first byte */
+    char output[MAX_FILEPATH_LENGTH];       /* Path of the current output file */
+} CHECKPOINT;
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataCheckpoint_Path
+ * Inputs       : const char* pWritePath - output directory
+ *                const char* pPrefix - output file name prefix
+ *                const char* pSource - input path
+ *                char* pPath - Loaded with the checkpoint path
+ *                unsigned int pSize - size of the pPath buffer
+ * Outputs      : True if the path fits. False otherwise
+ * Description  : The checkpoint is named after the input file and a CRC32C of
+ *                its path, so inputs of the same name in different directories
+ *                keep checkpoints of their own
+ -----------------------------------------------------------------------------------*/
+extern bool DataCheckpoint_Path(const char* pWritePath, const char* pPrefix, const char* pSource, char* pPath,
+                                unsigned int pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataCheckpoint_Identify
+ * Inputs       : FILE* pInput - open input
+ *                const char* pSource - input path
+ *                CHECKPOINT* pCheckpoint - Loaded with the identity of the input
+ * Outputs      : True for a regular file. False otherwise
+ * Description  : Only the source, device, inode, size and modification time are
+ *                set
+ -----------------------------------------------------------------------------------*/
+extern bool DataCheckpoint_Identify(FILE* pInput, const char* pSource, CHECKPOINT* pCheckpoint);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataCheckpoint_Save
+ * Inputs       : const char* pPath - checkpoint path
+ *                const CHECKPOINT* pCheckpoint - checkpoint to be saved
+ * Outputs      : returns -
+ *                ERROR_NOERROR - checkpoint saved
+ *                ERROR_PATHTOOLONG - temporary path exceeds max length
+ *                ERROR_IO_FAILED - checkpoint cannot be written
+ * Description  : Writes a text file next to the output and renames it over the
+ *                previous checkpoint, so a crash leaves one of the two whole
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataCheckpoint_Save(const char* pPath, const CHECKPOINT* pCheckpoint);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataCheckpoint_Load
+ * Inputs       : const char* pPath - checkpoint path
+ *                CHECKPOINT* pCheckpoint - Loaded with the checkpoint
+ * Outputs      : returns -
+ *                ERROR_NOERROR - checkpoint loaded
+ *                ERROR_READ_FILEOPEN - no checkpoint
+ *                ERROR_IO_FAILED - checkpoint is invalid
+ * Description  :
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataCheckpoint_Load(const char* pPath, CHECKPOINT* pCheckpoint);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataCheckpoint_Resume
+ * Inputs       : const CHECKPOINT* pSaved - checkpoint of the earlier capture
+ *                const CHECKPOINT* pCurrent - identity of the input now
+ *                FILE* pInput - open input
+ *                WRITER_NAME_FN pDefineFile - names the output files of the
+ *                                             earlier capture
+ *                void* pNameContext - passed to pDefineFile
+ *                unsigned long long* pSegmentSize - Loaded with the bytes of the
+ *                                                   current output file to keep
+ * Outputs      : True if the capture can continue. The input is then positioned
+ *                at the first byte not captured. False otherwise
+ * Description  : The input must be the same file, not shorter than the captured
+ *                part and, if its size is unchanged, not modified. The output is
+ *                kept up to the checkpoint or to its end, whichever comes first,
+ *                and its last CHECKPOINT_OVERLAP bytes must match the input. An
+ *                empty output file opened after the checkpoint is removed
+ -----------------------------------------------------------------------------------*/
+extern bool DataCheckpoint_Resume(const CHECKPOINT* pSaved, const CHECKPOINT* pCurrent, FILE* pInput,
+                                  WRITER_NAME_FN pDefineFile, void* pNameContext, unsigned long long* pSegmentSize);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_CHECKPOINT_H */
@@ -0,0 +1,89 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stddef.h>
+#include "DataReader.h"
+
+#ifndef DATA_CHECKSUM_H
+#define DATA_CHECKSUM_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define CHECKSUM_BLOCK_SIZE (1024 * 1024)
+#define CHECKSUM_SIDECAR_EXTENSION ".crc"
+#define CHECKSUM_SIDECAR_TITLE "# DataReader CRC32C"
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Running checksums of one output file */
+typedef struct
+{
+    unsigned int fileCrc;           /* CRC32C of all data so far */
+    unsigned int blockCrc;          /* CRC32C of the current block */
+    unsigned int blockFill;         /* Bytes of the current block */
+    unsigned long long size;        /* Bytes of all data so far */
+    unsigned int* blocks;           /* CRC32C of every completed block */
+    unsigned int count;
+    unsigned int capacity;
+    bool failed;                    /* Block list could not be extended */
+} CHECKSUM_STATE;
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataChecksum_Crc32c
+ * Inputs       : unsigned int pCrc - CRC32C of the preceding data. 0 to start
+ *                const void* pData - data to be added
+ *                size_t pSize - size of the data in bytes
+ * Outputs      : returns -
+ *                CRC32C of the preceding data followed by pData
+ * Description  : Computes the Castagnoli CRC with the SSE4.2 crc32 instruction
+ *                where the processor has it and with slicing-by-8 tables elsewhere
+ -----------------------------------------------------------------------------------*/
+extern unsigned int DataChecksum_Crc32c(unsigned int pCrc, const void* pData, size_t pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataChecksum_Add
+ * Inputs       : CHECKSUM_STATE* pState - checksums of the file. Zero initialized
+ *                                         for a new file
+ *                const char* pData - data appended to the file
+ *                unsigned int pSize - size of the data in bytes
+ * Outputs      :
+ * Description  : Adds data to the whole file checksum and to the checksums of the
+ *                CHECKSUM_BLOCK_SIZE blocks of the file
+ -----------------------------------------------------------------------------------*/
+extern void DataChecksum_Add(CHECKSUM_STATE* pState, const char* pData, unsigned int pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataChecksum_WriteSidecar
+ * Inputs       : const CHECKSUM_STATE* pState - checksums of the complete file
+ *                const char* pFile - path of the file
+ * Outputs      : returns -
+ *                ERROR_NOERROR - sidecar written
+ *                ERROR_MEMORY_ALLOCATION - a block checksum was lost
+ *                ERROR_IO_FAILED - sidecar cannot be written
+ * Description  : Writes the size, the whole file checksum and the block checksums
+ *                to a text file next to the file, with CHECKSUM_SIDECAR_EXTENSION
+ *                appended to its name
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataChecksum_WriteSidecar(const CHECKSUM_STATE* pState, const char* pFile);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataChecksum_Verify
+ * Inputs       : const char* pFile - path of the file to be checked
+ *                unsigned long long* pBadBlock - Loaded with the first block that
+ *                                                does not match. May be NULL
+ * Outputs      : returns -
+ *                ERROR_NOERROR - file matches its sidecar
+ *                ERROR_PATHTOOLONG - path exceeds max length
+ *                ERROR_READ_FILEOPEN - file or sidecar cannot be opened
+ *                ERROR_CHECKSUM_MISMATCH - size or a checksum differs
+ *                ERROR_IO_FAILED - sidecar is invalid or the file cannot be read
+ * Description  : Reads the file once and compares it with its sidecar
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataChecksum_Verify(const char* pFile, unsigned long long* pBadBlock);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataChecksum_Free
+ * Inputs       : CHECKSUM_STATE* pState - checksums to be released
+ * Outputs      :
+ * Description  : Releases the block checksums and resets the state for a new file
+ -----------------------------------------------------------------------------------*/
+extern void DataChecksum_Free(CHECKSUM_STATE* pState);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_CHECKSUM_H */
@@ -0,0 +1,122 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdio.h>
+#include "DataEngine.h"
+
+#ifndef DATA_COMPRESS_H
+#define DATA_COMPRESS_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+/* Compressed output layout, all numbers little endian:
+   File header  : magic "DRZ1", version u32, block size u32, reserved u32
+   Block        : raw size u32, stored size u32, method u32, stored data
+   End of blocks: block header with raw and stored size 0
+   Index        : one entry per block - segment offset u64, raw offset u64,
+                  stored size u32, raw size u32
+   Footer       : index offset u64, block count u32, magic "DRZX"
+   Every output segment is a complete stream of this layout. Segment offsets
+   are counted from the start of the segment, raw offsets from the start of the
+   input, so the raw offset of the first block locates a rotated segment */
+#define COMPRESS_MAGIC "DRZ1"
+#define COMPRESS_INDEX_MAGIC "DRZX"
+#define COMPRESS_VERSION 1
+#define COMPRESS_FILE_HEADER_SIZE 16
+#define COMPRESS_BLOCK_HEADER_SIZE 12
+#define COMPRESS_INDEX_ENTRY_SIZE 24
+#define COMPRESS_FOOTER_SIZE 16
+#define COMPRESS_METHOD_RAW 0
+#define COMPRESS_METHOD_LZ 1
+#define COMPRESS_SLOTS_PER_WORKER 2
+#define COMPRESS_SAMPLE_SIZE (4 * 1024)
+#define COMPRESS_SAMPLE_COUNT 4
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Location of one block in the compressed stream */
+typedef struct
+{
+    unsigned long long offset;      /* Offset of the block header in the segment */
+    unsigned long long rawOffset;   /* Offset of the block data in the input */
+    unsigned int storedSize;        /* Size of the stored data without header */
+    unsigned int rawSize;           /* Size of the data once expanded */
+} COMPRESS_BLOCK;
+
+/* Block index of a compressed stream */
+typedef struct
+{
+    COMPRESS_BLOCK* blocks;
+    unsigned int count;
+    unsigned int capacity;
+    unsigned int blockSize;         /* Largest raw size of a block */
+} COMPRESS_INDEX;
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataCompress_Copy
+ * Inputs       : ENGINE_JOB* pJob - copy to be performed. The I/O buffer size is
+ *                                   the block size
+ *                unsigned int pWorkers - number of compression threads
+ *                COMPRESS_STATS* pStats - Loaded with the block counters of the copy
+ * Outputs      : returns -
+ *                ERROR_NOERROR - end of input reached
+ *                ERROR_FILE_SIZELIMIT_REACHED - Output file size limit reached
+ *                ERROR_MEMORY_ALLOCATION - blocks cannot be allocated
+ *                ERROR_WRITE_FILEOPEN - next output segment cannot be opened
+ *                ERROR_IO_FAILED - worker cannot be started or write failed
+ * Description  : Splits the input into independent blocks that are compressed by
+ *                a pool of worker threads while the calling thread reads ahead
+ *                and writes the finished blocks in input order. Blocks whose
+ *                samples do not compress, or whose compressed form is not smaller,
+ *                are stored raw. Each segment ends with the index of its blocks
+ *                when the next block does not fit, or when the input ends. With
+ *                rotation the next segment starts with its own header, otherwise
+ *                the copy stops at the size limit
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataCompress_Copy(ENGINE_JOB* pJob, unsigned int pWorkers, COMPRESS_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataCompress_Expand
+ * Inputs       : FILE* pInput - compressed stream, positioned at its start
+ *                FILE* pOutput - receives the expanded data
+ * Outputs      : returns -
+ *                ERROR_NOERROR - all blocks expanded
+ *                ERROR_MEMORY_ALLOCATION - block buffers cannot be allocated
+ *                ERROR_IO_FAILED - stream is corrupt, truncated or cannot be written.
+ *                                  The complete blocks before the error are written
+ * Description  : Expands a compressed stream block by block without the index
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataCompress_Expand(FILE* pInput, FILE* pOutput);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataCompress_ReadIndex
+ * Inputs       : FILE* pInput - seekable compressed stream
+ *                COMPRESS_INDEX* pIndex - Loaded with the block index. Released with
+ *                                         DataCompress_FreeIndex
+ * Outputs      : returns -
+ *                ERROR_NOERROR - index loaded
+ *                ERROR_MEMORY_ALLOCATION - index cannot be allocated
+ *                ERROR_IO_FAILED - stream has no valid index
+ * Description  : Loads the block index from the footer of the stream
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataCompress_ReadIndex(FILE* pInput, COMPRESS_INDEX* pIndex);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataCompress_ReadBlock
+ * Inputs       : FILE* pInput - seekable compressed stream
+ *                const COMPRESS_BLOCK* pBlock - block of the index to be read
+ *                char* pData - receives the expanded block. pBlock->rawSize bytes
+ * Outputs      : returns -
+ *                ERROR_NOERROR - block expanded
+ *                ERROR_MEMORY_ALLOCATION - block buffer cannot be allocated
+ *                ERROR_IO_FAILED - block is corrupt or cannot be read
+ * Description  : Seeks to a single block and expands it
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataCompress_ReadBlock(FILE* pInput, const COMPRESS_BLOCK* pBlock, char* pData);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataCompress_FreeIndex
+ * Inputs       : COMPRESS_INDEX* pIndex - index to be released
+ * Outputs      :
+ * Description  : Releases an index loaded by DataCompress_ReadIndex
+ -----------------------------------------------------------------------------------*/
+extern void DataCompress_FreeIndex(COMPRESS_INDEX* pIndex);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_COMPRESS_H */
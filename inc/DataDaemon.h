@@ -0,0 +1,83 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdbool.h>
+#include "DataReader.h"
+
+#ifndef DATA_DAEMON_H
+#define DATA_DAEMON_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+/* Events taken by a worker from the poll set at a time */
+#define DAEMON_MAX_EVENTS 64
+/* Buffers read from one connection before the others get their turn */
+#define DAEMON_READS_PER_TURN 16
+#define DAEMON_BACKLOG 512
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Counters of a running daemon */
+typedef struct
+{
+    unsigned long long accepted;    /* Connections accepted */
+    unsigned long long active;      /* Connections open */
+    unsigned long long completed;   /* Connections whose capture succeeded */
+    unsigned long long failed;      /* Connections whose capture failed or could not be opened */
+    unsigned long long bytes;       /* Bytes received over all connections */
+} DAEMON_STATS;
+
+/* Socket listener with its worker pool. Opaque to the users */
+typedef struct DATA_DAEMON DATA_DAEMON;
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataDaemon_Start
+ * Inputs       : DATA_DAEMON** pDaemon - Loaded with the running daemon
+ *                const char* pSocket - path of the UNIX domain socket to listen on
+ *                unsigned int pWorkers - threads serving the connections. 0 - one
+ *                                        per core
+ * Outputs      : returns -
+ *                ERROR_NOERROR - daemon listening
+ *                ERROR_PATHTOOLONG - socket path exceeds the address length
+ *                ERROR_MEMORY_ALLOCATION - daemon cannot be allocated
+ *                ERROR_IO_FAILED - socket cannot be created, no thread can be
+ *                                  started, or the platform has no epoll
+ * Description  : Listens on a local stream socket and captures every connection
+ *                to its own output with DataReader_OpenStream(), so the default
+ *                configuration names, limits and rotates each of them. All
+ *                connections are multiplexed with epoll on the worker pool. A
+ *                stale socket file left by an earlier daemon is replaced
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataDaemon_Start(DATA_DAEMON** pDaemon, const char* pSocket, unsigned int pWorkers);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataDaemon_GetStats
+ * Inputs       : DATA_DAEMON* pDaemon - running daemon
+ *                DAEMON_STATS* pStats - Loaded with the counters
+ * Outputs      :
+ * Description  : Counters are updated while the connections are served
+ -----------------------------------------------------------------------------------*/
+extern void DataDaemon_GetStats(DATA_DAEMON* pDaemon, DAEMON_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataDaemon_Stop
+ * Inputs       : DATA_DAEMON* pDaemon - daemon to be stopped and released
+ *                DAEMON_STATS* pStats - Loaded with the final counters. May be NULL
+ * Outputs      :
+ * Description  : Stops listening, removes the socket file and joins the workers.
+ *                Connections still open are closed with the data received so far
+ *                and counted as completed
+ -----------------------------------------------------------------------------------*/
+extern void DataDaemon_Stop(DATA_DAEMON* pDaemon, DAEMON_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataDaemon_Run
+ * Inputs       : const char* pSocket - path of the UNIX domain socket to listen on
+ *                unsigned int pWorkers - threads serving the connections. 0 - one
+ *                                        per core
+ *                DAEMON_STATS* pStats - Loaded with the final counters
+ * Outputs      : returns -
+ *                Same as DataDaemon_Start
+ * Description  : Runs the daemon until SIGINT or SIGTERM is received
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataDaemon_Run(const char* pSocket, unsigned int pWorkers, DAEMON_STATS* pStats);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_DAEMON_H */
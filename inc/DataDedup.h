@@ -0,0 +1,72 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdio.h>
+#include "DataEngine.h"
+
+#ifndef DATA_DEDUP_H
+#define DATA_DEDUP_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+/* Deduplicated output layout:
+   Chunk store : <store>/<first 2 hash digits>/<SHA-256 of the chunk in hex>, one
+                 file per unique chunk holding its raw bytes
+   Recipe      : text file replacing the .dat output of a capture -
+                 "# DataReader recipe"
+                 "chunk <SHA-256 in hex> <size>" for every chunk in input order
+                 "size <total size>" once all chunks are listed */
+#define DEDUP_STORE_DIRECTORY "chunks"
+#define DEDUP_RECIPE_EXTENSION ".rcp"
+#define DEDUP_RECIPE_TITLE "# DataReader recipe"
+#define DEDUP_MIN_CHUNK_SIZE (2 * 1024)
+#define DEDUP_AVERAGE_CHUNK_SIZE (8 * 1024)
+#define DEDUP_MAX_CHUNK_SIZE (64 * 1024)
+#define DEDUP_HASH_SIZE 32
+#define DEDUP_HASH_LENGTH (DEDUP_HASH_SIZE * 2)
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataDedup_Copy
+ * Inputs       : ENGINE_JOB* pJob - copy to be performed. The recipe is written to
+ *                                   the writer of the job
+ *                const char* pStore - directory of the chunk store. Created if
+ *                                     missing
+ *                unsigned long long pLimit - maximum number of input bytes. 0 - no
+ *                                            limit
+ *                DEDUP_STATS* pStats - Loaded with the chunk counters of the copy
+ * Outputs      : returns -
+ *                ERROR_NOERROR - end of input reached
+ *                ERROR_FILE_SIZELIMIT_REACHED - pLimit input bytes captured
+ *                ERROR_MEMORY_ALLOCATION - buffers cannot be allocated
+ *                ERROR_IO_FAILED - chunk or recipe cannot be written
+ * Description  : Splits the input into content defined chunks with a gear rolling
+ *                hash, so that an insertion only changes the chunks around it.
+ *                Chunks missing from the store are added to it and every chunk is
+ *                listed in the recipe. Several captures may share a store at the
+ *                same time
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataDedup_Copy(ENGINE_JOB* pJob, const char* pStore, unsigned long long pLimit,
+                                 DEDUP_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataDedup_Restore
+ * Inputs       : const char* pRecipe - path of the recipe. The chunk store is the
+ *                                      DEDUP_STORE_DIRECTORY next to it
+ *                const char* pOutput - path of the restored file. Created
+ *                                      exclusively
+ *                unsigned long long* pSize - Loaded with the restored size. May be
+ *                                            NULL
+ * Outputs      : returns -
+ *                ERROR_NOERROR - file restored
+ *                ERROR_PATHTOOLONG - path exceeds max length
+ *                ERROR_READ_FILEOPEN - recipe or a chunk cannot be opened
+ *                ERROR_WRITE_FILEOPEN - output exists or cannot be created
+ *                ERROR_CHECKSUM_MISMATCH - a chunk does not match its hash
+ *                ERROR_IO_FAILED - recipe is invalid or truncated, or write failed
+ * Description  : Rebuilds the captured bytes from the chunks listed in the recipe.
+ *                Every chunk is checked against its hash. The output is removed
+ *                if the restore fails
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataDedup_Restore(const char* pRecipe, const char* pOutput, unsigned long long* pSize);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_DEDUP_H */
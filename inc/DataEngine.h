@@ -0,0 +1,106 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdio.h>
+#include <stdbool.h>
+#include "DataReader.h"
+#include "DataWriter.h"
+
+#ifndef DATA_ENGINE_H
+#define DATA_ENGINE_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define KERNEL_COPY_CHUNK_SIZE (64 * 1024 * 1024)
+#define MMAP_WINDOW_SIZE (256 * 1024 * 1024)
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Describes a single copy from an input to an output file */
+typedef struct
+{
+    FILE* input;                /* Input stream. May be stdin */
+    DATA_WRITER* writer;        /* Output of the capture */
+    unsigned int bufferSize;    /* Size of the user space I/O buffer in bytes */
+    CAPTURE_STATS* stats;       /* Reads of the capture. May be NULL */
+} ENGINE_JOB;
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataEngine_StdioCopy
+ * Inputs       : ENGINE_JOB* pJob - copy to be performed
+ * Outputs      : returns -
+ *                ERROR_NOERROR - end of input reached
+ *                ERROR_FILE_SIZELIMIT_REACHED - Output file size limit reached
+ *                ERROR_MEMORY_ALLOCATION - I/O buffer cannot be allocated
+ *                ERROR_WRITE_FILEOPEN - next output segment cannot be opened
+ *                ERROR_IO_FAILED - write to the output failed
+ * Description  : Copies the input to the output through a page aligned user space
+ *                buffer using fread/fwrite
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataEngine_StdioCopy(ENGINE_JOB* pJob);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataEngine_KernelCopy
+ * Inputs       : ENGINE_JOB* pJob - copy to be performed
+ * Outputs      : returns -
+ *                ERROR_NOERROR - end of input reached
+ *                ERROR_FILE_SIZELIMIT_REACHED - Output file size limit reached
+ *                ERROR_WRITE_FILEOPEN - next output segment cannot be opened
+ *                ERROR_IO_FAILED - read or write failed during the copy
+ * Description  : Copies the input to the output inside the kernel. Uses
+ *                copy_file_range and falls back to sendfile, splice and finally to
+ *                DataEngine_StdioCopy when a method is not supported for the pair
+ *                of files or the platform
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataEngine_KernelCopy(ENGINE_JOB* pJob);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataEngine_MmapCopy
+ * Inputs       : ENGINE_JOB* pJob - copy to be performed
+ * Outputs      : returns -
+ *                ERROR_NOERROR - end of input reached
+ *                ERROR_FILE_SIZELIMIT_REACHED - Output file size limit reached
+ *                ERROR_WRITE_FILEOPEN - next output segment cannot be opened
+ *                ERROR_IO_FAILED - mapping or write failed during the copy
+ * Description  : Maps a regular file input in windows of MMAP_WINDOW_SIZE, advises
+ *                the kernel of the sequential access and writes straight from the
+ *                mapping. Each window is unmapped before the next is mapped so the
+ *                resident set stays bounded. Other inputs and platforms without
+ *                mmap fall back to DataEngine_StdioCopy
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataEngine_MmapCopy(ENGINE_JOB* pJob);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataEngine_Read
+ * Inputs       : ENGINE_JOB* pJob - current copy
+ *                char* pBuffer - receives the data
+ *                unsigned int pSize - size of pBuffer in bytes
+ * Outputs      : returns -
+ *                Bytes read. 0 at end of input
+ * Description  : Reads the input through stdio and records the read in the
+ *                statistics of the job
+ -----------------------------------------------------------------------------------*/
+extern unsigned int DataEngine_Read(ENGINE_JOB* pJob, char* pBuffer, unsigned int pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataEngine_AllocateBuffer
+ * Inputs       : unsigned int pSize - size of the buffer in bytes
+ * Outputs      : returns -
+ *                Reference to the allocated buffer. NULL on failure
+ * Description  : Allocates a page aligned I/O buffer
+ -----------------------------------------------------------------------------------*/
+extern char* DataEngine_AllocateBuffer(unsigned int pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataEngine_FreeBuffer
+ * Inputs       : char* pBuffer - buffer allocated by DataEngine_AllocateBuffer()
+ * Outputs      :
+ * Description  : Releases an I/O buffer
+ -----------------------------------------------------------------------------------*/
+extern void DataEngine_FreeBuffer(char* pBuffer);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataEngine_GetCoreCount
+ * Inputs       :
+ * Outputs      : returns -
+ *                Number of online processors. At least 1
+ * Description  : Used to size worker pools
+ -----------------------------------------------------------------------------------*/
+extern unsigned int DataEngine_GetCoreCount(void);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_ENGINE_H */
@@ -0,0 +1,92 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdbool.h>
+#include "DataReader.h"
+
+#ifndef DATA_FOLLOW_H
+#define DATA_FOLLOW_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+/* File change events taken from the kernel at a time */
+#define FOLLOW_EVENT_BUFFER 4096
+/* Interval at which DataFollow_Run checks that the file is still followed */
+#define FOLLOW_CHECK_INTERVAL_MS 100
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Counters of a followed file */
+typedef struct
+{
+    unsigned long long bytes;           /* Bytes captured */
+    unsigned long long truncations;     /* Times the file shrank below the captured offset */
+    unsigned long long rotations;       /* Times a new file replaced the followed one */
+    bool active;                        /* The file is still followed */
+    ERROR_TYPE result;                  /* Result of the capture. Final once inactive */
+} FOLLOW_STATS;
+
+/* Followed file with the thread copying its new data. Opaque to the users */
+typedef struct DATA_FOLLOW DATA_FOLLOW;
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataFollow_Start
+ * Inputs       : DATA_FOLLOW** pFollow - Loaded with the running follow
+ *                const char* pReadFile - path of the file to be followed
+ *                bool pFromStart - true - capture the current content first.
+ *                                  false - capture only data appended from now
+ *                char* pWriteFile - Loaded with the output file path
+ *                int pSize - size of the pWriteFile buffer
+ * Outputs      : returns -
+ *                ERROR_NOERROR - file followed
+ *                ERROR_PATHTOOLONG - read or write path exceeds max length
+ *                ERROR_READ_FILEOPEN - directory of the file cannot be watched,
+ *                                      or the file is not a regular file
+ *                ERROR_MEMORY_ALLOCATION - follow cannot be allocated
+ *                ERROR_IO_FAILED - thread cannot be started, or the platform
+ *                                  has no inotify
+ *                Otherwise the result of DataReader_OpenStream
+ * Description  : Captures what is appended to the file like tail -F, into one
+ *                stream of the default configuration. The thread sleeps on file
+ *                change events and copies new data as soon as it is written. A
+ *                file that shrinks is captured again from its start, and a file
+ *                replaced under the same path, e.g. by log rotation, is captured
+ *                to its end before the new one is followed. A missing file is
+ *                waited for
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataFollow_Start(DATA_FOLLOW** pFollow, const char* pReadFile, bool pFromStart,
+                                   char* pWriteFile, int pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataFollow_GetStats
+ * Inputs       : DATA_FOLLOW* pFollow - running follow
+ *                FOLLOW_STATS* pStats - Loaded with the counters
+ * Outputs      :
+ * Description  : Counters are updated as the data is captured. A follow whose
+ *                capture failed is inactive and only waits to be stopped
+ -----------------------------------------------------------------------------------*/
+extern void DataFollow_GetStats(DATA_FOLLOW* pFollow, FOLLOW_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataFollow_Stop
+ * Inputs       : DATA_FOLLOW* pFollow - follow to be stopped and released
+ *                FOLLOW_STATS* pStats - Loaded with the final counters. May be NULL
+ * Outputs      :
+ * Description  : Captures the data appended so far, then closes the output
+ -----------------------------------------------------------------------------------*/
+extern void DataFollow_Stop(DATA_FOLLOW* pFollow, FOLLOW_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataFollow_Run
+ * Inputs       : const char* pReadFile - path of the file to be followed
+ *                bool pFromStart - capture the current content first
+ *                char* pWriteFile - Loaded with the output file path
+ *                int pSize - size of the pWriteFile buffer
+ *                FOLLOW_STATS* pStats - Loaded with the final counters
+ * Outputs      : returns -
+ *                Same as DataFollow_Start
+ * Description  : Follows the file until SIGINT or SIGTERM is received, or until
+ *                its capture fails
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataFollow_Run(const char* pReadFile, bool pFromStart, char* pWriteFile, int pSize,
+                                 FOLLOW_STATS* pStats);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_FOLLOW_H */
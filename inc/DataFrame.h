@@ -0,0 +1,95 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdio.h>
+#include "DataEngine.h"
+
+#ifndef DATA_FRAME_H
+#define DATA_FRAME_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+/* Framed output layout, per output segment, all numbers little endian:
+   Segment header: magic "DRF1", version u32, header size u32, segment number u32,
+                   creation time u64 (nanoseconds since the epoch), largest record
+                   size u32, source length u32, source name
+   Record        : data size u32, data
+   Index         : offset of every record from the start of the segment u64
+   Footer        : index offset u64, record count u64, data bytes u64, reserved u32,
+                   magic "DRFX"
+   Every segment is complete on its own. Records never span segments */
+#define FRAME_MAGIC "DRF1"
+#define FRAME_FOOTER_MAGIC "DRFX"
+#define FRAME_VERSION 1
+#define FRAME_HEADER_SIZE 32
+#define FRAME_RECORD_HEADER_SIZE 4
+#define FRAME_INDEX_ENTRY_SIZE 8
+#define FRAME_FOOTER_SIZE 32
+#define FRAME_STDIN_SOURCE "stdin"
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Description of a complete framed segment */
+typedef struct
+{
+    unsigned int version;
+    unsigned int segment;                   /* Sequence number of the segment */
+    unsigned long long created;             /* Creation time in nanoseconds since the epoch */
+    unsigned int maxRecordSize;             /* Largest record in bytes */
+    char source[MAX_FILEPATH_LENGTH];       /* Input of the capture */
+    unsigned long long indexOffset;         /* Offset of the record index */
+    unsigned long long records;             /* Number of records */
+    unsigned long long bytes;               /* Data bytes of all records */
+} FRAME_INFO;
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataFrame_Copy
+ * Inputs       : ENGINE_JOB* pJob - copy to be performed. Records are up to the I/O
+ *                                   buffer size
+ *                const char* pSource - name of the input recorded in the headers
+ * Outputs      : returns -
+ *                ERROR_NOERROR - end of input reached
+ *                ERROR_FILE_SIZELIMIT_REACHED - Output file size limit reached
+ *                ERROR_MEMORY_ALLOCATION - buffer or index cannot be allocated
+ *                ERROR_WRITE_FILEOPEN - next output segment cannot be opened
+ *                ERROR_IO_FAILED - write to the output failed
+ * Description  : Writes every read of the input as a length prefixed record. Each
+ *                segment starts with a header and ends with the index of its
+ *                records and a footer. A record that does not fit in the space
+ *                left in a segment is split, and the rest continues in the next
+ *                segment with rotation or is dropped without
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataFrame_Copy(ENGINE_JOB* pJob, const char* pSource);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataFrame_Open
+ * Inputs       : FILE* pInput - seekable framed segment
+ *                FRAME_INFO* pInfo - Loaded with the header and the footer
+ * Outputs      : returns -
+ *                ERROR_NOERROR - segment is complete
+ *                ERROR_IO_FAILED - header or footer is missing or they do not
+ *                                  match the size of the segment
+ * Description  : Reads only the header and the footer, so the completeness of a
+ *                segment is checked without reading its records
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataFrame_Open(FILE* pInput, FRAME_INFO* pInfo);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataFrame_ReadRecord
+ * Inputs       : FILE* pInput - seekable framed segment
+ *                const FRAME_INFO* pInfo - segment opened by DataFrame_Open
+ *                unsigned long long pRecord - number of the record, from 0
+ *                char* pData - receives the record
+ *                unsigned int pCapacity - size of pData in bytes
+ *                unsigned int* pSize - Loaded with the size of the record
+ * Outputs      : returns -
+ *                ERROR_NOERROR - record read
+ *                ERROR_INVALIDARG - no such record
+ *                ERROR_MEMORY_ALLOCATION - record is larger than pCapacity
+ *                ERROR_IO_FAILED - record cannot be read
+ * Description  : Seeks to the record through its index entry. Two seeks and two
+ *                reads whatever the number of the record
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataFrame_ReadRecord(FILE* pInput, const FRAME_INFO* pInfo, unsigned long long pRecord,
+                                       char* pData, unsigned int pCapacity, unsigned int* pSize);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_FRAME_H */
@@ -0,0 +1,85 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdio.h>
+#include "DataEngine.h"
+
+#ifndef DATA_LINES_H
+#define DATA_LINES_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+/* Line index sidecar, a text file next to each output file:
+   "# DataReader line index"
+   "interval <lines between two entries>"
+   "lines <lines in the file, the last one may be unterminated>"
+   "size <bytes in the file>"
+   "offsets"
+   one LINE_INDEX_ENTRY_LENGTH line per entry with the offset of line
+   interval * (entry + 1), so entry N is found without reading the others */
+#define LINE_DELIMITER '\n'
+#define LINE_INDEX_INTERVAL 1024
+#define LINE_INDEX_EXTENSION ".idx"
+#define LINE_INDEX_TITLE "# DataReader line index"
+#define LINE_INDEX_OFFSETS "offsets"
+#define LINE_INDEX_ENTRY_FORMAT "%020llu\n"
+#define LINE_INDEX_ENTRY_LENGTH 21
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataLines_Copy
+ * Inputs       : ENGINE_JOB* pJob - copy to be performed
+ *                bool pIndex - write a line index sidecar for every output file
+ * Outputs      : returns -
+ *                ERROR_NOERROR - end of input reached
+ *                ERROR_FILE_SIZELIMIT_REACHED - Output file size limit reached
+ *                ERROR_MEMORY_ALLOCATION - buffer or index cannot be allocated
+ *                ERROR_WRITE_FILEOPEN - next output segment cannot be opened
+ *                ERROR_IO_FAILED - write to the output or to an index failed
+ * Description  : Copies the input so that output files end on a line boundary.
+ *                The unterminated end of each read is held back until its line is
+ *                complete, and a full segment is cut after its last complete line.
+ *                Only a line longer than the I/O buffer or than a whole segment
+ *                is cut inside
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataLines_Copy(ENGINE_JOB* pJob, bool pIndex);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataLines_Seek
+ * Inputs       : const char* pFile - output file with a line index sidecar
+ *                unsigned long long pLine - number of the line, from 0
+ *                unsigned long long* pOffset - Loaded with the offset of the line
+ * Outputs      : returns -
+ *                ERROR_NOERROR - line found
+ *                ERROR_PATHTOOLONG - path exceeds max length
+ *                ERROR_READ_FILEOPEN - file or index cannot be opened
+ *                ERROR_INVALIDARG - file has fewer lines
+ *                ERROR_IO_FAILED - index is invalid or the file cannot be read
+ * Description  : Reads the index entry at or before the line directly and scans
+ *                at most LINE_INDEX_INTERVAL lines of the file
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataLines_Seek(const char* pFile, unsigned long long pLine, unsigned long long* pOffset);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataLines_Count
+ * Inputs       : const char* pData - data to be scanned
+ *                size_t pSize - size of the data in bytes
+ *                char pDelimiter - line delimiter
+ * Outputs      : returns -
+ *                Number of delimiters in the data
+ * Description  : Scans 32 bytes at a time with AVX2, or 16 with SSE2, where the
+ *                processor has them and byte by byte elsewhere
+ -----------------------------------------------------------------------------------*/
+extern unsigned long long DataLines_Count(const char* pData, size_t pSize, char pDelimiter);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataLines_FindLast
+ * Inputs       : const char* pData - data to be scanned
+ *                size_t pSize - size of the data in bytes
+ *                char pDelimiter - line delimiter
+ * Outputs      : returns -
+ *                Number of bytes up to and including the last delimiter. 0 if the
+ *                data has no delimiter
+ * Description  : Scans backwards from the end, with the same instructions as
+ *                DataLines_Count
+ -----------------------------------------------------------------------------------*/
+extern size_t DataLines_FindLast(const char* pData, size_t pSize, char pDelimiter);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_LINES_H */
@@ -0,0 +1,44 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include "DataEngine.h"
+
+#ifndef DATA_PARALLEL_H
+#define DATA_PARALLEL_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+/* Largest part of the input copied by one thread at a time */
+#define PARALLEL_RANGE_SIZE (8ULL * 1024ULL * 1024ULL)
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataParallel_Copy
+ * Inputs       : ENGINE_JOB* pJob - copy to be performed
+ *                unsigned int pThreads - number of copying threads
+ * Outputs      : returns -
+ *                ERROR_NOERROR - end of input reached
+ *                ERROR_FILE_SIZELIMIT_REACHED - Output file size limit reached
+ *                ERROR_MEMORY_ALLOCATION - buffers cannot be allocated
+ *                ERROR_WRITE_FILEOPEN - next output segment cannot be opened
+ *                ERROR_IO_FAILED - read or write failed, or no thread started
+ *                ERROR_INCONSISTENT_COPY - the output does not match the input,
+ *                                          or the input changed during the copy
+ * Description  : Copies a regular file input on pThreads threads. The part of the
+ *                input that fits in the current segment is reserved in the output
+ *                and split into ranges of up to PARALLEL_RANGE_SIZE, which the
+ *                threads take in turn and copy with pread and pwrite. Ranges are
+ *                committed to the writer in input order as they complete, so the
+ *                size limit, rotation and progress see the data in order. Each
+ *                completed segment is checked: its size must be the one planned
+ *                and, while the modification and change times of the input stay
+ *                the same, the last block of every range must match the input.
+ *                If the times moved during the segment, all of its data is
+ *                compared. After the copy the input must not have been modified
+ *                in place. Data appended meanwhile and the unaligned end of a
+ *                direct I/O output are copied by DataEngine_StdioCopy, like
+ *                inputs that are not regular files and platforms without pread
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataParallel_Copy(ENGINE_JOB* pJob, unsigned int pThreads);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_PARALLEL_H */
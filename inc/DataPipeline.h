@@ -0,0 +1,33 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include "DataEngine.h"
+
+#ifndef DATA_PIPELINE_H
+#define DATA_PIPELINE_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define MIN_PIPELINE_SLOTS 2
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataPipeline_Copy
+ * Inputs       : ENGINE_JOB* pJob - copy to be performed
+ *                unsigned long long pMemory - total memory of the ring in bytes
+ *                PIPELINE_STATS* pStats - Loaded with the stall counters of the copy
+ * Outputs      : returns -
+ *                ERROR_NOERROR - end of input reached
+ *                ERROR_FILE_SIZELIMIT_REACHED - Output file size limit reached
+ *                ERROR_MEMORY_ALLOCATION - ring cannot be allocated
+ *                ERROR_WRITE_FILEOPEN - next output segment cannot be opened
+ *                ERROR_IO_FAILED - reader thread cannot be started or write failed
+ * Description  : Copies the input to the output with a reader thread and the
+ *                calling thread as writer. Both are joined by a single producer /
+ *                single consumer lock-free ring of buffers whose total size is
+ *                limited to pMemory. A side that finds the ring full (reader) or
+ *                empty (writer) counts a stall and waits for the other side
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataPipeline_Copy(ENGINE_JOB* pJob, unsigned long long pMemory, PIPELINE_STATS* pStats);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_PIPELINE_H */
@@ -2,6 +2,7 @@
 /* Header includes */
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
 
 #ifndef DATA_READER_H
 #define DATA_READER_H
@@ -10,9 +11,23 @@
 /* Definitions */
 #define MAX_FILEPATH_LENGTH 255
 #define DEFAULT_OUTPUT_FILE_SIZE_KB "65535"
+#define DEFAULT_BUFFER_SIZE_KB "64"
+#define MAX_BUFFER_SIZE_KB 65536
+#define BUFFER_ALIGNMENT 4096
+#define DEFAULT_PIPELINE_MEMORY "16M"
+#define DEFAULT_QUEUE_DEPTH "8"
+#define MAX_QUEUE_DEPTH 64
 #define DEFAULT_FILENAME_PREFIX  "File_"
 #define DEFAULT_FILE_EXTENSTION ".dat"
+/* Output directories written in parallel, the first one included */
+#define MAX_DESTINATIONS 4
+#ifdef _WIN32
 #define PATH_DELIMITER '\\'
+#define DESTINATION_DELIMITER ';'
+#else
+#define PATH_DELIMITER '/'
+#define DESTINATION_DELIMITER ':'
+#endif
 #define NULL_CHARACTER '\0'
 
 /*----------------------------------------------------------------------------------*/
@@ -23,6 +38,22 @@ typedef enum
     ARGUMENT_PATH = 0,
     ARGUMENT_FILENAME,
     ARGUMENT_MAXFILESIZE,
+    ARGUMENT_BUFFERSIZE,
+    ARGUMENT_FLUSHINTERVAL,
+    ARGUMENT_ENGINE,
+    ARGUMENT_ROTATE,
+    ARGUMENT_PIPELINEMEMORY,
+    ARGUMENT_QUEUEDEPTH,
+    ARGUMENT_DIRECTIO,
+    ARGUMENT_COMPRESS,
+    ARGUMENT_CHECKSUM,
+    ARGUMENT_DEDUP,
+    ARGUMENT_FRAMING,
+    ARGUMENT_LINES,
+    ARGUMENT_STATSFILE,
+    ARGUMENT_PREALLOCATE,
+    ARGUMENT_DURABILITY,
+    ARGUMENT_CHECKPOINT,
     ARGUMENT_HELP,
     ARGUMENT_MAX /*This item should always be at the end*/
 } ARGUMENT_TYPE;
@@ -34,15 +65,330 @@ typedef enum
     ERROR_INVALIDARG,
     ERROR_PATHTOOLONG,
     ERROR_INVALIDFILESIZE,
+    ERROR_INVALIDBUFFERSIZE,
+    ERROR_INVALIDFLUSHINTERVAL,
+    ERROR_MEMORY_ALLOCATION,
+    ERROR_INVALIDENGINE,
+    ERROR_IO_FAILED,
+    ERROR_INVALIDROTATION,
+    ERROR_INVALIDPIPELINEMEMORY,
+    ERROR_INVALIDQUEUEDEPTH,
+    ERROR_INVALIDDIRECTIO,
+    ERROR_INVALIDCOMPRESSION,
+    ERROR_INVALIDCHECKSUM,
+    ERROR_INVALIDDEDUP,
+    ERROR_INVALIDFRAMING,
+    ERROR_INVALIDLINES,
+    ERROR_INVALIDPREALLOCATION,
+    ERROR_INVALIDDURABILITY,
+    ERROR_INVALIDDESTINATIONS,
+    ERROR_INVALIDCHECKPOINT,
     ERROR_READ_FILEOPEN,
     ERROR_WRITE_FILEOPEN,
     ERROR_FILE_SIZELIMIT_REACHED,
+    ERROR_CHECKSUM_MISMATCH,
+    ERROR_DESTINATION_STALLED,
+    ERROR_INCONSISTENT_COPY,
     ERROR_HELP_INVOKED,
     ERROR_UNKNOWN,
     ERROR_MAX /*This item should always be at the end*/
 } ERROR_TYPE;
+
+/* Copy engines used to move the data from input to output */
+typedef enum
+{
+    ENGINE_STDIO = 0,
+    ENGINE_KERNEL,
+    ENGINE_MMAP,
+    ENGINE_PIPELINE,
+    ENGINE_URING,
+    ENGINE_PARALLEL,
+    ENGINE_MAX /*This item should always be at the end*/
+} ENGINE_TYPE;
+
+/* Points at which the output is synced to the device */
+typedef enum
+{
+    DURABILITY_NONE = 0,    /* Left to the operating system */
+    DURABILITY_BYTES,       /* fdatasync after every sync interval of data, fsync on close */
+    DURABILITY_TIME,        /* fdatasync after every sync interval of time, fsync on close */
+    DURABILITY_CLOSE,       /* fsync when an output file is closed */
+    DURABILITY_GROUP,       /* As close, with one sync shared by the captures closing together */
+    DURABILITY_MAX /*This item should always be at the end*/
+} DURABILITY_TYPE;
+
+/* Stall counters of the pipelined engine */
+typedef struct
+{
+    unsigned long long readerStalls;    /* Reader found the ring full - output is the bottleneck */
+    unsigned long long writerStalls;    /* Writer found the ring empty - input is the bottleneck */
+    unsigned long long readerStallTime; /* Time the reader waited in microseconds */
+    unsigned long long writerStallTime; /* Time the writer waited in microseconds */
+} PIPELINE_STATS;
+
+/* Block counters of the compression stage */
+typedef struct
+{
+    unsigned long long blocks;          /* Blocks written */
+    unsigned long long rawBlocks;       /* Blocks stored uncompressed */
+    unsigned long long inputBytes;      /* Bytes read from the input */
+    unsigned long long storedBytes;     /* Bytes of the blocks in the output, with headers */
+} COMPRESS_STATS;
+
+/* Chunk counters of the deduplication stage */
+typedef struct
+{
+    unsigned long long chunks;          /* Chunks listed in the recipe */
+    unsigned long long newChunks;       /* Chunks added to the store */
+    unsigned long long inputBytes;      /* Bytes read from the input */
+    unsigned long long storedBytes;     /* Bytes of the chunks added to the store */
+} DEDUP_STATS;
+
+/* Result of one output directory of a capture written to several */
+typedef struct
+{
+    ERROR_TYPE result;                  /* Result of the copy to this directory */
+    unsigned long long bytes;           /* Bytes written to this directory */
+    unsigned long long waitTime;        /* Time its writer waited for data in microseconds */
+    char output[MAX_FILEPATH_LENGTH];   /* First output file in this directory */
+} DESTINATION_STATS;
+
+/* Counters of a capture written to several output directories */
+typedef struct
+{
+    unsigned int destinations;          /* Output directories, the first one included */
+    unsigned long long readerStalls;    /* Reader found a writer a full ring behind */
+    unsigned long long readerStallTime; /* Time the reader waited in microseconds */
+    DESTINATION_STATS destination[MAX_DESTINATIONS];
+} TEE_STATS;
+
+/* Buckets of a latency histogram. Bucket N counts the calls taking 2^N to
+   2^(N+1) - 1 nanoseconds, the last one also all longer calls */
+#define STATS_LATENCY_BUCKETS 40
+/* Throughput samples kept per capture */
+#define STATS_THROUGHPUT_SAMPLES 64
+
+/* Calls of one kind made by a capture */
+typedef struct
+{
+    unsigned long long calls;
+    unsigned long long bytes;
+    unsigned long long totalTime;       /* Time in the calls in nanoseconds */
+    unsigned long long maxTime;         /* Longest call in nanoseconds */
+    unsigned long long buckets[STATS_LATENCY_BUCKETS];
+} CALL_STATS;
+
+/* Counters of a single capture, collected by every engine */
+typedef struct
+{
+    unsigned long long started;         /* Monotonic start time in nanoseconds */
+    unsigned long long duration;        /* Duration of the capture in nanoseconds */
+    unsigned int segments;              /* Output files written */
+    unsigned long long flushes;         /* Flushes made by the flush interval */
+    CALL_STATS reads;                   /* Reads of the input */
+    CALL_STATS writes;                  /* Writes to the output. Kernel copies count as both */
+    CALL_STATS syncs;                   /* Syncs of the output to the device, with the bytes each made durable */
+    unsigned long long sampleInterval;  /* Time covered by one throughput sample in nanoseconds */
+    unsigned int samples;               /* Throughput samples in use */
+    unsigned long long sampleBytes[STATS_THROUGHPUT_SAMPLES]; /* Bytes written in each sample */
+} CAPTURE_STATS;
+
+/* Configuration and statistics of independent captures. Opaque to the users */
+typedef struct DATA_READER_CONTEXT DATA_READER_CONTEXT;
+
+/* Output of a capture whose data is handed over by the caller. Opaque to the users */
+typedef struct DATA_READER_STREAM DATA_READER_STREAM;
 /*----------------------------------------------------------------------------------*/
 /* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextCreate
+ * Inputs       :
+ * Outputs      : returns -
+ *                New context with default arguments. NULL on allocation failure
+ * Description  : Creates a context for captures that are configured independently
+ *                of the default context and of each other. Captures on different
+ *                contexts can run at the same time
+ -----------------------------------------------------------------------------------*/
+extern DATA_READER_CONTEXT* DataReader_ContextCreate(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextDestroy
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be released. May be NULL
+ * Outputs      :
+ * Description  : Releases a context created by DataReader_ContextCreate. No capture
+ *                may be running on it
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_ContextDestroy(DATA_READER_CONTEXT* pContext);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextParseArguments
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be configured
+ *                char pArgc - argument count
+ *                char* pArgv[] - reference to arguments string
+ * Outputs      : returns -
+ *                Same as DataReader_ParseArguments
+ * Description  : DataReader_ParseArguments for the given context
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataReader_ContextParseArguments(DATA_READER_CONTEXT* pContext, int pArgc, char* pArgv[]);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextReadData
+ * Inputs       : DATA_READER_CONTEXT* pContext - configuration of the capture
+ *                const char* pReadFile - Input file to be read from
+ *                char* pWriteFile - String buffer to store the output file path
+ *                int pSize - Size of pWriteFile buffer
+ * Outputs      : returns -
+ *                Same as DataReader_ReadData
+ * Description  : DataReader_ReadData with the configuration of the given context.
+ *                Several captures may run on one context at the same time
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataReader_ContextReadData(DATA_READER_CONTEXT* pContext, const char* pReadFile,
+                                             char* pWriteFile, int pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextOpenStream
+ * Inputs       : DATA_READER_CONTEXT* pContext - configuration of the capture
+ *                DATA_READER_STREAM** pStream - Loaded with the new stream
+ *                char* pWriteFile - String buffer to store the output file path
+ *                int pSize - Size of pWriteFile buffer
+ * Outputs      : returns -
+ *                ERROR_NOERROR - output opened
+ *                ERROR_PATHTOOLONG - output path exceeds max length
+ *                ERROR_WRITE_FILEOPEN - write file cannot be opened
+ *                ERROR_MEMORY_ALLOCATION - stream cannot be allocated
+ *                ERROR_INVALIDARG - the configured mode needs to read the input
+ *                                   itself (-z, -u, -t, -w or several -p paths)
+ * Description  : Opens the output of a capture whose data is passed to
+ *                DataReader_StreamWrite() instead of being read from a file. The
+ *                output is named, limited, rotated and synced as with
+ *                DataReader_ContextReadData()
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataReader_ContextOpenStream(DATA_READER_CONTEXT* pContext, DATA_READER_STREAM** pStream,
+                                               char* pWriteFile, int pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_StreamWrite
+ * Inputs       : DATA_READER_STREAM* pStream - stream opened by DataReader_OpenStream
+ *                const char* pData - data to be captured
+ *                unsigned int pSize - size of the data in bytes
+ * Outputs      : returns -
+ *                ERROR_NOERROR - all data written
+ *                ERROR_FILE_SIZELIMIT_REACHED - Output file size limit reached
+ *                ERROR_WRITE_FILEOPEN - next output file cannot be opened
+ *                ERROR_IO_FAILED - write failed
+ * Description  : Appends the data to the output. A stream may be written by
+ *                different threads, one at a time. After an error the stream only
+ *                waits to be closed
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataReader_StreamWrite(DATA_READER_STREAM* pStream, const char* pData, unsigned int pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_StreamFlush
+ * Inputs       : DATA_READER_STREAM* pStream - stream opened by DataReader_OpenStream
+ * Outputs      : returns -
+ *                ERROR_NOERROR - written data is in the output file
+ *                ERROR_IO_FAILED - write failed
+ * Description  : Hands the data buffered since the last flush to the operating
+ *                system without waiting for the flush interval. With direct I/O
+ *                the partial block at the end stays buffered
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataReader_StreamFlush(DATA_READER_STREAM* pStream);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_StreamClose
+ * Inputs       : DATA_READER_STREAM* pStream - stream to be closed and released
+ * Outputs      : returns -
+ *                First error of the stream, or the result of closing its output
+ * Description  : Closes the output and records the statistics of the capture like
+ *                DataReader_ContextReadData()
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataReader_StreamClose(DATA_READER_STREAM* pStream);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextGet...
+ * Inputs       : const DATA_READER_CONTEXT* pContext - context to be queried
+ * Outputs      : returns -
+ *                Same as the DataReader_Get... function of the same name
+ * Description  : Getters of the arguments of the given context
+ -----------------------------------------------------------------------------------*/
+extern const unsigned long long DataReader_ContextGetMaxOutputFileSize(const DATA_READER_CONTEXT* pContext);
+extern const unsigned int DataReader_ContextGetBufferSize(const DATA_READER_CONTEXT* pContext);
+extern const unsigned long long DataReader_ContextGetFlushInterval(const DATA_READER_CONTEXT* pContext);
+extern const ENGINE_TYPE DataReader_ContextGetEngine(const DATA_READER_CONTEXT* pContext);
+extern const bool DataReader_ContextGetRotation(const DATA_READER_CONTEXT* pContext);
+extern const unsigned long long DataReader_ContextGetPipelineMemory(const DATA_READER_CONTEXT* pContext);
+extern const unsigned int DataReader_ContextGetQueueDepth(const DATA_READER_CONTEXT* pContext);
+extern const bool DataReader_ContextGetDirectIo(const DATA_READER_CONTEXT* pContext);
+extern const bool DataReader_ContextGetCompression(const DATA_READER_CONTEXT* pContext);
+extern const bool DataReader_ContextGetChecksum(const DATA_READER_CONTEXT* pContext);
+extern const bool DataReader_ContextGetDedup(const DATA_READER_CONTEXT* pContext);
+extern const bool DataReader_ContextGetFraming(const DATA_READER_CONTEXT* pContext);
+extern const bool DataReader_ContextGetLines(const DATA_READER_CONTEXT* pContext);
+extern const bool DataReader_ContextGetLineIndex(const DATA_READER_CONTEXT* pContext);
+extern const bool DataReader_ContextGetPreallocation(const DATA_READER_CONTEXT* pContext);
+extern const DURABILITY_TYPE DataReader_ContextGetDurability(const DATA_READER_CONTEXT* pContext);
+extern const unsigned long long DataReader_ContextGetSyncInterval(const DATA_READER_CONTEXT* pContext);
+extern const bool DataReader_ContextGetCheckpoint(const DATA_READER_CONTEXT* pContext);
+extern const char* DataReader_ContextGetWriteFilePath(const DATA_READER_CONTEXT* pContext);
+extern const char* DataReader_ContextGetWriteFileNamePrefix(const DATA_READER_CONTEXT* pContext);
+extern const char* DataReader_ContextGetStatsFile(const DATA_READER_CONTEXT* pContext);
+extern const char* DataReader_ContextGetDestinationPath(const DATA_READER_CONTEXT* pContext, unsigned int pIndex);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextGetPipelineStats
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be queried
+ *                PIPELINE_STATS* pStats - Loaded with the stall counters
+ * Outputs      :
+ * Description  : returns the stall counters of the last pipelined capture made on
+ *                the given context
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_ContextGetPipelineStats(DATA_READER_CONTEXT* pContext, PIPELINE_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextGetCompressStats
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be queried
+ *                COMPRESS_STATS* pStats - Loaded with the block counters
+ * Outputs      :
+ * Description  : returns the block counters of the last compressed capture made on
+ *                the given context
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_ContextGetCompressStats(DATA_READER_CONTEXT* pContext, COMPRESS_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextGetDedupStats
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be queried
+ *                DEDUP_STATS* pStats - Loaded with the chunk counters
+ * Outputs      :
+ * Description  : returns the chunk counters of the last deduplicated capture made
+ *                on the given context
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_ContextGetDedupStats(DATA_READER_CONTEXT* pContext, DEDUP_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextGetCaptureStats
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be queried
+ *                CAPTURE_STATS* pStats - Loaded with the capture counters
+ * Outputs      :
+ * Description  : returns the counters, latency histograms and throughput samples
+ *                of the last capture made on the given context, whatever its engine
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_ContextGetCaptureStats(DATA_READER_CONTEXT* pContext, CAPTURE_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextGetTeeStats
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be queried
+ *                TEE_STATS* pStats - Loaded with the results of every directory
+ * Outputs      :
+ * Description  : returns the results of the last capture made on the given context
+ *                with several output directories
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_ContextGetTeeStats(DATA_READER_CONTEXT* pContext, TEE_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextGetResumedBytes
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be queried
+ * Outputs      : returns -
+ *                Input bytes of the last capture taken from an earlier one
+ * Description  : Zero unless the last capture made on the given context
+ *                continued from a checkpoint
+ -----------------------------------------------------------------------------------*/
+extern unsigned long long DataReader_ContextGetResumedBytes(DATA_READER_CONTEXT* pContext);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_ContextResetArguments
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be reset
+ * Outputs      :
+ * Description  : Resets all configurable arguments of the given context
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_ContextResetArguments(DATA_READER_CONTEXT* pContext);
+/*-----------------------------------------------------------------------------------
+ * The functions below operate on the default context of the component
+ -----------------------------------------------------------------------------------*/
 /*-----------------------------------------------------------------------------------
  * Name         : DataReader_ParseArguments
  * Inputs       : char pArgc - argument count
@@ -53,7 +399,8 @@ typedef enum
  *                ERROR_GRACEFUL_CLOSE - argument parsed but execution can be stopped
  * Description  : Parses the argument list and stores the necessary information. The
  *                 argument list is received as an array of strings with the argument id
- *                 and the argument placed one after the other
+ *                 and the argument placed one after the other. Sizes are in KB unless
+ *                 suffixed with K, M, G or T
  -----------------------------------------------------------------------------------*/
 extern ERROR_TYPE DataReader_ParseArguments(int pArgc, char* pArgv[]);
 /*-----------------------------------------------------------------------------------
@@ -66,9 +413,37 @@ extern ERROR_TYPE DataReader_ParseArguments(int pArgc, char* pArgv[]);
  *                ERROR_READ_FILEOPEN - read file cannot be opened
  *                ERROR_WRITE_FILEOPEN - write file cannot be opened
  *                ERROR_FILE_SIZELIMIT_REACHED - Output file size limit reached
- * Description  : Reads the data and saves it to the output file.
+ *                ERROR_MEMORY_ALLOCATION - I/O buffer cannot be allocated
+ *                ERROR_IO_FAILED - read or write failed during the copy
+ *                ERROR_INVALIDDESTINATIONS - several output directories are
+ *                                            combined with a transforming mode
+ *                ERROR_INVALIDCHECKPOINT - checkpoints are combined with a
+ *                                          transforming mode, checksums or
+ *                                          several output directories
+ * Description  : Reads the data and saves it to the output file. Data is copied
+ *                through a page aligned heap buffer of the configured size and the
+ *                output is flushed only at the configured interval and on close.
+ *                With rotation enabled the output is split into sequence numbered
+ *                segments of the maximum size and pWriteFile holds the first one.
+ *                With several output directories the input is read once and
+ *                written to each of them. The capture succeeds if any directory
+ *                received all of it, see DataReader_GetTeeStats for each one.
+ *                With checkpoints enabled, a file input captured before continues
+ *                in the output of the earlier capture from where it stopped, and
+ *                pWriteFile holds the output file appended to.
  -----------------------------------------------------------------------------------*/
 extern ERROR_TYPE DataReader_ReadData(const char* pReadFile, char* pWriteFile, int pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_OpenStream
+ * Inputs       : DATA_READER_STREAM** pStream - Loaded with the new stream
+ *                char* pWriteFile - String buffer to store the output file path
+ *                int pSize - Size of pWriteFile buffer
+ * Outputs      : returns -
+ *                Same as DataReader_ContextOpenStream
+ * Description  : Opens a capture fed with DataReader_StreamWrite() instead of
+ *                being read from a file
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataReader_OpenStream(DATA_READER_STREAM** pStream, char* pWriteFile, int pSize);
 /*-----------------------------------------------------------------------------------
  * Name         : DataReader_GetMaxOutputFileSize
  * Inputs       :
@@ -76,7 +451,193 @@ extern ERROR_TYPE DataReader_ReadData(const char* pReadFile, char* pWriteFile, i
  *                MaxOutputFileSize
  * Description  : returns the maximum allowed size of the output file in KB
  -----------------------------------------------------------------------------------*/
-extern const unsigned int DataReader_GetMaxOutputFileSize(void);
+extern const unsigned long long DataReader_GetMaxOutputFileSize(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetBufferSize
+ * Inputs       :
+ * Outputs      : returns -
+ *                BufferSize
+ * Description  : returns the size of the I/O buffer used for the data copy in KB
+ -----------------------------------------------------------------------------------*/
+extern const unsigned int DataReader_GetBufferSize(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetFlushInterval
+ * Inputs       :
+ * Outputs      : returns -
+ *                FlushInterval
+ * Description  : returns the amount of data written between two output flushes in
+ *                KB. Zero means the output is flushed only when the file is closed
+ -----------------------------------------------------------------------------------*/
+extern const unsigned long long DataReader_GetFlushInterval(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetRotation
+ * Inputs       :
+ * Outputs      : returns -
+ *                true if output rotation is enabled
+ * Description  : returns whether a new output segment is opened when the maximum
+ *                output file size is reached
+ -----------------------------------------------------------------------------------*/
+extern const bool DataReader_GetRotation(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetPipelineMemory
+ * Inputs       :
+ * Outputs      : returns -
+ *                PipelineMemory
+ * Description  : returns the total memory of the pipelined engine ring in KB
+ -----------------------------------------------------------------------------------*/
+extern const unsigned long long DataReader_GetPipelineMemory(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetPipelineStats
+ * Inputs       : PIPELINE_STATS* pStats - Loaded with the stall counters
+ * Outputs      :
+ * Description  : returns the stall counters of the last capture made with the
+ *                pipelined engine
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_GetPipelineStats(PIPELINE_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetQueueDepth
+ * Inputs       :
+ * Outputs      : returns -
+ *                QueueDepth
+ * Description  : returns the number of requests kept in flight by the io_uring
+ *                engine, or of threads copying with the parallel engine
+ -----------------------------------------------------------------------------------*/
+extern const unsigned int DataReader_GetQueueDepth(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetDirectIo
+ * Inputs       :
+ * Outputs      : returns -
+ *                true if direct I/O output is enabled
+ * Description  : returns whether the output files are written around the page
+ *                cache
+ -----------------------------------------------------------------------------------*/
+extern const bool DataReader_GetDirectIo(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetCompression
+ * Inputs       :
+ * Outputs      : returns -
+ *                true if the output is compressed
+ * Description  : returns whether the output is written in the compressed block
+ *                format. The blocks are the size of the I/O buffer
+ -----------------------------------------------------------------------------------*/
+extern const bool DataReader_GetCompression(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetCompressStats
+ * Inputs       : COMPRESS_STATS* pStats - Loaded with the block counters
+ * Outputs      :
+ * Description  : returns the block counters of the last compressed capture
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_GetCompressStats(COMPRESS_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetChecksum
+ * Inputs       :
+ * Outputs      : returns -
+ *                true if checksums are recorded
+ * Description  : returns whether a CRC32C sidecar is written for every output file
+ -----------------------------------------------------------------------------------*/
+extern const bool DataReader_GetChecksum(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetDedup
+ * Inputs       :
+ * Outputs      : returns -
+ *                true if the output is deduplicated
+ * Description  : returns whether captures are stored as chunks in the chunk store
+ *                of the write path, with a recipe in place of the .dat file
+ -----------------------------------------------------------------------------------*/
+extern const bool DataReader_GetDedup(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetDedupStats
+ * Inputs       : DEDUP_STATS* pStats - Loaded with the chunk counters
+ * Outputs      :
+ * Description  : returns the chunk counters of the last deduplicated capture
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_GetDedupStats(DEDUP_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetCaptureStats
+ * Inputs       : CAPTURE_STATS* pStats - Loaded with the capture counters
+ * Outputs      :
+ * Description  : returns the counters, latency histograms and throughput samples
+ *                of the last capture
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_GetCaptureStats(CAPTURE_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetStatsFile
+ * Inputs       :
+ * Outputs      : returns -
+ *                Path of the statistics file. Empty if none
+ * Description  : returns the file the statistics of every capture are appended to
+ -----------------------------------------------------------------------------------*/
+extern const char* DataReader_GetStatsFile(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetFraming
+ * Inputs       :
+ * Outputs      : returns -
+ *                true if the output is framed
+ * Description  : returns whether the output is written as length prefixed records
+ *                between a segment header and a footer index
+ -----------------------------------------------------------------------------------*/
+extern const bool DataReader_GetFraming(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetLines
+ * Inputs       :
+ * Outputs      : returns -
+ *                true if output files end on line boundaries
+ * Description  : returns whether segments are cut after their last complete line
+ -----------------------------------------------------------------------------------*/
+extern const bool DataReader_GetLines(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetLineIndex
+ * Inputs       :
+ * Outputs      : returns -
+ *                true if output files get a line index sidecar
+ * Description  : returns whether a sparse line index is written next to every
+ *                output file
+ -----------------------------------------------------------------------------------*/
+extern const bool DataReader_GetLineIndex(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetPreallocation
+ * Inputs       :
+ * Outputs      : returns -
+ *                true if output space is reserved up front
+ * Description  : returns whether the space of every output file is reserved with
+ *                fallocate when it is opened and the unused rest released on close
+ -----------------------------------------------------------------------------------*/
+extern const bool DataReader_GetPreallocation(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetDurability
+ * Inputs       :
+ * Outputs      : returns -
+ *                Durability policy
+ * Description  : returns when the output is synced to the device
+ -----------------------------------------------------------------------------------*/
+extern const DURABILITY_TYPE DataReader_GetDurability(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetSyncInterval
+ * Inputs       :
+ * Outputs      : returns -
+ *                SyncInterval
+ * Description  : returns the data between two syncs in KB for DURABILITY_BYTES and
+ *                the time between two syncs in milliseconds for DURABILITY_TIME.
+ *                Zero for the other policies
+ -----------------------------------------------------------------------------------*/
+extern const unsigned long long DataReader_GetSyncInterval(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetCheckpoint
+ * Inputs       :
+ * Outputs      : returns -
+ *                Checkpoint mode
+ * Description  : returns whether file captures save a checkpoint next to the
+ *                output and continue from it when run again
+ -----------------------------------------------------------------------------------*/
+extern const bool DataReader_GetCheckpoint(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetResumedBytes
+ * Inputs       :
+ * Outputs      : returns -
+ *                Input bytes of the last capture taken from an earlier one
+ * Description  : Zero unless the last capture continued from a checkpoint
+ -----------------------------------------------------------------------------------*/
+extern unsigned long long DataReader_GetResumedBytes(void);
 /*-----------------------------------------------------------------------------------
  * Name         : DataReader_GetWriteFilePath
  * Inputs       :
@@ -85,6 +646,31 @@ extern const unsigned int DataReader_GetMaxOutputFileSize(void);
  * Description  : returns the path to which files will be saved to
  -----------------------------------------------------------------------------------*/
 extern const char* DataReader_GetWriteFilePath(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetDestinationPath
+ * Inputs       : unsigned int pIndex - position of the directory in the -p list
+ * Outputs      : returns -
+ *                String buffer reference to the directory. NULL past the last one
+ * Description  : returns an output directory of the captures. Directory 0 is the
+ *                write file path
+ -----------------------------------------------------------------------------------*/
+extern const char* DataReader_GetDestinationPath(unsigned int pIndex);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetTeeStats
+ * Inputs       : TEE_STATS* pStats - Loaded with the results of every directory
+ * Outputs      :
+ * Description  : returns the results of the last capture written to several output
+ *                directories
+ -----------------------------------------------------------------------------------*/
+extern void DataReader_GetTeeStats(TEE_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataReader_GetEngine
+ * Inputs       :
+ * Outputs      : returns -
+ *                Engine
+ * Description  : returns the copy engine used to move data to the output file
+ -----------------------------------------------------------------------------------*/
+extern const ENGINE_TYPE DataReader_GetEngine(void);
 /*-----------------------------------------------------------------------------------
  * Name         : DataReader_GetWriteFileNamePrefix
  * Inputs       :
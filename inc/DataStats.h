@@ -0,0 +1,120 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdio.h>
+#include <stdbool.h>
+#include "DataReader.h"
+
+#ifndef DATA_STATS_H
+#define DATA_STATS_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+/* Time covered by one throughput sample at the start of a capture. Doubled, with
+   the samples merged in pairs, whenever a capture outlasts all samples */
+#define STATS_SAMPLE_INTERVAL_NS (100ULL * 1000ULL * 1000ULL)
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataStats_Now
+ * Inputs       :
+ * Outputs      : returns -
+ *                Monotonic time in nanoseconds
+ * Description  : Start time of a call passed to DataStats_RecordRead and
+ *                DataStats_RecordWrite
+ -----------------------------------------------------------------------------------*/
+extern unsigned long long DataStats_Now(void);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataStats_Start
+ * Inputs       : CAPTURE_STATS* pStats - statistics of a new capture
+ * Outputs      :
+ * Description  : Clears the counters and starts the capture clock
+ -----------------------------------------------------------------------------------*/
+extern void DataStats_Start(CAPTURE_STATS* pStats);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataStats_RecordRead
+ * Inputs       : CAPTURE_STATS* pStats - statistics of the capture. May be NULL
+ *                unsigned long long pStart - DataStats_Now() before the call
+ *                unsigned long long pBytes - bytes returned by the call
+ * Outputs      :
+ * Description  : Counts one read of the input and its latency. Must only be called
+ *                by the thread reading the input
+ -----------------------------------------------------------------------------------*/
+extern void DataStats_RecordRead(CAPTURE_STATS* pStats, unsigned long long pStart, unsigned long long pBytes);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataStats_RecordWrite
+ * Inputs       : CAPTURE_STATS* pStats - statistics of the capture. May be NULL
+ *                unsigned long long pStart - DataStats_Now() before the call
+ *                unsigned long long pBytes - bytes written by the call
+ * Outputs      :
+ * Description  : Counts one write to the output, its latency and its share of the
+ *                throughput sample it ends in. Must only be called by the thread
+ *                writing the output
+ -----------------------------------------------------------------------------------*/
+extern void DataStats_RecordWrite(CAPTURE_STATS* pStats, unsigned long long pStart, unsigned long long pBytes);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataStats_RecordSync
+ * Inputs       : CAPTURE_STATS* pStats - statistics of the capture. May be NULL
+ *                unsigned long long pStart - DataStats_Now() before the sync
+ *                unsigned long long pEnd - DataStats_Now() after the sync
+ *                unsigned long long pBytes - bytes made durable by the sync
+ * Outputs      :
+ * Description  : Counts one sync of the output and its latency. The end is passed
+ *                in, so syncs made by the thread closing a segment can be counted
+ *                later by the thread writing the output, which must be the only
+ *                one calling this
+ -----------------------------------------------------------------------------------*/
+extern void DataStats_RecordSync(CAPTURE_STATS* pStats, unsigned long long pStart, unsigned long long pEnd,
+                                 unsigned long long pBytes);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataStats_Finish
+ * Inputs       : CAPTURE_STATS* pStats - statistics of the capture
+ *                unsigned int pSegments - output files written
+ * Outputs      :
+ * Description  : Stops the capture clock
+ -----------------------------------------------------------------------------------*/
+extern void DataStats_Finish(CAPTURE_STATS* pStats, unsigned int pSegments);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataStats_Percentile
+ * Inputs       : const CALL_STATS* pCalls - latency distribution
+ *                unsigned int pPercent - 1 - 100
+ * Outputs      : returns -
+ *                Upper bound of the bucket holding the percentile in nanoseconds.
+ *                0 without calls
+ * Description  : The bound is at most twice the true latency
+ -----------------------------------------------------------------------------------*/
+extern unsigned long long DataStats_Percentile(const CALL_STATS* pCalls, unsigned int pPercent);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataStats_ToJson
+ * Inputs       : const CAPTURE_STATS* pStats - statistics of a finished capture
+ *                const char* pOutput - first output file of the capture
+ *                ERROR_TYPE pResult - result of the capture
+ *                char* pBuffer - receives the JSON object, without a line end
+ *                size_t pSize - size of pBuffer in bytes
+ * Outputs      : returns -
+ *                Length of the complete JSON object. The object is truncated when
+ *                this is not less than pSize
+ * Description  : Formats the counters, the latency percentiles and non empty
+ *                histogram buckets of the reads, writes and syncs, and the throughput
+ *                samples in MB/s
+ -----------------------------------------------------------------------------------*/
+extern size_t DataStats_ToJson(const CAPTURE_STATS* pStats, const char* pOutput, ERROR_TYPE pResult,
+                               char* pBuffer, size_t pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataStats_Append
+ * Inputs       : const CAPTURE_STATS* pStats - statistics of a finished capture
+ *                const char* pFile - JSON lines file
+ *                const char* pOutput - first output file of the capture
+ *                ERROR_TYPE pResult - result of the capture
+ * Outputs      : returns -
+ *                ERROR_NOERROR - statistics appended
+ *                ERROR_MEMORY_ALLOCATION - JSON object cannot be formatted
+ *                ERROR_WRITE_FILEOPEN - file cannot be opened
+ *                ERROR_IO_FAILED - write failed
+ * Description  : Appends the JSON object as one line with a single write, so that
+ *                concurrent captures do not interleave their lines
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataStats_Append(const CAPTURE_STATS* pStats, const char* pFile, const char* pOutput,
+                                   ERROR_TYPE pResult);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_STATS_H */
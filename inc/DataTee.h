@@ -0,0 +1,47 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include "DataEngine.h"
+
+#ifndef DATA_TEE_H
+#define DATA_TEE_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define MIN_TEE_SLOTS 2
+/* Time the reader may wait in total for a destination a full ring behind while
+   another one could take more data, until it catches up. It is dropped after it */
+#define TEE_STALL_TIMEOUT_MS 10000
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataTee_Copy
+ * Inputs       : ENGINE_JOB* pJob - copy to be performed. Its writer is ignored
+ *                DATA_WRITER* pWriters[] - writer of every destination. A NULL
+ *                                          entry is skipped
+ *                unsigned int pCount - number of entries in pWriters
+ *                unsigned long long pMemory - total memory of the ring in bytes
+ *                TEE_STATS* pStats - Loaded with the result, bytes and wait time
+ *                                    of every writer run and the reader stalls
+ * Outputs      : returns -
+ *                ERROR_NOERROR - end of input reached by at least one destination
+ *                ERROR_MEMORY_ALLOCATION - ring cannot be allocated
+ *                ERROR_IO_FAILED - no writer thread can be started
+ *                Otherwise the result of the first destination
+ * Description  : Reads the input once on the calling thread into a ring of
+ *                buffers shared by one writer thread per destination. A slot is
+ *                reused once every destination has written it. A destination
+ *                that fails stops alone. One that keeps the reader waiting for
+ *                TEE_STALL_TIMEOUT_MS in total while another is ready for more
+ *                data, without catching up in between, is dropped with
+ *                ERROR_DESTINATION_STALLED, even if it still advances slowly.
+ *                The others continue at their own pace. A dropped writer is
+ *                joined after its pending write returns, at the end of the copy,
+ *                so a destination hung inside a write holds the return of the
+ *                copy until the write returns. It is not detached, as the caller
+ *                closes its writer next, which would wait for the same device
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataTee_Copy(ENGINE_JOB* pJob, DATA_WRITER* pWriters[], unsigned int pCount,
+                               unsigned long long pMemory, TEE_STATS* pStats);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_TEE_H */
@@ -0,0 +1,29 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include "DataEngine.h"
+
+#ifndef DATA_URING_H
+#define DATA_URING_H
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataUring_Copy
+ * Inputs       : ENGINE_JOB* pJob - copy to be performed
+ *                unsigned int pQueueDepth - number of read/write pairs in flight
+ * Outputs      : returns -
+ *                ERROR_NOERROR - end of input reached
+ *                ERROR_FILE_SIZELIMIT_REACHED - Output file size limit reached
+ *                ERROR_MEMORY_ALLOCATION - buffers cannot be allocated
+ *                ERROR_WRITE_FILEOPEN - next output segment cannot be opened
+ *                ERROR_IO_FAILED - read or write failed during the copy
+ * Description  : Copies a regular file input with io_uring. pQueueDepth registered
+ *                buffers are kept busy, each with a read linked to the write of
+ *                the same buffer so the kernel starts the write as soon as the
+ *                read completes. Inputs that are not regular files, platforms
+ *                without io_uring and kernels that refuse the ring fall back to
+ *                DataEngine_StdioCopy
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataUring_Copy(ENGINE_JOB* pJob, unsigned int pQueueDepth);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_URING_H */
@@ -0,0 +1,273 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdio.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <pthread.h>
+#include "DataReader.h"
+#include "DataChecksum.h"
+
+#ifndef DATA_WRITER_H
+#define DATA_WRITER_H
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define SEGMENT_NUMBER_FORMAT "_%04u"
+#define DIRECT_STAGING_SIZE (1024 * 1024)
+#define WRITER_CREATE_ATTEMPTS 8
+/* Space reserved ahead of the writes at a time, so that an unknown input does not
+   claim a whole segment at once */
+#define PREALLOCATE_STEP (256ULL * 1024ULL * 1024ULL)
+/* Input size passed to DataWriter_Preallocate when it cannot be known */
+#define WRITER_SIZE_UNKNOWN ULLONG_MAX
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Defines the full path of an output segment. Returns false on failure */
+typedef bool (*WRITER_NAME_FN)(void* pNameContext, char* pWriteFile, unsigned int pSize, unsigned int pSegment);
+
+struct DATA_WRITER;
+/* Told about the data written so far. Called on the writing thread */
+typedef void (*WRITER_PROGRESS_FN)(void* pContext, const struct DATA_WRITER* pWriter);
+
+/* Output of a single capture. Owns the current segment and the size accounting */
+typedef struct DATA_WRITER
+{
+    FILE* output;                           /* Current output segment */
+    char fileName[MAX_FILEPATH_LENGTH];     /* Path of the current segment */
+    WRITER_NAME_FN defineFile;              /* Names the next segment on rotation */
+    void* nameContext;                      /* Passed to defineFile */
+    unsigned long long maxSize;             /* Maximum number of bytes per segment */
+    unsigned long long flushInterval;       /* Bytes written between two flushes */
+    bool rotate;                            /* Open a new segment when one is full */
+    unsigned int segment;                   /* Sequence number of the current segment */
+    unsigned long long segmentSize;         /* Bytes written to the current segment */
+    unsigned long long written;             /* Bytes written to all segments */
+    unsigned long long unflushed;           /* Bytes written since the last flush */
+    bool direct;                            /* Bypass the page cache with aligned writes */
+    char* staging;                          /* Aligned buffer collecting direct writes */
+    unsigned int staged;                    /* Bytes waiting in the staging buffer */
+    bool checksum;                          /* Record CRC32C sidecars of the segments */
+    CHECKSUM_STATE crc;                     /* Checksums of the current segment */
+    FILE* closing;                          /* Previous segment being closed */
+    pthread_t closer;                       /* Thread closing the previous segment */
+    CAPTURE_STATS* stats;                   /* Writes of the capture. May be NULL */
+    bool preallocate;                       /* Reserve the space of the segments ahead */
+    unsigned long long expected;            /* Input bytes of the capture. WRITER_SIZE_UNKNOWN if unknown */
+    unsigned long long reserved;            /* Bytes reserved in the current segment */
+    DURABILITY_TYPE durability;             /* When the segments are synced to the device */
+    unsigned long long syncInterval;        /* Bytes or nanoseconds between two syncs */
+    unsigned long long unsynced;            /* Bytes written since the last sync */
+    unsigned long long lastSync;            /* Time of the last sync in nanoseconds */
+    unsigned long long closingBytes;        /* Unsynced bytes of the segment being closed */
+    unsigned long long closingStart;        /* Start of the sync of the segment being closed */
+    unsigned long long closingEnd;          /* End of the sync of the segment being closed */
+    bool closingFailed;                     /* The sync or close of the segment being closed failed */
+    bool syncFailed;                        /* A sync failed. Reported by the next write or close */
+    WRITER_PROGRESS_FN progress;            /* Told about the progress. May be NULL */
+    void* progressContext;                  /* Passed to progress */
+    unsigned long long progressInterval;    /* Bytes written between two progress calls */
+    unsigned long long lastProgress;        /* Bytes written at the last progress call */
+} DATA_WRITER;
+
+/*----------------------------------------------------------------------------------*/
+/* External function declarations */
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_Open
+ * Inputs       : DATA_WRITER* pWriter - writer to be initialized
+ *                const char* pWriteFile - path of the first segment
+ *                WRITER_NAME_FN pDefineFile - names the following segments
+ *                void* pNameContext - passed to pDefineFile
+ *                unsigned long long pMaxSize - maximum segment size in bytes
+ *                unsigned long long pFlushInterval - bytes between flushes. 0 - on close
+ *                bool pRotate - rotate to a new segment instead of stopping
+ *                bool pDirect - write with O_DIRECT, bypassing the page cache
+ *                bool pChecksum - write a CRC32C sidecar for every segment
+ * Outputs      : returns -
+ *                ERROR_NOERROR - first segment opened
+ *                ERROR_MEMORY_ALLOCATION - direct staging buffer cannot be allocated
+ *                ERROR_WRITE_FILEOPEN - first segment cannot be opened
+ * Description  : Initializes the writer and opens the first output segment. Files
+ *                are created exclusively. If the name exists, pDefineFile is asked
+ *                for a new one up to WRITER_CREATE_ATTEMPTS times. In direct mode
+ *                writes are collected in an aligned staging buffer and written in
+ *                whole blocks. The unaligned tail of a segment is
+ *                written without O_DIRECT when the segment is closed. Where
+ *                O_DIRECT is not available the segments are written normally.
+ *                Checksums cover the data passed to DataWriter_Write only
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataWriter_Open(DATA_WRITER* pWriter, const char* pWriteFile, WRITER_NAME_FN pDefineFile,
+                                  void* pNameContext, unsigned long long pMaxSize, unsigned long long pFlushInterval, bool pRotate,
+                                  bool pDirect, bool pChecksum);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_Resume
+ * Inputs       : DATA_WRITER* pWriter - writer to be initialized
+ *                const char* pWriteFile - path of an existing segment
+ *                unsigned int pSegment - sequence number of the segment
+ *                unsigned long long pSegmentSize - bytes of the segment to keep
+ *                Others - same as DataWriter_Open
+ * Outputs      : returns -
+ *                ERROR_NOERROR - segment opened
+ *                ERROR_MEMORY_ALLOCATION - direct staging buffer cannot be allocated
+ *                ERROR_WRITE_FILEOPEN - segment cannot be opened or cut
+ * Description  : Continues an earlier capture. The segment is cut to pSegmentSize
+ *                and written from there, and the following segments are named by
+ *                pDefineFile as usual. Checksums are not supported, as they would
+ *                only cover the data written from here
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataWriter_Resume(DATA_WRITER* pWriter, const char* pWriteFile, unsigned int pSegment,
+                                    unsigned long long pSegmentSize, WRITER_NAME_FN pDefineFile, void* pNameContext,
+                                    unsigned long long pMaxSize, unsigned long long pFlushInterval, bool pRotate,
+                                    bool pDirect);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_SetProgress
+ * Inputs       : DATA_WRITER* pWriter - opened writer
+ *                WRITER_PROGRESS_FN pProgress - called with the progress
+ *                void* pContext - passed to pProgress
+ *                unsigned long long pInterval - bytes written between two calls
+ * Outputs      :
+ * Description  : pProgress is called after every pInterval bytes written and
+ *                whenever a new segment is opened. The data may still be buffered
+ -----------------------------------------------------------------------------------*/
+extern void DataWriter_SetProgress(DATA_WRITER* pWriter, WRITER_PROGRESS_FN pProgress, void* pContext,
+                                   unsigned long long pInterval);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_Preallocate
+ * Inputs       : DATA_WRITER* pWriter - opened writer
+ *                unsigned long long pExpected - input bytes of the capture.
+ *                                               WRITER_SIZE_UNKNOWN if unknown
+ * Outputs      :
+ * Description  : Reserves the space of the current and all following segments
+ *                with fallocate, up to the segment size or the input left to be
+ *                written, in steps of PREALLOCATE_STEP ahead of the writes. The
+ *                file size is kept, so a segment never shows unwritten data, and
+ *                the unused reservation is released when the segment is closed.
+ *                A file system refusing the reservation stops preallocation
+ *                without failing the capture. Does nothing where fallocate is
+ *                not available
+ -----------------------------------------------------------------------------------*/
+extern void DataWriter_Preallocate(DATA_WRITER* pWriter, unsigned long long pExpected);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_Reserve
+ * Inputs       : DATA_WRITER* pWriter - opened writer
+ *                unsigned long long pSize - bytes about to be written
+ * Outputs      :
+ * Description  : Reserves the next pSize bytes of the current segment at once,
+ *                up to the segment size, for engines writing them out of order.
+ *                The file size is kept and the unused reservation is released
+ *                with the segment like with DataWriter_Preallocate. A refused
+ *                reservation is ignored
+ -----------------------------------------------------------------------------------*/
+extern void DataWriter_Reserve(DATA_WRITER* pWriter, unsigned long long pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_SetDurability
+ * Inputs       : DATA_WRITER* pWriter - opened writer
+ *                DURABILITY_TYPE pDurability - sync policy
+ *                unsigned long long pInterval - bytes between two syncs for
+ *                                               DURABILITY_BYTES, nanoseconds for
+ *                                               DURABILITY_TIME
+ * Outputs      :
+ * Description  : Sets when the data is synced to the device. Interval syncs use
+ *                fdatasync from the writing thread. In direct mode they cover the
+ *                whole blocks written so far. Every policy but DURABILITY_NONE
+ *                also fsyncs each segment before it is closed. Rotated segments
+ *                are synced by the thread closing them. With DURABILITY_GROUP the
+ *                captures closing segments at the same time start the writeback
+ *                of all their files together, then fsync at the same time so one
+ *                journal commit covers them. A failed sync fails the next write
+ *                or the close
+ -----------------------------------------------------------------------------------*/
+extern void DataWriter_SetDurability(DATA_WRITER* pWriter, DURABILITY_TYPE pDurability, unsigned long long pInterval);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_Write
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ *                const char* pData - data to be written
+ *                unsigned int pSize - size of the data in bytes
+ * Outputs      : returns -
+ *                ERROR_NOERROR - all data written
+ *                ERROR_FILE_SIZELIMIT_REACHED - segment full and rotation disabled.
+ *                                               Data is written up to the limit
+ *                ERROR_WRITE_FILEOPEN - next segment cannot be opened
+ *                ERROR_IO_FAILED - write to the output or a sync failed
+ * Description  : Writes the data to the output, rotating to the next segment
+ *                whenever the current one is full
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataWriter_Write(DATA_WRITER* pWriter, const char* pData, unsigned int pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_Flush
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ * Outputs      : returns -
+ *                ERROR_NOERROR - buffered data handed to the operating system
+ *                ERROR_IO_FAILED - write failed
+ * Description  : Done after every flush interval, or by the caller when the data
+ *                must be visible in the file at once. In direct mode only whole
+ *                blocks are written and the partial block stays staged
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataWriter_Flush(DATA_WRITER* pWriter);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_Space
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ * Outputs      : returns -
+ *                Number of bytes that still fit in the current segment
+ * Description  : Used by engines that write to the descriptor directly
+ -----------------------------------------------------------------------------------*/
+extern unsigned long long DataWriter_Space(DATA_WRITER* pWriter);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_Descriptor
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ * Outputs      : returns -
+ *                File descriptor of the current segment
+ * Description  : Flushes the stdio buffer of the current segment and returns its
+ *                descriptor for direct writes. Writes made through the descriptor
+ *                must be reported with DataWriter_Commit. In direct mode the
+ *                staged data is written and the writer leaves direct mode for
+ *                the rest of the capture, as the writes may be unaligned
+ -----------------------------------------------------------------------------------*/
+extern int DataWriter_Descriptor(DATA_WRITER* pWriter);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_BlockDescriptor
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ * Outputs      : returns -
+ *                File descriptor of the current segment
+ * Description  : Like DataWriter_Descriptor, for callers writing whole blocks at
+ *                block aligned offsets. The staged data is written, and only a
+ *                staged partial block makes the segment leave direct mode. The
+ *                descriptor keeps O_DIRECT otherwise
+ -----------------------------------------------------------------------------------*/
+extern int DataWriter_BlockDescriptor(DATA_WRITER* pWriter);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_Commit
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ *                unsigned int pSize - bytes written through the descriptor
+ * Outputs      :
+ * Description  : Accounts data written directly to the descriptor and syncs it
+ *                when the sync interval is reached
+ -----------------------------------------------------------------------------------*/
+extern void DataWriter_Commit(DATA_WRITER* pWriter, unsigned int pSize);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_Rotate
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ * Outputs      : returns -
+ *                ERROR_NOERROR - next segment opened
+ *                ERROR_WRITE_FILEOPEN - next segment cannot be opened
+ *                ERROR_IO_FAILED - staged data of the current segment cannot be written
+ *                ERROR_MEMORY_ALLOCATION - a block checksum of the segment was lost
+ * Description  : Opens the next segment and hands the current one to a background
+ *                thread for closing, so that reading is not stalled by the close.
+ *                The checksum sidecar of the current segment is written first
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataWriter_Rotate(DATA_WRITER* pWriter);
+/*-----------------------------------------------------------------------------------
+ * Name         : DataWriter_Close
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ * Outputs      : returns -
+ *                ERROR_NOERROR - segment closed
+ *                ERROR_IO_FAILED - staged data or checksum sidecar cannot be written,
+ *                                  or a sync failed
+ *                ERROR_MEMORY_ALLOCATION - a block checksum of the segment was lost
+ * Description  : Closes the current segment and waits for pending closes. An empty
+ *                trailing segment created by rotation is removed
+ -----------------------------------------------------------------------------------*/
+extern ERROR_TYPE DataWriter_Close(DATA_WRITER* pWriter);
+/*----------------------------------------------------------------------------------*/
+#endif /* DATA_WRITER_H */
@@ -0,0 +1,313 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "DataBatch.h"
+#include "DataEngine.h"
+#include "DataChecksum.h"
+#include "DataDedup.h"
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define BATCH_INITIAL_CAPACITY 16
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Work done for one input of a batch */
+typedef ERROR_TYPE (*BATCH_ITEM_FN)(BATCH_ITEM* pItem);
+
+/* State shared by the workers of a batch */
+typedef struct
+{
+    BATCH_LIST* list;
+    BATCH_ITEM_FN process;      /* Applied to every input */
+    atomic_uint next;           /* Next input to be captured */
+    atomic_uint failed;         /* Inputs whose capture failed */
+} BATCH_POOL;
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static unsigned int runPool(BATCH_LIST* pList, unsigned int pWorkers, BATCH_ITEM_FN pProcess);
+static void* workerThread(void* pPool);
+static ERROR_TYPE captureItem(BATCH_ITEM* pItem);
+static ERROR_TYPE verifyItem(BATCH_ITEM* pItem);
+static ERROR_TYPE restoreItem(BATCH_ITEM* pItem);
+static unsigned long long getMicroseconds(void);
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataBatch_Add(BATCH_LIST* pList, const char* pInput)
+{
+    BATCH_ITEM* item;
+    if(strlen(pInput) >= MAX_FILEPATH_LENGTH)
+    {
+        return(ERROR_PATHTOOLONG);
+    }
+    if(pList->count == pList->capacity)
+    {
+        unsigned int capacity = pList->capacity ? pList->capacity * 2 : BATCH_INITIAL_CAPACITY;
+        BATCH_ITEM* items = realloc(pList->items, capacity * sizeof(BATCH_ITEM));
+        if(items == NULL)
+        {
+            return(ERROR_MEMORY_ALLOCATION);
+        }
+        pList->items = items;
+        pList->capacity = capacity;
+    }
+    item = &pList->items[pList->count++];
+    memset(item, 0, sizeof(BATCH_ITEM));
+    strcpy(item->input, pInput);
+    item->result = ERROR_UNKNOWN;
+    return(ERROR_NOERROR);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataBatch_LoadManifest(BATCH_LIST* pList, const char* pManifest)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    char line[MAX_FILEPATH_LENGTH + 2];
+    FILE* manifest = fopen(pManifest, "r");
+    if(manifest == NULL)
+    {
+        return(ERROR_READ_FILEOPEN);
+    }
+    while((ret == ERROR_NOERROR) && (fgets(line, sizeof(line), manifest) != NULL))
+    {
+        size_t length = strlen(line);
+        if(length && (line[length - 1] != '\n') && !feof(manifest))
+        {
+            /* Line did not fit the buffer */
+            ret = ERROR_PATHTOOLONG;
+            break;
+        }
+        /* Strip the line ending, including Windows line endings */
+        while(length && ((line[length - 1] == '\n') || (line[length - 1] == '\r')))
+        {
+            line[--length] = NULL_CHARACTER;
+        }
+        if(length && (line[0] != BATCH_MANIFEST_COMMENT))
+        {
+            ret = DataBatch_Add(pList, line);
+        }
+    }
+    fclose(manifest);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+unsigned int DataBatch_DefaultWorkers(const BATCH_LIST* pList)
+{
+    unsigned int workers = DataEngine_GetCoreCount();
+    unsigned int limit = (workers + BATCH_WORKERS_PER_DEVICE - 1) / BATCH_WORKERS_PER_DEVICE;
+    unsigned int devices = 0;
+    unsigned int i;
+    dev_t* seen = calloc(limit, sizeof(dev_t));
+    /* Count the distinct devices holding the inputs. Once the devices can keep all
+       cores busy the cores are the limit */
+    for(i = 0; (seen != NULL) && (i < pList->count) && (devices < limit); i++)
+    {
+        struct stat input;
+        unsigned int j;
+        if(stat(pList->items[i].input, &input) != 0)
+        {
+            continue;
+        }
+        for(j = 0; (j < devices) && (seen[j] != input.st_dev); j++)
+        {
+        }
+        if(j == devices)
+        {
+            seen[devices++] = input.st_dev;
+        }
+    }
+    free(seen);
+    if(devices && (devices < limit))
+    {
+        workers = devices * BATCH_WORKERS_PER_DEVICE;
+    }
+    if(workers > pList->count)
+    {
+        workers = pList->count;
+    }
+    return(workers ? workers : 1);
+}
+/*----------------------------------------------------------------------------------*/
+unsigned int DataBatch_Run(BATCH_LIST* pList, unsigned int pWorkers)
+{
+    return runPool(pList, pWorkers, captureItem);
+}
+/*----------------------------------------------------------------------------------*/
+unsigned int DataBatch_Verify(BATCH_LIST* pList, unsigned int pWorkers)
+{
+    return runPool(pList, pWorkers, verifyItem);
+}
+/*----------------------------------------------------------------------------------*/
+unsigned int DataBatch_Restore(BATCH_LIST* pList, unsigned int pWorkers)
+{
+    return runPool(pList, pWorkers, restoreItem);
+}
+/*----------------------------------------------------------------------------------*/
+void DataBatch_Report(const BATCH_LIST* pList, FILE* pStream)
+{
+    unsigned long long size = 0;
+    unsigned int failed = 0;
+    unsigned int i;
+    fprintf(pStream, "------------------Batch Report-----------------------\n");
+    for(i = 0; i < pList->count; i++)
+    {
+        const BATCH_ITEM* item = &pList->items[i];
+        double seconds = item->elapsed / 1000000.0;
+        fprintf(pStream, "%s -> %s : %s (%llu bytes, %.1f MB/s)\n", item->input,
+                strlen(item->output) ? item->output : "-", DataReader_ConvertErrorToString(item->result),
+                item->size, seconds > 0 ? (item->size / (1024.0 * 1024.0)) / seconds : 0.0);
+        size = size + item->size;
+        if(item->result != ERROR_NOERROR)
+        {
+            failed++;
+        }
+    }
+    fprintf(pStream, "-----------------------------------------------------\n");
+    fprintf(pStream, "Inputs: %u, Failed: %u, Total: %llu bytes\n", pList->count, failed, size);
+    fprintf(pStream, "-----------------------------------------------------\n");
+}
+/*----------------------------------------------------------------------------------*/
+void DataBatch_Free(BATCH_LIST* pList)
+{
+    free(pList->items);
+    memset(pList, 0, sizeof(BATCH_LIST));
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : runPool
+ * Inputs       : BATCH_LIST* pList - inputs of the batch. Loaded with the results
+ *                unsigned int pWorkers - number of inputs processed at the same time
+ *                BATCH_ITEM_FN pProcess - work done for every input
+ * Outputs      : Number of inputs whose processing failed
+ * Description  : Runs the worker pool. The calling thread is the last worker
+ -----------------------------------------------------------------------------------*/
+static unsigned int runPool(BATCH_LIST* pList, unsigned int pWorkers, BATCH_ITEM_FN pProcess)
+{
+    BATCH_POOL pool;
+    pthread_t* threads;
+    unsigned int started = 0;
+    unsigned int i;
+    pool.list = pList;
+    pool.process = pProcess;
+    atomic_init(&pool.next, 0);
+    atomic_init(&pool.failed, 0);
+    if(pWorkers > pList->count)
+    {
+        pWorkers = pList->count;
+    }
+    /* The calling thread is the last worker */
+    threads = pWorkers > 1 ? calloc(pWorkers - 1, sizeof(pthread_t)) : NULL;
+    for(i = 0; (threads != NULL) && (i < (pWorkers - 1)); i++)
+    {
+        if(pthread_create(&threads[i], NULL, workerThread, &pool))
+        {
+            break;
+        }
+        started++;
+    }
+    (void)workerThread(&pool);
+    for(i = 0; i < started; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    return(atomic_load(&pool.failed));
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : workerThread
+ * Inputs       : void* pPool - BATCH_POOL shared by the workers
+ * Outputs      : NULL
+ * Description  : Takes the next unprocessed input until all inputs are done
+ -----------------------------------------------------------------------------------*/
+static void* workerThread(void* pPool)
+{
+    BATCH_POOL* pool = (BATCH_POOL*)pPool;
+    unsigned int index;
+    while((index = atomic_fetch_add(&pool->next, 1)) < pool->list->count)
+    {
+        BATCH_ITEM* item = &pool->list->items[index];
+        struct stat input;
+        unsigned long long start = getMicroseconds();
+        if(stat(item->input, &input) == 0)
+        {
+            item->size = (unsigned long long)input.st_size;
+        }
+        item->result = pool->process(item);
+        item->elapsed = getMicroseconds() - start;
+        if(item->result != ERROR_NOERROR)
+        {
+            atomic_fetch_add(&pool->failed, 1);
+        }
+    }
+    return NULL;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : captureItem
+ * Inputs       : BATCH_ITEM* pItem - input to be captured. Loaded with the output
+ * Outputs      : Result of DataReader_ReadData()
+ * Description  : Captures the input with the default configuration
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE captureItem(BATCH_ITEM* pItem)
+{
+    return DataReader_ReadData(pItem->input, pItem->output, sizeof(pItem->output) - 1);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : verifyItem
+ * Inputs       : BATCH_ITEM* pItem - file to be verified
+ * Outputs      : Result of DataChecksum_Verify()
+ * Description  : Checks the file against its checksum sidecar. The first block
+ *                that does not match is reported in place of the output
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE verifyItem(BATCH_ITEM* pItem)
+{
+    unsigned long long badBlock = 0;
+    ERROR_TYPE ret = DataChecksum_Verify(pItem->input, &badBlock);
+    if(ret == ERROR_CHECKSUM_MISMATCH)
+    {
+        sprintf(pItem->output, "block %llu", badBlock);
+    }
+    return ret;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : restoreItem
+ * Inputs       : BATCH_ITEM* pItem - recipe to be restored. Loaded with the output
+ *                                    and the restored size
+ * Outputs      : Result of DataDedup_Restore()
+ * Description  : Rebuilds the capture next to its recipe, with the recipe
+ *                extension replaced by the output file extension
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE restoreItem(BATCH_ITEM* pItem)
+{
+    size_t length = strlen(pItem->input);
+    size_t extension = strlen(DEDUP_RECIPE_EXTENSION);
+    if((length > extension) && !strcmp(pItem->input + length - extension, DEDUP_RECIPE_EXTENSION))
+    {
+        length = length - extension;
+    }
+    if((length + strlen(DEFAULT_FILE_EXTENSTION)) >= sizeof(pItem->output))
+    {
+        return(ERROR_PATHTOOLONG);
+    }
+    memcpy(pItem->output, pItem->input, length);
+    strcpy(pItem->output + length, DEFAULT_FILE_EXTENSTION);
+    return DataDedup_Restore(pItem->input, pItem->output, &pItem->size);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : getMicroseconds
+ * Inputs       :
+ * Outputs      : Monotonic time in microseconds
+ * Description  : Used to measure the duration of a capture
+ -----------------------------------------------------------------------------------*/
+static unsigned long long getMicroseconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((unsigned long long)now.tv_sec * 1000000ULL + (unsigned long long)now.tv_nsec / 1000ULL);
+}
+/*----------------------------------------------------------------------------------*/
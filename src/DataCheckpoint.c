@@ -0,0 +1,276 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#ifdef __linux__
+/* Required for fileno and st_mtim. Must precede all system headers */
+#define _GNU_SOURCE
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "DataCheckpoint.h"
+#include "DataChecksum.h"
+#ifdef _WIN32
+#define seekStream _fseeki64
+#define tellStream _ftelli64
+#else
+#define seekStream fseeko
+#define tellStream ftello
+#endif
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define CHECKPOINT_TEMPORARY_EXTENSION ".tmp"
+#define CHECKPOINT_LINE_LENGTH (MAX_FILEPATH_LENGTH + 32)
+/* Every field of a checkpoint, as a mask of the fields found */
+#define CHECKPOINT_FIELDS 0x3FF
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static bool readValue(const char* pLine, const char* pKey, char* pValue, unsigned int pSize);
+static bool readNumber(const char* pLine, const char* pKey, unsigned long long* pValue);
+static bool overlapMatches(FILE* pInput, unsigned long long pInputOffset, FILE* pOutput,
+                           unsigned long long pOutputOffset, unsigned int pSize);
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+bool DataCheckpoint_Path(const char* pWritePath, const char* pPrefix, const char* pSource, char* pPath,
+                         unsigned int pSize)
+{
+    const char* name = pSource;
+    const char* separator;
+    for(separator = pSource; *separator != NULL_CHARACTER; separator++)
+    {
+        if((*separator == '/') || (*separator == '\\'))
+        {
+            name = separator + 1;
+        }
+    }
+    return(snprintf(pPath, pSize, "%s%s%s_%08x%s", pWritePath, pPrefix, name,
+                    DataChecksum_Crc32c(0, pSource, strlen(pSource)), CHECKPOINT_EXTENSION) < (int)pSize);
+}
+/*----------------------------------------------------------------------------------*/
+bool DataCheckpoint_Identify(FILE* pInput, const char* pSource, CHECKPOINT* pCheckpoint)
+{
+    struct stat inputStat;
+    if((strlen(pSource) >= sizeof(pCheckpoint->source)) || (fstat(fileno(pInput), &inputStat) != 0) ||
+       !S_ISREG(inputStat.st_mode))
+    {
+        return false;
+    }
+    memset(pCheckpoint, 0, sizeof(CHECKPOINT));
+    strcpy(pCheckpoint->source, pSource);
+    pCheckpoint->device = (unsigned long long)inputStat.st_dev;
+    pCheckpoint->inode = (unsigned long long)inputStat.st_ino;
+    pCheckpoint->size = (unsigned long long)inputStat.st_size;
+#ifdef __linux__
+    pCheckpoint->modified = (unsigned long long)inputStat.st_mtim.tv_sec * 1000000000ULL +
+                            (unsigned long long)inputStat.st_mtim.tv_nsec;
+#else
+    pCheckpoint->modified = (unsigned long long)inputStat.st_mtime * 1000000000ULL;
+#endif
+    return true;
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataCheckpoint_Save(const char* pPath, const CHECKPOINT* pCheckpoint)
+{
+    char temporary[MAX_FILEPATH_LENGTH + sizeof(CHECKPOINT_TEMPORARY_EXTENSION)];
+    FILE* file;
+    int written;
+    if(snprintf(temporary, sizeof(temporary), "%s%s", pPath, CHECKPOINT_TEMPORARY_EXTENSION) >= (int)sizeof(temporary))
+    {
+        return(ERROR_PATHTOOLONG);
+    }
+    file = fopen(temporary, "w");
+    if(file == NULL)
+    {
+        return(ERROR_IO_FAILED);
+    }
+    written = fprintf(file, "%s\nsource %s\ndevice %llu\ninode %llu\nsize %llu\nmodified %llu\noffset %llu\n"
+                      "stamp %s\nsegment %u\nsegment_start %llu\noutput %s\n", CHECKPOINT_TITLE, pCheckpoint->source,
+                      pCheckpoint->device, pCheckpoint->inode, pCheckpoint->size, pCheckpoint->modified,
+                      pCheckpoint->offset, pCheckpoint->stamp, pCheckpoint->segment, pCheckpoint->segmentStart,
+                      pCheckpoint->output);
+    if((fclose(file) != 0) || (written < 0))
+    {
+        remove(temporary);
+        return(ERROR_IO_FAILED);
+    }
+#ifdef _WIN32
+    /* rename does not replace an existing file here */
+    remove(pPath);
+#endif
+    if(rename(temporary, pPath) != 0)
+    {
+        remove(temporary);
+        return(ERROR_IO_FAILED);
+    }
+    return(ERROR_NOERROR);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataCheckpoint_Load(const char* pPath, CHECKPOINT* pCheckpoint)
+{
+    char line[CHECKPOINT_LINE_LENGTH];
+    unsigned long long segment = 0;
+    unsigned int found = 0;
+    FILE* file = fopen(pPath, "r");
+    if(file == NULL)
+    {
+        return(ERROR_READ_FILEOPEN);
+    }
+    memset(pCheckpoint, 0, sizeof(CHECKPOINT));
+    if((fgets(line, sizeof(line), file) == NULL) || strncmp(line, CHECKPOINT_TITLE, strlen(CHECKPOINT_TITLE)))
+    {
+        fclose(file);
+        return(ERROR_IO_FAILED);
+    }
+    while(fgets(line, sizeof(line), file) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = NULL_CHARACTER;
+        found |= readValue(line, "source", pCheckpoint->source, sizeof(pCheckpoint->source)) ? 0x001 : 0;
+        found |= readNumber(line, "device", &pCheckpoint->device) ? 0x002 : 0;
+        found |= readNumber(line, "inode", &pCheckpoint->inode) ? 0x004 : 0;
+        found |= readNumber(line, "size", &pCheckpoint->size) ? 0x008 : 0;
+        found |= readNumber(line, "modified", &pCheckpoint->modified) ? 0x010 : 0;
+        found |= readNumber(line, "offset", &pCheckpoint->offset) ? 0x020 : 0;
+        found |= readValue(line, "stamp", pCheckpoint->stamp, sizeof(pCheckpoint->stamp)) ? 0x040 : 0;
+        found |= readNumber(line, "segment", &segment) ? 0x080 : 0;
+        found |= readNumber(line, "segment_start", &pCheckpoint->segmentStart) ? 0x100 : 0;
+        found |= readValue(line, "output", pCheckpoint->output, sizeof(pCheckpoint->output)) ? 0x200 : 0;
+    }
+    fclose(file);
+    pCheckpoint->segment = (unsigned int)segment;
+    if((found != CHECKPOINT_FIELDS) || (pCheckpoint->segmentStart > pCheckpoint->offset))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    return(ERROR_NOERROR);
+}
+/*----------------------------------------------------------------------------------*/
+bool DataCheckpoint_Resume(const CHECKPOINT* pSaved, const CHECKPOINT* pCurrent, FILE* pInput,
+                           WRITER_NAME_FN pDefineFile, void* pNameContext, unsigned long long* pSegmentSize)
+{
+    char nextFile[MAX_FILEPATH_LENGTH] = { NULL_CHARACTER };
+    struct stat nextStat;
+    unsigned long long keep;
+    unsigned int overlap;
+    FILE* output;
+    bool matches;
+    /* Same file, only grown since the checkpoint */
+    if(strcmp(pSaved->source, pCurrent->source) || (pSaved->device != pCurrent->device) ||
+       (pSaved->inode != pCurrent->inode) || (pCurrent->size < pSaved->offset) ||
+       ((pCurrent->size == pSaved->size) && (pCurrent->modified != pSaved->modified)))
+    {
+        return false;
+    }
+    output = fopen(pSaved->output, "rb");
+    if(output == NULL)
+    {
+        return false;
+    }
+    /* Data past the checkpoint may have been written out of order. Data before
+       it may have been lost with the page cache */
+    keep = pSaved->offset - pSaved->segmentStart;
+    if((seekStream(output, 0, SEEK_END) != 0) || (tellStream(output) < 0))
+    {
+        fclose(output);
+        return false;
+    }
+    if((unsigned long long)tellStream(output) < keep)
+    {
+        keep = (unsigned long long)tellStream(output);
+    }
+    overlap = (keep < CHECKPOINT_OVERLAP) ? (unsigned int)keep : CHECKPOINT_OVERLAP;
+    matches = overlapMatches(pInput, pSaved->segmentStart + keep - overlap, output, keep - overlap, overlap);
+    fclose(output);
+    if(!matches)
+    {
+        return false;
+    }
+    /* The next output file is opened before the checkpoint naming it is saved */
+    if(pDefineFile(pNameContext, nextFile, sizeof(nextFile), pSaved->segment + 1) &&
+       strcmp(nextFile, pSaved->output) && (stat(nextFile, &nextStat) == 0))
+    {
+        if(nextStat.st_size || (remove(nextFile) != 0))
+        {
+            return false;
+        }
+    }
+    if(seekStream(pInput, (long long)(pSaved->segmentStart + keep), SEEK_SET) != 0)
+    {
+        return false;
+    }
+    *pSegmentSize = keep;
+    return true;
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : readValue
+ * Inputs       : const char* pLine - checkpoint line without its line end
+ *                const char* pKey - field name
+ *                char* pValue - Loaded with the rest of the line
+ *                unsigned int pSize - size of the pValue buffer
+ * Outputs      : True if the line holds the field. False otherwise
+ * Description  : Values are taken whole, so paths may hold spaces
+ -----------------------------------------------------------------------------------*/
+static bool readValue(const char* pLine, const char* pKey, char* pValue, unsigned int pSize)
+{
+    size_t length = strlen(pKey);
+    if(strncmp(pLine, pKey, length) || (pLine[length] != ' ') || (strlen(pLine + length + 1) >= pSize))
+    {
+        return false;
+    }
+    strcpy(pValue, pLine + length + 1);
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : readNumber
+ * Inputs       : const char* pLine - checkpoint line without its line end
+ *                const char* pKey - field name
+ *                unsigned long long* pValue - Loaded with the value
+ * Outputs      : True if the line holds the field with a number. False otherwise
+ * Description  :
+ -----------------------------------------------------------------------------------*/
+static bool readNumber(const char* pLine, const char* pKey, unsigned long long* pValue)
+{
+    char number[32];
+    char* end;
+    if(!readValue(pLine, pKey, number, sizeof(number)) || (number[0] < '0') || (number[0] > '9'))
+    {
+        return false;
+    }
+    *pValue = strtoull(number, &end, 10);
+    return(*end == NULL_CHARACTER);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : overlapMatches
+ * Inputs       : FILE* pInput - input of the capture
+ *                unsigned long long pInputOffset - start of the range in the input
+ *                FILE* pOutput - output file of the capture
+ *                unsigned long long pOutputOffset - start of the range in the output
+ *                unsigned int pSize - bytes of the range
+ * Outputs      : True if both ranges hold the same data. False otherwise
+ * Description  :
+ -----------------------------------------------------------------------------------*/
+static bool overlapMatches(FILE* pInput, unsigned long long pInputOffset, FILE* pOutput,
+                           unsigned long long pOutputOffset, unsigned int pSize)
+{
+    char* inputData;
+    char* outputData;
+    bool matches;
+    if(!pSize)
+    {
+        return true;
+    }
+    inputData = malloc(pSize);
+    outputData = malloc(pSize);
+    matches = (inputData != NULL) && (outputData != NULL) &&
+              (seekStream(pInput, (long long)pInputOffset, SEEK_SET) == 0) &&
+              (fread(inputData, sizeof(char), pSize, pInput) == pSize) &&
+              (seekStream(pOutput, (long long)pOutputOffset, SEEK_SET) == 0) &&
+              (fread(outputData, sizeof(char), pSize, pOutput) == pSize) &&
+              !memcmp(inputData, outputData, pSize);
+    free(inputData);
+    free(outputData);
+    return matches;
+}
+/*----------------------------------------------------------------------------------*/
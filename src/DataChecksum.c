@@ -0,0 +1,326 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "DataChecksum.h"
+#include "DataEngine.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHECKSUM_SSE42
+#include <nmmintrin.h>
+#endif
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define CRC32C_POLYNOMIAL 0x82F63B78U   /* Castagnoli, reflected */
+#define CRC32C_SLICES 8
+#define CHECKSUM_LINE_LENGTH 64
+
+/*----------------------------------------------------------------------------------*/
+/* Static variables */
+static unsigned int fl_Table[CRC32C_SLICES][256];
+static bool fl_Hardware = false;
+static pthread_once_t fl_Initialized = PTHREAD_ONCE_INIT;
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static void initialize(void);
+static unsigned int crcSoftware(unsigned int pCrc, const unsigned char* pData, size_t pSize);
+#ifdef CHECKSUM_SSE42
+static unsigned int crcHardware(unsigned int pCrc, const unsigned char* pData, size_t pSize);
+#endif
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+unsigned int DataChecksum_Crc32c(unsigned int pCrc, const void* pData, size_t pSize)
+{
+    (void)pthread_once(&fl_Initialized, initialize);
+#ifdef CHECKSUM_SSE42
+    if(fl_Hardware)
+    {
+        return ~crcHardware(~pCrc, (const unsigned char*)pData, pSize);
+    }
+#endif
+    return ~crcSoftware(~pCrc, (const unsigned char*)pData, pSize);
+}
+/*----------------------------------------------------------------------------------*/
+void DataChecksum_Add(CHECKSUM_STATE* pState, const char* pData, unsigned int pSize)
+{
+    pState->fileCrc = DataChecksum_Crc32c(pState->fileCrc, pData, pSize);
+    pState->size = pState->size + pSize;
+    while(pSize)
+    {
+        unsigned int size = CHECKSUM_BLOCK_SIZE - pState->blockFill;
+        if(size > pSize)
+        {
+            size = pSize;
+        }
+        pState->blockCrc = DataChecksum_Crc32c(pState->blockCrc, pData, size);
+        pState->blockFill = pState->blockFill + size;
+        pData = pData + size;
+        pSize = pSize - size;
+        if(pState->blockFill == CHECKSUM_BLOCK_SIZE)
+        {
+            if(pState->count == pState->capacity)
+            {
+                unsigned int capacity = pState->capacity ? pState->capacity * 2 : 64;
+                unsigned int* blocks = realloc(pState->blocks, capacity * sizeof(unsigned int));
+                if(blocks == NULL)
+                {
+                    pState->failed = true;
+                    capacity = pState->capacity;
+                }
+                else
+                {
+                    pState->blocks = blocks;
+                }
+                pState->capacity = capacity;
+            }
+            if(pState->count < pState->capacity)
+            {
+                pState->blocks[pState->count++] = pState->blockCrc;
+            }
+            pState->blockCrc = 0;
+            pState->blockFill = 0;
+        }
+    }
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataChecksum_WriteSidecar(const CHECKSUM_STATE* pState, const char* pFile)
+{
+    char sidecarFile[MAX_FILEPATH_LENGTH + sizeof(CHECKSUM_SIDECAR_EXTENSION)];
+    FILE* sidecar;
+    unsigned int i;
+    bool written;
+    if(pState->failed)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    sprintf(sidecarFile, "%s%s", pFile, CHECKSUM_SIDECAR_EXTENSION);
+    sidecar = fopen(sidecarFile, "w");
+    if(sidecar == NULL)
+    {
+        return(ERROR_IO_FAILED);
+    }
+    fprintf(sidecar, "%s\nsize %llu\nblock_size %u\nfile %08x\n", CHECKSUM_SIDECAR_TITLE, pState->size,
+            CHECKSUM_BLOCK_SIZE, pState->fileCrc);
+    for(i = 0; i < pState->count; i++)
+    {
+        fprintf(sidecar, "block %u %08x\n", i, pState->blocks[i]);
+    }
+    if(pState->blockFill)
+    {
+        /* Partial last block */
+        fprintf(sidecar, "block %u %08x\n", i, pState->blockCrc);
+    }
+    written = !ferror(sidecar);
+    written = (fclose(sidecar) == 0) && written;
+    return(written ? ERROR_NOERROR : ERROR_IO_FAILED);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataChecksum_Verify(const char* pFile, unsigned long long* pBadBlock)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    char sidecarFile[MAX_FILEPATH_LENGTH + sizeof(CHECKSUM_SIDECAR_EXTENSION)];
+    char line[CHECKSUM_LINE_LENGTH];
+    unsigned long long size = 0;
+    unsigned long long blocks = 0;
+    unsigned long long total = 0;
+    unsigned int blockSize = 0;
+    unsigned int fileCrc = 0;
+    unsigned int crc = 0;
+    bool header = false;
+    char* buffer;
+    FILE* sidecar;
+    FILE* input;
+    if(strlen(pFile) >= MAX_FILEPATH_LENGTH)
+    {
+        return(ERROR_PATHTOOLONG);
+    }
+    sprintf(sidecarFile, "%s%s", pFile, CHECKSUM_SIDECAR_EXTENSION);
+    sidecar = fopen(sidecarFile, "r");
+    input = fopen(pFile, "rb");
+    buffer = DataEngine_AllocateBuffer(CHECKSUM_BLOCK_SIZE);
+    if((sidecar == NULL) || (input == NULL))
+    {
+        ret = ERROR_READ_FILEOPEN;
+    }
+    else if(buffer == NULL)
+    {
+        ret = ERROR_MEMORY_ALLOCATION;
+    }
+    /* The header precedes the block lines */
+    while((ret == ERROR_NOERROR) && !header && (fgets(line, sizeof(line), sidecar) != NULL))
+    {
+        (void)sscanf(line, "size %llu", &size);
+        (void)sscanf(line, "block_size %u", &blockSize);
+        header = (sscanf(line, "file %x", &fileCrc) == 1);
+    }
+    if((ret == ERROR_NOERROR) && (!header || (blockSize != CHECKSUM_BLOCK_SIZE)))
+    {
+        ret = ERROR_IO_FAILED;
+    }
+    while(ret == ERROR_NOERROR)
+    {
+        unsigned int expected;
+        unsigned long long block;
+        size_t read = fread(buffer, sizeof(char), CHECKSUM_BLOCK_SIZE, input);
+        if(!read)
+        {
+            break;
+        }
+        crc = DataChecksum_Crc32c(crc, buffer, read);
+        total = total + read;
+        if((fgets(line, sizeof(line), sidecar) == NULL) || (sscanf(line, "block %llu %x", &block, &expected) != 2) ||
+           (block != blocks) || (DataChecksum_Crc32c(0, buffer, read) != expected))
+        {
+            /* Also reached when the file is longer than recorded */
+            ret = ERROR_CHECKSUM_MISMATCH;
+            if(pBadBlock != NULL)
+            {
+                *pBadBlock = blocks;
+            }
+        }
+        blocks++;
+    }
+    if((ret == ERROR_NOERROR) && ferror(input))
+    {
+        ret = ERROR_IO_FAILED;
+    }
+    /* A shorter file fails on size */
+    if((ret == ERROR_NOERROR) && ((crc != fileCrc) || (total != size)))
+    {
+        ret = ERROR_CHECKSUM_MISMATCH;
+        if(pBadBlock != NULL)
+        {
+            *pBadBlock = blocks;
+        }
+    }
+    if(sidecar != NULL)
+    {
+        fclose(sidecar);
+    }
+    if(input != NULL)
+    {
+        fclose(input);
+    }
+    DataEngine_FreeBuffer(buffer);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+void DataChecksum_Free(CHECKSUM_STATE* pState)
+{
+    free(pState->blocks);
+    memset(pState, 0, sizeof(CHECKSUM_STATE));
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : initialize
+ * Inputs       :
+ * Outputs      :
+ * Description  : Builds the slicing tables and checks for the crc32 instruction.
+ *                Runs once, on the first checksum
+ -----------------------------------------------------------------------------------*/
+static void initialize(void)
+{
+    unsigned int i;
+    unsigned int slice;
+    for(i = 0; i < 256; i++)
+    {
+        unsigned int crc = i;
+        unsigned int bit;
+        for(bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+        }
+        fl_Table[0][i] = crc;
+    }
+    for(i = 0; i < 256; i++)
+    {
+        for(slice = 1; slice < CRC32C_SLICES; slice++)
+        {
+            fl_Table[slice][i] = (fl_Table[slice - 1][i] >> 8) ^ fl_Table[0][fl_Table[slice - 1][i] & 0xFF];
+        }
+    }
+#ifdef CHECKSUM_SSE42
+    __builtin_cpu_init();
+    fl_Hardware = __builtin_cpu_supports("sse4.2");
+#endif
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : crcSoftware
+ * Inputs       : unsigned int pCrc - CRC register
+ *                const unsigned char* pData - data to be added
+ *                size_t pSize - size of the data in bytes
+ * Outputs      : CRC register after the data
+ * Description  : Slicing-by-8. Processes 8 bytes per step with one table per byte
+ *                position
+ -----------------------------------------------------------------------------------*/
+static unsigned int crcSoftware(unsigned int pCrc, const unsigned char* pData, size_t pSize)
+{
+    while(pSize >= CRC32C_SLICES)
+    {
+        unsigned int low = pCrc ^ ((unsigned int)pData[0] | ((unsigned int)pData[1] << 8) |
+                                   ((unsigned int)pData[2] << 16) | ((unsigned int)pData[3] << 24));
+        pCrc = fl_Table[7][low & 0xFF] ^ fl_Table[6][(low >> 8) & 0xFF] ^ fl_Table[5][(low >> 16) & 0xFF] ^
+               fl_Table[4][low >> 24] ^ fl_Table[3][pData[4]] ^ fl_Table[2][pData[5]] ^ fl_Table[1][pData[6]] ^
+               fl_Table[0][pData[7]];
+        pData = pData + CRC32C_SLICES;
+        pSize = pSize - CRC32C_SLICES;
+    }
+    while(pSize--)
+    {
+        pCrc = (pCrc >> 8) ^ fl_Table[0][(pCrc ^ *pData++) & 0xFF];
+    }
+    return pCrc;
+}
+#ifdef CHECKSUM_SSE42
+/*-----------------------------------------------------------------------------------
+ * Name         : crcHardware
+ * Inputs       : unsigned int pCrc - CRC register
+ *                const unsigned char* pData - data to be added
+ *                size_t pSize - size of the data in bytes
+ * Outputs      : CRC register after the data
+ * Description  : SSE4.2 crc32 instruction, 8 bytes at a time on 64 bit builds.
+ *                Compiled for SSE4.2 regardless of the build flags and only called
+ *                when the processor supports it
+ -----------------------------------------------------------------------------------*/
+__attribute__((target("sse4.2")))
+static unsigned int crcHardware(unsigned int pCrc, const unsigned char* pData, size_t pSize)
+{
+    while(pSize && ((uintptr_t)pData & 7))
+    {
+        pCrc = _mm_crc32_u8(pCrc, *pData++);
+        pSize--;
+    }
+#ifdef __x86_64__
+    {
+        unsigned long long crc = pCrc;
+        while(pSize >= 8)
+        {
+            unsigned long long value;
+            memcpy(&value, pData, sizeof(value));
+            crc = _mm_crc32_u64(crc, value);
+            pData = pData + 8;
+            pSize = pSize - 8;
+        }
+        pCrc = (unsigned int)crc;
+    }
+#endif
+    while(pSize >= 4)
+    {
+        unsigned int value;
+        memcpy(&value, pData, sizeof(value));
+        pCrc = _mm_crc32_u32(pCrc, value);
+        pData = pData + 4;
+        pSize = pSize - 4;
+    }
+    while(pSize--)
+    {
+        pCrc = _mm_crc32_u8(pCrc, *pData++);
+    }
+    return pCrc;
+}
+#endif
+/*----------------------------------------------------------------------------------*/
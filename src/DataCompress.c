@@ -0,0 +1,845 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "DataCompress.h"
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define LZ_MIN_MATCH 4
+#define LZ_LAST_LITERALS 5          /* Last bytes of a block are always literals */
+#define LZ_MATCH_SEARCH_END 12      /* No match is searched in the last bytes of a block */
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_BITS 14
+#define LZ_MIN_HASH_BITS 10
+#define LZ_SKIP_SHIFT 6             /* Search speeds up after 64 bytes without match */
+#define LZ_LENGTH_NIBBLE 15
+#define LZ_LENGTH_BYTE 255
+#define COMPRESS_MIN_SAVING_PERCENT 10
+#ifdef _WIN32
+#define seekStream _fseeki64
+#else
+#define seekStream fseeko
+#endif
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* One block of the ring */
+typedef struct
+{
+    char* raw;                  /* Block as read from the input */
+    char* stored;               /* Compressed block */
+    unsigned int rawSize;
+    unsigned int storedSize;
+    unsigned int method;        /* COMPRESS_METHOD_RAW or COMPRESS_METHOD_LZ */
+    bool done;                  /* Block compressed. Guarded by the lock */
+} COMPRESS_SLOT;
+
+/* State shared by the calling thread and the workers */
+typedef struct
+{
+    COMPRESS_SLOT* slots;
+    unsigned int slotCount;
+    unsigned int blockSize;
+    unsigned int read;          /* Blocks read from the input */
+    unsigned int taken;         /* Blocks taken by a worker */
+    bool stop;                  /* Workers must exit */
+    pthread_mutex_t lock;
+    pthread_cond_t work;        /* A block was read or the workers must stop */
+    pthread_cond_t done;        /* A block was compressed */
+} COMPRESS_POOL;
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static void* workerThread(void* pPool);
+static void compressSlot(COMPRESS_SLOT* pSlot, unsigned int* pTable, unsigned char* pScratch);
+static bool isCompressible(const unsigned char* pData, unsigned int pSize, unsigned int* pTable,
+                           unsigned char* pScratch);
+static unsigned int lzCompress(const unsigned char* pSrc, unsigned int pSize, unsigned char* pDst,
+                               unsigned int pCapacity, unsigned int* pTable);
+static unsigned char* lzEmit(unsigned char* pOut, const unsigned char* pEnd, const unsigned char* pLiterals,
+                             unsigned int pLiteralCount, unsigned int pOffset, unsigned int pMatchLength);
+static unsigned char* lzPutLength(unsigned char* pOut, unsigned int pLength);
+static bool lzExpand(const unsigned char* pSrc, unsigned int pSize, unsigned char* pDst, unsigned int pRawSize);
+static bool lzGetLength(const unsigned char* pSrc, unsigned int pSize, unsigned int* pPosition, unsigned int* pLength);
+static ERROR_TYPE writeHeader(DATA_WRITER* pWriter, unsigned int pBlockSize);
+static bool blockFits(DATA_WRITER* pWriter, const COMPRESS_INDEX* pIndex, const COMPRESS_SLOT* pSlot);
+static ERROR_TYPE writeBlock(DATA_WRITER* pWriter, const COMPRESS_SLOT* pSlot, COMPRESS_INDEX* pIndex,
+                             unsigned long long* pOffset, unsigned long long* pRawOffset);
+static ERROR_TYPE writeIndex(DATA_WRITER* pWriter, const COMPRESS_INDEX* pIndex, unsigned long long pOffset);
+static bool readBlock(FILE* pInput, unsigned int pBlockSize, char* pStored, char* pRaw, unsigned int* pRawSize);
+static bool allocateRing(COMPRESS_POOL* pPool, unsigned int pBlockSize, unsigned int pWorkers);
+static void freeRing(COMPRESS_POOL* pPool);
+static unsigned int getLe32(const unsigned char* pData);
+static unsigned long long getLe64(const unsigned char* pData);
+static void putLe32(unsigned char* pData, unsigned int pValue);
+static void putLe64(unsigned char* pData, unsigned long long pValue);
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataCompress_Copy(ENGINE_JOB* pJob, unsigned int pWorkers, COMPRESS_STATS* pStats)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    COMPRESS_POOL pool;
+    COMPRESS_INDEX index;
+    pthread_t* threads;
+    unsigned long long offset = COMPRESS_FILE_HEADER_SIZE;
+    unsigned long long rawOffset = 0;
+    unsigned int written = 0;
+    unsigned int started = 0;
+    unsigned int i;
+    bool eof = false;
+    memset(&pool, 0, sizeof(pool));
+    memset(&index, 0, sizeof(index));
+    memset(pStats, 0, sizeof(COMPRESS_STATS));
+    if(!pWorkers)
+    {
+        pWorkers = 1;
+    }
+    threads = calloc(pWorkers, sizeof(pthread_t));
+    if((threads == NULL) || !allocateRing(&pool, pJob->bufferSize, pWorkers))
+    {
+        free(threads);
+        freeRing(&pool);
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    (void)pthread_mutex_init(&pool.lock, NULL);
+    (void)pthread_cond_init(&pool.work, NULL);
+    (void)pthread_cond_init(&pool.done, NULL);
+    for(i = 0; i < pWorkers; i++)
+    {
+        if(pthread_create(&threads[i], NULL, workerThread, &pool))
+        {
+            break;
+        }
+        started++;
+    }
+    ret = started ? writeHeader(pJob->writer, pool.blockSize) : ERROR_IO_FAILED;
+    /* The calling thread reads ahead into free slots and writes finished blocks in order */
+    while(ret == ERROR_NOERROR)
+    {
+        COMPRESS_SLOT* slot;
+        while(!eof && ((pool.read - written) < pool.slotCount))
+        {
+            slot = &pool.slots[pool.read % pool.slotCount];
+            slot->rawSize = DataEngine_Read(pJob, slot->raw, pool.blockSize);
+            if(!slot->rawSize)
+            {
+                /* File read completed */
+                eof = true;
+                break;
+            }
+            slot->done = false;
+            pthread_mutex_lock(&pool.lock);
+            pool.read++;
+            pthread_cond_signal(&pool.work);
+            pthread_mutex_unlock(&pool.lock);
+        }
+        if(written == pool.read)
+        {
+            ret = writeIndex(pJob->writer, &index, offset);
+            break;
+        }
+        slot = &pool.slots[written % pool.slotCount];
+        pthread_mutex_lock(&pool.lock);
+        while(!slot->done)
+        {
+            pthread_cond_wait(&pool.done, &pool.lock);
+        }
+        pthread_mutex_unlock(&pool.lock);
+        if(!blockFits(pJob->writer, &index, slot))
+        {
+            /* Segment is full. End it with its index and continue in the next one or stop */
+            ret = writeIndex(pJob->writer, &index, offset);
+            if((ret == ERROR_NOERROR) && (!pJob->writer->rotate || !index.count))
+            {
+                /* A block that does not fit an empty segment never will */
+                ret = ERROR_FILE_SIZELIMIT_REACHED;
+            }
+            if(ret == ERROR_NOERROR)
+            {
+                ret = DataWriter_Rotate(pJob->writer);
+            }
+            if(ret == ERROR_NOERROR)
+            {
+                index.count = 0;
+                offset = COMPRESS_FILE_HEADER_SIZE;
+                ret = writeHeader(pJob->writer, pool.blockSize);
+            }
+            continue;
+        }
+        ret = writeBlock(pJob->writer, slot, &index, &offset, &rawOffset);
+        if(ret == ERROR_NOERROR)
+        {
+            pStats->blocks++;
+            pStats->rawBlocks += (slot->method == COMPRESS_METHOD_RAW);
+            pStats->inputBytes += slot->rawSize;
+            pStats->storedBytes += slot->storedSize + COMPRESS_BLOCK_HEADER_SIZE;
+        }
+        written++;
+    }
+    /* Workers finish the block at hand before exiting */
+    pthread_mutex_lock(&pool.lock);
+    pool.stop = true;
+    pthread_cond_broadcast(&pool.work);
+    pthread_mutex_unlock(&pool.lock);
+    for(i = 0; i < started; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+    }
+    (void)pthread_cond_destroy(&pool.done);
+    (void)pthread_cond_destroy(&pool.work);
+    (void)pthread_mutex_destroy(&pool.lock);
+    DataCompress_FreeIndex(&index);
+    freeRing(&pool);
+    free(threads);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataCompress_Expand(FILE* pInput, FILE* pOutput)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    unsigned char header[COMPRESS_FILE_HEADER_SIZE];
+    unsigned int blockSize;
+    char* stored;
+    char* raw;
+    if((fread(header, sizeof(char), sizeof(header), pInput) != sizeof(header)) ||
+       memcmp(header, COMPRESS_MAGIC, 4) || (getLe32(header + 4) != COMPRESS_VERSION))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    blockSize = getLe32(header + 8);
+    stored = malloc(blockSize ? blockSize : 1);
+    raw = malloc(blockSize ? blockSize : 1);
+    if((stored == NULL) || (raw == NULL))
+    {
+        ret = ERROR_MEMORY_ALLOCATION;
+    }
+    while(ret == ERROR_NOERROR)
+    {
+        unsigned int rawSize;
+        if(!readBlock(pInput, blockSize, stored, raw, &rawSize))
+        {
+            ret = ERROR_IO_FAILED;
+        }
+        else if(!rawSize)
+        {
+            /* End of blocks */
+            break;
+        }
+        else if(fwrite(raw, sizeof(char), rawSize, pOutput) != rawSize)
+        {
+            ret = ERROR_IO_FAILED;
+        }
+    }
+    free(stored);
+    free(raw);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataCompress_ReadIndex(FILE* pInput, COMPRESS_INDEX* pIndex)
+{
+    unsigned char header[COMPRESS_FILE_HEADER_SIZE];
+    unsigned char footer[COMPRESS_FOOTER_SIZE];
+    unsigned char entry[COMPRESS_INDEX_ENTRY_SIZE];
+    unsigned int count;
+    unsigned int i;
+    memset(pIndex, 0, sizeof(COMPRESS_INDEX));
+    if(seekStream(pInput, 0, SEEK_SET) || (fread(header, sizeof(char), sizeof(header), pInput) != sizeof(header)) ||
+       memcmp(header, COMPRESS_MAGIC, 4) || seekStream(pInput, -COMPRESS_FOOTER_SIZE, SEEK_END) ||
+       (fread(footer, sizeof(char), sizeof(footer), pInput) != sizeof(footer)) ||
+       memcmp(footer + 12, COMPRESS_INDEX_MAGIC, 4) || seekStream(pInput, (long long)getLe64(footer), SEEK_SET))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    count = getLe32(footer + 8);
+    pIndex->blockSize = getLe32(header + 8);
+    pIndex->blocks = calloc(count ? count : 1, sizeof(COMPRESS_BLOCK));
+    if(pIndex->blocks == NULL)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    pIndex->capacity = count;
+    for(i = 0; i < count; i++)
+    {
+        COMPRESS_BLOCK* block = &pIndex->blocks[i];
+        if(fread(entry, sizeof(char), sizeof(entry), pInput) != sizeof(entry))
+        {
+            DataCompress_FreeIndex(pIndex);
+            return(ERROR_IO_FAILED);
+        }
+        block->offset = getLe64(entry);
+        block->rawOffset = getLe64(entry + 8);
+        block->storedSize = getLe32(entry + 16);
+        block->rawSize = getLe32(entry + 20);
+        pIndex->count++;
+    }
+    return(ERROR_NOERROR);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataCompress_ReadBlock(FILE* pInput, const COMPRESS_BLOCK* pBlock, char* pData)
+{
+    ERROR_TYPE ret = ERROR_IO_FAILED;
+    unsigned int rawSize;
+    char* stored = malloc(pBlock->rawSize ? pBlock->rawSize : 1);
+    if(stored == NULL)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    if(!seekStream(pInput, (long long)pBlock->offset, SEEK_SET) &&
+       readBlock(pInput, pBlock->rawSize, stored, pData, &rawSize) && (rawSize == pBlock->rawSize))
+    {
+        ret = ERROR_NOERROR;
+    }
+    free(stored);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+void DataCompress_FreeIndex(COMPRESS_INDEX* pIndex)
+{
+    free(pIndex->blocks);
+    memset(pIndex, 0, sizeof(COMPRESS_INDEX));
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : workerThread
+ * Inputs       : void* pPool - COMPRESS_POOL shared with the calling thread
+ * Outputs      : NULL
+ * Description  : Compresses blocks in the order they were read until told to stop
+ -----------------------------------------------------------------------------------*/
+static void* workerThread(void* pPool)
+{
+    COMPRESS_POOL* pool = (COMPRESS_POOL*)pPool;
+    /* Without a hash table the worker stores its blocks raw */
+    unsigned int* table = malloc(sizeof(unsigned int) << LZ_HASH_BITS);
+    unsigned char* scratch = malloc(COMPRESS_SAMPLE_SIZE);
+    while(true)
+    {
+        COMPRESS_SLOT* slot;
+        pthread_mutex_lock(&pool->lock);
+        while(!pool->stop && (pool->taken == pool->read))
+        {
+            pthread_cond_wait(&pool->work, &pool->lock);
+        }
+        if(pool->stop)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        slot = &pool->slots[pool->taken++ % pool->slotCount];
+        pthread_mutex_unlock(&pool->lock);
+        compressSlot(slot, scratch != NULL ? table : NULL, scratch);
+        pthread_mutex_lock(&pool->lock);
+        slot->done = true;
+        pthread_cond_broadcast(&pool->done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    free(scratch);
+    free(table);
+    return NULL;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : compressSlot
+ * Inputs       : COMPRESS_SLOT* pSlot - block to be compressed
+ *                unsigned int* pTable - match hash table. NULL - store raw
+ *                unsigned char* pScratch - COMPRESS_SAMPLE_SIZE bytes for sampling
+ * Outputs      :
+ * Description  : Compresses the block unless sampling shows it is incompressible.
+ *                The block is stored raw when compression does not make it smaller
+ -----------------------------------------------------------------------------------*/
+static void compressSlot(COMPRESS_SLOT* pSlot, unsigned int* pTable, unsigned char* pScratch)
+{
+    unsigned int size = 0;
+    const unsigned char* raw = (const unsigned char*)pSlot->raw;
+    if((pTable != NULL) && isCompressible(raw, pSlot->rawSize, pTable, pScratch))
+    {
+        size = lzCompress(raw, pSlot->rawSize, (unsigned char*)pSlot->stored, pSlot->rawSize - 1, pTable);
+    }
+    pSlot->method = size ? COMPRESS_METHOD_LZ : COMPRESS_METHOD_RAW;
+    pSlot->storedSize = size ? size : pSlot->rawSize;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : isCompressible
+ * Inputs       : const unsigned char* pData - block to be checked
+ *                unsigned int pSize - size of the block
+ *                unsigned int* pTable - match hash table
+ *                unsigned char* pScratch - COMPRESS_SAMPLE_SIZE bytes of output
+ * Outputs      : False if the samples of the block do not compress
+ * Description  : Compresses COMPRESS_SAMPLE_COUNT evenly spaced samples of the
+ *                block. Already compressed or encrypted data fails the check at a
+ *                fraction of the cost of compressing the whole block. Blocks that
+ *                are not larger than the samples are always compressed
+ -----------------------------------------------------------------------------------*/
+static bool isCompressible(const unsigned char* pData, unsigned int pSize, unsigned int* pTable,
+                           unsigned char* pScratch)
+{
+    unsigned int sampled = COMPRESS_SAMPLE_SIZE * COMPRESS_SAMPLE_COUNT;
+    unsigned int stride;
+    unsigned int stored = 0;
+    unsigned int i;
+    if(pSize <= sampled)
+    {
+        return true;
+    }
+    stride = (pSize - COMPRESS_SAMPLE_SIZE) / (COMPRESS_SAMPLE_COUNT - 1);
+    for(i = 0; i < COMPRESS_SAMPLE_COUNT; i++)
+    {
+        unsigned int size = lzCompress(pData + (i * stride), COMPRESS_SAMPLE_SIZE, pScratch,
+                                       COMPRESS_SAMPLE_SIZE, pTable);
+        stored = stored + (size ? size : COMPRESS_SAMPLE_SIZE);
+    }
+    return(stored <= sampled - ((sampled / 100) * COMPRESS_MIN_SAVING_PERCENT));
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : lzCompress
+ * Inputs       : const unsigned char* pSrc - data to be compressed
+ *                unsigned int pSize - size of the data
+ *                unsigned char* pDst - receives the compressed data
+ *                unsigned int pCapacity - size of pDst
+ *                unsigned int* pTable - hash table of 1 << LZ_HASH_BITS entries
+ * Outputs      : Size of the compressed data. 0 if it does not fit pCapacity
+ * Description  : Byte oriented LZ77 with a 64 KB window. The data is a list of
+ *                sequences, each a token holding the literal count and the match
+ *                length in its high and low nibble, extra length bytes for the
+ *                literal count, the literals, a 16 bit match offset and extra
+ *                length bytes for the match. The last sequence has no match.
+ *                Matches are found through a hash of the next 4 bytes holding the
+ *                last position they were seen at
+ -----------------------------------------------------------------------------------*/
+static unsigned int lzCompress(const unsigned char* pSrc, unsigned int pSize, unsigned char* pDst,
+                               unsigned int pCapacity, unsigned int* pTable)
+{
+    const unsigned char* end = pDst + pCapacity;
+    unsigned char* out = pDst;
+    unsigned int hashBits = LZ_HASH_BITS;
+    unsigned int position = 0;
+    unsigned int anchor = 0;
+    /* Smaller inputs use a smaller part of the table, which is cheaper to clear */
+    while((hashBits > LZ_MIN_HASH_BITS) && ((1U << hashBits) > pSize))
+    {
+        hashBits--;
+    }
+    memset(pTable, 0, sizeof(unsigned int) << hashBits);
+    if(pSize > LZ_MATCH_SEARCH_END)
+    {
+        unsigned int searchEnd = pSize - LZ_MATCH_SEARCH_END;
+        unsigned int matchEnd = pSize - LZ_LAST_LITERALS;
+        while(position < searchEnd)
+        {
+            unsigned int sequence = getLe32(pSrc + position);
+            unsigned int hash = (sequence * 2654435761U) >> (32 - hashBits);
+            unsigned int reference = pTable[hash];
+            pTable[hash] = position;
+            if((reference < position) && ((position - reference) <= LZ_MAX_OFFSET) &&
+               (getLe32(pSrc + reference) == sequence))
+            {
+                unsigned int length = LZ_MIN_MATCH;
+                while(((position + length) < matchEnd) && (pSrc[reference + length] == pSrc[position + length]))
+                {
+                    length++;
+                }
+                /* Extend the match backwards over the pending literals */
+                while((position > anchor) && reference && (pSrc[position - 1] == pSrc[reference - 1]))
+                {
+                    position--;
+                    reference--;
+                    length++;
+                }
+                out = lzEmit(out, end, pSrc + anchor, position - anchor, position - reference, length);
+                if(out == NULL)
+                {
+                    return 0;
+                }
+                position = position + length;
+                anchor = position;
+            }
+            else
+            {
+                /* Step faster through data without matches */
+                position = position + 1 + ((position - anchor) >> LZ_SKIP_SHIFT);
+            }
+        }
+    }
+    out = lzEmit(out, end, pSrc + anchor, pSize - anchor, 0, 0);
+    return(out != NULL ? (unsigned int)(out - pDst) : 0);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : lzEmit
+ * Inputs       : unsigned char* pOut - current output position
+ *                const unsigned char* pEnd - end of the output buffer
+ *                const unsigned char* pLiterals - literals preceding the match
+ *                unsigned int pLiteralCount - number of literals
+ *                unsigned int pOffset - distance back to the match
+ *                unsigned int pMatchLength - length of the match. 0 - last sequence
+ * Outputs      : Output position after the sequence. NULL if it does not fit
+ * Description  : Writes one sequence of the compressed data
+ -----------------------------------------------------------------------------------*/
+static unsigned char* lzEmit(unsigned char* pOut, const unsigned char* pEnd, const unsigned char* pLiterals,
+                             unsigned int pLiteralCount, unsigned int pOffset, unsigned int pMatchLength)
+{
+    unsigned int matchCode = pMatchLength ? pMatchLength - LZ_MIN_MATCH : 0;
+    unsigned long long needed = 1ULL + (pLiteralCount / LZ_LENGTH_BYTE) + 1 + pLiteralCount +
+                                (pMatchLength ? 2 + (matchCode / LZ_LENGTH_BYTE) + 1 : 0);
+    if(needed > (unsigned long long)(pEnd - pOut))
+    {
+        return NULL;
+    }
+    *pOut++ = (unsigned char)(((pLiteralCount < LZ_LENGTH_NIBBLE ? pLiteralCount : LZ_LENGTH_NIBBLE) << 4) |
+                              (matchCode < LZ_LENGTH_NIBBLE ? matchCode : LZ_LENGTH_NIBBLE));
+    if(pLiteralCount >= LZ_LENGTH_NIBBLE)
+    {
+        pOut = lzPutLength(pOut, pLiteralCount - LZ_LENGTH_NIBBLE);
+    }
+    memcpy(pOut, pLiterals, pLiteralCount);
+    pOut = pOut + pLiteralCount;
+    if(pMatchLength)
+    {
+        *pOut++ = (unsigned char)(pOffset & 0xFF);
+        *pOut++ = (unsigned char)(pOffset >> 8);
+        if(matchCode >= LZ_LENGTH_NIBBLE)
+        {
+            pOut = lzPutLength(pOut, matchCode - LZ_LENGTH_NIBBLE);
+        }
+    }
+    return pOut;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : lzPutLength
+ * Inputs       : unsigned char* pOut - current output position
+ *                unsigned int pLength - length exceeding the token nibble
+ * Outputs      : Output position after the length
+ * Description  : Writes a length as bytes of 255 followed by the remainder
+ -----------------------------------------------------------------------------------*/
+static unsigned char* lzPutLength(unsigned char* pOut, unsigned int pLength)
+{
+    while(pLength >= LZ_LENGTH_BYTE)
+    {
+        *pOut++ = LZ_LENGTH_BYTE;
+        pLength = pLength - LZ_LENGTH_BYTE;
+    }
+    *pOut++ = (unsigned char)pLength;
+    return pOut;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : lzExpand
+ * Inputs       : const unsigned char* pSrc - compressed data
+ *                unsigned int pSize - size of the compressed data
+ *                unsigned char* pDst - receives the expanded data
+ *                unsigned int pRawSize - expected size of the expanded data
+ * Outputs      : True if the data expanded to exactly pRawSize bytes
+ * Description  : Reverses lzCompress. Every length and offset is checked, so
+ *                corrupt data never reads or writes out of bounds
+ -----------------------------------------------------------------------------------*/
+static bool lzExpand(const unsigned char* pSrc, unsigned int pSize, unsigned char* pDst, unsigned int pRawSize)
+{
+    unsigned int in = 0;
+    unsigned int out = 0;
+    while(in < pSize)
+    {
+        unsigned int token = pSrc[in++];
+        unsigned int literals = token >> 4;
+        unsigned int length = token & LZ_LENGTH_NIBBLE;
+        unsigned int offset;
+        if((literals == LZ_LENGTH_NIBBLE) && !lzGetLength(pSrc, pSize, &in, &literals))
+        {
+            return false;
+        }
+        if((literals > (pSize - in)) || (literals > (pRawSize - out)))
+        {
+            return false;
+        }
+        memcpy(pDst + out, pSrc + in, literals);
+        in = in + literals;
+        out = out + literals;
+        if(in == pSize)
+        {
+            /* Last sequence has no match */
+            break;
+        }
+        if((pSize - in) < 2)
+        {
+            return false;
+        }
+        offset = pSrc[in] | ((unsigned int)pSrc[in + 1] << 8);
+        in = in + 2;
+        if((length == LZ_LENGTH_NIBBLE) && !lzGetLength(pSrc, pSize, &in, &length))
+        {
+            return false;
+        }
+        length = length + LZ_MIN_MATCH;
+        if(!offset || (offset > out) || (length > (pRawSize - out)))
+        {
+            return false;
+        }
+        /* Byte by byte, the match may overlap the bytes being written */
+        while(length--)
+        {
+            pDst[out] = pDst[out - offset];
+            out++;
+        }
+    }
+    return(out == pRawSize);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : lzGetLength
+ * Inputs       : const unsigned char* pSrc - compressed data
+ *                unsigned int pSize - size of the compressed data
+ *                unsigned int* pPosition - position of the length bytes. Advanced
+ *                unsigned int* pLength - nibble value. Extended with the length bytes
+ * Outputs      : False if the length bytes are truncated or overflow
+ * Description  : Reads the extra bytes of a length written by lzPutLength
+ -----------------------------------------------------------------------------------*/
+static bool lzGetLength(const unsigned char* pSrc, unsigned int pSize, unsigned int* pPosition, unsigned int* pLength)
+{
+    unsigned int byte;
+    do
+    {
+        if((*pPosition >= pSize) || (*pLength > (0x7FFFFFFFU - LZ_LENGTH_BYTE)))
+        {
+            return false;
+        }
+        byte = pSrc[(*pPosition)++];
+        *pLength = *pLength + byte;
+    } while(byte == LZ_LENGTH_BYTE);
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : writeHeader
+ * Inputs       : DATA_WRITER* pWriter - output of the capture
+ *                unsigned int pBlockSize - largest raw size of a block
+ * Outputs      : returns -
+ *                ERROR_NOERROR - header written
+ *                ERROR_FILE_SIZELIMIT_REACHED - segment cannot hold an empty stream
+ *                Errors of DataWriter_Write
+ * Description  : Starts a segment with the file header
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE writeHeader(DATA_WRITER* pWriter, unsigned int pBlockSize)
+{
+    unsigned char header[COMPRESS_FILE_HEADER_SIZE] = { 0 };
+    if(DataWriter_Space(pWriter) < (COMPRESS_FILE_HEADER_SIZE + COMPRESS_BLOCK_HEADER_SIZE + COMPRESS_FOOTER_SIZE))
+    {
+        /* Segments are too small to hold any data */
+        return(ERROR_FILE_SIZELIMIT_REACHED);
+    }
+    memcpy(header, COMPRESS_MAGIC, 4);
+    putLe32(header + 4, COMPRESS_VERSION);
+    putLe32(header + 8, pBlockSize);
+    return(DataWriter_Write(pWriter, (const char*)header, sizeof(header)));
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : blockFits
+ * Inputs       : DATA_WRITER* pWriter - output of the capture
+ *                const COMPRESS_INDEX* pIndex - blocks of the segment
+ *                const COMPRESS_SLOT* pSlot - compressed block to be written
+ * Outputs      : True if the block fits in the segment
+ * Description  : Keeps room for the end of blocks marker, the index with an entry
+ *                for the block and the footer, so the segment can always be ended
+ -----------------------------------------------------------------------------------*/
+static bool blockFits(DATA_WRITER* pWriter, const COMPRESS_INDEX* pIndex, const COMPRESS_SLOT* pSlot)
+{
+    unsigned long long needed = (unsigned long long)COMPRESS_BLOCK_HEADER_SIZE + pSlot->storedSize +
+                                COMPRESS_BLOCK_HEADER_SIZE + (pIndex->count + 1ULL) * COMPRESS_INDEX_ENTRY_SIZE +
+                                COMPRESS_FOOTER_SIZE;
+    return(DataWriter_Space(pWriter) >= needed);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : writeBlock
+ * Inputs       : DATA_WRITER* pWriter - output of the capture
+ *                const COMPRESS_SLOT* pSlot - compressed block. Fits in the segment
+ *                COMPRESS_INDEX* pIndex - extended with the block
+ *                unsigned long long* pOffset - segment offset. Advanced
+ *                unsigned long long* pRawOffset - input offset. Advanced
+ * Outputs      : returns -
+ *                ERROR_NOERROR - block written
+ *                ERROR_MEMORY_ALLOCATION - index cannot be extended
+ *                Errors of DataWriter_Write
+ * Description  : Writes a block with its header and adds it to the index
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE writeBlock(DATA_WRITER* pWriter, const COMPRESS_SLOT* pSlot, COMPRESS_INDEX* pIndex,
+                             unsigned long long* pOffset, unsigned long long* pRawOffset)
+{
+    ERROR_TYPE ret;
+    unsigned char header[COMPRESS_BLOCK_HEADER_SIZE];
+    COMPRESS_BLOCK* block;
+    if(pIndex->count == pIndex->capacity)
+    {
+        unsigned int capacity = pIndex->capacity ? pIndex->capacity * 2 : 64;
+        COMPRESS_BLOCK* blocks = realloc(pIndex->blocks, capacity * sizeof(COMPRESS_BLOCK));
+        if(blocks == NULL)
+        {
+            return(ERROR_MEMORY_ALLOCATION);
+        }
+        pIndex->blocks = blocks;
+        pIndex->capacity = capacity;
+    }
+    putLe32(header, pSlot->rawSize);
+    putLe32(header + 4, pSlot->storedSize);
+    putLe32(header + 8, pSlot->method);
+    ret = DataWriter_Write(pWriter, (const char*)header, sizeof(header));
+    if(ret == ERROR_NOERROR)
+    {
+        ret = DataWriter_Write(pWriter, pSlot->method == COMPRESS_METHOD_RAW ? pSlot->raw : pSlot->stored,
+                               pSlot->storedSize);
+    }
+    block = &pIndex->blocks[pIndex->count++];
+    block->offset = *pOffset;
+    block->rawOffset = *pRawOffset;
+    block->storedSize = pSlot->storedSize;
+    block->rawSize = pSlot->rawSize;
+    *pOffset = *pOffset + COMPRESS_BLOCK_HEADER_SIZE + pSlot->storedSize;
+    *pRawOffset = *pRawOffset + pSlot->rawSize;
+    return(ret);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : writeIndex
+ * Inputs       : DATA_WRITER* pWriter - output of the capture
+ *                const COMPRESS_INDEX* pIndex - blocks written
+ *                unsigned long long pOffset - segment offset after the last block
+ * Outputs      : returns -
+ *                Errors of DataWriter_Write
+ * Description  : Ends the segment with the end of blocks marker, the index and the
+ *                footer locating the index
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE writeIndex(DATA_WRITER* pWriter, const COMPRESS_INDEX* pIndex, unsigned long long pOffset)
+{
+    unsigned char marker[COMPRESS_BLOCK_HEADER_SIZE] = { 0 };
+    unsigned char entry[COMPRESS_INDEX_ENTRY_SIZE];
+    unsigned char footer[COMPRESS_FOOTER_SIZE];
+    unsigned int i;
+    ERROR_TYPE ret = DataWriter_Write(pWriter, (const char*)marker, sizeof(marker));
+    for(i = 0; (ret == ERROR_NOERROR) && (i < pIndex->count); i++)
+    {
+        const COMPRESS_BLOCK* block = &pIndex->blocks[i];
+        putLe64(entry, block->offset);
+        putLe64(entry + 8, block->rawOffset);
+        putLe32(entry + 16, block->storedSize);
+        putLe32(entry + 20, block->rawSize);
+        ret = DataWriter_Write(pWriter, (const char*)entry, sizeof(entry));
+    }
+    if(ret == ERROR_NOERROR)
+    {
+        putLe64(footer, pOffset + sizeof(marker));
+        putLe32(footer + 8, pIndex->count);
+        memcpy(footer + 12, COMPRESS_INDEX_MAGIC, 4);
+        ret = DataWriter_Write(pWriter, (const char*)footer, sizeof(footer));
+    }
+    return(ret);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : readBlock
+ * Inputs       : FILE* pInput - compressed stream positioned at a block header
+ *                unsigned int pBlockSize - largest raw size of a block
+ *                char* pStored - pBlockSize bytes for the stored data
+ *                char* pRaw - pBlockSize bytes. Receives the expanded block
+ *                unsigned int* pRawSize - size of the expanded block. 0 - end of blocks
+ * Outputs      : False if the block is truncated or corrupt
+ * Description  : Reads and expands the block at the current position
+ -----------------------------------------------------------------------------------*/
+static bool readBlock(FILE* pInput, unsigned int pBlockSize, char* pStored, char* pRaw, unsigned int* pRawSize)
+{
+    unsigned char header[COMPRESS_BLOCK_HEADER_SIZE];
+    unsigned int storedSize;
+    unsigned int method;
+    if(fread(header, sizeof(char), sizeof(header), pInput) != sizeof(header))
+    {
+        return false;
+    }
+    *pRawSize = getLe32(header);
+    storedSize = getLe32(header + 4);
+    method = getLe32(header + 8);
+    if(!*pRawSize)
+    {
+        return(storedSize == 0);
+    }
+    if((*pRawSize > pBlockSize) || (storedSize > *pRawSize) ||
+       ((method == COMPRESS_METHOD_RAW) && (storedSize != *pRawSize)) ||
+       ((method != COMPRESS_METHOD_RAW) && (method != COMPRESS_METHOD_LZ)))
+    {
+        return false;
+    }
+    if(method == COMPRESS_METHOD_RAW)
+    {
+        return(fread(pRaw, sizeof(char), storedSize, pInput) == storedSize);
+    }
+    return((fread(pStored, sizeof(char), storedSize, pInput) == storedSize) &&
+           lzExpand((const unsigned char*)pStored, storedSize, (unsigned char*)pRaw, *pRawSize));
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : allocateRing
+ * Inputs       : COMPRESS_POOL* pPool - pool whose ring is allocated
+ *                unsigned int pBlockSize - size of a block in bytes
+ *                unsigned int pWorkers - number of workers
+ * Outputs      : True if all blocks were allocated
+ * Description  : Allocates COMPRESS_SLOTS_PER_WORKER blocks per worker so the
+ *                workers stay busy while finished blocks wait to be written
+ -----------------------------------------------------------------------------------*/
+static bool allocateRing(COMPRESS_POOL* pPool, unsigned int pBlockSize, unsigned int pWorkers)
+{
+    unsigned int i;
+    pPool->blockSize = pBlockSize;
+    pPool->slotCount = pWorkers * COMPRESS_SLOTS_PER_WORKER;
+    pPool->slots = calloc(pPool->slotCount, sizeof(COMPRESS_SLOT));
+    if(pPool->slots == NULL)
+    {
+        return false;
+    }
+    for(i = 0; i < pPool->slotCount; i++)
+    {
+        pPool->slots[i].raw = DataEngine_AllocateBuffer(pBlockSize);
+        pPool->slots[i].stored = malloc(pBlockSize);
+        if((pPool->slots[i].raw == NULL) || (pPool->slots[i].stored == NULL))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : freeRing
+ * Inputs       : COMPRESS_POOL* pPool - pool whose ring is released
+ * Outputs      :
+ * Description  : Releases the blocks allocated by allocateRing. Partial allocations
+ *                are released as well
+ -----------------------------------------------------------------------------------*/
+static void freeRing(COMPRESS_POOL* pPool)
+{
+    unsigned int i;
+    for(i = 0; (pPool->slots != NULL) && (i < pPool->slotCount); i++)
+    {
+        DataEngine_FreeBuffer(pPool->slots[i].raw);
+        free(pPool->slots[i].stored);
+    }
+    free(pPool->slots);
+    pPool->slots = NULL;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : getLe32 / getLe64 / putLe32 / putLe64
+ * Inputs       : unsigned char* pData - position of the number
+ *                pValue - number to be stored
+ * Outputs      : Number read
+ * Description  : Little endian numbers of the stream, independent of alignment and
+ *                of the byte order of the machine
+ -----------------------------------------------------------------------------------*/
+static unsigned int getLe32(const unsigned char* pData)
+{
+    return((unsigned int)pData[0] | ((unsigned int)pData[1] << 8) | ((unsigned int)pData[2] << 16) |
+           ((unsigned int)pData[3] << 24));
+}
+static unsigned long long getLe64(const unsigned char* pData)
+{
+    return((unsigned long long)getLe32(pData) | ((unsigned long long)getLe32(pData + 4) << 32));
+}
+static void putLe32(unsigned char* pData, unsigned int pValue)
+{
+    pData[0] = (unsigned char)pValue;
+    pData[1] = (unsigned char)(pValue >> 8);
+    pData[2] = (unsigned char)(pValue >> 16);
+    pData[3] = (unsigned char)(pValue >> 24);
+}
+static void putLe64(unsigned char* pData, unsigned long long pValue)
+{
+    putLe32(pData, (unsigned int)pValue);
+    putLe32(pData + 4, (unsigned int)(pValue >> 32));
+}
+/*----------------------------------------------------------------------------------*/
@@ -0,0 +1,477 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#ifdef __linux__
+/* Required for accept4. Must precede all system headers */
+#define _GNU_SOURCE
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "DataDaemon.h"
+#include "DataEngine.h"
+#ifdef __linux__
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+#ifdef __linux__
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* One client connection and the capture it feeds */
+typedef struct CONNECTION
+{
+    int fd;
+    DATA_READER_STREAM* stream;
+    pthread_mutex_t lock;       /* Held by the worker serving the connection */
+    struct CONNECTION* previous;
+    struct CONNECTION* next;
+} CONNECTION;
+
+/* Listener, poll set and worker pool */
+struct DATA_DAEMON
+{
+    char socketPath[MAX_FILEPATH_LENGTH];
+    int listener;
+    int stopEvent;                  /* Readable once the daemon stops */
+    int poll;
+    pthread_t* workers;
+    unsigned int started;
+    unsigned int bufferSize;
+    CONNECTION* connections;        /* Open connections, for the final cleanup */
+    pthread_mutex_t lock;           /* Guards the connection list */
+    atomic_ullong accepted;
+    atomic_ullong active;
+    atomic_ullong completed;
+    atomic_ullong failed;
+    atomic_ullong bytes;
+};
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static bool openListener(DATA_DAEMON* pDaemon, const char* pSocket);
+static void* workerThread(void* pDaemon);
+static void acceptConnections(DATA_DAEMON* pDaemon);
+static void serveConnection(DATA_DAEMON* pDaemon, CONNECTION* pConnection, char* pBuffer);
+static void closeConnection(DATA_DAEMON* pDaemon, CONNECTION* pConnection, bool pFailed);
+static bool watch(DATA_DAEMON* pDaemon, int pOperation, int pFd, void* pData);
+static void releaseDaemon(DATA_DAEMON* pDaemon);
+#endif
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataDaemon_Start(DATA_DAEMON** pDaemon, const char* pSocket, unsigned int pWorkers)
+{
+#ifdef __linux__
+    DATA_DAEMON* daemon;
+    unsigned int i;
+    *pDaemon = NULL;
+    if(strlen(pSocket) >= sizeof(((struct sockaddr_un*)0)->sun_path))
+    {
+        return(ERROR_PATHTOOLONG);
+    }
+    daemon = calloc(1, sizeof(DATA_DAEMON));
+    if(daemon == NULL)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    daemon->listener = -1;
+    daemon->stopEvent = -1;
+    daemon->poll = -1;
+    (void)pthread_mutex_init(&daemon->lock, NULL);
+    atomic_init(&daemon->accepted, 0);
+    atomic_init(&daemon->active, 0);
+    atomic_init(&daemon->completed, 0);
+    atomic_init(&daemon->failed, 0);
+    atomic_init(&daemon->bytes, 0);
+    /* The configuration is only completed by the first capture */
+    daemon->bufferSize = DataReader_GetBufferSize() * 1024;
+    if(!daemon->bufferSize)
+    {
+        daemon->bufferSize = (unsigned int)strtoul(DEFAULT_BUFFER_SIZE_KB, NULL, 10) * 1024;
+    }
+    if(!pWorkers)
+    {
+        pWorkers = DataEngine_GetCoreCount();
+    }
+    daemon->poll = epoll_create1(EPOLL_CLOEXEC);
+    daemon->stopEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    daemon->workers = calloc(pWorkers, sizeof(pthread_t));
+    if((daemon->poll < 0) || (daemon->stopEvent < 0) || (daemon->workers == NULL) ||
+       !watch(daemon, EPOLL_CTL_ADD, daemon->stopEvent, &daemon->stopEvent) || !openListener(daemon, pSocket))
+    {
+        releaseDaemon(daemon);
+        return(ERROR_IO_FAILED);
+    }
+    for(i = 0; i < pWorkers; i++)
+    {
+        if(pthread_create(&daemon->workers[daemon->started], NULL, workerThread, daemon))
+        {
+            break;
+        }
+        daemon->started++;
+    }
+    if(!daemon->started)
+    {
+        releaseDaemon(daemon);
+        return(ERROR_IO_FAILED);
+    }
+    *pDaemon = daemon;
+    return(ERROR_NOERROR);
+#else
+    /* epoll and UNIX domain sockets are not available on this platform */
+    (void)pSocket;
+    (void)pWorkers;
+    *pDaemon = NULL;
+    return(ERROR_IO_FAILED);
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+void DataDaemon_GetStats(DATA_DAEMON* pDaemon, DAEMON_STATS* pStats)
+{
+#ifdef __linux__
+    pStats->accepted = atomic_load(&pDaemon->accepted);
+    pStats->active = atomic_load(&pDaemon->active);
+    pStats->completed = atomic_load(&pDaemon->completed);
+    pStats->failed = atomic_load(&pDaemon->failed);
+    pStats->bytes = atomic_load(&pDaemon->bytes);
+#else
+    (void)pDaemon;
+    memset(pStats, 0, sizeof(DAEMON_STATS));
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+void DataDaemon_Stop(DATA_DAEMON* pDaemon, DAEMON_STATS* pStats)
+{
+#ifdef __linux__
+    unsigned long long stop = 1;
+    unsigned int i;
+    /* The event stays readable, so every worker sees it */
+    (void)!write(pDaemon->stopEvent, &stop, sizeof(stop));
+    for(i = 0; i < pDaemon->started; i++)
+    {
+        (void)pthread_join(pDaemon->workers[i], NULL);
+    }
+    pDaemon->started = 0;
+    /* Keep what the remaining clients have sent */
+    while(pDaemon->connections != NULL)
+    {
+        closeConnection(pDaemon, pDaemon->connections, false);
+    }
+    if(pStats != NULL)
+    {
+        DataDaemon_GetStats(pDaemon, pStats);
+    }
+    releaseDaemon(pDaemon);
+#else
+    (void)pDaemon;
+    if(pStats != NULL)
+    {
+        memset(pStats, 0, sizeof(DAEMON_STATS));
+    }
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataDaemon_Run(const char* pSocket, unsigned int pWorkers, DAEMON_STATS* pStats)
+{
+#ifdef __linux__
+    DATA_DAEMON* daemon;
+    ERROR_TYPE ret;
+    sigset_t signals;
+    sigset_t previous;
+    int received;
+    /* Blocked before the workers start, so that they inherit the mask and the
+       signals are only taken by sigwait */
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    (void)pthread_sigmask(SIG_BLOCK, &signals, &previous);
+    ret = DataDaemon_Start(&daemon, pSocket, pWorkers);
+    if(ret == ERROR_NOERROR)
+    {
+        (void)sigwait(&signals, &received);
+        DataDaemon_Stop(daemon, pStats);
+    }
+    (void)pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    return(ret);
+#else
+    (void)pSocket;
+    (void)pWorkers;
+    memset(pStats, 0, sizeof(DAEMON_STATS));
+    return(ERROR_IO_FAILED);
+#endif
+}
+#ifdef __linux__
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : openListener
+ * Inputs       : DATA_DAEMON* pDaemon - daemon being started
+ *                const char* pSocket - path of the socket
+ * Outputs      : True if the socket listens and is watched. False otherwise
+ * Description  : A socket file that nobody listens on any more is removed first.
+ *                Any other existing file is kept and fails the bind
+ -----------------------------------------------------------------------------------*/
+static bool openListener(DATA_DAEMON* pDaemon, const char* pSocket)
+{
+    struct sockaddr_un address;
+    struct stat existing;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, pSocket);
+    if((stat(pSocket, &existing) == 0) && S_ISSOCK(existing.st_mode))
+    {
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if((probe >= 0) && (connect(probe, (struct sockaddr*)&address, sizeof(address)) != 0) &&
+           (errno == ECONNREFUSED))
+        {
+            (void)unlink(pSocket);
+        }
+        if(probe >= 0)
+        {
+            close(probe);
+        }
+    }
+    pDaemon->listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if((pDaemon->listener < 0) || (bind(pDaemon->listener, (struct sockaddr*)&address, sizeof(address)) != 0))
+    {
+        return false;
+    }
+    strcpy(pDaemon->socketPath, pSocket);
+    if((listen(pDaemon->listener, DAEMON_BACKLOG) != 0) ||
+       !watch(pDaemon, EPOLL_CTL_ADD, pDaemon->listener, &pDaemon->listener))
+    {
+        return false;
+    }
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : workerThread
+ * Inputs       : void* pDaemon - DATA_DAEMON shared by the workers
+ * Outputs      : NULL
+ * Description  : Takes ready connections from the shared poll set until the
+ *                daemon stops. Every descriptor is armed for one event at a time,
+ *                so a connection is only served by one worker at once
+ -----------------------------------------------------------------------------------*/
+static void* workerThread(void* pDaemon)
+{
+    DATA_DAEMON* daemon = (DATA_DAEMON*)pDaemon;
+    struct epoll_event events[DAEMON_MAX_EVENTS];
+    char* buffer = DataEngine_AllocateBuffer(daemon->bufferSize);
+    bool running = (buffer != NULL);
+    while(running)
+    {
+        int count = epoll_wait(daemon->poll, events, DAEMON_MAX_EVENTS, -1);
+        int i;
+        for(i = 0; i < count; i++)
+        {
+            if(events[i].data.ptr == &daemon->stopEvent)
+            {
+                running = false;
+            }
+            else if(events[i].data.ptr == &daemon->listener)
+            {
+                acceptConnections(daemon);
+            }
+            else
+            {
+                serveConnection(daemon, (CONNECTION*)events[i].data.ptr, buffer);
+            }
+        }
+        if((count < 0) && (errno != EINTR))
+        {
+            running = false;
+        }
+    }
+    DataEngine_FreeBuffer(buffer);
+    return NULL;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : acceptConnections
+ * Inputs       : DATA_DAEMON* pDaemon - current daemon
+ * Outputs      :
+ * Description  : Accepts all pending connections and opens a capture for each.
+ *                A connection whose capture cannot be opened is closed at once
+ -----------------------------------------------------------------------------------*/
+static void acceptConnections(DATA_DAEMON* pDaemon)
+{
+    int fd;
+    while((fd = accept4(pDaemon->listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+    {
+        char writeFile[MAX_FILEPATH_LENGTH] = { NULL_CHARACTER };
+        CONNECTION* connection = calloc(1, sizeof(CONNECTION));
+        atomic_fetch_add(&pDaemon->accepted, 1);
+        if((connection == NULL) ||
+           (DataReader_OpenStream(&connection->stream, writeFile, sizeof(writeFile) - 1) != ERROR_NOERROR))
+        {
+            atomic_fetch_add(&pDaemon->failed, 1);
+            free(connection);
+            close(fd);
+            continue;
+        }
+        connection->fd = fd;
+        (void)pthread_mutex_init(&connection->lock, NULL);
+        pthread_mutex_lock(&pDaemon->lock);
+        connection->next = pDaemon->connections;
+        if(pDaemon->connections != NULL)
+        {
+            pDaemon->connections->previous = connection;
+        }
+        pDaemon->connections = connection;
+        pthread_mutex_unlock(&pDaemon->lock);
+        atomic_fetch_add(&pDaemon->active, 1);
+        if(!watch(pDaemon, EPOLL_CTL_ADD, fd, connection))
+        {
+            closeConnection(pDaemon, connection, true);
+        }
+    }
+    /* Armed again once the backlog is empty */
+    (void)watch(pDaemon, EPOLL_CTL_MOD, pDaemon->listener, &pDaemon->listener);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : serveConnection
+ * Inputs       : DATA_DAEMON* pDaemon - current daemon
+ *                CONNECTION* pConnection - readable connection
+ *                char* pBuffer - I/O buffer of the worker
+ * Outputs      :
+ * Description  : Writes what the client sent to its capture, at most
+ *                DAEMON_READS_PER_TURN buffers so that a fast client does not
+ *                starve the others. The capture is closed when the client closes
+ *                the connection. A failed capture closes the connection, so the
+ *                client sees its writes fail
+ -----------------------------------------------------------------------------------*/
+static void serveConnection(DATA_DAEMON* pDaemon, CONNECTION* pConnection, char* pBuffer)
+{
+    unsigned int turn;
+    pthread_mutex_lock(&pConnection->lock);
+    for(turn = 0; turn < DAEMON_READS_PER_TURN; turn++)
+    {
+        ssize_t received = recv(pConnection->fd, pBuffer, pDaemon->bufferSize, 0);
+        if(received > 0)
+        {
+            atomic_fetch_add(&pDaemon->bytes, (unsigned long long)received);
+            if(DataReader_StreamWrite(pConnection->stream, pBuffer, (unsigned int)received) != ERROR_NOERROR)
+            {
+                pthread_mutex_unlock(&pConnection->lock);
+                closeConnection(pDaemon, pConnection, true);
+                return;
+            }
+        }
+        else if(!received)
+        {
+            /* The client finished its capture */
+            pthread_mutex_unlock(&pConnection->lock);
+            closeConnection(pDaemon, pConnection, false);
+            return;
+        }
+        else if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        else if(errno != EINTR)
+        {
+            pthread_mutex_unlock(&pConnection->lock);
+            closeConnection(pDaemon, pConnection, true);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&pConnection->lock);
+    if(!watch(pDaemon, EPOLL_CTL_MOD, pConnection->fd, pConnection))
+    {
+        closeConnection(pDaemon, pConnection, true);
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : closeConnection
+ * Inputs       : DATA_DAEMON* pDaemon - current daemon
+ *                CONNECTION* pConnection - connection to be released
+ *                bool pFailed - the connection already failed
+ * Outputs      :
+ * Description  : Closes the capture and the socket and counts the result
+ -----------------------------------------------------------------------------------*/
+static void closeConnection(DATA_DAEMON* pDaemon, CONNECTION* pConnection, bool pFailed)
+{
+    pthread_mutex_lock(&pDaemon->lock);
+    if(pConnection->previous != NULL)
+    {
+        pConnection->previous->next = pConnection->next;
+    }
+    else
+    {
+        pDaemon->connections = pConnection->next;
+    }
+    if(pConnection->next != NULL)
+    {
+        pConnection->next->previous = pConnection->previous;
+    }
+    pthread_mutex_unlock(&pDaemon->lock);
+    /* Closing the descriptor also removes it from the poll set */
+    close(pConnection->fd);
+    pthread_mutex_lock(&pConnection->lock);
+    if((DataReader_StreamClose(pConnection->stream) != ERROR_NOERROR) || pFailed)
+    {
+        atomic_fetch_add(&pDaemon->failed, 1);
+    }
+    else
+    {
+        atomic_fetch_add(&pDaemon->completed, 1);
+    }
+    pthread_mutex_unlock(&pConnection->lock);
+    atomic_fetch_sub(&pDaemon->active, 1);
+    (void)pthread_mutex_destroy(&pConnection->lock);
+    free(pConnection);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : watch
+ * Inputs       : DATA_DAEMON* pDaemon - current daemon
+ *                int pOperation - EPOLL_CTL_ADD or EPOLL_CTL_MOD
+ *                int pFd - descriptor to be watched
+ *                void* pData - returned with its events
+ * Outputs      : True on success. False otherwise
+ * Description  : Arms a descriptor for one readable event. The stop event stays
+ *                armed so that it reaches every worker
+ -----------------------------------------------------------------------------------*/
+static bool watch(DATA_DAEMON* pDaemon, int pOperation, int pFd, void* pData)
+{
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = (pFd == pDaemon->stopEvent) ? EPOLLIN : (EPOLLIN | EPOLLRDHUP | EPOLLONESHOT);
+    event.data.ptr = pData;
+    return(epoll_ctl(pDaemon->poll, pOperation, pFd, &event) == 0);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : releaseDaemon
+ * Inputs       : DATA_DAEMON* pDaemon - daemon without running workers
+ * Outputs      :
+ * Description  : Closes the descriptors, removes the socket file and frees the
+ *                daemon
+ -----------------------------------------------------------------------------------*/
+static void releaseDaemon(DATA_DAEMON* pDaemon)
+{
+    if(pDaemon->listener >= 0)
+    {
+        close(pDaemon->listener);
+    }
+    if(strlen(pDaemon->socketPath))
+    {
+        (void)unlink(pDaemon->socketPath);
+    }
+    if(pDaemon->stopEvent >= 0)
+    {
+        close(pDaemon->stopEvent);
+    }
+    if(pDaemon->poll >= 0)
+    {
+        close(pDaemon->poll);
+    }
+    (void)pthread_mutex_destroy(&pDaemon->lock);
+    free(pDaemon->workers);
+    free(pDaemon);
+}
+#endif
+/*----------------------------------------------------------------------------------*/
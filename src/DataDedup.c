@@ -0,0 +1,741 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "DataDedup.h"
+#ifdef _WIN32
+#include <io.h>
+#include <direct.h>
+#include <process.h>
+#define DEDUP_FILE_MODE (_S_IREAD | _S_IWRITE)
+#define makeDirectory(pPath) _mkdir(pPath)
+#define fsync(pDescriptor) _commit(pDescriptor)
+#else
+#include <unistd.h>
+#define DEDUP_FILE_MODE 0644
+#define O_BINARY 0
+#define makeDirectory(pPath) mkdir(pPath, 0755)
+#define _getpid getpid
+#endif
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+/* Normalized chunking: cut points are harder to find before the average size and
+   easier after it, which narrows the spread of the chunk sizes. The masks use the
+   top bits of the gear hash, which depend on the last 64 bytes */
+#define GEAR_MASK_SMALL 0xFFFE000000000000ULL   /* 15 bits - before the average size */
+#define GEAR_MASK_LARGE 0xFFE0000000000000ULL   /* 11 bits - after the average size */
+#define GEAR_SEED 0x6A09E667F3BCC908ULL
+#define SHA256_BLOCK_SIZE 64
+#define ROTATE_RIGHT(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define DEDUP_LINE_LENGTH 128
+#define DEDUP_FANOUT_LENGTH 2
+/* Store path, fan-out directory and hash with their delimiters */
+#define DEDUP_CHUNK_PATH_LENGTH (MAX_FILEPATH_LENGTH + DEDUP_FANOUT_LENGTH + DEDUP_HASH_LENGTH + 8)
+#define DEDUP_TEMPORARY_SUFFIX_LENGTH 40
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Running SHA-256 of one chunk */
+typedef struct
+{
+    uint32_t state[8];
+    unsigned long long length;              /* Bytes hashed so far */
+    unsigned char block[SHA256_BLOCK_SIZE];
+    unsigned int fill;                      /* Bytes waiting in block */
+} SHA256_STATE;
+
+/*----------------------------------------------------------------------------------*/
+/* Static variables */
+static uint64_t fl_Gear[256];
+static pthread_once_t fl_Initialized = PTHREAD_ONCE_INIT;
+static atomic_uint fl_TemporarySequence = 0;
+static const uint32_t fl_Sha256Constants[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static void initialize(void);
+static size_t findCut(const unsigned char* pData, size_t pSize, size_t pFill, uint64_t* pHash, bool* pCut);
+static ERROR_TYPE emitChunk(DATA_WRITER* pWriter, const char* pStore, const unsigned char* pChunk,
+                            unsigned int pSize, DEDUP_STATS* pStats);
+static ERROR_TYPE storeChunk(const char* pStore, const char* pHash, const unsigned char* pChunk,
+                             unsigned int pSize, bool pSync, bool* pAdded);
+static bool writeFile(const char* pFile, const unsigned char* pData, unsigned int pSize, bool pSync);
+static bool syncPath(const char* pPath, bool pDirectory);
+static ERROR_TYPE readChunk(const char* pStore, const char* pHash, unsigned int pSize, unsigned char* pChunk);
+static void hashChunk(const unsigned char* pData, size_t pSize, char* pHex);
+static void sha256Init(SHA256_STATE* pState);
+static void sha256Update(SHA256_STATE* pState, const unsigned char* pData, size_t pSize);
+static void sha256Final(SHA256_STATE* pState, unsigned char* pDigest);
+static void sha256Transform(uint32_t* pState, const unsigned char* pBlock);
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataDedup_Copy(ENGINE_JOB* pJob, const char* pStore, unsigned long long pLimit,
+                          DEDUP_STATS* pStats)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    char line[DEDUP_LINE_LENGTH];
+    unsigned long long total = 0;
+    uint64_t hash = 0;
+    size_t fill = 0;
+    unsigned char* chunk;
+    char* readBuffer;
+    memset(pStats, 0, sizeof(DEDUP_STATS));
+    (void)pthread_once(&fl_Initialized, initialize);
+    if(strlen(pStore) >= MAX_FILEPATH_LENGTH)
+    {
+        return(ERROR_PATHTOOLONG);
+    }
+    if((makeDirectory(pStore) != 0) && (errno != EEXIST))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    chunk = malloc(DEDUP_MAX_CHUNK_SIZE);
+    readBuffer = DataEngine_AllocateBuffer(pJob->bufferSize);
+    if((chunk == NULL) || (readBuffer == NULL))
+    {
+        ret = ERROR_MEMORY_ALLOCATION;
+    }
+    else
+    {
+        sprintf(line, "%s\n", DEDUP_RECIPE_TITLE);
+        ret = DataWriter_Write(pJob->writer, line, strlen(line));
+    }
+    while(ret == ERROR_NOERROR)
+    {
+        const unsigned char* data = (const unsigned char*)readBuffer;
+        size_t readSize = DataEngine_Read(pJob, readBuffer, pJob->bufferSize);
+        if(!readSize)
+        {
+            /* File read completed */
+            break;
+        }
+        if(pLimit && ((total + readSize) > pLimit))
+        {
+            /* Input beyond the limit is dropped, as by a full output file */
+            readSize = (size_t)(pLimit - total);
+            ret = ERROR_FILE_SIZELIMIT_REACHED;
+        }
+        total = total + readSize;
+        pStats->inputBytes = total;
+        /* Chunks may span reads. The open chunk is collected in its own buffer */
+        while(readSize)
+        {
+            bool cut = false;
+            size_t used = findCut(data, readSize, fill, &hash, &cut);
+            memcpy(chunk + fill, data, used);
+            fill = fill + used;
+            data = data + used;
+            readSize = readSize - used;
+            if(cut)
+            {
+                ERROR_TYPE emitted = emitChunk(pJob->writer, pStore, chunk, (unsigned int)fill, pStats);
+                if(emitted != ERROR_NOERROR)
+                {
+                    ret = emitted;
+                    break;
+                }
+                fill = 0;
+                hash = 0;
+            }
+        }
+    }
+    if(((ret == ERROR_NOERROR) || (ret == ERROR_FILE_SIZELIMIT_REACHED)) && fill)
+    {
+        /* Last chunk ends with the input */
+        ERROR_TYPE emitted = emitChunk(pJob->writer, pStore, chunk, (unsigned int)fill, pStats);
+        if(emitted != ERROR_NOERROR)
+        {
+            ret = emitted;
+        }
+    }
+    if((ret == ERROR_NOERROR) || (ret == ERROR_FILE_SIZELIMIT_REACHED))
+    {
+        /* The size line marks a complete recipe */
+        ERROR_TYPE written;
+        sprintf(line, "size %llu\n", total);
+        written = DataWriter_Write(pJob->writer, line, strlen(line));
+        if(written != ERROR_NOERROR)
+        {
+            ret = written;
+        }
+    }
+    free(chunk);
+    DataEngine_FreeBuffer(readBuffer);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataDedup_Restore(const char* pRecipe, const char* pOutput, unsigned long long* pSize)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    char store[MAX_FILEPATH_LENGTH + sizeof(DEDUP_STORE_DIRECTORY)] = { NULL_CHARACTER };
+    char line[DEDUP_LINE_LENGTH];
+    unsigned long long total = 0;
+    unsigned long long size = 0;
+    bool complete = false;
+    unsigned char* chunk;
+    const char* name;
+    FILE* recipe;
+    FILE* output = NULL;
+    int descriptor;
+    if((strlen(pRecipe) >= MAX_FILEPATH_LENGTH) || (strlen(pOutput) >= MAX_FILEPATH_LENGTH))
+    {
+        return(ERROR_PATHTOOLONG);
+    }
+    /* The store is next to the recipe */
+    name = strrchr(pRecipe, PATH_DELIMITER);
+#ifdef _WIN32
+    if((name == NULL) || (strrchr(pRecipe, '/') > name))
+    {
+        name = strrchr(pRecipe, '/');
+    }
+#endif
+    if(name != NULL)
+    {
+        memcpy(store, pRecipe, name - pRecipe + 1);
+    }
+    strcat(store, DEDUP_STORE_DIRECTORY);
+    recipe = fopen(pRecipe, "r");
+    if(recipe == NULL)
+    {
+        return(ERROR_READ_FILEOPEN);
+    }
+    if((fgets(line, sizeof(line), recipe) == NULL) || strncmp(line, DEDUP_RECIPE_TITLE, strlen(DEDUP_RECIPE_TITLE)))
+    {
+        fclose(recipe);
+        return(ERROR_IO_FAILED);
+    }
+    /* The output is created exclusively, so an existing file is never overwritten */
+    descriptor = open(pOutput, O_WRONLY | O_CREAT | O_EXCL | O_BINARY, DEDUP_FILE_MODE);
+    if(descriptor >= 0)
+    {
+        output = fdopen(descriptor, "wb");
+        if(output == NULL)
+        {
+            close(descriptor);
+        }
+    }
+    chunk = malloc(DEDUP_MAX_CHUNK_SIZE);
+    if(output == NULL)
+    {
+        ret = ERROR_WRITE_FILEOPEN;
+    }
+    else if(chunk == NULL)
+    {
+        ret = ERROR_MEMORY_ALLOCATION;
+    }
+    while((ret == ERROR_NOERROR) && !complete && (fgets(line, sizeof(line), recipe) != NULL))
+    {
+        char hash[DEDUP_HASH_LENGTH + 1];
+        unsigned int chunkSize;
+        if(sscanf(line, "chunk %64s %u", hash, &chunkSize) == 2)
+        {
+            if((strlen(hash) != DEDUP_HASH_LENGTH) || !chunkSize || (chunkSize > DEDUP_MAX_CHUNK_SIZE))
+            {
+                ret = ERROR_IO_FAILED;
+                break;
+            }
+            ret = readChunk(store, hash, chunkSize, chunk);
+            if((ret == ERROR_NOERROR) && (fwrite(chunk, sizeof(char), chunkSize, output) != chunkSize))
+            {
+                ret = ERROR_IO_FAILED;
+            }
+            total = total + chunkSize;
+        }
+        else if(sscanf(line, "size %llu", &size) == 1)
+        {
+            complete = true;
+        }
+        else
+        {
+            ret = ERROR_IO_FAILED;
+        }
+    }
+    /* A recipe cut before its size line is incomplete */
+    if((ret == ERROR_NOERROR) && (!complete || (size != total)))
+    {
+        ret = ERROR_IO_FAILED;
+    }
+    if(output != NULL)
+    {
+        if((fclose(output) != 0) && (ret == ERROR_NOERROR))
+        {
+            ret = ERROR_IO_FAILED;
+        }
+        if(ret != ERROR_NOERROR)
+        {
+            remove(pOutput);
+        }
+    }
+    if(pSize != NULL)
+    {
+        *pSize = total;
+    }
+    fclose(recipe);
+    free(chunk);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : initialize
+ * Inputs       :
+ * Outputs      :
+ * Description  : Fills the gear table with fixed pseudo random values. The values
+ *                must never change, or the chunks of new captures would no longer
+ *                match the chunks in existing stores
+ -----------------------------------------------------------------------------------*/
+static void initialize(void)
+{
+    uint64_t seed = GEAR_SEED;
+    unsigned int i;
+    for(i = 0; i < 256; i++)
+    {
+        /* splitmix64 */
+        uint64_t value;
+        seed = seed + 0x9E3779B97F4A7C15ULL;
+        value = seed;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        fl_Gear[i] = value ^ (value >> 31);
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : findCut
+ * Inputs       : const unsigned char* pData - input following the open chunk
+ *                size_t pSize - size of the input in bytes
+ *                size_t pFill - bytes already in the open chunk
+ *                uint64_t* pHash - gear hash of the open chunk. 0 for a new chunk
+ *                bool* pCut - Set if the chunk ends within the returned bytes
+ * Outputs      : Number of input bytes belonging to the open chunk
+ * Description  : Gear rolling hash with normalized chunking. The first
+ *                DEDUP_MIN_CHUNK_SIZE bytes of a chunk are not hashed, and a chunk
+ *                is cut at DEDUP_MAX_CHUNK_SIZE if no cut point was found
+ -----------------------------------------------------------------------------------*/
+static size_t findCut(const unsigned char* pData, size_t pSize, size_t pFill, uint64_t* pHash, bool* pCut)
+{
+    uint64_t hash = *pHash;
+    size_t limit = DEDUP_MAX_CHUNK_SIZE - pFill;
+    size_t normal = pFill < DEDUP_AVERAGE_CHUNK_SIZE ? DEDUP_AVERAGE_CHUNK_SIZE - pFill : 0;
+    size_t i = pFill < DEDUP_MIN_CHUNK_SIZE ? DEDUP_MIN_CHUNK_SIZE - pFill : 0;
+    if(limit > pSize)
+    {
+        limit = pSize;
+    }
+    if(normal > limit)
+    {
+        normal = limit;
+    }
+    /* Before the average size */
+    for(; i < normal; i++)
+    {
+        hash = (hash << 1) + fl_Gear[pData[i]];
+        if(!(hash & GEAR_MASK_SMALL))
+        {
+            *pHash = hash;
+            *pCut = true;
+            return(i + 1);
+        }
+    }
+    /* After the average size */
+    for(; i < limit; i++)
+    {
+        hash = (hash << 1) + fl_Gear[pData[i]];
+        if(!(hash & GEAR_MASK_LARGE))
+        {
+            *pHash = hash;
+            *pCut = true;
+            return(i + 1);
+        }
+    }
+    *pHash = hash;
+    *pCut = ((pFill + limit) == DEDUP_MAX_CHUNK_SIZE);
+    return(limit);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : emitChunk
+ * Inputs       : DATA_WRITER* pWriter - receives the recipe line
+ *                const char* pStore - directory of the chunk store
+ *                const unsigned char* pChunk - complete chunk
+ *                unsigned int pSize - size of the chunk in bytes
+ *                DEDUP_STATS* pStats - chunk counters to be updated
+ * Outputs      : ERROR_NOERROR, or the error of the store or of the writer
+ * Description  : Stores the chunk if it is new and lists it in the recipe
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE emitChunk(DATA_WRITER* pWriter, const char* pStore, const unsigned char* pChunk,
+                            unsigned int pSize, DEDUP_STATS* pStats)
+{
+    char hash[DEDUP_HASH_LENGTH + 1];
+    char line[DEDUP_LINE_LENGTH];
+    bool added = false;
+    ERROR_TYPE ret;
+    hashChunk(pChunk, pSize, hash);
+    ret = storeChunk(pStore, hash, pChunk, pSize, pWriter->durability != DURABILITY_NONE, &added);
+    if(ret != ERROR_NOERROR)
+    {
+        return(ret);
+    }
+    pStats->chunks++;
+    if(added)
+    {
+        pStats->newChunks++;
+        pStats->storedBytes = pStats->storedBytes + pSize;
+    }
+    sprintf(line, "chunk %s %u\n", hash, pSize);
+    return(DataWriter_Write(pWriter, line, strlen(line)));
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : storeChunk
+ * Inputs       : const char* pStore - directory of the chunk store
+ *                const char* pHash - hash of the chunk in hex
+ *                const unsigned char* pChunk - chunk data
+ *                unsigned int pSize - size of the chunk in bytes
+ *                bool pSync - Set if the chunk must be on the device before it is
+ *                             listed in the recipe
+ *                bool* pAdded - Set if the chunk was not in the store
+ * Outputs      : ERROR_NOERROR, or ERROR_IO_FAILED if the chunk cannot be stored
+ * Description  : Chunks are written to a temporary file that is renamed into
+ *                place, so a reader never sees a partial chunk. Captures storing
+ *                the same chunk at the same time write identical files, so the
+ *                rename losing the race is harmless. With pSync the chunk and the
+ *                directory entries leading to it are synced, so a synced recipe
+ *                never lists a chunk lost by a crash
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE storeChunk(const char* pStore, const char* pHash, const unsigned char* pChunk,
+                             unsigned int pSize, bool pSync, bool* pAdded)
+{
+    char chunkFile[DEDUP_CHUNK_PATH_LENGTH];
+    char temporaryFile[DEDUP_CHUNK_PATH_LENGTH + DEDUP_TEMPORARY_SUFFIX_LENGTH];
+    struct stat stored;
+    bool created = false;
+    int length = sprintf(chunkFile, "%s%c%.*s", pStore, PATH_DELIMITER, DEDUP_FANOUT_LENGTH, pHash);
+    sprintf(chunkFile + length, "%c%s", PATH_DELIMITER, pHash);
+    if(stat(chunkFile, &stored) == 0)
+    {
+        /* The chunk may come from a capture that did not sync it */
+        if(pSync && !syncPath(chunkFile, false))
+        {
+            return(ERROR_IO_FAILED);
+        }
+        chunkFile[length] = NULL_CHARACTER;
+        return((pSync && !syncPath(chunkFile, true)) ? ERROR_IO_FAILED : ERROR_NOERROR);
+    }
+    /* Fan-out directory keeps the directories of large stores small */
+    chunkFile[length] = NULL_CHARACTER;
+    if(makeDirectory(chunkFile) == 0)
+    {
+        created = true;
+    }
+    else if(errno != EEXIST)
+    {
+        return(ERROR_IO_FAILED);
+    }
+    if(created && pSync && !syncPath(pStore, true))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    chunkFile[length] = PATH_DELIMITER;
+    sprintf(temporaryFile, "%s.%lu_%u.tmp", chunkFile, (unsigned long)_getpid(),
+            atomic_fetch_add(&fl_TemporarySequence, 1));
+    if(!writeFile(temporaryFile, pChunk, pSize, pSync))
+    {
+        remove(temporaryFile);
+        return(ERROR_IO_FAILED);
+    }
+    if(rename(temporaryFile, chunkFile) != 0)
+    {
+        /* Rename does not replace an existing file on all platforms */
+        remove(temporaryFile);
+        if(stat(chunkFile, &stored) != 0)
+        {
+            return(ERROR_IO_FAILED);
+        }
+    }
+    else
+    {
+        *pAdded = true;
+    }
+    chunkFile[length] = NULL_CHARACTER;
+    if(pSync && !syncPath(chunkFile, true))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    return(ERROR_NOERROR);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : writeFile
+ * Inputs       : const char* pFile - path of the file. Created exclusively
+ *                const unsigned char* pData - content of the file
+ *                unsigned int pSize - size of the content in bytes
+ *                bool pSync - Set if the file must be on the device when closed
+ * Outputs      : True if the file is complete. False on failure
+ * Description  : Writes a whole file in one call
+ -----------------------------------------------------------------------------------*/
+static bool writeFile(const char* pFile, const unsigned char* pData, unsigned int pSize, bool pSync)
+{
+    bool written;
+    FILE* output;
+    int descriptor = open(pFile, O_WRONLY | O_CREAT | O_EXCL | O_BINARY, DEDUP_FILE_MODE);
+    if(descriptor < 0)
+    {
+        return false;
+    }
+    output = fdopen(descriptor, "wb");
+    if(output == NULL)
+    {
+        close(descriptor);
+        return false;
+    }
+    written = (fwrite(pData, sizeof(char), pSize, output) == pSize);
+    if(written && pSync)
+    {
+        written = (fflush(output) == 0) && (fsync(descriptor) == 0);
+    }
+    written = (fclose(output) == 0) && written;
+    return written;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : syncPath
+ * Inputs       : const char* pPath - path of the file or directory
+ *                bool pDirectory - Set if the path is a directory
+ * Outputs      : True if the path is on the device. False on failure
+ * Description  : Syncs an existing file, or a directory so that its entries
+ *                survive a crash. Directories cannot be opened on Windows, where
+ *                the file system journals their entries itself
+ -----------------------------------------------------------------------------------*/
+static bool syncPath(const char* pPath, bool pDirectory)
+{
+    bool synced;
+    int descriptor;
+#ifdef _WIN32
+    if(pDirectory)
+    {
+        return true;
+    }
+    descriptor = open(pPath, O_RDWR | O_BINARY);
+#else
+    (void)pDirectory;
+    descriptor = open(pPath, O_RDONLY);
+#endif
+    if(descriptor < 0)
+    {
+        return false;
+    }
+    synced = (fsync(descriptor) == 0);
+    synced = (close(descriptor) == 0) && synced;
+    return synced;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : readChunk
+ * Inputs       : const char* pStore - directory of the chunk store
+ *                const char* pHash - hash of the chunk in hex
+ *                unsigned int pSize - size of the chunk in bytes
+ *                unsigned char* pChunk - receives the chunk
+ * Outputs      : ERROR_NOERROR - chunk read and verified
+ *                ERROR_READ_FILEOPEN - chunk is missing from the store
+ *                ERROR_CHECKSUM_MISMATCH - chunk differs from its hash or size
+ * Description  : Reads one chunk from the store and checks it against its hash
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE readChunk(const char* pStore, const char* pHash, unsigned int pSize, unsigned char* pChunk)
+{
+    char chunkFile[DEDUP_CHUNK_PATH_LENGTH];
+    char hash[DEDUP_HASH_LENGTH + 1];
+    size_t read;
+    FILE* input;
+    sprintf(chunkFile, "%s%c%.*s%c%s", pStore, PATH_DELIMITER, DEDUP_FANOUT_LENGTH, pHash, PATH_DELIMITER, pHash);
+    input = fopen(chunkFile, "rb");
+    if(input == NULL)
+    {
+        return(ERROR_READ_FILEOPEN);
+    }
+    /* One byte more than expected detects a longer file */
+    read = fread(pChunk, sizeof(char), pSize, input);
+    if((read == pSize) && (fgetc(input) != EOF))
+    {
+        read++;
+    }
+    fclose(input);
+    if(read != pSize)
+    {
+        return(ERROR_CHECKSUM_MISMATCH);
+    }
+    hashChunk(pChunk, pSize, hash);
+    return(strcmp(hash, pHash) ? ERROR_CHECKSUM_MISMATCH : ERROR_NOERROR);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : hashChunk
+ * Inputs       : const unsigned char* pData - chunk data
+ *                size_t pSize - size of the chunk in bytes
+ *                char* pHex - receives the SHA-256 of the chunk in lower case hex
+ * Outputs      :
+ * Description  : Names a chunk in the store
+ -----------------------------------------------------------------------------------*/
+static void hashChunk(const unsigned char* pData, size_t pSize, char* pHex)
+{
+    static const char digits[] = "0123456789abcdef";
+    unsigned char digest[DEDUP_HASH_SIZE];
+    SHA256_STATE state;
+    unsigned int i;
+    sha256Init(&state);
+    sha256Update(&state, pData, pSize);
+    sha256Final(&state, digest);
+    for(i = 0; i < DEDUP_HASH_SIZE; i++)
+    {
+        pHex[i * 2] = digits[digest[i] >> 4];
+        pHex[i * 2 + 1] = digits[digest[i] & 0x0F];
+    }
+    pHex[DEDUP_HASH_LENGTH] = NULL_CHARACTER;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : sha256Init
+ * Inputs       : SHA256_STATE* pState - hash to be started
+ * Outputs      :
+ * Description  : Loads the initial hash values of FIPS 180-4
+ -----------------------------------------------------------------------------------*/
+static void sha256Init(SHA256_STATE* pState)
+{
+    static const uint32_t initial[8] =
+    {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(pState->state, initial, sizeof(initial));
+    pState->length = 0;
+    pState->fill = 0;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : sha256Update
+ * Inputs       : SHA256_STATE* pState - running hash
+ *                const unsigned char* pData - data to be added
+ *                size_t pSize - size of the data in bytes
+ * Outputs      :
+ * Description  : Hashes whole blocks straight from the data and keeps the rest
+ -----------------------------------------------------------------------------------*/
+static void sha256Update(SHA256_STATE* pState, const unsigned char* pData, size_t pSize)
+{
+    pState->length = pState->length + pSize;
+    if(pState->fill)
+    {
+        size_t size = SHA256_BLOCK_SIZE - pState->fill;
+        if(size > pSize)
+        {
+            size = pSize;
+        }
+        memcpy(pState->block + pState->fill, pData, size);
+        pState->fill = pState->fill + size;
+        pData = pData + size;
+        pSize = pSize - size;
+        if(pState->fill < SHA256_BLOCK_SIZE)
+        {
+            return;
+        }
+        sha256Transform(pState->state, pState->block);
+        pState->fill = 0;
+    }
+    while(pSize >= SHA256_BLOCK_SIZE)
+    {
+        sha256Transform(pState->state, pData);
+        pData = pData + SHA256_BLOCK_SIZE;
+        pSize = pSize - SHA256_BLOCK_SIZE;
+    }
+    memcpy(pState->block, pData, pSize);
+    pState->fill = pSize;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : sha256Final
+ * Inputs       : SHA256_STATE* pState - running hash
+ *                unsigned char* pDigest - receives the DEDUP_HASH_SIZE byte digest
+ * Outputs      :
+ * Description  : Adds the padding and the bit length and stores the digest
+ -----------------------------------------------------------------------------------*/
+static void sha256Final(SHA256_STATE* pState, unsigned char* pDigest)
+{
+    unsigned long long bits = pState->length * 8;
+    unsigned int i;
+    pState->block[pState->fill++] = 0x80;
+    if(pState->fill > (SHA256_BLOCK_SIZE - 8))
+    {
+        memset(pState->block + pState->fill, 0, SHA256_BLOCK_SIZE - pState->fill);
+        sha256Transform(pState->state, pState->block);
+        pState->fill = 0;
+    }
+    memset(pState->block + pState->fill, 0, SHA256_BLOCK_SIZE - 8 - pState->fill);
+    for(i = 0; i < 8; i++)
+    {
+        pState->block[SHA256_BLOCK_SIZE - 1 - i] = (unsigned char)(bits >> (i * 8));
+    }
+    sha256Transform(pState->state, pState->block);
+    for(i = 0; i < 8; i++)
+    {
+        pDigest[i * 4] = (unsigned char)(pState->state[i] >> 24);
+        pDigest[i * 4 + 1] = (unsigned char)(pState->state[i] >> 16);
+        pDigest[i * 4 + 2] = (unsigned char)(pState->state[i] >> 8);
+        pDigest[i * 4 + 3] = (unsigned char)pState->state[i];
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : sha256Transform
+ * Inputs       : uint32_t* pState - hash values to be updated
+ *                const unsigned char* pBlock - SHA256_BLOCK_SIZE bytes of data
+ * Outputs      :
+ * Description  : SHA-256 compression function for one block
+ -----------------------------------------------------------------------------------*/
+static void sha256Transform(uint32_t* pState, const unsigned char* pBlock)
+{
+    uint32_t w[64];
+    uint32_t a = pState[0], b = pState[1], c = pState[2], d = pState[3];
+    uint32_t e = pState[4], f = pState[5], g = pState[6], h = pState[7];
+    unsigned int i;
+    for(i = 0; i < 16; i++)
+    {
+        w[i] = ((uint32_t)pBlock[i * 4] << 24) | ((uint32_t)pBlock[i * 4 + 1] << 16) |
+               ((uint32_t)pBlock[i * 4 + 2] << 8) | (uint32_t)pBlock[i * 4 + 3];
+    }
+    for(i = 16; i < 64; i++)
+    {
+        uint32_t s0 = ROTATE_RIGHT(w[i - 15], 7) ^ ROTATE_RIGHT(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROTATE_RIGHT(w[i - 2], 17) ^ ROTATE_RIGHT(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    for(i = 0; i < 64; i++)
+    {
+        uint32_t s1 = ROTATE_RIGHT(e, 6) ^ ROTATE_RIGHT(e, 11) ^ ROTATE_RIGHT(e, 25);
+        uint32_t choose = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + choose + fl_Sha256Constants[i] + w[i];
+        uint32_t s0 = ROTATE_RIGHT(a, 2) ^ ROTATE_RIGHT(a, 13) ^ ROTATE_RIGHT(a, 22);
+        uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + majority;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    pState[0] += a;
+    pState[1] += b;
+    pState[2] += c;
+    pState[3] += d;
+    pState[4] += e;
+    pState[5] += f;
+    pState[6] += g;
+    pState[7] += h;
+}
+/*----------------------------------------------------------------------------------*/
@@ -0,0 +1,430 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#ifdef __linux__
+/* Required for copy_file_range and splice. Must precede all system headers */
+#define _GNU_SOURCE
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include "DataEngine.h"
+#include "DataStats.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define SPLICE_PIPE_SIZE (1024 * 1024)
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+#ifdef __linux__
+/* Kernel copy methods in the order they are attempted */
+typedef enum
+{
+    KERNEL_METHOD_COPY_FILE_RANGE = 0,
+    KERNEL_METHOD_SENDFILE,
+    KERNEL_METHOD_SPLICE,
+    KERNEL_METHOD_MAX /*This item should always be at the end*/
+} KERNEL_METHOD;
+#endif
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+#ifdef __linux__
+static long bufferedInputSize(FILE* pStream);
+static ERROR_TYPE drainBufferedInput(ENGINE_JOB* pJob, unsigned int pSize);
+static ssize_t kernelCopyChunk(KERNEL_METHOD pMethod, int pInput, int pOutput, size_t pSize, int* pPipe);
+static bool isMethodUnsupported(int pError);
+static bool hasMoreInput(int pInput);
+#endif
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataEngine_StdioCopy(ENGINE_JOB* pJob)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    bool running = true;
+    /* Data is copied through a single page aligned heap buffer */
+    char* readBuffer = DataEngine_AllocateBuffer(pJob->bufferSize);
+    if(readBuffer == NULL)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    /* Read until end of input */
+    while(running)
+    {
+        unsigned int readSize = DataEngine_Read(pJob, readBuffer, pJob->bufferSize);
+        if(readSize)
+        {
+            ret = DataWriter_Write(pJob->writer, readBuffer, readSize);
+            if(ret != ERROR_NOERROR)
+            {
+                running = false;
+            }
+        }
+        else
+        {
+            /* File read completed */
+            running = false;
+        }
+    }
+    DataEngine_FreeBuffer(readBuffer);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataEngine_KernelCopy(ENGINE_JOB* pJob)
+{
+#ifdef __linux__
+    ERROR_TYPE ret = ERROR_NOERROR;
+    KERNEL_METHOD method = KERNEL_METHOD_COPY_FILE_RANGE;
+    int pipeFds[2] = { -1, -1 };
+    int input = fileno(pJob->input);
+    bool running = true;
+    /* Bytes already read ahead by stdio are not visible through the descriptor */
+    long buffered = bufferedInputSize(pJob->input);
+    if(buffered < 0)
+    {
+        return(DataEngine_StdioCopy(pJob));
+    }
+    ret = drainBufferedInput(pJob, (unsigned int)buffered);
+    while(running && (ret == ERROR_NOERROR))
+    {
+        unsigned long long remaining = DataWriter_Space(pJob->writer);
+        size_t chunk = remaining < KERNEL_COPY_CHUNK_SIZE ? (size_t)remaining : KERNEL_COPY_CHUNK_SIZE;
+        if(chunk == 0)
+        {
+            if(pJob->writer->rotate)
+            {
+                /* Continue in the next segment */
+                ret = DataWriter_Rotate(pJob->writer);
+            }
+            else
+            {
+                /* File size limit reached. Stop if there is more data to read */
+                if(hasMoreInput(input))
+                {
+                    ret = ERROR_FILE_SIZELIMIT_REACHED;
+                }
+                running = false;
+            }
+        }
+        else if(method == KERNEL_METHOD_MAX)
+        {
+            /* No kernel method supports this pair of files. Finish in user space */
+            ret = DataEngine_StdioCopy(pJob);
+            running = false;
+        }
+        else
+        {
+            int output = DataWriter_Descriptor(pJob->writer);
+            unsigned long long start = DataStats_Now();
+            ssize_t copied = kernelCopyChunk(method, input, output, chunk, pipeFds);
+            if(copied > 0)
+            {
+                /* Both a read and a write of the capture */
+                DataStats_RecordRead(pJob->stats, start, (unsigned long long)copied);
+                DataStats_RecordWrite(pJob->stats, start, (unsigned long long)copied);
+                DataWriter_Commit(pJob->writer, (unsigned int)copied);
+            }
+            else if(copied == 0)
+            {
+                /* copy_file_range reports 0 for some pseudo files. Let the next
+                   method confirm the end of input */
+                if(method == KERNEL_METHOD_COPY_FILE_RANGE)
+                {
+                    method++;
+                }
+                else
+                {
+                    /* File read completed */
+                    running = false;
+                }
+            }
+            else if(errno == EINTR)
+            {
+                /* Interrupted before any data was moved. Retry */
+            }
+            else if(isMethodUnsupported(errno))
+            {
+                /* Offsets are unchanged. Continue with the next method */
+                method++;
+            }
+            else
+            {
+                ret = ERROR_IO_FAILED;
+                running = false;
+            }
+        }
+    }
+    if(pipeFds[0] != -1)
+    {
+        close(pipeFds[0]);
+        close(pipeFds[1]);
+    }
+    return(ret);
+#else
+    /* Kernel side copy is not available on this platform */
+    return(DataEngine_StdioCopy(pJob));
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataEngine_MmapCopy(ENGINE_JOB* pJob)
+{
+#ifndef _WIN32
+    ERROR_TYPE ret = ERROR_NOERROR;
+    struct stat inputStat;
+    off_t offset;
+    long pageSize = sysconf(_SC_PAGESIZE);
+    int input = fileno(pJob->input);
+    /* Only regular files can be mapped */
+    if((fstat(input, &inputStat) != 0) || !S_ISREG(inputStat.st_mode))
+    {
+        return(DataEngine_StdioCopy(pJob));
+    }
+    /* ftello accounts for data already read ahead by stdio */
+    offset = ftello(pJob->input);
+    if(offset < 0)
+    {
+        return(DataEngine_StdioCopy(pJob));
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    (void)posix_fadvise(input, offset, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    /* Snapshot of the size. Truncating the input while it is mapped is not
+       supported and raises SIGBUS */
+    while((ret == ERROR_NOERROR) && (offset < inputStat.st_size))
+    {
+        /* Windows start on a page boundary */
+        off_t windowStart = offset - (offset % pageSize);
+        size_t windowSize = MMAP_WINDOW_SIZE;
+        size_t skip = (size_t)(offset - windowStart);
+        char* window;
+        if((off_t)windowSize > (inputStat.st_size - windowStart))
+        {
+            windowSize = (size_t)(inputStat.st_size - windowStart);
+        }
+        unsigned long long start = DataStats_Now();
+        window = mmap(NULL, windowSize, PROT_READ, MAP_SHARED, input, windowStart);
+        if(window == MAP_FAILED)
+        {
+            ret = ERROR_IO_FAILED;
+        }
+        else
+        {
+            (void)posix_madvise(window, windowSize, POSIX_MADV_SEQUENTIAL);
+            (void)posix_madvise(window, windowSize, POSIX_MADV_WILLNEED);
+            /* The pages are read on access. The read is the mapping of the window */
+            DataStats_RecordRead(pJob->stats, start, windowSize - skip);
+            /* Write directly from the mapping */
+            ret = DataWriter_Write(pJob->writer, window + skip, (unsigned int)(windowSize - skip));
+            (void)munmap(window, windowSize);
+            offset = windowStart + windowSize;
+        }
+    }
+    /* Leave the stream positioned after the data that was copied */
+    (void)fseeko(pJob->input, offset, SEEK_SET);
+    return(ret);
+#else
+    /* Memory mapped copy is not available on this platform */
+    return(DataEngine_StdioCopy(pJob));
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+unsigned int DataEngine_Read(ENGINE_JOB* pJob, char* pBuffer, unsigned int pSize)
+{
+    unsigned long long start = DataStats_Now();
+    unsigned int readSize = (unsigned int)fread(pBuffer, sizeof(char), pSize, pJob->input);
+    DataStats_RecordRead(pJob->stats, start, readSize);
+    return readSize;
+}
+/*----------------------------------------------------------------------------------*/
+char* DataEngine_AllocateBuffer(unsigned int pSize)
+{
+    void* buffer = NULL;
+#ifdef _WIN32
+    buffer = _aligned_malloc(pSize, BUFFER_ALIGNMENT);
+#else
+    if(posix_memalign(&buffer, BUFFER_ALIGNMENT, pSize))
+    {
+        buffer = NULL;
+    }
+#endif
+    return (char*)buffer;
+}
+/*----------------------------------------------------------------------------------*/
+void DataEngine_FreeBuffer(char* pBuffer)
+{
+#ifdef _WIN32
+    _aligned_free(pBuffer);
+#else
+    free(pBuffer);
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+unsigned int DataEngine_GetCoreCount(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return(info.dwNumberOfProcessors ? (unsigned int)info.dwNumberOfProcessors : 1);
+#else
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return(cores > 0 ? (unsigned int)cores : 1);
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+#ifdef __linux__
+/*-----------------------------------------------------------------------------------
+ * Name         : bufferedInputSize
+ * Inputs       : FILE* pStream - input stream
+ * Outputs      : Number of bytes read ahead into the stdio buffer. -1 if unknown
+ * Description  : stdin may already have been read through stdio (e.g. scanf of
+ *                the menu choice). Those bytes have to be copied before the
+ *                descriptor is used directly
+ -----------------------------------------------------------------------------------*/
+static long bufferedInputSize(FILE* pStream)
+{
+#ifdef __GLIBC__
+    return (long)(pStream->_IO_read_end - pStream->_IO_read_ptr);
+#else
+    /* Files opened by DataReader_ReadData have not been read yet */
+    return (pStream == stdin) ? -1 : 0;
+#endif
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : drainBufferedInput
+ * Inputs       : ENGINE_JOB* pJob - current copy
+ *                unsigned int pSize - number of bytes held in the stdio buffer
+ * Outputs      : ERROR_TYPE of the write
+ * Description  : Moves the data held in the stdio input buffer to the output
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE drainBufferedInput(ENGINE_JOB* pJob, unsigned int pSize)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    if(pSize)
+    {
+        char* buffer = malloc(pSize);
+        if(buffer == NULL)
+        {
+            return(ERROR_MEMORY_ALLOCATION);
+        }
+        /* Served from the stdio buffer without another read */
+        pSize = DataEngine_Read(pJob, buffer, pSize);
+        ret = DataWriter_Write(pJob->writer, buffer, pSize);
+        free(buffer);
+    }
+    return(ret);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : kernelCopyChunk
+ * Inputs       : KERNEL_METHOD pMethod - kernel copy method to use
+ *                int pInput - input descriptor
+ *                int pOutput - output descriptor
+ *                size_t pSize - maximum number of bytes to copy
+ *                int* pPipe - intermediate pipe for splice. Created on first use
+ * Outputs      : Number of bytes copied. 0 at end of input. -1 on error (errno)
+ * Description  : Copies one chunk from the input to the output inside the kernel
+ *                using the current file offsets of both descriptors
+ -----------------------------------------------------------------------------------*/
+static ssize_t kernelCopyChunk(KERNEL_METHOD pMethod, int pInput, int pOutput, size_t pSize, int* pPipe)
+{
+    struct stat inputStat;
+    ssize_t copied = -1;
+    switch(pMethod)
+    {
+    case KERNEL_METHOD_COPY_FILE_RANGE:
+        copied = copy_file_range(pInput, NULL, pOutput, NULL, pSize, 0);
+        break;
+
+    case KERNEL_METHOD_SENDFILE:
+        copied = sendfile(pOutput, pInput, NULL, pSize);
+        break;
+
+    case KERNEL_METHOD_SPLICE:
+        if((fstat(pInput, &inputStat) == 0) && S_ISFIFO(inputStat.st_mode))
+        {
+            /* Pipe input can be spliced straight into the output */
+            copied = splice(pInput, NULL, pOutput, NULL, pSize, SPLICE_F_MOVE | SPLICE_F_MORE);
+        }
+        else
+        {
+            ssize_t pending;
+            /* Otherwise route the pages through an intermediate pipe */
+            if((pPipe[0] == -1) && (pipe(pPipe) == 0))
+            {
+                (void)fcntl(pPipe[1], F_SETPIPE_SZ, SPLICE_PIPE_SIZE);
+            }
+            if(pPipe[0] == -1)
+            {
+                return(-1);
+            }
+            copied = splice(pInput, NULL, pPipe[1], NULL, pSize, SPLICE_F_MOVE | SPLICE_F_MORE);
+            pending = copied;
+            while(pending > 0)
+            {
+                ssize_t moved = splice(pPipe[0], NULL, pOutput, NULL, pending, SPLICE_F_MOVE | SPLICE_F_MORE);
+                if(moved > 0)
+                {
+                    pending = pending - moved;
+                }
+                else if((moved < 0) && (errno == EINTR))
+                {
+                    /* Retry */
+                }
+                else
+                {
+                    /* Data is stuck in the pipe. Cannot be recovered */
+                    errno = EIO;
+                    return(-1);
+                }
+            }
+        }
+        break;
+
+    default:
+        errno = ENOSYS;
+        break;
+    }
+    return(copied);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : isMethodUnsupported
+ * Inputs       : int pError - errno reported by the kernel copy call
+ * Outputs      : True if the error means the method cannot handle these files
+ * Description  : Separates "not supported here" errors, which fall back to the next
+ *                method, from real I/O errors
+ -----------------------------------------------------------------------------------*/
+static bool isMethodUnsupported(int pError)
+{
+    return((pError == ENOSYS) || (pError == EXDEV) || (pError == EINVAL) ||
+           (pError == EOPNOTSUPP) || (pError == EBADF) || (pError == ESPIPE));
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : hasMoreInput
+ * Inputs       : int pInput - input descriptor
+ * Outputs      : True if at least one more byte could be read
+ * Description  : Probes the input once the output is full. The probed byte is
+ *                discarded, matching the stdio path which drops the excess chunk
+ -----------------------------------------------------------------------------------*/
+static bool hasMoreInput(int pInput)
+{
+    char probe;
+    ssize_t readSize;
+    do
+    {
+        readSize = read(pInput, &probe, sizeof(probe));
+    } while((readSize < 0) && (errno == EINTR));
+    return(readSize > 0);
+}
+#endif
+/*----------------------------------------------------------------------------------*/
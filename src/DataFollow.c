@@ -0,0 +1,458 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#ifdef __linux__
+/* Required for pread and sigtimedwait. Must precede all system headers */
+#define _GNU_SOURCE
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "DataFollow.h"
+#include "DataEngine.h"
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Followed file, its watches and the capture of its data */
+struct DATA_FOLLOW
+{
+    char readFile[MAX_FILEPATH_LENGTH];
+    char directory[MAX_FILEPATH_LENGTH];    /* Watched for a new file under the name */
+    const char* name;                       /* File name within readFile */
+    int notify;
+    int stopEvent;                          /* Readable once the follow stops */
+    int directoryWatch;
+    int fileWatch;
+    int input;                              /* Open file being captured. -1 while missing */
+    dev_t device;
+    ino_t inode;
+    unsigned long long offset;              /* Input bytes captured so far */
+    char* buffer;
+    unsigned int bufferSize;
+    DATA_READER_STREAM* stream;
+    pthread_t thread;
+    atomic_bool active;
+    atomic_int result;
+    atomic_ullong bytes;
+    atomic_ullong truncations;
+    atomic_ullong rotations;
+};
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static void* followThread(void* pFollow);
+static bool readEvents(DATA_FOLLOW* pFollow);
+static bool checkSource(DATA_FOLLOW* pFollow);
+static bool copyAppended(DATA_FOLLOW* pFollow);
+static bool openInput(DATA_FOLLOW* pFollow, bool pFromStart);
+static void closeInput(DATA_FOLLOW* pFollow);
+static void releaseFollow(DATA_FOLLOW* pFollow);
+#endif
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataFollow_Start(DATA_FOLLOW** pFollow, const char* pReadFile, bool pFromStart,
+                            char* pWriteFile, int pSize)
+{
+#ifdef __linux__
+    DATA_FOLLOW* follow;
+    struct stat existing;
+    char* separator;
+    ERROR_TYPE ret;
+    *pFollow = NULL;
+    if(strlen(pReadFile) >= MAX_FILEPATH_LENGTH)
+    {
+        return(ERROR_PATHTOOLONG);
+    }
+    if((stat(pReadFile, &existing) == 0) && !S_ISREG(existing.st_mode))
+    {
+        /* Only files keep their data to be read again after a truncation */
+        return(ERROR_READ_FILEOPEN);
+    }
+    follow = calloc(1, sizeof(DATA_FOLLOW));
+    if(follow == NULL)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    follow->notify = -1;
+    follow->stopEvent = -1;
+    follow->directoryWatch = -1;
+    follow->fileWatch = -1;
+    follow->input = -1;
+    atomic_init(&follow->active, true);
+    atomic_init(&follow->result, ERROR_NOERROR);
+    atomic_init(&follow->bytes, 0);
+    atomic_init(&follow->truncations, 0);
+    atomic_init(&follow->rotations, 0);
+    strcpy(follow->readFile, pReadFile);
+    strcpy(follow->directory, pReadFile);
+    separator = strrchr(follow->directory, '/');
+    if(separator == NULL)
+    {
+        strcpy(follow->directory, ".");
+        follow->name = follow->readFile;
+    }
+    else
+    {
+        follow->name = follow->readFile + (separator - follow->directory) + 1;
+        separator[(separator == follow->directory) ? 1 : 0] = NULL_CHARACTER;
+    }
+    /* The configuration is only completed by the first capture */
+    follow->bufferSize = DataReader_GetBufferSize() * 1024;
+    if(!follow->bufferSize)
+    {
+        follow->bufferSize = (unsigned int)strtoul(DEFAULT_BUFFER_SIZE_KB, NULL, 10) * 1024;
+    }
+    follow->buffer = DataEngine_AllocateBuffer(follow->bufferSize);
+    if(follow->buffer == NULL)
+    {
+        releaseFollow(follow);
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    follow->notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    follow->stopEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if((follow->notify < 0) || (follow->stopEvent < 0))
+    {
+        releaseFollow(follow);
+        return(ERROR_IO_FAILED);
+    }
+    /* A file created or moved under the name replaces the followed one */
+    follow->directoryWatch = inotify_add_watch(follow->notify, follow->directory, IN_CREATE | IN_MOVED_TO);
+    if((follow->directoryWatch < 0) || (!openInput(follow, pFromStart) && (errno != ENOENT)))
+    {
+        releaseFollow(follow);
+        return(ERROR_READ_FILEOPEN);
+    }
+    ret = DataReader_OpenStream(&follow->stream, pWriteFile, pSize);
+    if(ret != ERROR_NOERROR)
+    {
+        releaseFollow(follow);
+        return(ret);
+    }
+    if(pthread_create(&follow->thread, NULL, followThread, follow))
+    {
+        releaseFollow(follow);
+        return(ERROR_IO_FAILED);
+    }
+    *pFollow = follow;
+    return(ERROR_NOERROR);
+#else
+    /* inotify is not available on this platform */
+    (void)pReadFile;
+    (void)pFromStart;
+    (void)pWriteFile;
+    (void)pSize;
+    *pFollow = NULL;
+    return(ERROR_IO_FAILED);
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+void DataFollow_GetStats(DATA_FOLLOW* pFollow, FOLLOW_STATS* pStats)
+{
+#ifdef __linux__
+    pStats->bytes = atomic_load(&pFollow->bytes);
+    pStats->truncations = atomic_load(&pFollow->truncations);
+    pStats->rotations = atomic_load(&pFollow->rotations);
+    pStats->active = atomic_load(&pFollow->active);
+    pStats->result = (ERROR_TYPE)atomic_load(&pFollow->result);
+#else
+    (void)pFollow;
+    memset(pStats, 0, sizeof(FOLLOW_STATS));
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+void DataFollow_Stop(DATA_FOLLOW* pFollow, FOLLOW_STATS* pStats)
+{
+#ifdef __linux__
+    unsigned long long stop = 1;
+    ERROR_TYPE closed;
+    (void)!write(pFollow->stopEvent, &stop, sizeof(stop));
+    (void)pthread_join(pFollow->thread, NULL);
+    closed = DataReader_StreamClose(pFollow->stream);
+    pFollow->stream = NULL;
+    if(atomic_load(&pFollow->result) == ERROR_NOERROR)
+    {
+        atomic_store(&pFollow->result, closed);
+    }
+    if(pStats != NULL)
+    {
+        DataFollow_GetStats(pFollow, pStats);
+    }
+    releaseFollow(pFollow);
+#else
+    (void)pFollow;
+    if(pStats != NULL)
+    {
+        memset(pStats, 0, sizeof(FOLLOW_STATS));
+    }
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataFollow_Run(const char* pReadFile, bool pFromStart, char* pWriteFile, int pSize,
+                          FOLLOW_STATS* pStats)
+{
+#ifdef __linux__
+    const struct timespec interval = { 0, FOLLOW_CHECK_INTERVAL_MS * 1000000L };
+    DATA_FOLLOW* follow;
+    ERROR_TYPE ret;
+    sigset_t signals;
+    sigset_t previous;
+    /* Blocked before the thread starts, so that it inherits the mask and the
+       signals are only taken by sigtimedwait */
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    (void)pthread_sigmask(SIG_BLOCK, &signals, &previous);
+    ret = DataFollow_Start(&follow, pReadFile, pFromStart, pWriteFile, pSize);
+    if(ret == ERROR_NOERROR)
+    {
+        /* A failed capture ends the follow without a signal */
+        do
+        {
+            DataFollow_GetStats(follow, pStats);
+        } while(pStats->active && (sigtimedwait(&signals, NULL, &interval) < 0));
+        DataFollow_Stop(follow, pStats);
+    }
+    (void)pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    return(ret);
+#else
+    (void)pReadFile;
+    (void)pFromStart;
+    (void)pWriteFile;
+    (void)pSize;
+    memset(pStats, 0, sizeof(FOLLOW_STATS));
+    return(ERROR_IO_FAILED);
+#endif
+}
+#ifdef __linux__
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : followThread
+ * Inputs       : void* pFollow - DATA_FOLLOW to be served
+ * Outputs      : NULL
+ * Description  : Sleeps until the file or its directory changes and captures
+ *                what changed, until the follow stops or its capture fails. The
+ *                data appended before the stop is captured on the way out
+ -----------------------------------------------------------------------------------*/
+static void* followThread(void* pFollow)
+{
+    DATA_FOLLOW* follow = (DATA_FOLLOW*)pFollow;
+    struct pollfd events[2];
+    bool running = checkSource(follow);
+    events[0].fd = follow->notify;
+    events[0].events = POLLIN;
+    events[1].fd = follow->stopEvent;
+    events[1].events = POLLIN;
+    while(running)
+    {
+        int ready = poll(events, 2, -1);
+        if(ready < 0)
+        {
+            running = (errno == EINTR);
+        }
+        else if(events[1].revents & POLLIN)
+        {
+            running = false;
+            (void)checkSource(follow);
+        }
+        else if((events[0].revents & POLLIN) && readEvents(follow))
+        {
+            running = checkSource(follow);
+        }
+    }
+    atomic_store(&follow->active, false);
+    return NULL;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : readEvents
+ * Inputs       : DATA_FOLLOW* pFollow - current follow
+ * Outputs      : True if any event concerns the followed file
+ * Description  : Takes all pending events. Events of other files in the
+ *                directory are ignored. A lost event may hide any change
+ -----------------------------------------------------------------------------------*/
+static bool readEvents(DATA_FOLLOW* pFollow)
+{
+    _Alignas(struct inotify_event) char events[FOLLOW_EVENT_BUFFER];
+    bool relevant = false;
+    ssize_t length;
+    while((length = read(pFollow->notify, events, sizeof(events))) > 0)
+    {
+        ssize_t position = 0;
+        while(position < length)
+        {
+            const struct inotify_event* event = (const struct inotify_event*)(events + position);
+            if((event->wd == pFollow->fileWatch) || (event->mask & IN_Q_OVERFLOW) ||
+               ((event->wd == pFollow->directoryWatch) && event->len && !strcmp(event->name, pFollow->name)))
+            {
+                relevant = true;
+            }
+            position = position + (ssize_t)sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return relevant;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : checkSource
+ * Inputs       : DATA_FOLLOW* pFollow - current follow
+ * Outputs      : False if the capture failed. True otherwise
+ * Description  : Captures the data appended to the open file, from its start if
+ *                it was truncated. A different file now found under the path is
+ *                followed from its start once the open one is captured
+ -----------------------------------------------------------------------------------*/
+static bool checkSource(DATA_FOLLOW* pFollow)
+{
+    struct stat current;
+    if(pFollow->input >= 0)
+    {
+        if((fstat(pFollow->input, &current) == 0) && ((unsigned long long)current.st_size < pFollow->offset))
+        {
+            pFollow->offset = 0;
+            atomic_fetch_add(&pFollow->truncations, 1);
+        }
+        if(!copyAppended(pFollow))
+        {
+            return false;
+        }
+    }
+    if((stat(pFollow->readFile, &current) == 0) && S_ISREG(current.st_mode) &&
+       ((pFollow->input < 0) || (current.st_dev != pFollow->device) || (current.st_ino != pFollow->inode)))
+    {
+        if(pFollow->input >= 0)
+        {
+            closeInput(pFollow);
+            atomic_fetch_add(&pFollow->rotations, 1);
+        }
+        if(openInput(pFollow, true))
+        {
+            return copyAppended(pFollow);
+        }
+    }
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : copyAppended
+ * Inputs       : DATA_FOLLOW* pFollow - follow with an open file
+ * Outputs      : False if the capture failed. True otherwise
+ * Description  : Captures the file from the captured offset to its end and makes
+ *                the data visible in the output at once
+ -----------------------------------------------------------------------------------*/
+static bool copyAppended(DATA_FOLLOW* pFollow)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    bool copied = false;
+    ssize_t count;
+    do
+    {
+        count = pread(pFollow->input, pFollow->buffer, pFollow->bufferSize, (off_t)pFollow->offset);
+        if(count > 0)
+        {
+            ret = DataReader_StreamWrite(pFollow->stream, pFollow->buffer, (unsigned int)count);
+            pFollow->offset = pFollow->offset + (unsigned long long)count;
+            atomic_fetch_add(&pFollow->bytes, (unsigned long long)count);
+            copied = true;
+        }
+    } while((ret == ERROR_NOERROR) && ((count > 0) || ((count < 0) && (errno == EINTR))));
+    if((ret == ERROR_NOERROR) && (count < 0))
+    {
+        ret = ERROR_IO_FAILED;
+    }
+    if((ret == ERROR_NOERROR) && copied)
+    {
+        ret = DataReader_StreamFlush(pFollow->stream);
+    }
+    if(ret != ERROR_NOERROR)
+    {
+        atomic_store(&pFollow->result, ret);
+        return false;
+    }
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : openInput
+ * Inputs       : DATA_FOLLOW* pFollow - follow without an open file
+ *                bool pFromStart - capture the current content of the file
+ * Outputs      : True if the file is open and watched. False with errno otherwise
+ * Description  : The file is watched before it is opened, so that no change
+ *                after the open is missed
+ -----------------------------------------------------------------------------------*/
+static bool openInput(DATA_FOLLOW* pFollow, bool pFromStart)
+{
+    struct stat opened;
+    pFollow->fileWatch = inotify_add_watch(pFollow->notify, pFollow->readFile,
+                                           IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+    if(pFollow->fileWatch < 0)
+    {
+        return false;
+    }
+    pFollow->input = open(pFollow->readFile, O_RDONLY | O_CLOEXEC);
+    if((pFollow->input < 0) || (fstat(pFollow->input, &opened) != 0))
+    {
+        int error = errno;
+        closeInput(pFollow);
+        errno = error;
+        return false;
+    }
+    pFollow->device = opened.st_dev;
+    pFollow->inode = opened.st_ino;
+    pFollow->offset = pFromStart ? 0 : (unsigned long long)opened.st_size;
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : closeInput
+ * Inputs       : DATA_FOLLOW* pFollow - current follow
+ * Outputs      :
+ * Description  : Stops watching the followed file and closes it. The watch of a
+ *                deleted file is already gone
+ -----------------------------------------------------------------------------------*/
+static void closeInput(DATA_FOLLOW* pFollow)
+{
+    if(pFollow->fileWatch >= 0)
+    {
+        (void)inotify_rm_watch(pFollow->notify, pFollow->fileWatch);
+        pFollow->fileWatch = -1;
+    }
+    if(pFollow->input >= 0)
+    {
+        close(pFollow->input);
+        pFollow->input = -1;
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : releaseFollow
+ * Inputs       : DATA_FOLLOW* pFollow - follow without a running thread
+ * Outputs      :
+ * Description  : Closes the file, the capture and the descriptors and frees the
+ *                follow
+ -----------------------------------------------------------------------------------*/
+static void releaseFollow(DATA_FOLLOW* pFollow)
+{
+    closeInput(pFollow);
+    if(pFollow->stream != NULL)
+    {
+        (void)DataReader_StreamClose(pFollow->stream);
+    }
+    if(pFollow->notify >= 0)
+    {
+        close(pFollow->notify);
+    }
+    if(pFollow->stopEvent >= 0)
+    {
+        close(pFollow->stopEvent);
+    }
+    DataEngine_FreeBuffer(pFollow->buffer);
+    free(pFollow);
+}
+#endif
+/*----------------------------------------------------------------------------------*/
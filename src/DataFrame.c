@@ -0,0 +1,353 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "DataFrame.h"
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define FRAME_INDEX_INITIAL_CAPACITY 1024
+/* Smallest record worth starting a segment for */
+#define FRAME_MIN_RECORD_SIZE 1
+#ifdef _WIN32
+#define seekStream _fseeki64
+#define tellStream _ftelli64
+#else
+#define seekStream fseeko
+#define tellStream ftello
+#endif
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Framing state of the current segment */
+typedef struct
+{
+    DATA_WRITER* writer;
+    const char* source;
+    unsigned int maxRecordSize;
+    unsigned char* index;           /* Encoded index entries of the segment */
+    unsigned long long records;
+    unsigned long long capacity;    /* Entries that fit in index */
+    unsigned long long bytes;       /* Data bytes of the records of the segment */
+    unsigned long long offset;      /* Bytes written to the segment */
+} FRAME_SEGMENT;
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static ERROR_TYPE writeHeader(FRAME_SEGMENT* pSegment);
+static ERROR_TYPE writeRecord(FRAME_SEGMENT* pSegment, const char* pData, unsigned int pSize);
+static ERROR_TYPE writeFooter(FRAME_SEGMENT* pSegment);
+static unsigned long long recordSpace(const FRAME_SEGMENT* pSegment);
+static unsigned int getLe32(const unsigned char* pData);
+static unsigned long long getLe64(const unsigned char* pData);
+static void putLe32(unsigned char* pData, unsigned int pValue);
+static void putLe64(unsigned char* pData, unsigned long long pValue);
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataFrame_Copy(ENGINE_JOB* pJob, const char* pSource)
+{
+    ERROR_TYPE ret;
+    FRAME_SEGMENT segment;
+    bool running = true;
+    char* readBuffer = DataEngine_AllocateBuffer(pJob->bufferSize);
+    if(readBuffer == NULL)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    memset(&segment, 0, sizeof(segment));
+    segment.writer = pJob->writer;
+    segment.source = pSource;
+    segment.maxRecordSize = pJob->bufferSize;
+    ret = writeHeader(&segment);
+    /* Read until end of input */
+    while(running && (ret == ERROR_NOERROR))
+    {
+        const char* data = readBuffer;
+        unsigned int readSize = DataEngine_Read(pJob, readBuffer, pJob->bufferSize);
+        if(!readSize)
+        {
+            /* File read completed */
+            break;
+        }
+        while(readSize && (ret == ERROR_NOERROR))
+        {
+            unsigned long long space = recordSpace(&segment);
+            unsigned int size = readSize;
+            if(space < FRAME_MIN_RECORD_SIZE)
+            {
+                /* Segment is full. Close it and continue in the next one or stop */
+                ret = writeFooter(&segment);
+                if(ret != ERROR_NOERROR)
+                {
+                    break;
+                }
+                if(!pJob->writer->rotate)
+                {
+                    ret = ERROR_FILE_SIZELIMIT_REACHED;
+                    running = false;
+                    break;
+                }
+                ret = DataWriter_Rotate(pJob->writer);
+                if(ret == ERROR_NOERROR)
+                {
+                    ret = writeHeader(&segment);
+                }
+                continue;
+            }
+            if(size > space)
+            {
+                size = (unsigned int)space;
+            }
+            ret = writeRecord(&segment, data, size);
+            data = data + size;
+            readSize = readSize - size;
+        }
+    }
+    /* A segment cut by the size limit already has its footer */
+    if(running && (ret == ERROR_NOERROR))
+    {
+        ret = writeFooter(&segment);
+    }
+    free(segment.index);
+    DataEngine_FreeBuffer(readBuffer);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataFrame_Open(FILE* pInput, FRAME_INFO* pInfo)
+{
+    unsigned char header[FRAME_HEADER_SIZE];
+    unsigned char footer[FRAME_FOOTER_SIZE];
+    unsigned int headerSize;
+    unsigned int sourceLength;
+    long long size;
+    memset(pInfo, 0, sizeof(FRAME_INFO));
+    if(seekStream(pInput, 0, SEEK_END) || ((size = (long long)tellStream(pInput)) < (FRAME_HEADER_SIZE + FRAME_FOOTER_SIZE)) ||
+       seekStream(pInput, 0, SEEK_SET) || (fread(header, sizeof(char), sizeof(header), pInput) != sizeof(header)) ||
+       memcmp(header, FRAME_MAGIC, 4))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    pInfo->version = getLe32(header + 4);
+    headerSize = getLe32(header + 8);
+    pInfo->segment = getLe32(header + 12);
+    pInfo->created = getLe64(header + 16);
+    pInfo->maxRecordSize = getLe32(header + 24);
+    sourceLength = getLe32(header + 28);
+    if((pInfo->version != FRAME_VERSION) || (sourceLength >= MAX_FILEPATH_LENGTH) ||
+       (headerSize != (FRAME_HEADER_SIZE + sourceLength)) ||
+       (fread(pInfo->source, sizeof(char), sourceLength, pInput) != sourceLength))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    pInfo->source[sourceLength] = NULL_CHARACTER;
+    if(seekStream(pInput, size - FRAME_FOOTER_SIZE, SEEK_SET) ||
+       (fread(footer, sizeof(char), sizeof(footer), pInput) != sizeof(footer)) ||
+       memcmp(footer + FRAME_FOOTER_SIZE - 4, FRAME_FOOTER_MAGIC, 4))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    pInfo->indexOffset = getLe64(footer);
+    pInfo->records = getLe64(footer + 8);
+    pInfo->bytes = getLe64(footer + 16);
+    /* The index ends where the footer starts and the records fill the space between
+       the header and the index */
+    if((pInfo->indexOffset < headerSize) || (pInfo->records > ((unsigned long long)size / FRAME_INDEX_ENTRY_SIZE)) ||
+       ((pInfo->indexOffset + pInfo->records * FRAME_INDEX_ENTRY_SIZE + FRAME_FOOTER_SIZE) != (unsigned long long)size) ||
+       ((headerSize + pInfo->records * FRAME_RECORD_HEADER_SIZE + pInfo->bytes) != pInfo->indexOffset))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    return(ERROR_NOERROR);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataFrame_ReadRecord(FILE* pInput, const FRAME_INFO* pInfo, unsigned long long pRecord,
+                                char* pData, unsigned int pCapacity, unsigned int* pSize)
+{
+    unsigned char entry[FRAME_INDEX_ENTRY_SIZE];
+    unsigned char record[FRAME_RECORD_HEADER_SIZE];
+    unsigned long long offset;
+    unsigned int size;
+    if(pRecord >= pInfo->records)
+    {
+        return(ERROR_INVALIDARG);
+    }
+    if(seekStream(pInput, pInfo->indexOffset + pRecord * FRAME_INDEX_ENTRY_SIZE, SEEK_SET) ||
+       (fread(entry, sizeof(char), sizeof(entry), pInput) != sizeof(entry)))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    offset = getLe64(entry);
+    if(((offset + FRAME_RECORD_HEADER_SIZE) > pInfo->indexOffset) || seekStream(pInput, offset, SEEK_SET) ||
+       (fread(record, sizeof(char), sizeof(record), pInput) != sizeof(record)))
+    {
+        return(ERROR_IO_FAILED);
+    }
+    size = getLe32(record);
+    *pSize = size;
+    if((offset + FRAME_RECORD_HEADER_SIZE + size) > pInfo->indexOffset)
+    {
+        return(ERROR_IO_FAILED);
+    }
+    if(size > pCapacity)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    return((fread(pData, sizeof(char), size, pInput) == size) ? ERROR_NOERROR : ERROR_IO_FAILED);
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : writeHeader
+ * Inputs       : FRAME_SEGMENT* pSegment - framing state. Reset for the new segment
+ * Outputs      : ERROR_NOERROR, ERROR_FILE_SIZELIMIT_REACHED if the header, the
+ *                footer and a record do not fit in a segment, or the error of the
+ *                writer
+ * Description  : Starts a segment with its header
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE writeHeader(FRAME_SEGMENT* pSegment)
+{
+    unsigned char header[FRAME_HEADER_SIZE + MAX_FILEPATH_LENGTH];
+    unsigned int sourceLength = strlen(pSegment->source);
+    struct timespec now;
+    ERROR_TYPE ret;
+    if(sourceLength >= MAX_FILEPATH_LENGTH)
+    {
+        sourceLength = MAX_FILEPATH_LENGTH - 1;
+    }
+    clock_gettime(CLOCK_REALTIME, &now);
+    memcpy(header, FRAME_MAGIC, 4);
+    putLe32(header + 4, FRAME_VERSION);
+    putLe32(header + 8, FRAME_HEADER_SIZE + sourceLength);
+    putLe32(header + 12, pSegment->writer->segment);
+    putLe64(header + 16, (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec);
+    putLe32(header + 24, pSegment->maxRecordSize);
+    putLe32(header + 28, sourceLength);
+    memcpy(header + FRAME_HEADER_SIZE, pSegment->source, sourceLength);
+    pSegment->records = 0;
+    pSegment->bytes = 0;
+    pSegment->offset = 0;
+    if(DataWriter_Space(pSegment->writer) <
+       (FRAME_HEADER_SIZE + sourceLength + FRAME_RECORD_HEADER_SIZE + FRAME_MIN_RECORD_SIZE + FRAME_INDEX_ENTRY_SIZE +
+        FRAME_FOOTER_SIZE))
+    {
+        /* Segments are too small to hold any data */
+        return(ERROR_FILE_SIZELIMIT_REACHED);
+    }
+    ret = DataWriter_Write(pSegment->writer, (const char*)header, FRAME_HEADER_SIZE + sourceLength);
+    pSegment->offset = FRAME_HEADER_SIZE + sourceLength;
+    return(ret);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : writeRecord
+ * Inputs       : FRAME_SEGMENT* pSegment - framing state
+ *                const char* pData - data of the record
+ *                unsigned int pSize - size of the record. Fits in the segment
+ * Outputs      : ERROR_NOERROR, ERROR_MEMORY_ALLOCATION if the index cannot be
+ *                extended, or the error of the writer
+ * Description  : Writes the length prefix and the data and records the offset
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE writeRecord(FRAME_SEGMENT* pSegment, const char* pData, unsigned int pSize)
+{
+    unsigned char prefix[FRAME_RECORD_HEADER_SIZE];
+    ERROR_TYPE ret;
+    if(pSegment->records == pSegment->capacity)
+    {
+        unsigned long long capacity = pSegment->capacity ? pSegment->capacity * 2 : FRAME_INDEX_INITIAL_CAPACITY;
+        unsigned char* index = realloc(pSegment->index, capacity * FRAME_INDEX_ENTRY_SIZE);
+        if(index == NULL)
+        {
+            return(ERROR_MEMORY_ALLOCATION);
+        }
+        pSegment->index = index;
+        pSegment->capacity = capacity;
+    }
+    putLe32(prefix, pSize);
+    ret = DataWriter_Write(pSegment->writer, (const char*)prefix, sizeof(prefix));
+    if(ret == ERROR_NOERROR)
+    {
+        ret = DataWriter_Write(pSegment->writer, pData, pSize);
+    }
+    if(ret == ERROR_NOERROR)
+    {
+        putLe64(pSegment->index + pSegment->records * FRAME_INDEX_ENTRY_SIZE, pSegment->offset);
+        pSegment->records++;
+        pSegment->bytes = pSegment->bytes + pSize;
+        pSegment->offset = pSegment->offset + FRAME_RECORD_HEADER_SIZE + pSize;
+    }
+    return(ret);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : writeFooter
+ * Inputs       : FRAME_SEGMENT* pSegment - framing state
+ * Outputs      : ERROR_NOERROR or the error of the writer
+ * Description  : Ends the segment with the index of its records and the footer
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE writeFooter(FRAME_SEGMENT* pSegment)
+{
+    unsigned char footer[FRAME_FOOTER_SIZE] = { 0 };
+    ERROR_TYPE ret = ERROR_NOERROR;
+    if(pSegment->records)
+    {
+        ret = DataWriter_Write(pSegment->writer, (const char*)pSegment->index,
+                               (unsigned int)(pSegment->records * FRAME_INDEX_ENTRY_SIZE));
+    }
+    if(ret == ERROR_NOERROR)
+    {
+        putLe64(footer, pSegment->offset);
+        putLe64(footer + 8, pSegment->records);
+        putLe64(footer + 16, pSegment->bytes);
+        memcpy(footer + FRAME_FOOTER_SIZE - 4, FRAME_FOOTER_MAGIC, 4);
+        ret = DataWriter_Write(pSegment->writer, (const char*)footer, sizeof(footer));
+    }
+    return(ret);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : recordSpace
+ * Inputs       : const FRAME_SEGMENT* pSegment - framing state
+ * Outputs      : Largest record that still fits in the segment, with its index
+ *                entry and the footer. Limited to the largest record size
+ * Description  : Keeps room for the end of the segment
+ -----------------------------------------------------------------------------------*/
+static unsigned long long recordSpace(const FRAME_SEGMENT* pSegment)
+{
+    unsigned long long space = DataWriter_Space(pSegment->writer);
+    unsigned long long reserved = FRAME_RECORD_HEADER_SIZE + (pSegment->records + 1) * FRAME_INDEX_ENTRY_SIZE +
+                                  FRAME_FOOTER_SIZE;
+    if(space <= reserved)
+    {
+        return 0;
+    }
+    space = space - reserved;
+    return(space < pSegment->maxRecordSize ? space : pSegment->maxRecordSize);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : getLe32 / getLe64 / putLe32 / putLe64
+ * Inputs       : unsigned char* pData - position of the number
+ *                pValue - number to be stored
+ * Outputs      : Number read
+ * Description  : Little endian numbers of the segment, independent of alignment
+ *                and of the byte order of the machine
+ -----------------------------------------------------------------------------------*/
+static unsigned int getLe32(const unsigned char* pData)
+{
+    return((unsigned int)pData[0] | ((unsigned int)pData[1] << 8) | ((unsigned int)pData[2] << 16) |
+           ((unsigned int)pData[3] << 24));
+}
+static unsigned long long getLe64(const unsigned char* pData)
+{
+    return((unsigned long long)getLe32(pData) | ((unsigned long long)getLe32(pData + 4) << 32));
+}
+static void putLe32(unsigned char* pData, unsigned int pValue)
+{
+    pData[0] = (unsigned char)pValue;
+    pData[1] = (unsigned char)(pValue >> 8);
+    pData[2] = (unsigned char)(pValue >> 16);
+    pData[3] = (unsigned char)(pValue >> 24);
+}
+static void putLe64(unsigned char* pData, unsigned long long pValue)
+{
+    putLe32(pData, (unsigned int)pValue);
+    putLe32(pData + 4, (unsigned int)(pValue >> 32));
+}
+/*----------------------------------------------------------------------------------*/
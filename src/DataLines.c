@@ -0,0 +1,568 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include "DataLines.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LINES_SIMD
+#include <immintrin.h>
+#endif
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define LINE_INDEX_INITIAL_CAPACITY 64
+#define LINE_INDEX_LINE_LENGTH 64
+#define LINE_SCAN_SIZE (64 * 1024)
+#ifdef _WIN32
+#define seekStream _fseeki64
+#define tellStream _ftelli64
+#else
+#define seekStream fseeko
+#define tellStream ftello
+#endif
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Counts delimiters until pLimit are found. Returns the bytes scanned, which end
+   right after the last delimiter counted when the limit is reached */
+typedef size_t (*LINES_COUNT_FN)(const unsigned char* pData, size_t pSize, unsigned char pDelimiter,
+                                 unsigned long long pLimit, unsigned long long* pCount);
+/* Returns the bytes up to and including the last delimiter. 0 - no delimiter */
+typedef size_t (*LINES_FIND_LAST_FN)(const unsigned char* pData, size_t pSize, unsigned char pDelimiter);
+
+/* Line index of the current output segment */
+typedef struct
+{
+    bool enabled;
+    unsigned long long lines;       /* Delimiters in the segment */
+    unsigned long long size;        /* Bytes in the segment */
+    bool terminated;                /* Segment ends with a delimiter */
+    unsigned long long* offsets;    /* Offset of every LINE_INDEX_INTERVAL-th line */
+    unsigned long long count;
+    unsigned long long capacity;
+} LINE_INDEX;
+
+/*----------------------------------------------------------------------------------*/
+/* Static variables */
+static LINES_COUNT_FN fl_Count;
+static LINES_FIND_LAST_FN fl_FindLast;
+static pthread_once_t fl_Initialized = PTHREAD_ONCE_INIT;
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static void initialize(void);
+static ERROR_TYPE writeLines(DATA_WRITER* pWriter, LINE_INDEX* pIndex, const char* pData, size_t pSize);
+static bool indexLines(LINE_INDEX* pIndex, const char* pData, size_t pSize);
+static ERROR_TYPE writeIndex(LINE_INDEX* pIndex, const char* pFile);
+static size_t countScalar(const unsigned char* pData, size_t pSize, unsigned char pDelimiter,
+                          unsigned long long pLimit, unsigned long long* pCount);
+static size_t findLastScalar(const unsigned char* pData, size_t pSize, unsigned char pDelimiter);
+#ifdef LINES_SIMD
+static size_t countSse2(const unsigned char* pData, size_t pSize, unsigned char pDelimiter,
+                        unsigned long long pLimit, unsigned long long* pCount);
+static size_t findLastSse2(const unsigned char* pData, size_t pSize, unsigned char pDelimiter);
+static size_t countAvx2(const unsigned char* pData, size_t pSize, unsigned char pDelimiter,
+                        unsigned long long pLimit, unsigned long long* pCount);
+static size_t findLastAvx2(const unsigned char* pData, size_t pSize, unsigned char pDelimiter);
+static size_t countMask(unsigned int pMask, unsigned long long* pCount, unsigned long long pLimit, bool* pReached);
+#endif
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataLines_Copy(ENGINE_JOB* pJob, bool pIndex)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    LINE_INDEX index;
+    size_t pending = 0;
+    bool running = true;
+    /* Room for a held back line and a full read */
+    char* buffer = DataEngine_AllocateBuffer(pJob->bufferSize * 2);
+    if(buffer == NULL)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    (void)pthread_once(&fl_Initialized, initialize);
+    memset(&index, 0, sizeof(index));
+    index.enabled = pIndex;
+    while(running && (ret == ERROR_NOERROR))
+    {
+        size_t readSize = DataEngine_Read(pJob, buffer + pending, pJob->bufferSize);
+        size_t total = pending + readSize;
+        size_t complete = total;
+        if(readSize)
+        {
+            /* The held back bytes have no delimiter */
+            complete = fl_FindLast((const unsigned char*)buffer + pending, readSize, LINE_DELIMITER);
+            complete = complete ? pending + complete : 0;
+            if(!complete && (total >= pJob->bufferSize))
+            {
+                /* Line longer than the buffer. It cannot be held back */
+                complete = total;
+            }
+        }
+        else
+        {
+            /* The last line ends with the input */
+            running = false;
+        }
+        ret = writeLines(pJob->writer, &index, buffer, complete);
+        pending = total - complete;
+        memmove(buffer, buffer + complete, pending);
+    }
+    /* A segment cut by the size limit already has its index */
+    if(index.enabled && (ret == ERROR_NOERROR))
+    {
+        ret = writeIndex(&index, pJob->writer->fileName);
+    }
+    free(index.offsets);
+    DataEngine_FreeBuffer(buffer);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataLines_Seek(const char* pFile, unsigned long long pLine, unsigned long long* pOffset)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    char indexFile[MAX_FILEPATH_LENGTH + sizeof(LINE_INDEX_EXTENSION)];
+    char line[LINE_INDEX_LINE_LENGTH];
+    unsigned long long interval = 0;
+    unsigned long long lines = 0;
+    unsigned long long size = 0;
+    unsigned long long offset = 0;
+    unsigned long long remaining;
+    bool header = false;
+    char* buffer = NULL;
+    FILE* index;
+    FILE* input = NULL;
+    if(strlen(pFile) >= MAX_FILEPATH_LENGTH)
+    {
+        return(ERROR_PATHTOOLONG);
+    }
+    (void)pthread_once(&fl_Initialized, initialize);
+    sprintf(indexFile, "%s%s", pFile, LINE_INDEX_EXTENSION);
+    index = fopen(indexFile, "rb");
+    if(index == NULL)
+    {
+        return(ERROR_READ_FILEOPEN);
+    }
+    while(!header && (fgets(line, sizeof(line), index) != NULL))
+    {
+        (void)sscanf(line, "interval %llu", &interval);
+        (void)sscanf(line, "lines %llu", &lines);
+        (void)sscanf(line, "size %llu", &size);
+        header = !strncmp(line, LINE_INDEX_OFFSETS, strlen(LINE_INDEX_OFFSETS));
+    }
+    if(!header || !interval)
+    {
+        ret = ERROR_IO_FAILED;
+    }
+    else if(pLine >= lines)
+    {
+        ret = ERROR_INVALIDARG;
+    }
+    else if(pLine >= interval)
+    {
+        /* Entries have a fixed length. Entry N holds line interval * (N + 1) */
+        long long entries = (long long)tellStream(index);
+        if((entries < 0) ||
+           seekStream(index, entries + (long long)((pLine / interval) - 1) * LINE_INDEX_ENTRY_LENGTH, SEEK_SET) ||
+           (fgets(line, sizeof(line), index) == NULL) || (sscanf(line, "%llu", &offset) != 1) || (offset > size))
+        {
+            ret = ERROR_IO_FAILED;
+        }
+    }
+    fclose(index);
+    /* Scan the lines between the entry and the line */
+    remaining = pLine % interval;
+    if((ret == ERROR_NOERROR) && remaining)
+    {
+        input = fopen(pFile, "rb");
+        buffer = DataEngine_AllocateBuffer(LINE_SCAN_SIZE);
+        if(input == NULL)
+        {
+            ret = ERROR_READ_FILEOPEN;
+        }
+        else if(buffer == NULL)
+        {
+            ret = ERROR_MEMORY_ALLOCATION;
+        }
+        else if(seekStream(input, (long long)offset, SEEK_SET))
+        {
+            ret = ERROR_IO_FAILED;
+        }
+        while((ret == ERROR_NOERROR) && remaining)
+        {
+            unsigned long long found = 0;
+            size_t readSize = fread(buffer, sizeof(char), LINE_SCAN_SIZE, input);
+            if(!readSize)
+            {
+                /* File is shorter than its index */
+                ret = ERROR_IO_FAILED;
+                break;
+            }
+            offset = offset + fl_Count((const unsigned char*)buffer, readSize, LINE_DELIMITER, remaining, &found);
+            remaining = remaining - found;
+        }
+    }
+    if(input != NULL)
+    {
+        fclose(input);
+    }
+    DataEngine_FreeBuffer(buffer);
+    *pOffset = offset;
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+unsigned long long DataLines_Count(const char* pData, size_t pSize, char pDelimiter)
+{
+    unsigned long long count = 0;
+    (void)pthread_once(&fl_Initialized, initialize);
+    (void)fl_Count((const unsigned char*)pData, pSize, (unsigned char)pDelimiter, ULLONG_MAX, &count);
+    return count;
+}
+/*----------------------------------------------------------------------------------*/
+size_t DataLines_FindLast(const char* pData, size_t pSize, char pDelimiter)
+{
+    (void)pthread_once(&fl_Initialized, initialize);
+    return fl_FindLast((const unsigned char*)pData, pSize, (unsigned char)pDelimiter);
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : initialize
+ * Inputs       :
+ * Outputs      :
+ * Description  : Selects the widest scanner the processor supports. Runs once, on
+ *                the first scan
+ -----------------------------------------------------------------------------------*/
+static void initialize(void)
+{
+    fl_Count = countScalar;
+    fl_FindLast = findLastScalar;
+#ifdef LINES_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+    {
+        fl_Count = countAvx2;
+        fl_FindLast = findLastAvx2;
+    }
+    else if(__builtin_cpu_supports("sse2"))
+    {
+        fl_Count = countSse2;
+        fl_FindLast = findLastSse2;
+    }
+#endif
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : writeLines
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ *                LINE_INDEX* pIndex - line index of the current segment
+ *                const char* pData - data to be written
+ *                size_t pSize - size of the data in bytes
+ * Outputs      : ERROR_NOERROR, ERROR_FILE_SIZELIMIT_REACHED, or the error of the
+ *                writer or of the index
+ * Description  : Fills each segment up to its last complete line. The index of a
+ *                full segment is written before the next segment is opened
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE writeLines(DATA_WRITER* pWriter, LINE_INDEX* pIndex, const char* pData, size_t pSize)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    while(pSize && (ret == ERROR_NOERROR))
+    {
+        unsigned long long space = DataWriter_Space(pWriter);
+        size_t cut = pSize;
+        if(pSize > space)
+        {
+            cut = fl_FindLast((const unsigned char*)pData, (size_t)space, LINE_DELIMITER);
+            if(!cut && !pWriter->segmentSize)
+            {
+                /* Line longer than a segment */
+                cut = (size_t)space;
+            }
+        }
+        if(cut)
+        {
+            ret = DataWriter_Write(pWriter, pData, (unsigned int)cut);
+            if((ret == ERROR_NOERROR) && !indexLines(pIndex, pData, cut))
+            {
+                ret = ERROR_MEMORY_ALLOCATION;
+            }
+            pData = pData + cut;
+            pSize = pSize - cut;
+        }
+        if(pSize && (ret == ERROR_NOERROR))
+        {
+            /* Segment is full up to a line boundary */
+            if(pIndex->enabled)
+            {
+                ret = writeIndex(pIndex, pWriter->fileName);
+            }
+            if(ret != ERROR_NOERROR)
+            {
+                break;
+            }
+            ret = pWriter->rotate ? DataWriter_Rotate(pWriter) : ERROR_FILE_SIZELIMIT_REACHED;
+        }
+    }
+    return(ret);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : indexLines
+ * Inputs       : LINE_INDEX* pIndex - line index of the current segment
+ *                const char* pData - data appended to the segment
+ *                size_t pSize - size of the data in bytes
+ * Outputs      : False if the index cannot be extended
+ * Description  : Counts the lines of the data and records the offset of every
+ *                LINE_INDEX_INTERVAL-th line
+ -----------------------------------------------------------------------------------*/
+static bool indexLines(LINE_INDEX* pIndex, const char* pData, size_t pSize)
+{
+    if(!pIndex->enabled || !pSize)
+    {
+        return true;
+    }
+    pIndex->terminated = (pData[pSize - 1] == LINE_DELIMITER);
+    while(pSize)
+    {
+        unsigned long long next = (pIndex->count + 1) * LINE_INDEX_INTERVAL;
+        unsigned long long found = 0;
+        size_t used = fl_Count((const unsigned char*)pData, pSize, LINE_DELIMITER, next - pIndex->lines, &found);
+        pIndex->lines = pIndex->lines + found;
+        pIndex->size = pIndex->size + used;
+        pData = pData + used;
+        pSize = pSize - used;
+        if(pIndex->lines == next)
+        {
+            /* Line "next" starts after its preceding delimiter */
+            if(pIndex->count == pIndex->capacity)
+            {
+                unsigned long long capacity = pIndex->capacity ? pIndex->capacity * 2 : LINE_INDEX_INITIAL_CAPACITY;
+                unsigned long long* offsets = realloc(pIndex->offsets, capacity * sizeof(unsigned long long));
+                if(offsets == NULL)
+                {
+                    return false;
+                }
+                pIndex->offsets = offsets;
+                pIndex->capacity = capacity;
+            }
+            pIndex->offsets[pIndex->count++] = pIndex->size;
+        }
+    }
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : writeIndex
+ * Inputs       : LINE_INDEX* pIndex - line index of a complete segment. Reset for
+ *                                     the next segment
+ *                const char* pFile - path of the segment
+ * Outputs      : ERROR_NOERROR, or ERROR_IO_FAILED if the sidecar cannot be written
+ * Description  : Writes the index next to the segment, with LINE_INDEX_EXTENSION
+ *                appended to its name
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE writeIndex(LINE_INDEX* pIndex, const char* pFile)
+{
+    char indexFile[MAX_FILEPATH_LENGTH + sizeof(LINE_INDEX_EXTENSION)];
+    unsigned long long lines = pIndex->lines;
+    unsigned long long i;
+    bool written;
+    FILE* index;
+    if(pIndex->size && !pIndex->terminated)
+    {
+        /* Unterminated last line */
+        lines++;
+    }
+    sprintf(indexFile, "%s%s", pFile, LINE_INDEX_EXTENSION);
+    index = fopen(indexFile, "wb");
+    if(index == NULL)
+    {
+        return(ERROR_IO_FAILED);
+    }
+    fprintf(index, "%s\ninterval %u\nlines %llu\nsize %llu\n%s\n", LINE_INDEX_TITLE, LINE_INDEX_INTERVAL, lines,
+            pIndex->size, LINE_INDEX_OFFSETS);
+    for(i = 0; i < pIndex->count; i++)
+    {
+        fprintf(index, LINE_INDEX_ENTRY_FORMAT, pIndex->offsets[i]);
+    }
+    written = !ferror(index);
+    written = (fclose(index) == 0) && written;
+    pIndex->lines = 0;
+    pIndex->size = 0;
+    pIndex->terminated = false;
+    pIndex->count = 0;
+    return(written ? ERROR_NOERROR : ERROR_IO_FAILED);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : countScalar
+ * Inputs       : const unsigned char* pData - data to be scanned
+ *                size_t pSize - size of the data in bytes
+ *                unsigned char pDelimiter - line delimiter
+ *                unsigned long long pLimit - stop after this many delimiters
+ *                unsigned long long* pCount - Loaded with the delimiters found
+ * Outputs      : Bytes scanned
+ * Description  : Portable scanner, one byte at a time
+ -----------------------------------------------------------------------------------*/
+static size_t countScalar(const unsigned char* pData, size_t pSize, unsigned char pDelimiter,
+                          unsigned long long pLimit, unsigned long long* pCount)
+{
+    unsigned long long count = 0;
+    size_t i;
+    for(i = 0; (i < pSize) && (count < pLimit); i++)
+    {
+        count = count + (pData[i] == pDelimiter);
+    }
+    *pCount = count;
+    return i;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : findLastScalar
+ * Inputs       : const unsigned char* pData - data to be scanned
+ *                size_t pSize - size of the data in bytes
+ *                unsigned char pDelimiter - line delimiter
+ * Outputs      : Bytes up to and including the last delimiter. 0 - none
+ * Description  : Portable backward scanner
+ -----------------------------------------------------------------------------------*/
+static size_t findLastScalar(const unsigned char* pData, size_t pSize, unsigned char pDelimiter)
+{
+    while(pSize && (pData[pSize - 1] != pDelimiter))
+    {
+        pSize--;
+    }
+    return pSize;
+}
+#ifdef LINES_SIMD
+/*-----------------------------------------------------------------------------------
+ * Name         : countMask
+ * Inputs       : unsigned int pMask - one bit per delimiter in a vector
+ *                unsigned long long* pCount - delimiters found so far. Updated
+ *                unsigned long long pLimit - stop after this many delimiters
+ *                bool* pReached - Set if the limit is reached in the vector
+ * Outputs      : Bytes of the vector up to the delimiter reaching the limit
+ * Description  : Counts a whole vector at once unless it holds the delimiter
+ *                reaching the limit, which is then located bit by bit
+ -----------------------------------------------------------------------------------*/
+static size_t countMask(unsigned int pMask, unsigned long long* pCount, unsigned long long pLimit, bool* pReached)
+{
+    unsigned int found = (unsigned int)__builtin_popcount(pMask);
+    if((*pCount + found) < pLimit)
+    {
+        *pCount = *pCount + found;
+        return 0;
+    }
+    while(++(*pCount) < pLimit)
+    {
+        pMask = pMask & (pMask - 1);
+    }
+    *pReached = true;
+    return((size_t)__builtin_ctz(pMask) + 1);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : countSse2 / findLastSse2
+ * Inputs       : as countScalar / findLastScalar
+ * Outputs      : as countScalar / findLastScalar
+ * Description  : 16 bytes per compare. The tail is scanned byte by byte
+ -----------------------------------------------------------------------------------*/
+__attribute__((target("sse2")))
+static size_t countSse2(const unsigned char* pData, size_t pSize, unsigned char pDelimiter,
+                        unsigned long long pLimit, unsigned long long* pCount)
+{
+    __m128i delimiter = _mm_set1_epi8((char)pDelimiter);
+    unsigned long long count = 0;
+    unsigned long long tail = 0;
+    bool reached = false;
+    size_t i = 0;
+    if(!pLimit)
+    {
+        *pCount = 0;
+        return 0;
+    }
+    for(; (i + 16) <= pSize; i = i + 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(pData + i));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, delimiter));
+        if(mask)
+        {
+            size_t used = countMask(mask, &count, pLimit, &reached);
+            if(reached)
+            {
+                *pCount = count;
+                return(i + used);
+            }
+        }
+    }
+    i = i + countScalar(pData + i, pSize - i, pDelimiter, pLimit - count, &tail);
+    *pCount = count + tail;
+    return i;
+}
+__attribute__((target("sse2")))
+static size_t findLastSse2(const unsigned char* pData, size_t pSize, unsigned char pDelimiter)
+{
+    __m128i delimiter = _mm_set1_epi8((char)pDelimiter);
+    while(pSize >= 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(pData + pSize - 16));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, delimiter));
+        if(mask)
+        {
+            return(pSize - 16 + (32 - (size_t)__builtin_clz(mask)));
+        }
+        pSize = pSize - 16;
+    }
+    return findLastScalar(pData, pSize, pDelimiter);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : countAvx2 / findLastAvx2
+ * Inputs       : as countScalar / findLastScalar
+ * Outputs      : as countScalar / findLastScalar
+ * Description  : 32 bytes per compare. Compiled for AVX2 regardless of the build
+ *                flags and only called when the processor supports it
+ -----------------------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static size_t countAvx2(const unsigned char* pData, size_t pSize, unsigned char pDelimiter,
+                        unsigned long long pLimit, unsigned long long* pCount)
+{
+    __m256i delimiter = _mm256_set1_epi8((char)pDelimiter);
+    unsigned long long count = 0;
+    unsigned long long tail = 0;
+    bool reached = false;
+    size_t i = 0;
+    if(!pLimit)
+    {
+        *pCount = 0;
+        return 0;
+    }
+    for(; (i + 32) <= pSize; i = i + 32)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(pData + i));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, delimiter));
+        if(mask)
+        {
+            size_t used = countMask(mask, &count, pLimit, &reached);
+            if(reached)
+            {
+                *pCount = count;
+                return(i + used);
+            }
+        }
+    }
+    i = i + countScalar(pData + i, pSize - i, pDelimiter, pLimit - count, &tail);
+    *pCount = count + tail;
+    return i;
+}
+__attribute__((target("avx2")))
+static size_t findLastAvx2(const unsigned char* pData, size_t pSize, unsigned char pDelimiter)
+{
+    __m256i delimiter = _mm256_set1_epi8((char)pDelimiter);
+    while(pSize >= 32)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(pData + pSize - 32));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, delimiter));
+        if(mask)
+        {
+            return(pSize - 32 + (32 - (size_t)__builtin_clz(mask)));
+        }
+        pSize = pSize - 32;
+    }
+    return findLastScalar(pData, pSize, pDelimiter);
+}
+#endif
+/*----------------------------------------------------------------------------------*/
@@ -0,0 +1,560 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#ifdef __linux__
+/* Required for pread, pwrite and O_DIRECT. Must precede all system headers */
+#define _GNU_SOURCE
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "DataParallel.h"
+#include "DataStats.h"
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#ifndef _WIN32
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Part of the current segment, copied by one thread */
+typedef struct
+{
+    off_t inputOffset;
+    off_t outputOffset;
+    unsigned long long length;
+    unsigned long long copied;  /* Bytes copied. Valid once done */
+    bool done;
+} PARALLEL_RANGE;
+
+/* State shared by the copying threads and the committing thread */
+typedef struct
+{
+    ENGINE_JOB* job;
+    int input;
+    int output;
+    PARALLEL_RANGE* ranges;
+    unsigned int rangeCount;
+    atomic_uint next;           /* Next range to be taken */
+    atomic_bool stop;           /* A range failed or ended short. Take no more */
+    ERROR_TYPE result;          /* First failure of a range */
+    pthread_mutex_t lock;       /* Guards the ranges, the result and the read and write statistics */
+    pthread_cond_t completed;
+} PARALLEL_COPY;
+
+/* One copying thread with its buffer */
+typedef struct
+{
+    PARALLEL_COPY* copy;
+    char* buffer;
+    pthread_t thread;
+    bool started;
+} PARALLEL_WORKER;
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static ERROR_TYPE copySegment(PARALLEL_COPY* pCopy, PARALLEL_WORKER* pWorkers, unsigned int pThreads,
+                              off_t pInputOffset, off_t pOutputOffset, unsigned long long pSize,
+                              unsigned long long* pCopied);
+static void* copyThread(void* pWorker);
+static ERROR_TYPE copyRange(PARALLEL_COPY* pCopy, PARALLEL_RANGE* pRange, char* pBuffer);
+static bool verifySegment(PARALLEL_COPY* pCopy, off_t pOutputEnd, bool pFull);
+static bool compareRange(int pInput, int pOutput, off_t pInputOffset, off_t pOutputOffset, unsigned long long pLength);
+static bool sameVersion(const struct stat* pBefore, const struct stat* pAfter);
+static bool isDirect(int pOutput);
+static unsigned long long modificationTime(const struct stat* pStat);
+#endif
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataParallel_Copy(ENGINE_JOB* pJob, unsigned int pThreads)
+{
+#ifndef _WIN32
+    ERROR_TYPE ret = ERROR_NOERROR;
+    PARALLEL_COPY copy;
+    PARALLEL_WORKER* workers;
+    struct stat inputStat;
+    struct stat finalStat;
+    DATA_WRITER* writer = pJob->writer;
+    off_t inputOffset;
+    off_t outputOffset;
+    bool direct;
+    bool aligned;
+    unsigned int i;
+    memset(&copy, 0, sizeof(copy));
+    copy.job = pJob;
+    copy.input = fileno(pJob->input);
+    /* Ranges are read at explicit offsets, which requires a regular file */
+    if((fstat(copy.input, &inputStat) != 0) || !S_ISREG(inputStat.st_mode))
+    {
+        return(DataEngine_StdioCopy(pJob));
+    }
+    /* ftello accounts for data already read ahead by stdio */
+    inputOffset = ftello(pJob->input);
+    if(inputOffset < 0)
+    {
+        return(DataEngine_StdioCopy(pJob));
+    }
+    workers = calloc(pThreads, sizeof(PARALLEL_WORKER));
+    if(workers == NULL)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    for(i = 0; i < pThreads; i++)
+    {
+        workers[i].copy = &copy;
+        workers[i].buffer = DataEngine_AllocateBuffer(pJob->bufferSize);
+        if(workers[i].buffer == NULL)
+        {
+            ret = ERROR_MEMORY_ALLOCATION;
+        }
+    }
+    (void)pthread_mutex_init(&copy.lock, NULL);
+    (void)pthread_cond_init(&copy.completed, NULL);
+    copy.output = DataWriter_BlockDescriptor(writer);
+    outputOffset = lseek(copy.output, 0, SEEK_CUR);
+    direct = isDirect(copy.output);
+    /* Direct writes must start and end on block boundaries. Leave an unaligned
+       output to the stdio path, which stages it */
+    aligned = (outputOffset >= 0) &&
+              (!direct || (!(outputOffset % BUFFER_ALIGNMENT) && !(pJob->bufferSize % BUFFER_ALIGNMENT)));
+    while((ret == ERROR_NOERROR) && aligned)
+    {
+        unsigned long long copied = 0;
+        unsigned long long size = DataWriter_Space(writer);
+        if(size > (unsigned long long)(inputStat.st_size - inputOffset))
+        {
+            size = (unsigned long long)(inputStat.st_size - inputOffset);
+        }
+        if(direct)
+        {
+            size = size - (size % BUFFER_ALIGNMENT);
+        }
+        if(!size)
+        {
+            if(!DataWriter_Space(writer) && writer->rotate && (inputOffset < inputStat.st_size))
+            {
+                /* The segment is complete. Continue in the next one */
+                ret = DataWriter_Rotate(writer);
+                copy.output = DataWriter_BlockDescriptor(writer);
+                outputOffset = 0;
+                direct = isDirect(copy.output);
+                continue;
+            }
+            break;
+        }
+        ret = copySegment(&copy, workers, pThreads, inputOffset, outputOffset, size, &copied);
+        inputOffset = inputOffset + (off_t)copied;
+        outputOffset = outputOffset + (off_t)copied;
+        if(copied < size)
+        {
+            /* The input ended early */
+            break;
+        }
+    }
+    (void)pthread_cond_destroy(&copy.completed);
+    (void)pthread_mutex_destroy(&copy.lock);
+    for(i = 0; i < pThreads; i++)
+    {
+        DataEngine_FreeBuffer(workers[i].buffer);
+    }
+    free(workers);
+    /* Ranges read at different times only form a copy of an input that was not
+       rewritten meanwhile. Appended data is copied below */
+    if((ret == ERROR_NOERROR) && (fstat(copy.input, &finalStat) == 0) && (finalStat.st_size <= inputStat.st_size) &&
+       (modificationTime(&finalStat) != modificationTime(&inputStat)))
+    {
+        ret = ERROR_INCONSISTENT_COPY;
+    }
+    if((ret == ERROR_NOERROR) && aligned)
+    {
+        /* Position both streams after the copied data. The stdio path then copies
+           the rest and reports a reached size limit */
+        (void)fseeko(pJob->input, inputOffset, SEEK_SET);
+        (void)fseeko(writer->output, outputOffset, SEEK_SET);
+    }
+    if(ret == ERROR_NOERROR)
+    {
+        ret = DataEngine_StdioCopy(pJob);
+    }
+    return(ret);
+#else
+    /* pread and pwrite are not available on this platform */
+    (void)pThreads;
+    return(DataEngine_StdioCopy(pJob));
+#endif
+}
+#ifndef _WIN32
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : copySegment
+ * Inputs       : PARALLEL_COPY* pCopy - current copy
+ *                PARALLEL_WORKER* pWorkers - threads with their buffers
+ *                unsigned int pThreads - number of threads
+ *                off_t pInputOffset - first input byte to be copied
+ *                off_t pOutputOffset - its offset in the current segment
+ *                unsigned long long pSize - bytes to be copied. Fit in the segment
+ *                unsigned long long* pCopied - Loaded with the bytes committed
+ * Outputs      : returns -
+ *                ERROR_NOERROR - copy done. Fewer bytes than requested if the
+ *                                input ended early
+ *                ERROR_IO_FAILED - a read or write failed, or no thread started
+ *                ERROR_INCONSISTENT_COPY - the segment does not match the input
+ * Description  : Splits the data into ranges copied by the threads and commits
+ *                them in order on the calling thread. Data written past the
+ *                committed ranges is cut off, so the segment never holds a gap
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE copySegment(PARALLEL_COPY* pCopy, PARALLEL_WORKER* pWorkers, unsigned int pThreads,
+                              off_t pInputOffset, off_t pOutputOffset, unsigned long long pSize,
+                              unsigned long long* pCopied)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    DATA_WRITER* writer = pCopy->job->writer;
+    struct stat outputStat;
+    struct stat before;
+    struct stat after;
+    unsigned long long rangeSize;
+    unsigned int committed = 0;
+    unsigned int started = 0;
+    unsigned int i;
+    /* Enough ranges to keep every thread busy, in whole blocks */
+    rangeSize = (pSize + pThreads - 1) / pThreads;
+    rangeSize = ((rangeSize + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT) * BUFFER_ALIGNMENT;
+    if(rangeSize > PARALLEL_RANGE_SIZE)
+    {
+        rangeSize = PARALLEL_RANGE_SIZE;
+    }
+    pCopy->rangeCount = (unsigned int)((pSize + rangeSize - 1) / rangeSize);
+    pCopy->ranges = calloc(pCopy->rangeCount, sizeof(PARALLEL_RANGE));
+    if(pCopy->ranges == NULL)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    for(i = 0; i < pCopy->rangeCount; i++)
+    {
+        pCopy->ranges[i].inputOffset = pInputOffset + (off_t)(i * rangeSize);
+        pCopy->ranges[i].outputOffset = pOutputOffset + (off_t)(i * rangeSize);
+        pCopy->ranges[i].length = (i < (pCopy->rangeCount - 1)) ? rangeSize : pSize - (i * rangeSize);
+    }
+    /* Out of order writes would otherwise extend the file piecemeal */
+    DataWriter_Reserve(writer, pSize);
+    if(fstat(pCopy->input, &before) != 0)
+    {
+        free(pCopy->ranges);
+        pCopy->ranges = NULL;
+        return(ERROR_IO_FAILED);
+    }
+    atomic_store(&pCopy->next, 0);
+    atomic_store(&pCopy->stop, false);
+    pCopy->result = ERROR_NOERROR;
+    for(i = 0; (i < pThreads) && (i < pCopy->rangeCount); i++)
+    {
+        pWorkers[i].started = !pthread_create(&pWorkers[i].thread, NULL, copyThread, &pWorkers[i]);
+        started = started + (pWorkers[i].started ? 1 : 0);
+    }
+    *pCopied = 0;
+    pthread_mutex_lock(&pCopy->lock);
+    if(!started)
+    {
+        pCopy->result = ERROR_IO_FAILED;
+        atomic_store(&pCopy->stop, true);
+    }
+    /* Commit the ranges in input order as they complete */
+    while(committed < pCopy->rangeCount)
+    {
+        unsigned int completed = committed;
+        bool ended = false;
+        while((completed < pCopy->rangeCount) && pCopy->ranges[completed].done && !ended)
+        {
+            ended = (pCopy->ranges[completed].copied < pCopy->ranges[completed].length);
+            completed++;
+        }
+        if(completed == committed)
+        {
+            /* Ranges not taken before the copy stopped are never done */
+            if(atomic_load(&pCopy->stop) && (committed >= atomic_load(&pCopy->next)))
+            {
+                break;
+            }
+            pthread_cond_wait(&pCopy->completed, &pCopy->lock);
+            continue;
+        }
+        /* A commit may sync the output or save a checkpoint. The threads report
+           completed ranges meanwhile. Done ranges are not changed any more, the
+           writer is only used by this thread and records no read or write
+           statistics */
+        pthread_mutex_unlock(&pCopy->lock);
+        for(i = committed; i < completed; i++)
+        {
+            if(pCopy->ranges[i].copied)
+            {
+                DataWriter_Commit(writer, (unsigned int)pCopy->ranges[i].copied);
+            }
+            *pCopied = *pCopied + pCopy->ranges[i].copied;
+        }
+        pthread_mutex_lock(&pCopy->lock);
+        committed = completed;
+        if(ended)
+        {
+            break;
+        }
+    }
+    atomic_store(&pCopy->stop, true);
+    pthread_mutex_unlock(&pCopy->lock);
+    for(i = 0; (i < pThreads) && (i < pCopy->rangeCount); i++)
+    {
+        if(pWorkers[i].started)
+        {
+            pthread_join(pWorkers[i].thread, NULL);
+            pWorkers[i].started = false;
+        }
+    }
+    ret = pCopy->result;
+    if((ret == ERROR_NOERROR) && (*pCopied == pSize))
+    {
+        /* An input modified while the ranges were read may have given each range
+           another version. Only a full comparison shows the segment is a copy */
+        bool changed = (fstat(pCopy->input, &after) != 0) || !sameVersion(&before, &after);
+        if(!verifySegment(pCopy, pOutputOffset + (off_t)pSize, changed))
+        {
+            ret = ERROR_INCONSISTENT_COPY;
+        }
+    }
+    else if((fstat(pCopy->output, &outputStat) == 0) && (outputStat.st_size > (pOutputOffset + (off_t)*pCopied)))
+    {
+        /* Ranges after a failed or short one were written but not committed */
+        (void)ftruncate(pCopy->output, pOutputOffset + (off_t)*pCopied);
+    }
+    free(pCopy->ranges);
+    pCopy->ranges = NULL;
+    return(ret);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : copyThread
+ * Inputs       : void* pWorker - PARALLEL_WORKER of the thread
+ * Outputs      : returns -
+ *                NULL
+ * Description  : Copies ranges until none is left or the copy stopped
+ -----------------------------------------------------------------------------------*/
+static void* copyThread(void* pWorker)
+{
+    PARALLEL_WORKER* worker = (PARALLEL_WORKER*)pWorker;
+    PARALLEL_COPY* copy = worker->copy;
+    unsigned int index;
+    while(!atomic_load(&copy->stop) && ((index = atomic_fetch_add(&copy->next, 1)) < copy->rangeCount))
+    {
+        PARALLEL_RANGE* range = &copy->ranges[index];
+        ERROR_TYPE ret = copyRange(copy, range, worker->buffer);
+        pthread_mutex_lock(&copy->lock);
+        range->done = true;
+        if((ret != ERROR_NOERROR) || (range->copied < range->length))
+        {
+            if(copy->result == ERROR_NOERROR)
+            {
+                copy->result = ret;
+            }
+            atomic_store(&copy->stop, true);
+        }
+        pthread_cond_signal(&copy->completed);
+        pthread_mutex_unlock(&copy->lock);
+    }
+    return NULL;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : copyRange
+ * Inputs       : PARALLEL_COPY* pCopy - current copy
+ *                PARALLEL_RANGE* pRange - range to be copied. Its copied count is
+ *                                         loaded with the bytes written
+ *                char* pBuffer - buffer of the thread
+ * Outputs      : returns -
+ *                ERROR_NOERROR - range copied, or the input ended within it
+ *                ERROR_IO_FAILED - read or write failed
+ * Description  : Copies the range through the buffer of the thread, retrying
+ *                short and interrupted writes
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE copyRange(PARALLEL_COPY* pCopy, PARALLEL_RANGE* pRange, char* pBuffer)
+{
+    unsigned long long copied = 0;
+    ERROR_TYPE ret = ERROR_NOERROR;
+    while((copied < pRange->length) && (ret == ERROR_NOERROR))
+    {
+        size_t chunk = pCopy->job->bufferSize;
+        size_t written = 0;
+        unsigned long long start = DataStats_Now();
+        ssize_t result;
+        if(chunk > (pRange->length - copied))
+        {
+            chunk = (size_t)(pRange->length - copied);
+        }
+        result = pread(pCopy->input, pBuffer, chunk, pRange->inputOffset + (off_t)copied);
+        if(result < 0)
+        {
+            ret = (errno == EINTR) ? ERROR_NOERROR : ERROR_IO_FAILED;
+            continue;
+        }
+        if(result == 0)
+        {
+            /* The input shrank below the planned end */
+            break;
+        }
+        pthread_mutex_lock(&pCopy->lock);
+        DataStats_RecordRead(pCopy->job->stats, start, (unsigned long long)result);
+        pthread_mutex_unlock(&pCopy->lock);
+        start = DataStats_Now();
+        while(written < (size_t)result)
+        {
+            ssize_t part = pwrite(pCopy->output, pBuffer + written, (size_t)result - written,
+                                  pRange->outputOffset + (off_t)(copied + written));
+            if(part < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+                ret = ERROR_IO_FAILED;
+                break;
+            }
+            written = written + (size_t)part;
+        }
+        if(ret == ERROR_NOERROR)
+        {
+            pthread_mutex_lock(&pCopy->lock);
+            DataStats_RecordWrite(pCopy->job->stats, start, (unsigned long long)written);
+            pthread_mutex_unlock(&pCopy->lock);
+            copied = copied + written;
+        }
+    }
+    pRange->copied = copied;
+    return(ret);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : verifySegment
+ * Inputs       : PARALLEL_COPY* pCopy - copy whose ranges all completed
+ *                off_t pOutputEnd - planned end of the data in the segment
+ *                bool pFull - compare all data of the ranges
+ * Outputs      : True if the segment is consistent with the input. False otherwise
+ * Description  : The segment must end where planned, so no range wrote past its
+ *                end or was left out. Without pFull only the last block of every
+ *                range is read back and compared with the input. This sample
+ *                shows that no range landed at the wrong offset, but not that an
+ *                unchanged input was copied correctly elsewhere in a range. The
+ *                input is known to be unchanged from its modification and change
+ *                times, checked by the caller. With pFull, after the input
+ *                changed, every byte is compared
+ -----------------------------------------------------------------------------------*/
+static bool verifySegment(PARALLEL_COPY* pCopy, off_t pOutputEnd, bool pFull)
+{
+    struct stat outputStat;
+    bool consistent;
+    unsigned int i;
+    int check;
+    if((fstat(pCopy->output, &outputStat) != 0) || (outputStat.st_size != pOutputEnd))
+    {
+        return false;
+    }
+    /* The segment may be open for direct writes only */
+    check = open(pCopy->job->writer->fileName, O_RDONLY);
+    if(check < 0)
+    {
+        return false;
+    }
+    consistent = true;
+    for(i = 0; consistent && (i < pCopy->rangeCount); i++)
+    {
+        const PARALLEL_RANGE* range = &pCopy->ranges[i];
+        unsigned long long size = range->length;
+        if(!pFull && (size > BUFFER_ALIGNMENT))
+        {
+            size = BUFFER_ALIGNMENT;
+        }
+        consistent = compareRange(pCopy->input, check, range->inputOffset + (off_t)(range->length - size),
+                                  range->outputOffset + (off_t)(range->length - size), size);
+    }
+    close(check);
+    return consistent;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : compareRange
+ * Inputs       : int pInput - input descriptor
+ *                int pOutput - output descriptor open for reading
+ *                off_t pInputOffset - start of the data in the input
+ *                off_t pOutputOffset - start of its copy in the output
+ *                unsigned long long pLength - bytes to be compared
+ * Outputs      : True if both hold the same data. False otherwise or on failure
+ * Description  : Compares block by block
+ -----------------------------------------------------------------------------------*/
+static bool compareRange(int pInput, int pOutput, off_t pInputOffset, off_t pOutputOffset, unsigned long long pLength)
+{
+    char inputBlock[BUFFER_ALIGNMENT];
+    char outputBlock[BUFFER_ALIGNMENT];
+    unsigned long long compared = 0;
+    while(compared < pLength)
+    {
+        size_t size = ((pLength - compared) < BUFFER_ALIGNMENT) ? (size_t)(pLength - compared) : BUFFER_ALIGNMENT;
+        if((pread(pInput, inputBlock, size, pInputOffset + (off_t)compared) != (ssize_t)size) ||
+           (pread(pOutput, outputBlock, size, pOutputOffset + (off_t)compared) != (ssize_t)size) ||
+           memcmp(inputBlock, outputBlock, size))
+        {
+            return false;
+        }
+        compared = compared + size;
+    }
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : isDirect
+ * Inputs       : int pOutput - output descriptor
+ * Outputs      : True if writes to the descriptor bypass the page cache
+ * Description  :
+ -----------------------------------------------------------------------------------*/
+static bool isDirect(int pOutput)
+{
+#ifdef O_DIRECT
+    int flags = fcntl(pOutput, F_GETFL);
+    return((flags >= 0) && (flags & O_DIRECT));
+#else
+    (void)pOutput;
+    return false;
+#endif
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : modificationTime
+ * Inputs       : const struct stat* pStat - status of a file
+ * Outputs      : returns -
+ *                Modification time of the file in nanoseconds
+ * Description  :
+ -----------------------------------------------------------------------------------*/
+static unsigned long long modificationTime(const struct stat* pStat)
+{
+#ifdef __linux__
+    return((unsigned long long)pStat->st_mtim.tv_sec * 1000000000ULL + (unsigned long long)pStat->st_mtim.tv_nsec);
+#else
+    return((unsigned long long)pStat->st_mtime * 1000000000ULL);
+#endif
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : sameVersion
+ * Inputs       : const struct stat* pBefore - status of the input before a copy
+ *                const struct stat* pAfter - status of the input after it
+ * Outputs      : True if the input was not modified in between
+ * Description  : Compares the identity, size and the modification and change
+ *                times. Writes within one tick of the file system clock after
+ *                pBefore leave the times unchanged and are not seen
+ -----------------------------------------------------------------------------------*/
+static bool sameVersion(const struct stat* pBefore, const struct stat* pAfter)
+{
+#ifdef __linux__
+    bool sameChange = (pBefore->st_ctim.tv_sec == pAfter->st_ctim.tv_sec) &&
+                      (pBefore->st_ctim.tv_nsec == pAfter->st_ctim.tv_nsec);
+#else
+    bool sameChange = (pBefore->st_ctime == pAfter->st_ctime);
+#endif
+    return((pBefore->st_dev == pAfter->st_dev) && (pBefore->st_ino == pAfter->st_ino) &&
+           (pBefore->st_size == pAfter->st_size) && sameChange &&
+           (modificationTime(pBefore) == modificationTime(pAfter)));
+}
+#endif
+/*----------------------------------------------------------------------------------*/
@@ -0,0 +1,286 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include "DataPipeline.h"
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* One buffer of the ring */
+typedef struct
+{
+    char* data;
+    unsigned int size;
+} RING_SLOT;
+
+/* State shared by the reader and the writer thread */
+typedef struct
+{
+    ENGINE_JOB* job;
+    RING_SLOT* slots;
+    unsigned int slotCount;
+    unsigned int slotSize;
+    /* The counters never wrap. The slot count is not a power of two, so a wrapping
+       counter would map to a different slot than the one after it */
+    atomic_ullong head;         /* Slots filled by the reader. Written by reader only */
+    atomic_ullong tail;         /* Slots drained by the writer. Written by writer only */
+    atomic_bool done;           /* Reader reached the end of input */
+    atomic_bool abort;          /* Writer stopped. Reader must stop */
+    atomic_bool readerWaiting;  /* Reader is waiting for a free slot */
+    atomic_bool writerWaiting;  /* Writer is waiting for a filled slot */
+    pthread_mutex_t lock;       /* Only taken when one side has to wait */
+    pthread_cond_t wakeup;
+    PIPELINE_STATS stats;
+} PIPELINE;
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static void* readerThread(void* pPipeline);
+static bool waitForReader(PIPELINE* pPipeline);
+static bool waitForWriter(PIPELINE* pPipeline);
+static void wakeUp(PIPELINE* pPipeline, atomic_bool* pWaiting);
+static unsigned long long getMicroseconds(void);
+static bool allocateRing(PIPELINE* pPipeline, unsigned int pBufferSize, unsigned long long pMemory);
+static void freeRing(PIPELINE* pPipeline);
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataPipeline_Copy(ENGINE_JOB* pJob, unsigned long long pMemory, PIPELINE_STATS* pStats)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    PIPELINE pipeline;
+    pthread_t reader;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.job = pJob;
+    atomic_init(&pipeline.head, 0);
+    atomic_init(&pipeline.tail, 0);
+    atomic_init(&pipeline.done, false);
+    atomic_init(&pipeline.abort, false);
+    atomic_init(&pipeline.readerWaiting, false);
+    atomic_init(&pipeline.writerWaiting, false);
+    if(!allocateRing(&pipeline, pJob->bufferSize, pMemory))
+    {
+        freeRing(&pipeline);
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    (void)pthread_mutex_init(&pipeline.lock, NULL);
+    (void)pthread_cond_init(&pipeline.wakeup, NULL);
+    if(pthread_create(&reader, NULL, readerThread, &pipeline))
+    {
+        ret = ERROR_IO_FAILED;
+    }
+    else
+    {
+        /* The calling thread is the writer */
+        while(waitForReader(&pipeline))
+        {
+            unsigned long long tail = atomic_load(&pipeline.tail);
+            RING_SLOT* slot = &pipeline.slots[tail % pipeline.slotCount];
+            ret = DataWriter_Write(pJob->writer, slot->data, slot->size);
+            if(ret != ERROR_NOERROR)
+            {
+                /* Stop the reader. It finishes its current read before exiting */
+                atomic_store(&pipeline.abort, true);
+                wakeUp(&pipeline, &pipeline.readerWaiting);
+                break;
+            }
+            /* Hand the slot back to the reader */
+            atomic_store(&pipeline.tail, tail + 1);
+            wakeUp(&pipeline, &pipeline.readerWaiting);
+        }
+        (void)pthread_join(reader, NULL);
+    }
+    *pStats = pipeline.stats;
+    (void)pthread_cond_destroy(&pipeline.wakeup);
+    (void)pthread_mutex_destroy(&pipeline.lock);
+    freeRing(&pipeline);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : readerThread
+ * Inputs       : void* pPipeline - PIPELINE shared with the writer
+ * Outputs      : NULL
+ * Description  : Fills free slots of the ring from the input until end of input or
+ *                until the writer stops
+ -----------------------------------------------------------------------------------*/
+static void* readerThread(void* pPipeline)
+{
+    PIPELINE* pipeline = (PIPELINE*)pPipeline;
+    while(waitForWriter(pipeline))
+    {
+        unsigned long long head = atomic_load(&pipeline->head);
+        RING_SLOT* slot = &pipeline->slots[head % pipeline->slotCount];
+        slot->size = DataEngine_Read(pipeline->job, slot->data, pipeline->slotSize);
+        if(!slot->size)
+        {
+            /* File read completed */
+            break;
+        }
+        /* Publish the slot to the writer */
+        atomic_store(&pipeline->head, head + 1);
+        wakeUp(pipeline, &pipeline->writerWaiting);
+    }
+    atomic_store(&pipeline->done, true);
+    wakeUp(pipeline, &pipeline->writerWaiting);
+    return NULL;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : waitForReader
+ * Inputs       : PIPELINE* pPipeline - current pipeline
+ * Outputs      : True if a filled slot is available. False at end of input
+ * Description  : Called by the writer. Waits while the ring is empty. Each wait
+ *                is a writer stall, meaning the input is the bottleneck
+ -----------------------------------------------------------------------------------*/
+static bool waitForReader(PIPELINE* pPipeline)
+{
+    unsigned long long start;
+    if(atomic_load(&pPipeline->head) != atomic_load(&pPipeline->tail))
+    {
+        return true;
+    }
+    if(atomic_load(&pPipeline->done))
+    {
+        /* The reader may have published its last slot before finishing */
+        return(atomic_load(&pPipeline->head) != atomic_load(&pPipeline->tail));
+    }
+    pPipeline->stats.writerStalls++;
+    start = getMicroseconds();
+    pthread_mutex_lock(&pPipeline->lock);
+    atomic_store(&pPipeline->writerWaiting, true);
+    while((atomic_load(&pPipeline->head) == atomic_load(&pPipeline->tail)) && !atomic_load(&pPipeline->done))
+    {
+        pthread_cond_wait(&pPipeline->wakeup, &pPipeline->lock);
+    }
+    atomic_store(&pPipeline->writerWaiting, false);
+    pthread_mutex_unlock(&pPipeline->lock);
+    pPipeline->stats.writerStallTime += getMicroseconds() - start;
+    return(atomic_load(&pPipeline->head) != atomic_load(&pPipeline->tail));
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : waitForWriter
+ * Inputs       : PIPELINE* pPipeline - current pipeline
+ * Outputs      : True if a free slot is available. False if the writer stopped
+ * Description  : Called by the reader. Waits while the ring is full. Each wait is
+ *                a reader stall, meaning the output is the bottleneck
+ -----------------------------------------------------------------------------------*/
+static bool waitForWriter(PIPELINE* pPipeline)
+{
+    unsigned long long start;
+    if((atomic_load(&pPipeline->head) - atomic_load(&pPipeline->tail)) < pPipeline->slotCount)
+    {
+        return(!atomic_load(&pPipeline->abort));
+    }
+    pPipeline->stats.readerStalls++;
+    start = getMicroseconds();
+    pthread_mutex_lock(&pPipeline->lock);
+    atomic_store(&pPipeline->readerWaiting, true);
+    while(((atomic_load(&pPipeline->head) - atomic_load(&pPipeline->tail)) >= pPipeline->slotCount) &&
+          !atomic_load(&pPipeline->abort))
+    {
+        pthread_cond_wait(&pPipeline->wakeup, &pPipeline->lock);
+    }
+    atomic_store(&pPipeline->readerWaiting, false);
+    pthread_mutex_unlock(&pPipeline->lock);
+    pPipeline->stats.readerStallTime += getMicroseconds() - start;
+    return(!atomic_load(&pPipeline->abort));
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : wakeUp
+ * Inputs       : PIPELINE* pPipeline - current pipeline
+ *                atomic_bool* pWaiting - waiting flag of the other side
+ * Outputs      :
+ * Description  : Wakes the other side only if it is waiting. The waiting flag is
+ *                set before the ring is checked under the lock, and the index is
+ *                updated before the flag is read here, so no wake up is lost
+ -----------------------------------------------------------------------------------*/
+static void wakeUp(PIPELINE* pPipeline, atomic_bool* pWaiting)
+{
+    if(atomic_load(pWaiting))
+    {
+        pthread_mutex_lock(&pPipeline->lock);
+        pthread_cond_broadcast(&pPipeline->wakeup);
+        pthread_mutex_unlock(&pPipeline->lock);
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : getMicroseconds
+ * Inputs       :
+ * Outputs      : Monotonic time in microseconds
+ * Description  : Used to measure the stall time
+ -----------------------------------------------------------------------------------*/
+static unsigned long long getMicroseconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((unsigned long long)now.tv_sec * 1000000ULL + (unsigned long long)now.tv_nsec / 1000ULL);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : allocateRing
+ * Inputs       : PIPELINE* pPipeline - current pipeline
+ *                unsigned int pBufferSize - preferred slot size in bytes
+ *                unsigned long long pMemory - total memory of the ring in bytes
+ * Outputs      : True if all slots are allocated. False otherwise
+ * Description  : Splits the memory limit into slots of the I/O buffer size. When
+ *                the limit cannot hold MIN_PIPELINE_SLOTS buffers, the slots are
+ *                shrunk instead so that the limit is honoured
+ -----------------------------------------------------------------------------------*/
+static bool allocateRing(PIPELINE* pPipeline, unsigned int pBufferSize, unsigned long long pMemory)
+{
+    unsigned int i;
+    pPipeline->slotSize = pBufferSize;
+    if((pMemory / pBufferSize) < MIN_PIPELINE_SLOTS)
+    {
+        pPipeline->slotSize = (unsigned int)(pMemory / MIN_PIPELINE_SLOTS);
+        pPipeline->slotSize = pPipeline->slotSize - (pPipeline->slotSize % BUFFER_ALIGNMENT);
+        if(!pPipeline->slotSize)
+        {
+            pPipeline->slotSize = BUFFER_ALIGNMENT;
+        }
+    }
+    pPipeline->slotCount = (unsigned int)(pMemory / pPipeline->slotSize);
+    if(pPipeline->slotCount < MIN_PIPELINE_SLOTS)
+    {
+        pPipeline->slotCount = MIN_PIPELINE_SLOTS;
+    }
+    pPipeline->slots = calloc(pPipeline->slotCount, sizeof(RING_SLOT));
+    if(pPipeline->slots == NULL)
+    {
+        return false;
+    }
+    for(i = 0; i < pPipeline->slotCount; i++)
+    {
+        pPipeline->slots[i].data = DataEngine_AllocateBuffer(pPipeline->slotSize);
+        if(pPipeline->slots[i].data == NULL)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : freeRing
+ * Inputs       : PIPELINE* pPipeline - current pipeline
+ * Outputs      :
+ * Description  : Releases the slots allocated by allocateRing()
+ -----------------------------------------------------------------------------------*/
+static void freeRing(PIPELINE* pPipeline)
+{
+    unsigned int i;
+    if(pPipeline->slots != NULL)
+    {
+        for(i = 0; i < pPipeline->slotCount; i++)
+        {
+            if(pPipeline->slots[i].data != NULL)
+            {
+                DataEngine_FreeBuffer(pPipeline->slots[i].data);
+            }
+        }
+        free(pPipeline->slots);
+        pPipeline->slots = NULL;
+    }
+}
+/*----------------------------------------------------------------------------------*/
@@ -1,15 +1,49 @@
 /*----------------------------------------------------------------------------------*/
 /* Header includes */
 #include <string.h>
+#include <ctype.h>
 #include <time.h>
-#include <direct.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#define _getcwd getcwd
+#define _getpid getpid
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 #include "DataReader.h"
+#include "DataEngine.h"
+#include "DataWriter.h"
+#include "DataPipeline.h"
+#include "DataUring.h"
+#include "DataParallel.h"
+#include "DataCompress.h"
+#include "DataDedup.h"
+#include "DataFrame.h"
+#include "DataLines.h"
+#include "DataStats.h"
+#include "DataTee.h"
+#include "DataCheckpoint.h"
 
 /*----------------------------------------------------------------------------------*/
 /* Definitions */
 #define TIMESTAMP_LENGTH 64
-#define BUFFER_SIZE 1024
+#define SWITCH_ON "on"
+#define SWITCH_OFF "off"
+#define SWITCH_INDEX "index"
+#define DURABILITY_MILLISECONDS "ms"
+#define TIMESTAMP_DATE_FORMAT "%Y%m%d_%H%M%S"
+#define TIMESTAMP_UNIQUE_FORMAT "_%09ld_%lu_%lu_%u"
 
 /*----------------------------------------------------------------------------------*/
 /* Custom data types */
@@ -22,6 +56,20 @@ struct Args
     char* argDescription;
 };
 
+/* Maps the copy engine and the engine name */
+struct Engines
+{
+    ENGINE_TYPE engineId;
+    char* engineName;
+};
+
+/* Maps the named durability policies to their type */
+struct Durabilities
+{
+    DURABILITY_TYPE durabilityId;
+    char* durabilityName;
+};
+
 /* Maps the error to a description */
 struct Errors
 {
@@ -32,9 +80,25 @@ struct Errors
 /* Command line argument list */
 const struct Args argument_list[ARGUMENT_MAX] =
 {
-    {ARGUMENT_PATH, "-p", ": Path to store the file (absolute paths only)"},
+    {ARGUMENT_PATH, "-p", ": Path to store the file (absolute paths only). Up to 4 paths separated by ':' (';' on Windows) get a copy each"},
     {ARGUMENT_FILENAME, "-n", ": File Name prefix to use" },
-    {ARGUMENT_MAXFILESIZE, "-s", ": Maximum size limit for output file (in KB)" },
+    {ARGUMENT_MAXFILESIZE, "-s", ": Maximum size limit for output file (in KB, or with K/M/G/T suffix)" },
+    {ARGUMENT_BUFFERSIZE, "-b", ": I/O buffer size (in KB, or with K/M suffix)" },
+    {ARGUMENT_FLUSHINTERVAL, "-f", ": Flush output after every N KB written (0 - flush on close only)" },
+    {ARGUMENT_ENGINE, "-e", ": Copy engine to use (stdio, kernel, mmap, pipeline, uring, parallel)" },
+    {ARGUMENT_ROTATE, "-r", ": Rotate to a new output file when the size limit is reached (on, off)" },
+    {ARGUMENT_PIPELINEMEMORY, "-m", ": Memory used by the pipeline engine buffers (in KB, or with K/M/G suffix)" },
+    {ARGUMENT_QUEUEDEPTH, "-q", ": Requests kept in flight by the uring engine, threads of the parallel engine (1 - 64)" },
+    {ARGUMENT_DIRECTIO, "-d", ": Write the output with direct I/O, bypassing the page cache (on, off)" },
+    {ARGUMENT_COMPRESS, "-z", ": Compress the output in blocks on all cores (on, off)" },
+    {ARGUMENT_CHECKSUM, "-k", ": Record CRC32C checksums of every output file in a .crc sidecar (on, off)" },
+    {ARGUMENT_DEDUP, "-u", ": Store the captures as deduplicated chunks and a .rcp recipe (on, off)" },
+    {ARGUMENT_FRAMING, "-t", ": Write the output as records with a header and a footer index (on, off)" },
+    {ARGUMENT_LINES, "-w", ": End every output file on a line boundary, with an optional .idx line index (on, off, index)" },
+    {ARGUMENT_STATSFILE, "-g", ": Append the statistics of every capture as a JSON line to a file" },
+    {ARGUMENT_PREALLOCATE, "-a", ": Reserve the space of every output file up front and release the rest on close (on, off)" },
+    {ARGUMENT_DURABILITY, "-y", ": Sync the output to the device (none, close, group, every N KB or with K/M/G suffix, every N ms)" },
+    {ARGUMENT_CHECKPOINT, "-C", ": Save a checkpoint of every file capture and continue it from there when run again (on, off)" },
     {ARGUMENT_HELP, "-help", ": Prints the help instructions"}
 };
 
@@ -45,28 +109,178 @@ const struct Errors error_list[ERROR_MAX] =
     {ERROR_INVALIDARG, "Invalid Arguments"},
     {ERROR_PATHTOOLONG, "Path exceeds max length"},
     {ERROR_INVALIDFILESIZE, "Max output file size limit is invalid"},
+    {ERROR_INVALIDBUFFERSIZE, "I/O buffer size is invalid"},
+    {ERROR_INVALIDFLUSHINTERVAL, "Flush interval is invalid"},
+    {ERROR_MEMORY_ALLOCATION, "Unable to allocate memory"},
+    {ERROR_INVALIDENGINE, "Copy engine is invalid"},
+    {ERROR_IO_FAILED, "Read or write failed during the copy"},
+    {ERROR_INVALIDROTATION, "Rotation mode is invalid"},
+    {ERROR_INVALIDPIPELINEMEMORY, "Pipeline memory limit is invalid"},
+    {ERROR_INVALIDQUEUEDEPTH, "Queue depth is invalid"},
+    {ERROR_INVALIDDIRECTIO, "Direct I/O mode is invalid"},
+    {ERROR_INVALIDCOMPRESSION, "Compression mode is invalid"},
+    {ERROR_INVALIDCHECKSUM, "Checksum mode is invalid"},
+    {ERROR_INVALIDDEDUP, "Deduplication mode is invalid"},
+    {ERROR_INVALIDFRAMING, "Framing mode is invalid"},
+    {ERROR_INVALIDLINES, "Line mode is invalid"},
+    {ERROR_INVALIDPREALLOCATION, "Preallocation mode is invalid"},
+    {ERROR_INVALIDDURABILITY, "Durability policy is invalid"},
+    {ERROR_INVALIDDESTINATIONS, "Output directories are invalid or cannot be combined with the configured mode"},
+    {ERROR_INVALIDCHECKPOINT, "Checkpoint mode is invalid or cannot be combined with the configured mode"},
     {ERROR_READ_FILEOPEN, "Unable to open file for read"},
     {ERROR_WRITE_FILEOPEN, "Unable to open file for write"},
     {ERROR_FILE_SIZELIMIT_REACHED, "Maximum output file size has been reached"},
+    {ERROR_CHECKSUM_MISMATCH, "File does not match its checksums"},
+    {ERROR_DESTINATION_STALLED, "Output directory fell behind the others and was dropped"},
+    {ERROR_INCONSISTENT_COPY, "Output does not match the input after a parallel copy. The input may have changed"},
     {ERROR_HELP_INVOKED, "Program help requested"},
     {ERROR_UNKNOWN, "Unknown error"}
 };
+
+/* Copy engine list */
+const struct Engines engine_list[ENGINE_MAX] =
+{
+    {ENGINE_STDIO, "stdio"},
+    {ENGINE_KERNEL, "kernel"},
+    {ENGINE_MMAP, "mmap"},
+    {ENGINE_PIPELINE, "pipeline"},
+    {ENGINE_URING, "uring"},
+    {ENGINE_PARALLEL, "parallel"}
+};
+
+/* Durability policies selected by name. The interval policies are given as a size
+   or a time */
+const struct Durabilities durability_list[] =
+{
+    {DURABILITY_NONE, "none"},
+    {DURABILITY_CLOSE, "close"},
+    {DURABILITY_GROUP, "group"}
+};
+/* Configuration and results of independent captures */
+struct DATA_READER_CONTEXT
+{
+    char writePath[MAX_FILEPATH_LENGTH];
+    char mirrorPath[MAX_DESTINATIONS - 1][MAX_FILEPATH_LENGTH];    /* Directories after the first one */
+    unsigned int mirrors;
+    TEE_STATS teeStats;
+    char writeFilePrefix[MAX_FILEPATH_LENGTH];
+    unsigned long long maxOutputFileSize;
+    unsigned int bufferSize;
+    unsigned long long flushInterval;
+    ENGINE_TYPE engine;
+    bool rotate;
+    unsigned long long pipelineMemory;
+    PIPELINE_STATS pipelineStats;
+    unsigned int queueDepth;
+    bool directIo;
+    bool compress;
+    COMPRESS_STATS compressStats;
+    bool checksum;
+    bool dedup;
+    DEDUP_STATS dedupStats;
+    bool framing;
+    bool lines;
+    bool lineIndex;
+    char statsFile[MAX_FILEPATH_LENGTH];
+    CAPTURE_STATS captureStats;
+    bool preallocate;
+    DURABILITY_TYPE durability;
+    unsigned long long syncInterval;    /* Bytes or milliseconds between two syncs */
+    bool checkpoint;
+    unsigned long long resumed;         /* Input bytes the last capture took from a checkpoint */
+    pthread_mutex_t lock;       /* Guards the defaults applied on the first capture and the stats */
+};
+
+/* Naming state of a single capture, handed to the writer for its segments */
+typedef struct
+{
+    DATA_READER_CONTEXT* context;
+    const char* writePath;      /* Directory of the output */
+    char timeStamp[TIMESTAMP_LENGTH];
+} CAPTURE_NAME;
+
+/* Checkpoint of a running file capture, saved as its writer progresses */
+typedef struct
+{
+    char path[MAX_FILEPATH_LENGTH];
+    CHECKPOINT checkpoint;
+    FILE* input;
+    unsigned long long base;            /* Input offset the writer started at */
+    const CAPTURE_NAME* name;
+} CAPTURE_CHECKPOINT;
+
+/* Capture fed by the caller. Lives on the heap, the writer refers to its name */
+struct DATA_READER_STREAM
+{
+    DATA_READER_CONTEXT* context;
+    CAPTURE_NAME name;
+    DATA_WRITER writer;
+    CAPTURE_STATS stats;
+    char output[MAX_FILEPATH_LENGTH];   /* First output file */
+    ERROR_TYPE result;                  /* First error of the stream */
+};
 /*----------------------------------------------------------------------------------*/
 /* Static variables */
-static char fl_WritePath[MAX_FILEPATH_LENGTH] = { NULL_CHARACTER };
-static char fl_WriteFilePrefix[MAX_FILEPATH_LENGTH] = { NULL_CHARACTER };
-static unsigned int fl_MaxOutputFileSize = 0;
+/* Default context used by the functions without a context argument */
+static DATA_READER_CONTEXT fl_Context = { .lock = PTHREAD_MUTEX_INITIALIZER };
+static atomic_uint fl_CaptureSequence = 0;
 /*----------------------------------------------------------------------------------*/
 /* Local function declarations */
 static ARGUMENT_TYPE findArgument(const char* pString);
-static bool initializeWritePath(const char* pWritePath, unsigned int pSize);
-static bool initializeWriteFilePrefix(const char* pWriteFilePrefix, unsigned int pSize);
-static bool initializeOutputFileSizeLimit(const char* pSize);
-static bool defineWriteFile(char* pWriteFile, unsigned int pSize);
+static ERROR_TYPE initializeWritePath(DATA_READER_CONTEXT* pContext, const char* pWritePaths);
+static bool copyWritePath(char* pPath, unsigned int pPathSize, const char* pWritePath, unsigned int pSize);
+static bool initializeWriteFilePrefix(DATA_READER_CONTEXT* pContext, const char* pWriteFilePrefix, unsigned int pSize);
+static bool initializeOutputFileSizeLimit(DATA_READER_CONTEXT* pContext, const char* pSize);
+static bool initializeBufferSize(DATA_READER_CONTEXT* pContext, const char* pSize);
+static bool initializeFlushInterval(DATA_READER_CONTEXT* pContext, const char* pInterval);
+static bool initializeEngine(DATA_READER_CONTEXT* pContext, const char* pEngine);
+static bool initializeRotation(DATA_READER_CONTEXT* pContext, const char* pRotation);
+static bool initializePipelineMemory(DATA_READER_CONTEXT* pContext, const char* pMemory);
+static bool initializeQueueDepth(DATA_READER_CONTEXT* pContext, const char* pDepth);
+static bool initializeDirectIo(DATA_READER_CONTEXT* pContext, const char* pDirectIo);
+static bool initializeCompression(DATA_READER_CONTEXT* pContext, const char* pCompression);
+static bool initializeChecksum(DATA_READER_CONTEXT* pContext, const char* pChecksum);
+static bool initializeDedup(DATA_READER_CONTEXT* pContext, const char* pDedup);
+static bool initializeFraming(DATA_READER_CONTEXT* pContext, const char* pFraming);
+static bool initializeLines(DATA_READER_CONTEXT* pContext, const char* pLines);
+static bool initializeStatsFile(DATA_READER_CONTEXT* pContext, const char* pStatsFile);
+static bool initializePreallocation(DATA_READER_CONTEXT* pContext, const char* pPreallocation);
+static bool initializeDurability(DATA_READER_CONTEXT* pContext, const char* pDurability);
+static bool initializeCheckpoint(DATA_READER_CONTEXT* pContext, const char* pCheckpoint);
+static bool parseSwitch(const char* pString, bool* pValue);
+static bool parseSize(const char* pString, unsigned long long* pBytes);
+static bool applyDefaults(DATA_READER_CONTEXT* pContext);
+static bool defineWriteFile(void* pCapture, char* pWriteFile, unsigned int pSize, unsigned int pSegment);
+static bool formatWriteFile(const CAPTURE_NAME* pCapture, char* pWriteFile, unsigned int pSize, unsigned int pSegment);
+static ERROR_TYPE copyToDestinations(DATA_READER_CONTEXT* pContext, ENGINE_JOB* pJob, const CAPTURE_NAME* pName,
+                                     unsigned long long pInputSize);
+static void saveCheckpoint(void* pCheckpoint, const DATA_WRITER* pWriter);
+static void returnWriteFile(char* pWriteFile, int pSize, const char* pPath);
 static void getTimeStamp(char* pTimeStamp);
+static unsigned long getThreadId(void);
+static unsigned long long getInputSize(FILE* pInput);
 /*----------------------------------------------------------------------------------*/
 /* Extern function definitions */
-ERROR_TYPE DataReader_ParseArguments(int pArgc, char* pArgv[])
+DATA_READER_CONTEXT* DataReader_ContextCreate(void)
+{
+    DATA_READER_CONTEXT* context = calloc(1, sizeof(DATA_READER_CONTEXT));
+    if(context != NULL)
+    {
+        (void)pthread_mutex_init(&context->lock, NULL);
+    }
+    return context;
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_ContextDestroy(DATA_READER_CONTEXT* pContext)
+{
+    if(pContext != NULL)
+    {
+        (void)pthread_mutex_destroy(&pContext->lock);
+        free(pContext);
+    }
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataReader_ContextParseArguments(DATA_READER_CONTEXT* pContext, int pArgc, char* pArgv[])
 {
     ERROR_TYPE ret = ERROR_NOERROR;
     /* Check for passed arguments */
@@ -78,33 +292,149 @@ ERROR_TYPE DataReader_ParseArguments(int pArgc, char* pArgv[])
             switch(findArgument(pArgv[i]))
             {
             case ARGUMENT_FILENAME:
-                if(!initializeWriteFilePrefix(pArgv[i + 1], strlen(pArgv[i + 1])))
+                if(!initializeWriteFilePrefix(pContext, pArgv[i + 1], strlen(pArgv[i + 1])))
                 {
                     ret = ERROR_PATHTOOLONG;
                 }
                 break;
 
             case ARGUMENT_PATH:
-                if(!initializeWritePath(pArgv[i + 1], strlen(pArgv[i + 1])))
+            {
+                /* A list of directories fails for its length or for its entries */
+                ERROR_TYPE pathResult = initializeWritePath(pContext, pArgv[i + 1]);
+                if(pathResult != ERROR_NOERROR)
                 {
-                    ret = ERROR_PATHTOOLONG;
+                    ret = pathResult;
                 }
                 break;
+            }
 
             case ARGUMENT_MAXFILESIZE:
-                if(!initializeOutputFileSizeLimit(pArgv[i + 1]))
+                if(!initializeOutputFileSizeLimit(pContext, pArgv[i + 1]))
                 {
                     ret = ERROR_INVALIDFILESIZE;
                 }
                 break;
 
+            case ARGUMENT_BUFFERSIZE:
+                if(!initializeBufferSize(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDBUFFERSIZE;
+                }
+                break;
+
+            case ARGUMENT_FLUSHINTERVAL:
+                if(!initializeFlushInterval(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDFLUSHINTERVAL;
+                }
+                break;
+
+            case ARGUMENT_ENGINE:
+                if(!initializeEngine(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDENGINE;
+                }
+                break;
+
+            case ARGUMENT_ROTATE:
+                if(!initializeRotation(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDROTATION;
+                }
+                break;
+
+            case ARGUMENT_PIPELINEMEMORY:
+                if(!initializePipelineMemory(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDPIPELINEMEMORY;
+                }
+                break;
+
+            case ARGUMENT_QUEUEDEPTH:
+                if(!initializeQueueDepth(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDQUEUEDEPTH;
+                }
+                break;
+
+            case ARGUMENT_DIRECTIO:
+                if(!initializeDirectIo(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDDIRECTIO;
+                }
+                break;
+
+            case ARGUMENT_COMPRESS:
+                if(!initializeCompression(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDCOMPRESSION;
+                }
+                break;
+
+            case ARGUMENT_CHECKSUM:
+                if(!initializeChecksum(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDCHECKSUM;
+                }
+                break;
+
+            case ARGUMENT_DEDUP:
+                if(!initializeDedup(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDDEDUP;
+                }
+                break;
+
+            case ARGUMENT_FRAMING:
+                if(!initializeFraming(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDFRAMING;
+                }
+                break;
+
+            case ARGUMENT_LINES:
+                if(!initializeLines(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDLINES;
+                }
+                break;
+
+            case ARGUMENT_STATSFILE:
+                if(!initializeStatsFile(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_PATHTOOLONG;
+                }
+                break;
+
+            case ARGUMENT_PREALLOCATE:
+                if(!initializePreallocation(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDPREALLOCATION;
+                }
+                break;
+
+            case ARGUMENT_DURABILITY:
+                if(!initializeDurability(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDDURABILITY;
+                }
+                break;
+
+            case ARGUMENT_CHECKPOINT:
+                if(!initializeCheckpoint(pContext, pArgv[i + 1]))
+                {
+                    ret = ERROR_INVALIDCHECKPOINT;
+                }
+                break;
+
             case ARGUMENT_HELP:
                 return(ERROR_HELP_INVOKED);
                 break;
 
             default:
                 /* Reset all config for an invalid argument */
-                DataReader_ResetArguments();
+                DataReader_ContextResetArguments(pContext);
                 return(ERROR_INVALIDARG);
                 break;
             }
@@ -113,19 +443,41 @@ ERROR_TYPE DataReader_ParseArguments(int pArgc, char* pArgv[])
     return ret;
 }
 /*----------------------------------------------------------------------------------*/
-ERROR_TYPE DataReader_ReadData(const char* pReadFile, char* pWriteFile, int pSize)
+ERROR_TYPE DataReader_ContextReadData(DATA_READER_CONTEXT* pContext, const char* pReadFile,
+                                      char* pWriteFile, int pSize)
 {
-    FILE* output;
+    DATA_WRITER writer;
+    CAPTURE_STATS captureStats;
     FILE* input;
     char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    CAPTURE_NAME name = { pContext, pContext->writePath, { NULL_CHARACTER } };
+    CAPTURE_CHECKPOINT checkpoint;
+    CHECKPOINT saved;
+    unsigned long long segmentSize = 0;
+    bool checkpointed = false;
+    bool resuming = false;
     ERROR_TYPE ret = ERROR_NOERROR;
     /* Determine the output file with full path */
-    if(!defineWriteFile(writeFile, sizeof(writeFile)))
+    if(!applyDefaults(pContext) || !defineWriteFile(&name, writeFile, sizeof(writeFile), 0))
     {
         pWriteFile = '\0';
         /* Fatal error. Return immediately */
         return(ERROR_PATHTOOLONG);
     }
+    /* Copies in other directories are written as read. The modes transforming
+       the data keep state of their own per output */
+    if(pContext->mirrors && (pContext->dedup || pContext->compress || pContext->framing || pContext->lines))
+    {
+        /* Fatal error. Return immediately */
+        return(ERROR_INVALIDDESTINATIONS);
+    }
+    /* A checkpoint describes a single plain copy of the input */
+    if(pContext->checkpoint && (pContext->mirrors || pContext->dedup || pContext->compress || pContext->framing ||
+                                pContext->lines || pContext->checksum))
+    {
+        /* Fatal error. Return immediately */
+        return(ERROR_INVALIDCHECKPOINT);
+    }
     /* Open the input file to read if provided */
     if(strlen(pReadFile))
     {
@@ -140,48 +492,202 @@ ERROR_TYPE DataReader_ReadData(const char* pReadFile, char* pWriteFile, int pSiz
     {
         input = stdin;
     }
+    /* Only files can be identified and read again from an offset */
+    if(pContext->checkpoint && (input != stdin) && DataCheckpoint_Identify(input, pReadFile, &checkpoint.checkpoint) &&
+       DataCheckpoint_Path(pContext->writePath, pContext->writeFilePrefix, pReadFile, checkpoint.path,
+                           sizeof(checkpoint.path)))
+    {
+        checkpointed = true;
+        if(DataCheckpoint_Load(checkpoint.path, &saved) == ERROR_NOERROR)
+        {
+            /* The earlier capture names the files that follow its output */
+            CAPTURE_NAME previous = name;
+            strcpy(previous.timeStamp, saved.stamp);
+            if(DataCheckpoint_Resume(&saved, &checkpoint.checkpoint, input, defineWriteFile, &previous, &segmentSize))
+            {
+                name = previous;
+                resuming = true;
+                strcpy(writeFile, saved.output);
+            }
+        }
+    }
+    DataStats_Start(&captureStats);
     /* Open the output file for writing
-       Note: Since time stamps are unique, the possibility of file overwrite is not considered
+       Note: Output files are created exclusively. An existing file is never overwritten
     */
-    output = fopen(writeFile, "wb");
-    if(output == NULL)
+    if(resuming)
+    {
+        /* Only the part of the output up to the checkpoint is kept */
+        ret = DataWriter_Resume(&writer, writeFile, saved.segment, segmentSize, defineWriteFile, &name,
+                                pContext->maxOutputFileSize, pContext->flushInterval, pContext->rotate,
+                                pContext->directIo);
+    }
+    else if(pContext->dedup)
+    {
+        /* The size limit applies to the captured data, not to its recipe */
+        ret = DataWriter_Open(&writer, writeFile, defineWriteFile, &name, ULLONG_MAX, pContext->flushInterval,
+                              false, pContext->directIo, pContext->checksum);
+    }
+    else
+    {
+        ret = DataWriter_Open(&writer, writeFile, defineWriteFile, &name, pContext->maxOutputFileSize,
+                              pContext->flushInterval, pContext->rotate, pContext->directIo, pContext->checksum);
+    }
+    /* The writer renames the output if the name was taken */
+    strcpy(writeFile, writer.fileName);
+    if(ret != ERROR_NOERROR)
     {
-        strncpy(pWriteFile, writeFile, strlen(writeFile) < pSize ? strlen(writeFile) : pSize);
+        returnWriteFile(pWriteFile, pSize, writeFile);
+        if(input != stdin)
+        {
+            fclose(input);
+        }
         /* Fatal error. Return immediately */
-        return(ERROR_WRITE_FILEOPEN);
+        return(ret);
     }
     else
     {
-        unsigned int currentFileSize = 0;
-        bool running = true;
-        /* Read until end of input */
-        while(running)
+        ENGINE_JOB job;
+        PIPELINE_STATS stats;
+        ENGINE_TYPE engine = pContext->engine;
+        ERROR_TYPE closed;
+        memset(&job, 0, sizeof(job));
+        job.input = input;
+        job.writer = &writer;
+        job.bufferSize = pContext->bufferSize;
+        job.stats = &captureStats;
+        writer.stats = &captureStats;
+        /* A recipe is much smaller than the input it describes */
+        if(pContext->preallocate && !pContext->dedup)
+        {
+            unsigned long long inputSize = getInputSize(input);
+            DataWriter_Preallocate(&writer, (resuming && (inputSize != WRITER_SIZE_UNKNOWN)) ?
+                                   inputSize - (saved.segmentStart + segmentSize) : inputSize);
+        }
+        if(checkpointed)
         {
-            char readChar[BUFFER_SIZE];
-            unsigned int readSize = fread(&readChar, sizeof(char), BUFFER_SIZE, input);
-            if(currentFileSize <= (fl_MaxOutputFileSize - readSize))
+            checkpoint.input = input;
+            checkpoint.base = resuming ? saved.segmentStart + segmentSize : 0;
+            checkpoint.name = &name;
+            DataWriter_SetProgress(&writer, saveCheckpoint, &checkpoint, CHECKPOINT_INTERVAL);
+            /* The output is named before any data is written to it */
+            saveCheckpoint(&checkpoint, &writer);
+            /* The uring engine completes writes out of order. A checkpoint may
+               only cover data written in sequence */
+            if(engine == ENGINE_URING)
             {
-                currentFileSize = currentFileSize + readSize;
-                if(readSize)
-                {
-                    /* Write data to file */
-                    fwrite(&readChar, sizeof(char), readSize, output);
-                    fflush(output);
-                }
-                else
-                {
-                    /* File read completed */
-                    running = false;
-                }
+                engine = ENGINE_KERNEL;
+            }
+        }
+        DataWriter_SetDurability(&writer, pContext->durability, (pContext->durability == DURABILITY_TIME) ?
+                                 pContext->syncInterval * 1000000ULL : pContext->syncInterval);
+        if(pContext->mirrors)
+        {
+            /* Every directory is written from the same buffers whatever the engine */
+            ret = copyToDestinations(pContext, &job, &name, getInputSize(input));
+        }
+        else if(pContext->dedup)
+        {
+            /* Chunks are stored next to the recipes. Without rotation the capture
+               stops at the size limit */
+            char store[MAX_FILEPATH_LENGTH + sizeof(DEDUP_STORE_DIRECTORY)];
+            DEDUP_STATS dedupStats;
+            sprintf(store, "%s%s", pContext->writePath, DEDUP_STORE_DIRECTORY);
+            ret = DataDedup_Copy(&job, store, pContext->rotate ? 0 : pContext->maxOutputFileSize, &dedupStats);
+            pthread_mutex_lock(&pContext->lock);
+            pContext->dedupStats = dedupStats;
+            pthread_mutex_unlock(&pContext->lock);
+        }
+        else if(pContext->compress)
+        {
+            /* Compression reads the input in user space blocks whatever the engine */
+            COMPRESS_STATS compressStats;
+            ret = DataCompress_Copy(&job, DataEngine_GetCoreCount(), &compressStats);
+            pthread_mutex_lock(&pContext->lock);
+            pContext->compressStats = compressStats;
+            pthread_mutex_unlock(&pContext->lock);
+        }
+        else if(pContext->framing)
+        {
+            /* Records are framed in user space whatever the engine */
+            ret = DataFrame_Copy(&job, strlen(pReadFile) ? pReadFile : FRAME_STDIN_SOURCE);
+        }
+        else if(pContext->lines)
+        {
+            /* Line boundaries are found in user space whatever the engine */
+            ret = DataLines_Copy(&job, pContext->lineIndex);
+        }
+        else
+        {
+            /* Checksums need the data in user space and in order. Engines copying
+               inside the kernel or out of order are replaced by the stdio engine */
+            if(pContext->checksum && ((engine == ENGINE_KERNEL) || (engine == ENGINE_URING) ||
+                                      (engine == ENGINE_PARALLEL)))
+            {
+                engine = ENGINE_STDIO;
+            }
+            /* Copy the data with the configured engine */
+            switch(engine)
+            {
+            case ENGINE_KERNEL:
+                ret = DataEngine_KernelCopy(&job);
+                break;
+
+            case ENGINE_MMAP:
+                ret = DataEngine_MmapCopy(&job);
+                break;
+
+            case ENGINE_PIPELINE:
+                ret = DataPipeline_Copy(&job, pContext->pipelineMemory, &stats);
+                pthread_mutex_lock(&pContext->lock);
+                pContext->pipelineStats = stats;
+                pthread_mutex_unlock(&pContext->lock);
+                break;
+
+            case ENGINE_URING:
+                ret = DataUring_Copy(&job, pContext->queueDepth);
+                break;
+
+            case ENGINE_PARALLEL:
+                /* One thread per request kept in flight */
+                ret = DataParallel_Copy(&job, pContext->queueDepth);
+                break;
+
+            default:
+                ret = DataEngine_StdioCopy(&job);
+                break;
             }
-            else
+        }
+        closed = DataWriter_Close(&writer);
+        if(ret == ERROR_NOERROR)
+        {
+            ret = closed;
+        }
+        if(checkpointed)
+        {
+            /* Data read after the last one is on disk now */
+            saveCheckpoint(&checkpoint, &writer);
+        }
+        if(pContext->mirrors && (closed != ERROR_NOERROR))
+        {
+            pthread_mutex_lock(&pContext->lock);
+            if(pContext->teeStats.destination[0].result == ERROR_NOERROR)
             {
-                /* File size limit reached. Stop reading */
-                ret = ERROR_FILE_SIZELIMIT_REACHED;
-                running = false;
+                pContext->teeStats.destination[0].result = closed;
             }
+            pthread_mutex_unlock(&pContext->lock);
+        }
+        /* A trailing segment left empty by rotation has been removed */
+        DataStats_Finish(&captureStats, writer.segment + ((writer.segment && !writer.segmentSize) ? 0 : 1));
+        pthread_mutex_lock(&pContext->lock);
+        pContext->captureStats = captureStats;
+        pContext->resumed = resuming ? checkpoint.base : 0;
+        pthread_mutex_unlock(&pContext->lock);
+        if(strlen(pContext->statsFile))
+        {
+            /* Statistics never fail the capture they describe */
+            (void)DataStats_Append(&captureStats, pContext->statsFile, writeFile, ret);
         }
-        fclose(output);
         /* Do not close stdin */
         if(input != stdin)
         {
@@ -189,149 +695,961 @@ ERROR_TYPE DataReader_ReadData(const char* pReadFile, char* pWriteFile, int pSiz
         }
     }
     /* Save the generated write file path to the passed buffer */
-    strncpy(pWriteFile, writeFile, strlen(writeFile) < pSize ? strlen(writeFile) : pSize);
+    returnWriteFile(pWriteFile, pSize, writeFile);
     return(ret);
 }
 /*----------------------------------------------------------------------------------*/
-const unsigned int DataReader_GetMaxOutputFileSize(void)
+ERROR_TYPE DataReader_ContextOpenStream(DATA_READER_CONTEXT* pContext, DATA_READER_STREAM** pStream,
+                                        char* pWriteFile, int pSize)
 {
-    return fl_MaxOutputFileSize / 1024;
+    DATA_READER_STREAM* stream;
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE ret;
+    *pStream = NULL;
+    /* Streams are written as handed over. The other modes read the input themselves */
+    if(pContext->mirrors || pContext->dedup || pContext->compress || pContext->framing || pContext->lines)
+    {
+        return(ERROR_INVALIDARG);
+    }
+    stream = calloc(1, sizeof(DATA_READER_STREAM));
+    if(stream == NULL)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    stream->context = pContext;
+    stream->name.context = pContext;
+    stream->name.writePath = pContext->writePath;
+    if(!applyDefaults(pContext) || !defineWriteFile(&stream->name, writeFile, sizeof(writeFile), 0))
+    {
+        free(stream);
+        return(ERROR_PATHTOOLONG);
+    }
+    DataStats_Start(&stream->stats);
+    ret = DataWriter_Open(&stream->writer, writeFile, defineWriteFile, &stream->name, pContext->maxOutputFileSize,
+                          pContext->flushInterval, pContext->rotate, pContext->directIo, pContext->checksum);
+    /* The writer renames the output if the name was taken */
+    returnWriteFile(pWriteFile, pSize, stream->writer.fileName);
+    if(ret != ERROR_NOERROR)
+    {
+        free(stream);
+        return(ret);
+    }
+    strcpy(stream->output, stream->writer.fileName);
+    stream->writer.stats = &stream->stats;
+    if(pContext->preallocate)
+    {
+        DataWriter_Preallocate(&stream->writer, WRITER_SIZE_UNKNOWN);
+    }
+    DataWriter_SetDurability(&stream->writer, pContext->durability, (pContext->durability == DURABILITY_TIME) ?
+                             pContext->syncInterval * 1000000ULL : pContext->syncInterval);
+    *pStream = stream;
+    return(ERROR_NOERROR);
 }
 /*----------------------------------------------------------------------------------*/
-const char* DataReader_GetWriteFilePath(void)
+ERROR_TYPE DataReader_StreamWrite(DATA_READER_STREAM* pStream, const char* pData, unsigned int pSize)
 {
-    return fl_WritePath;
+    if(pStream->result == ERROR_NOERROR)
+    {
+        /* The data is already in memory. It is counted as read when it arrives */
+        DataStats_RecordRead(&pStream->stats, DataStats_Now(), pSize);
+        pStream->result = DataWriter_Write(&pStream->writer, pData, pSize);
+    }
+    return(pStream->result);
 }
 /*----------------------------------------------------------------------------------*/
-const char* DataReader_GetWriteFileNamePrefix(void)
+ERROR_TYPE DataReader_StreamFlush(DATA_READER_STREAM* pStream)
 {
-    return fl_WriteFilePrefix;
+    if(pStream->result == ERROR_NOERROR)
+    {
+        pStream->result = DataWriter_Flush(&pStream->writer);
+    }
+    return(pStream->result);
 }
 /*----------------------------------------------------------------------------------*/
-void DataReader_ResetArguments(void)
+ERROR_TYPE DataReader_StreamClose(DATA_READER_STREAM* pStream)
 {
-    memset(fl_WritePath, NULL_CHARACTER, sizeof(fl_WritePath));
-    memset(fl_WriteFilePrefix, NULL_CHARACTER, sizeof(fl_WriteFilePrefix));
-    fl_MaxOutputFileSize = 0;
+    DATA_READER_CONTEXT* context = pStream->context;
+    ERROR_TYPE ret = pStream->result;
+    ERROR_TYPE closed = DataWriter_Close(&pStream->writer);
+    if(ret == ERROR_NOERROR)
+    {
+        ret = closed;
+    }
+    /* A trailing segment left empty by rotation has been removed */
+    DataStats_Finish(&pStream->stats, pStream->writer.segment +
+                     ((pStream->writer.segment && !pStream->writer.segmentSize) ? 0 : 1));
+    pthread_mutex_lock(&context->lock);
+    context->captureStats = pStream->stats;
+    pthread_mutex_unlock(&context->lock);
+    if(strlen(context->statsFile))
+    {
+        /* Statistics never fail the capture they describe */
+        (void)DataStats_Append(&pStream->stats, context->statsFile, pStream->output, ret);
+    }
+    free(pStream);
+    return(ret);
 }
 /*----------------------------------------------------------------------------------*/
-const char* DataReader_ConvertErrorToString(ERROR_TYPE pError)
+const unsigned long long DataReader_ContextGetMaxOutputFileSize(const DATA_READER_CONTEXT* pContext)
 {
-    unsigned int i;
-    for(i = 0; i < ERROR_MAX; i++)
-    {
-        if(pError == error_list[i].errorId)
-        {
-            return error_list[i].errorDescription;
-        }
-    }
-    return NULL;
+    return pContext->maxOutputFileSize / 1024;
 }
 /*----------------------------------------------------------------------------------*/
-void DataReader_Help(void)
+const unsigned int DataReader_ContextGetBufferSize(const DATA_READER_CONTEXT* pContext)
 {
-    unsigned int i;
-    printf("------------------Data Reader------------------------\n");
-    printf("Reads data from stdin or a file and saves it to a file \n");
-    printf("Supported Arguments: \n");
-    for(i = 0; i < ARGUMENT_MAX; i++)
-    {
-        printf("%s %s \n", argument_list[i].argString, argument_list[i].argDescription);
-    }
-    printf("-----------------------------------------------------\n");
+    return pContext->bufferSize / 1024;
 }
 /*----------------------------------------------------------------------------------*/
-/* Local function definitions */
-/*-----------------------------------------------------------------------------------
- * Name         : findArgument
- * Inputs       : char* sring - argument string
- * Outputs      : Argument type.
- * Description  : Searches for the current argument string in the supported
-                  argument list and returns the corresponding argument type.
-                  For invalid strings, ARGUMENT_MAX is returned
- -----------------------------------------------------------------------------------*/
-static ARGUMENT_TYPE findArgument(const char* string)
+const unsigned long long DataReader_ContextGetFlushInterval(const DATA_READER_CONTEXT* pContext)
 {
-    unsigned int i;
-    for(i = 0; i < ARGUMENT_MAX; i++)
-    {
-        if(!strcmp(string, argument_list[i].argString))
-        {
-            return argument_list[i].type;
-        }
-    }
-    return i;
+    return pContext->flushInterval / 1024;
 }
-/*-----------------------------------------------------------------------------------
- * Name         : initializeOutputFileSizeLimit
- * Inputs       : const char* pSize - Output file size limit in string format
- * Outputs      : True for successful config update. False otherwise
- * Description  : Checks and stores the configured write path
- -----------------------------------------------------------------------------------*/
-static bool initializeOutputFileSizeLimit(const char* pSize)
+/*----------------------------------------------------------------------------------*/
+const ENGINE_TYPE DataReader_ContextGetEngine(const DATA_READER_CONTEXT* pContext)
 {
-    /* Let the size be in bytes */
-    unsigned int size = atoi(pSize) * 1024;
-    if(size != 0)
-    {
-        fl_MaxOutputFileSize = size;
-        return true;
-    }
-    return false;
+    return pContext->engine;
 }
-/*-----------------------------------------------------------------------------------
- * Name         : initializeWritePath
- * Inputs       : char* pWritePath - string argument containing the file path
- * Outputs      : True for successful config update. False otherwise
- * Description  : Checks and stores the configured write path
- -----------------------------------------------------------------------------------*/
-static bool initializeWritePath(const char* pWritePath, unsigned int pSize)
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_ContextGetRotation(const DATA_READER_CONTEXT* pContext)
 {
-    /* Ensure the string size does not exceed the max limit */
-    if(sizeof(fl_WritePath) > pSize)
-    {
-        strcpy(fl_WritePath, pWritePath);
-        /* Ensure write path ends with Path delimiter */
-        char pathDelimiter = PATH_DELIMITER;
-        if(fl_WritePath[strlen(fl_WritePath) - 1] != pathDelimiter)
-        {
-            if(strlen(fl_WritePath) < sizeof(fl_WritePath))
-            {
-                /* Append path delimiter to the end */
-                //fl_WritePath[strlen(fl_WritePath)] = PATH_DELIMITER;
-                strncat(fl_WritePath, &pathDelimiter, 1);
-                return true;
-            }
+    return pContext->rotate;
+}
+/*----------------------------------------------------------------------------------*/
+const unsigned long long DataReader_ContextGetPipelineMemory(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->pipelineMemory / 1024;
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_ContextGetPipelineStats(DATA_READER_CONTEXT* pContext, PIPELINE_STATS* pStats)
+{
+    pthread_mutex_lock(&pContext->lock);
+    *pStats = pContext->pipelineStats;
+    pthread_mutex_unlock(&pContext->lock);
+}
+/*----------------------------------------------------------------------------------*/
+const unsigned int DataReader_ContextGetQueueDepth(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->queueDepth;
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_ContextGetDirectIo(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->directIo;
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_ContextGetCompression(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->compress;
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_ContextGetChecksum(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->checksum;
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_ContextGetDedup(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->dedup;
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_ContextGetFraming(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->framing;
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_ContextGetLines(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->lines;
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_ContextGetLineIndex(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->lineIndex;
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_ContextGetPreallocation(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->preallocate;
+}
+/*----------------------------------------------------------------------------------*/
+const DURABILITY_TYPE DataReader_ContextGetDurability(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->durability;
+}
+/*----------------------------------------------------------------------------------*/
+const unsigned long long DataReader_ContextGetSyncInterval(const DATA_READER_CONTEXT* pContext)
+{
+    return (pContext->durability == DURABILITY_BYTES) ? pContext->syncInterval / 1024 : pContext->syncInterval;
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_ContextGetCheckpoint(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->checkpoint;
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_ContextGetCompressStats(DATA_READER_CONTEXT* pContext, COMPRESS_STATS* pStats)
+{
+    pthread_mutex_lock(&pContext->lock);
+    *pStats = pContext->compressStats;
+    pthread_mutex_unlock(&pContext->lock);
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_ContextGetDedupStats(DATA_READER_CONTEXT* pContext, DEDUP_STATS* pStats)
+{
+    pthread_mutex_lock(&pContext->lock);
+    *pStats = pContext->dedupStats;
+    pthread_mutex_unlock(&pContext->lock);
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_ContextGetCaptureStats(DATA_READER_CONTEXT* pContext, CAPTURE_STATS* pStats)
+{
+    pthread_mutex_lock(&pContext->lock);
+    *pStats = pContext->captureStats;
+    pthread_mutex_unlock(&pContext->lock);
+}
+/*----------------------------------------------------------------------------------*/
+const char* DataReader_ContextGetStatsFile(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->statsFile;
+}
+/*----------------------------------------------------------------------------------*/
+const char* DataReader_ContextGetWriteFilePath(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->writePath;
+}
+/*----------------------------------------------------------------------------------*/
+const char* DataReader_ContextGetDestinationPath(const DATA_READER_CONTEXT* pContext, unsigned int pIndex)
+{
+    if(!pIndex)
+    {
+        return pContext->writePath;
+    }
+    return (pIndex <= pContext->mirrors) ? pContext->mirrorPath[pIndex - 1] : NULL;
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_ContextGetTeeStats(DATA_READER_CONTEXT* pContext, TEE_STATS* pStats)
+{
+    pthread_mutex_lock(&pContext->lock);
+    *pStats = pContext->teeStats;
+    pthread_mutex_unlock(&pContext->lock);
+}
+/*----------------------------------------------------------------------------------*/
+unsigned long long DataReader_ContextGetResumedBytes(DATA_READER_CONTEXT* pContext)
+{
+    unsigned long long resumed;
+    pthread_mutex_lock(&pContext->lock);
+    resumed = pContext->resumed;
+    pthread_mutex_unlock(&pContext->lock);
+    return resumed;
+}
+/*----------------------------------------------------------------------------------*/
+const char* DataReader_ContextGetWriteFileNamePrefix(const DATA_READER_CONTEXT* pContext)
+{
+    return pContext->writeFilePrefix;
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_ContextResetArguments(DATA_READER_CONTEXT* pContext)
+{
+    memset(pContext->writePath, NULL_CHARACTER, sizeof(pContext->writePath));
+    memset(pContext->mirrorPath, NULL_CHARACTER, sizeof(pContext->mirrorPath));
+    pContext->mirrors = 0;
+    memset(pContext->writeFilePrefix, NULL_CHARACTER, sizeof(pContext->writeFilePrefix));
+    memset(pContext->statsFile, NULL_CHARACTER, sizeof(pContext->statsFile));
+    pContext->maxOutputFileSize = 0;
+    pContext->bufferSize = 0;
+    pContext->flushInterval = 0;
+    pContext->engine = ENGINE_STDIO;
+    pContext->rotate = false;
+    pContext->pipelineMemory = 0;
+    pContext->queueDepth = 0;
+    pContext->directIo = false;
+    pContext->compress = false;
+    pContext->checksum = false;
+    pContext->dedup = false;
+    pContext->framing = false;
+    pContext->lines = false;
+    pContext->lineIndex = false;
+    pContext->preallocate = false;
+    pContext->durability = DURABILITY_NONE;
+    pContext->syncInterval = 0;
+    pContext->checkpoint = false;
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataReader_ParseArguments(int pArgc, char* pArgv[])
+{
+    return DataReader_ContextParseArguments(&fl_Context, pArgc, pArgv);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataReader_ReadData(const char* pReadFile, char* pWriteFile, int pSize)
+{
+    return DataReader_ContextReadData(&fl_Context, pReadFile, pWriteFile, pSize);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataReader_OpenStream(DATA_READER_STREAM** pStream, char* pWriteFile, int pSize)
+{
+    return DataReader_ContextOpenStream(&fl_Context, pStream, pWriteFile, pSize);
+}
+/*----------------------------------------------------------------------------------*/
+const unsigned long long DataReader_GetMaxOutputFileSize(void)
+{
+    return DataReader_ContextGetMaxOutputFileSize(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const unsigned int DataReader_GetBufferSize(void)
+{
+    return DataReader_ContextGetBufferSize(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const unsigned long long DataReader_GetFlushInterval(void)
+{
+    return DataReader_ContextGetFlushInterval(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const ENGINE_TYPE DataReader_GetEngine(void)
+{
+    return DataReader_ContextGetEngine(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_GetRotation(void)
+{
+    return DataReader_ContextGetRotation(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const unsigned long long DataReader_GetPipelineMemory(void)
+{
+    return DataReader_ContextGetPipelineMemory(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_GetPipelineStats(PIPELINE_STATS* pStats)
+{
+    DataReader_ContextGetPipelineStats(&fl_Context, pStats);
+}
+/*----------------------------------------------------------------------------------*/
+const unsigned int DataReader_GetQueueDepth(void)
+{
+    return DataReader_ContextGetQueueDepth(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_GetDirectIo(void)
+{
+    return DataReader_ContextGetDirectIo(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_GetCompression(void)
+{
+    return DataReader_ContextGetCompression(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_GetChecksum(void)
+{
+    return DataReader_ContextGetChecksum(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_GetDedup(void)
+{
+    return DataReader_ContextGetDedup(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_GetFraming(void)
+{
+    return DataReader_ContextGetFraming(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_GetLines(void)
+{
+    return DataReader_ContextGetLines(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_GetLineIndex(void)
+{
+    return DataReader_ContextGetLineIndex(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_GetPreallocation(void)
+{
+    return DataReader_ContextGetPreallocation(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const DURABILITY_TYPE DataReader_GetDurability(void)
+{
+    return DataReader_ContextGetDurability(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const unsigned long long DataReader_GetSyncInterval(void)
+{
+    return DataReader_ContextGetSyncInterval(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const bool DataReader_GetCheckpoint(void)
+{
+    return DataReader_ContextGetCheckpoint(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_GetCompressStats(COMPRESS_STATS* pStats)
+{
+    DataReader_ContextGetCompressStats(&fl_Context, pStats);
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_GetDedupStats(DEDUP_STATS* pStats)
+{
+    DataReader_ContextGetDedupStats(&fl_Context, pStats);
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_GetCaptureStats(CAPTURE_STATS* pStats)
+{
+    DataReader_ContextGetCaptureStats(&fl_Context, pStats);
+}
+/*----------------------------------------------------------------------------------*/
+const char* DataReader_GetStatsFile(void)
+{
+    return DataReader_ContextGetStatsFile(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const char* DataReader_GetWriteFilePath(void)
+{
+    return DataReader_ContextGetWriteFilePath(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const char* DataReader_GetDestinationPath(unsigned int pIndex)
+{
+    return DataReader_ContextGetDestinationPath(&fl_Context, pIndex);
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_GetTeeStats(TEE_STATS* pStats)
+{
+    DataReader_ContextGetTeeStats(&fl_Context, pStats);
+}
+/*----------------------------------------------------------------------------------*/
+unsigned long long DataReader_GetResumedBytes(void)
+{
+    return DataReader_ContextGetResumedBytes(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const char* DataReader_GetWriteFileNamePrefix(void)
+{
+    return DataReader_ContextGetWriteFileNamePrefix(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_ResetArguments(void)
+{
+    DataReader_ContextResetArguments(&fl_Context);
+}
+/*----------------------------------------------------------------------------------*/
+const char* DataReader_ConvertErrorToString(ERROR_TYPE pError)
+{
+    unsigned int i;
+    for(i = 0; i < ERROR_MAX; i++)
+    {
+        if(pError == error_list[i].errorId)
+        {
+            return error_list[i].errorDescription;
         }
-        else
+    }
+    return NULL;
+}
+/*----------------------------------------------------------------------------------*/
+void DataReader_Help(void)
+{
+    unsigned int i;
+    printf("------------------Data Reader------------------------\n");
+    printf("Reads data from stdin or a file and saves it to a file \n");
+    printf("Supported Arguments: \n");
+    for(i = 0; i < ARGUMENT_MAX; i++)
+    {
+        printf("%s %s \n", argument_list[i].argString, argument_list[i].argDescription);
+    }
+    printf("-----------------------------------------------------\n");
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : findArgument
+ * Inputs       : char* sring - argument string
+ * Outputs      : Argument type.
+ * Description  : Searches for the current argument string in the supported
+                  argument list and returns the corresponding argument type.
+                  For invalid strings, ARGUMENT_MAX is returned
+ -----------------------------------------------------------------------------------*/
+static ARGUMENT_TYPE findArgument(const char* string)
+{
+    unsigned int i;
+    for(i = 0; i < ARGUMENT_MAX; i++)
+    {
+        if(!strcmp(string, argument_list[i].argString))
         {
-            return true;
+            return argument_list[i].type;
         }
+    }
+    return i;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeOutputFileSizeLimit
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pSize - Output file size limit in string format
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores the configured write path
+ -----------------------------------------------------------------------------------*/
+static bool initializeOutputFileSizeLimit(DATA_READER_CONTEXT* pContext, const char* pSize)
+{
+    /* Let the size be in bytes */
+    unsigned long long size = 0;
+    if(parseSize(pSize, &size) && (size != 0))
+    {
+        pContext->maxOutputFileSize = size;
+        return true;
+    }
+    return false;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeBufferSize
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pSize - I/O buffer size in string format
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores the I/O buffer size
+ -----------------------------------------------------------------------------------*/
+static bool initializeBufferSize(DATA_READER_CONTEXT* pContext, const char* pSize)
+{
+    /* Let the size be in bytes */
+    unsigned long long size = 0;
+    if(parseSize(pSize, &size) && (size != 0) && (size <= (MAX_BUFFER_SIZE_KB * 1024ULL)))
+    {
+        pContext->bufferSize = (unsigned int)size;
+        return true;
+    }
+    return false;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeFlushInterval
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pInterval - Flush interval in string format
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores the flush interval. Zero disables the periodic
+ *                flush so that the output is flushed only on close
+ -----------------------------------------------------------------------------------*/
+static bool initializeFlushInterval(DATA_READER_CONTEXT* pContext, const char* pInterval)
+{
+    /* Let the interval be in bytes */
+    return parseSize(pInterval, &pContext->flushInterval);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializePipelineMemory
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pMemory - Pipeline memory limit in string format
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores the total memory of the pipeline ring. It must
+ *                hold at least MIN_PIPELINE_SLOTS aligned buffers
+ -----------------------------------------------------------------------------------*/
+static bool initializePipelineMemory(DATA_READER_CONTEXT* pContext, const char* pMemory)
+{
+    /* Let the size be in bytes */
+    unsigned long long size = 0;
+    if(parseSize(pMemory, &size) && (size >= (MIN_PIPELINE_SLOTS * BUFFER_ALIGNMENT)))
+    {
+        pContext->pipelineMemory = size;
+        return true;
+    }
+    return false;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeQueueDepth
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pDepth - Queue depth in string format
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores the number of requests kept in flight by the
+ *                io_uring engine, or of threads of the parallel engine. It must be
+ *                between 1 and MAX_QUEUE_DEPTH
+ -----------------------------------------------------------------------------------*/
+static bool initializeQueueDepth(DATA_READER_CONTEXT* pContext, const char* pDepth)
+{
+    char* end = NULL;
+    unsigned long depth;
+    if((pDepth == NULL) || !isdigit((unsigned char)pDepth[0]))
+    {
+        return false;
+    }
+    depth = strtoul(pDepth, &end, 10);
+    if((*end != NULL_CHARACTER) || (depth == 0) || (depth > MAX_QUEUE_DEPTH))
+    {
+        return false;
+    }
+    pContext->queueDepth = (unsigned int)depth;
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : parseSize
+ * Inputs       : const char* pString - size in string format
+ *                unsigned long long* pBytes - Loaded with the size in bytes
+ * Outputs      : True if the string is a valid size. False otherwise
+ * Description  : Converts a size argument to bytes. A plain number is in KB. The
+ *                number may be suffixed with K, M, G or T (case insensitive)
+ -----------------------------------------------------------------------------------*/
+static bool parseSize(const char* pString, unsigned long long* pBytes)
+{
+    char* end = NULL;
+    unsigned long long size;
+    unsigned int shift = 10;
+    /* strtoull accepts a sign and white space. Only digits are valid here */
+    if(!isdigit((unsigned char)pString[0]))
+    {
+        return false;
+    }
+    size = strtoull(pString, &end, 10);
+    switch(toupper((unsigned char)*end))
+    {
+    case NULL_CHARACTER:
+    case 'K':
+        shift = 10;
+        break;
+
+    case 'M':
+        shift = 20;
+        break;
+
+    case 'G':
+        shift = 30;
+        break;
 
+    case 'T':
+        shift = 40;
+        break;
+
+    default:
+        return false;
+    }
+    /* Only a single suffix character is allowed */
+    if((*end != NULL_CHARACTER) && (end[1] != NULL_CHARACTER))
+    {
+        return false;
+    }
+    /* Reject values that overflow 64 bits */
+    if(size > (~0ULL >> shift))
+    {
+        return false;
+    }
+    *pBytes = size << shift;
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeEngine
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pEngine - copy engine name
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Searches for the engine name in the supported engine list and
+ *                stores the corresponding copy engine
+ -----------------------------------------------------------------------------------*/
+static bool initializeEngine(DATA_READER_CONTEXT* pContext, const char* pEngine)
+{
+    unsigned int i;
+    for(i = 0; i < ENGINE_MAX; i++)
+    {
+        if(!strcmp(pEngine, engine_list[i].engineName))
+        {
+            pContext->engine = engine_list[i].engineId;
+            return true;
+        }
+    }
+    return false;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeRotation
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pRotation - rotation mode (on, off)
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores the output rotation mode
+ -----------------------------------------------------------------------------------*/
+static bool initializeRotation(DATA_READER_CONTEXT* pContext, const char* pRotation)
+{
+    return parseSwitch(pRotation, &pContext->rotate);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeDirectIo
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pDirectIo - direct I/O mode (on, off)
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores whether the output bypasses the page cache
+ -----------------------------------------------------------------------------------*/
+static bool initializeDirectIo(DATA_READER_CONTEXT* pContext, const char* pDirectIo)
+{
+    return parseSwitch(pDirectIo, &pContext->directIo);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeCompression
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pCompression - compression mode (on, off)
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores whether the output is compressed
+ -----------------------------------------------------------------------------------*/
+static bool initializeCompression(DATA_READER_CONTEXT* pContext, const char* pCompression)
+{
+    return parseSwitch(pCompression, &pContext->compress);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeChecksum
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pChecksum - checksum mode (on, off)
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores whether checksum sidecars are written
+ -----------------------------------------------------------------------------------*/
+static bool initializeChecksum(DATA_READER_CONTEXT* pContext, const char* pChecksum)
+{
+    return parseSwitch(pChecksum, &pContext->checksum);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeDedup
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pDedup - deduplication mode (on, off)
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores whether captures are deduplicated
+ -----------------------------------------------------------------------------------*/
+static bool initializeDedup(DATA_READER_CONTEXT* pContext, const char* pDedup)
+{
+    return parseSwitch(pDedup, &pContext->dedup);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeFraming
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pFraming - framing mode (on, off)
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores whether the output is framed
+ -----------------------------------------------------------------------------------*/
+static bool initializeFraming(DATA_READER_CONTEXT* pContext, const char* pFraming)
+{
+    return parseSwitch(pFraming, &pContext->framing);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeLines
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pLines - line mode (on, off, index)
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores whether output files end on line boundaries and
+ *                whether they get a line index
+ -----------------------------------------------------------------------------------*/
+static bool initializeLines(DATA_READER_CONTEXT* pContext, const char* pLines)
+{
+    bool lines;
+    if(!strcmp(pLines, SWITCH_INDEX))
+    {
+        pContext->lines = true;
+        pContext->lineIndex = true;
+        return true;
+    }
+    if(!parseSwitch(pLines, &lines))
+    {
+        return false;
+    }
+    pContext->lines = lines;
+    pContext->lineIndex = false;
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeStatsFile
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pStatsFile - path of the JSON lines file
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Stores the file the statistics of every capture are appended to
+ -----------------------------------------------------------------------------------*/
+static bool initializeStatsFile(DATA_READER_CONTEXT* pContext, const char* pStatsFile)
+{
+    if(strlen(pStatsFile) >= sizeof(pContext->statsFile))
+    {
+        return false;
+    }
+    strcpy(pContext->statsFile, pStatsFile);
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializePreallocation
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pPreallocation - preallocation mode (on, off)
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores whether output space is reserved up front
+ -----------------------------------------------------------------------------------*/
+static bool initializePreallocation(DATA_READER_CONTEXT* pContext, const char* pPreallocation)
+{
+    return parseSwitch(pPreallocation, &pContext->preallocate);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeDurability
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pDurability - policy name, size or time in ms
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores when the output is synced. A size selects a
+ *                sync after every interval of data and a number of milliseconds
+ *                a sync after every interval of time. Both must not be zero
+ -----------------------------------------------------------------------------------*/
+static bool initializeDurability(DATA_READER_CONTEXT* pContext, const char* pDurability)
+{
+    char* end = NULL;
+    unsigned long long interval = 0;
+    unsigned int i;
+    for(i = 0; i < (sizeof(durability_list) / sizeof(durability_list[0])); i++)
+    {
+        if(!strcmp(pDurability, durability_list[i].durabilityName))
+        {
+            pContext->durability = durability_list[i].durabilityId;
+            pContext->syncInterval = 0;
+            return true;
+        }
+    }
+    if(!isdigit((unsigned char)pDurability[0]))
+    {
+        return false;
+    }
+    interval = strtoull(pDurability, &end, 10);
+    if(!strcmp(end, DURABILITY_MILLISECONDS))
+    {
+        if(!interval || (interval > (ULLONG_MAX / 1000000ULL)))
+        {
+            return false;
+        }
+        pContext->durability = DURABILITY_TIME;
+        pContext->syncInterval = interval;
+        return true;
+    }
+    /* Let the interval be in bytes */
+    if(!parseSize(pDurability, &interval) || !interval)
+    {
+        return false;
+    }
+    pContext->durability = DURABILITY_BYTES;
+    pContext->syncInterval = interval;
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeCheckpoint
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                const char* pCheckpoint - checkpoint mode (on, off)
+ * Outputs      : True for successful config update. False otherwise
+ * Description  : Checks and stores whether file captures keep a checkpoint
+ -----------------------------------------------------------------------------------*/
+static bool initializeCheckpoint(DATA_READER_CONTEXT* pContext, const char* pCheckpoint)
+{
+    return parseSwitch(pCheckpoint, &pContext->checkpoint);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : parseSwitch
+ * Inputs       : const char* pString - switch in string format (on, off)
+ *                bool* pValue - Loaded with the switch state
+ * Outputs      : True if the string is a valid switch. False otherwise
+ * Description  : Converts an on/off argument
+ -----------------------------------------------------------------------------------*/
+static bool parseSwitch(const char* pString, bool* pValue)
+{
+    if(!strcmp(pString, SWITCH_ON))
+    {
+        *pValue = true;
+        return true;
+    }
+    if(!strcmp(pString, SWITCH_OFF))
+    {
+        *pValue = false;
+        return true;
     }
     return false;
 }
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeWritePath
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                char* pWritePaths - string argument containing the file path, or up
+ *                                    to MAX_DESTINATIONS paths separated by
+ *                                    DESTINATION_DELIMITER
+ * Outputs      : returns -
+ *                ERROR_NOERROR - paths stored
+ *                ERROR_PATHTOOLONG - a path exceeds max length
+ *                ERROR_INVALIDDESTINATIONS - a path is empty or there are too many
+ * Description  : Checks and stores the configured write path. The first path is
+ *                the write path, the others receive a copy of every capture
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE initializeWritePath(DATA_READER_CONTEXT* pContext, const char* pWritePaths)
+{
+    char paths[MAX_DESTINATIONS][MAX_FILEPATH_LENGTH];
+    const char* start = pWritePaths;
+    unsigned int count = 0;
+    unsigned int i;
+    while(true)
+    {
+        const char* end = strchr(start, DESTINATION_DELIMITER);
+        size_t length = (end == NULL) ? strlen(start) : (size_t)(end - start);
+        if(!length || (count == MAX_DESTINATIONS))
+        {
+            return(ERROR_INVALIDDESTINATIONS);
+        }
+        if((length >= MAX_FILEPATH_LENGTH) || !copyWritePath(paths[count], sizeof(paths[count]), start, length))
+        {
+            return(ERROR_PATHTOOLONG);
+        }
+        count++;
+        if(end == NULL)
+        {
+            break;
+        }
+        start = end + 1;
+    }
+    /* Only a valid list replaces the configured one */
+    strcpy(pContext->writePath, paths[0]);
+    for(i = 1; i < count; i++)
+    {
+        strcpy(pContext->mirrorPath[i - 1], paths[i]);
+    }
+    pContext->mirrors = count - 1;
+    return(ERROR_NOERROR);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : copyWritePath
+ * Inputs       : char* pPath - receives the path
+ *                unsigned int pPathSize - size of pPath in bytes
+ *                const char* pWritePath - path to be stored, not terminated
+ *                unsigned int pSize - length of pWritePath
+ * Outputs      : True if the path fits with a trailing path delimiter. False
+ *                otherwise
+ * Description  : Stores a write path so that a file name can be appended to it
+ -----------------------------------------------------------------------------------*/
+static bool copyWritePath(char* pPath, unsigned int pPathSize, const char* pWritePath, unsigned int pSize)
+{
+    /* Ensure the string size does not exceed the max limit */
+    if(!pSize || (pSize >= pPathSize))
+    {
+        return false;
+    }
+    memcpy(pPath, pWritePath, pSize);
+    pPath[pSize] = NULL_CHARACTER;
+    /* Ensure write path ends with Path delimiter */
+    if(pPath[pSize - 1] != PATH_DELIMITER)
+    {
+        if((pSize + 1) >= pPathSize)
+        {
+            return false;
+        }
+        /* Append path delimiter to the end */
+        pPath[pSize] = PATH_DELIMITER;
+        pPath[pSize + 1] = NULL_CHARACTER;
+    }
+    return true;
+}
 /*-----------------------------------------------------------------------------------
  * Name         : initializeWriteFilePrefix
- * Inputs       : char* pWriteFilePrefix - string argument containing the file path
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be updated
+ *                char* pWriteFilePrefix - string argument containing the file path
  *                int size - size of the write File buffer
  * Outputs      : True for successful config update. False otherwise
  * Description  : Checks and stores the configured write file name prefix
  -----------------------------------------------------------------------------------*/
-static bool initializeWriteFilePrefix(const char* pWriteFilePrefix, unsigned int pSize)
+static bool initializeWriteFilePrefix(DATA_READER_CONTEXT* pContext, const char* pWriteFilePrefix, unsigned int pSize)
 {
     /* Ensure the string size does not exceed the max limit */
-    if(sizeof(fl_WriteFilePrefix) > pSize)
+    if(sizeof(pContext->writeFilePrefix) > pSize)
     {
-        strcpy(fl_WriteFilePrefix, pWriteFilePrefix);
+        strcpy(pContext->writeFilePrefix, pWriteFilePrefix);
         /* Ensure file name prefix ends with underscore */
         char underScore = '_';
-        if(fl_WriteFilePrefix[strlen(fl_WriteFilePrefix) - 1] != underScore)
+        if(pContext->writeFilePrefix[strlen(pContext->writeFilePrefix) - 1] != underScore)
         {
-            if(strlen(fl_WriteFilePrefix) < sizeof(fl_WriteFilePrefix))
+            size_t length = strlen(pContext->writeFilePrefix);
+            if((length + 1) < sizeof(pContext->writeFilePrefix))
             {
-                /* Append path delimiter to the end */
-                strncat(fl_WriteFilePrefix, &underScore, 1);
+                /* Append the underscore to the end */
+                pContext->writeFilePrefix[length] = underScore;
+                pContext->writeFilePrefix[length + 1] = NULL_CHARACTER;
                 return true;
             }
         }
@@ -343,74 +1661,297 @@ static bool initializeWriteFilePrefix(const char* pWriteFilePrefix, unsigned int
     return false;
 }
 /*-----------------------------------------------------------------------------------
- * Name         : defineWriteFile
- * Inputs       : char* pWriteFile - Points to the write file path. Shall be loaded
- *                                    with filename and full file path
- *                int size - size of the write File buffer
- * Outputs      : True if Write file path defined successfully. False for failure
- * Description  : Determine the current file to write with full file path
+ * Name         : applyDefaults
+ * Inputs       : DATA_READER_CONTEXT* pContext - context to be completed
+ * Outputs      : True if all settings are valid. False if the default write path
+ *                cannot be used
+ * Description  : Sets every argument that was not configured to its default.
+ *                Concurrent captures share the settings, so they are completed
+ *                under the capture lock
  -----------------------------------------------------------------------------------*/
-static bool defineWriteFile(char* pWriteFile, unsigned int pSize)
+static bool applyDefaults(DATA_READER_CONTEXT* pContext)
 {
+    bool ret = true;
+    pthread_mutex_lock(&pContext->lock);
     /* Set max file size if not configured */
-    if(!fl_MaxOutputFileSize)
+    if(!pContext->maxOutputFileSize)
     {
-        (void)initializeOutputFileSizeLimit(DEFAULT_OUTPUT_FILE_SIZE_KB);
+        (void)initializeOutputFileSizeLimit(pContext, DEFAULT_OUTPUT_FILE_SIZE_KB);
     }
-
     /* Set file path to default working directory if not provided */
-    if(!strlen(fl_WritePath))
+    if(!strlen(pContext->writePath))
     {
         char workingDirectory[MAX_FILEPATH_LENGTH] = { '\0' };
         (void)_getcwd(workingDirectory, MAX_FILEPATH_LENGTH);
-        if(!initializeWritePath(workingDirectory, strlen(workingDirectory)))
-        {
-            return false;
-        }
+        ret = copyWritePath(pContext->writePath, sizeof(pContext->writePath), workingDirectory,
+                            strlen(workingDirectory));
     }
     /* Set file name prefix to default if not provided */
-    if(!strlen(fl_WriteFilePrefix))
+    if(ret && !strlen(pContext->writeFilePrefix))
+    {
+        ret = initializeWriteFilePrefix(pContext, DEFAULT_FILENAME_PREFIX, strlen(DEFAULT_FILENAME_PREFIX));
+    }
+    /* Set buffer size, pipeline memory and queue depth to default if not configured */
+    if(!pContext->bufferSize)
+    {
+        (void)initializeBufferSize(pContext, DEFAULT_BUFFER_SIZE_KB);
+    }
+    if(!pContext->pipelineMemory)
+    {
+        (void)initializePipelineMemory(pContext, DEFAULT_PIPELINE_MEMORY);
+    }
+    if(!pContext->queueDepth)
+    {
+        (void)initializeQueueDepth(pContext, DEFAULT_QUEUE_DEPTH);
+    }
+    pthread_mutex_unlock(&pContext->lock);
+    return ret;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : defineWriteFile
+ * Inputs       : void* pCapture - CAPTURE_NAME of the current capture
+ *                char* pWriteFile - Points to the write file path. Shall be loaded
+ *                                    with filename and full file path
+ *                int size - size of the write File buffer
+ *                unsigned int pSegment - output segment number. The time stamp is
+ *                                        fetched for segment 0 and reused after
+ * Outputs      : True if Write file path defined successfully. False for failure
+ * Description  : Determine the current file to write with full file path. With
+ *                rotation enabled the segment number is appended to the name
+ -----------------------------------------------------------------------------------*/
+static bool defineWriteFile(void* pCapture, char* pWriteFile, unsigned int pSize, unsigned int pSegment)
+{
+    CAPTURE_NAME* capture = (CAPTURE_NAME*)pCapture;
+    /* File Name is a combination of file prefix and current time stamp. Fetch timestamp
+       for a new capture. Segments of a capture share its time stamp */
+    if(!pSegment)
     {
-        if(!initializeWriteFilePrefix(DEFAULT_FILENAME_PREFIX, strlen(DEFAULT_FILENAME_PREFIX)))
+        getTimeStamp(capture->timeStamp);
+    }
+    return formatWriteFile(capture, pWriteFile, pSize, pSegment);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : formatWriteFile
+ * Inputs       : const CAPTURE_NAME* pCapture - naming state of the capture
+ *                char* pWriteFile - Loaded with filename and full file path
+ *                int size - size of the write File buffer
+ *                unsigned int pSegment - output segment number
+ * Outputs      : True if Write file path defined successfully. False for failure
+ * Description  : Builds the file name from the current time stamp of the capture.
+ *                Copies in other directories are named after the first output
+ -----------------------------------------------------------------------------------*/
+static bool formatWriteFile(const CAPTURE_NAME* pCapture, char* pWriteFile, unsigned int pSize, unsigned int pSegment)
+{
+    const DATA_READER_CONTEXT* context = pCapture->context;
+    char timeStamp[TIMESTAMP_LENGTH + 16] = { '\0' };
+    strcpy(timeStamp, pCapture->timeStamp);
+    if(context->dedup)
+    {
+        /* A capture has a single recipe */
+        strcat(timeStamp, DEDUP_RECIPE_EXTENSION);
+    }
+    else
+    {
+        if(context->rotate)
         {
-            return false;
+            sprintf(timeStamp + strlen(timeStamp), SEGMENT_NUMBER_FORMAT, pSegment);
         }
+        strcat(timeStamp, DEFAULT_FILE_EXTENSTION);
     }
-    /* File Name is a combination of file prefix and current time stamp. Fetch timestamp */
-    char timeStamp[TIMESTAMP_LENGTH] = { '\0' };
-    getTimeStamp(timeStamp);
-    strcat(timeStamp, DEFAULT_FILE_EXTENSTION);
     /* Ensure the combined path is less than the maximum path length */
-    if((strlen(fl_WritePath) + strlen(fl_WriteFilePrefix) + strlen(timeStamp)) < pSize)
+    if((strlen(pCapture->writePath) + strlen(context->writeFilePrefix) + strlen(timeStamp)) < pSize)
     {
         /* Store the file name with full path */
-        strcat(pWriteFile, fl_WritePath);
-        strcat(pWriteFile, fl_WriteFilePrefix);
+        strcat(pWriteFile, pCapture->writePath);
+        strcat(pWriteFile, context->writeFilePrefix);
         strcat(pWriteFile, timeStamp);
         return true;
     }
     return false;
 }
+/*-----------------------------------------------------------------------------------
+ * Name         : copyToDestinations
+ * Inputs       : DATA_READER_CONTEXT* pContext - configuration of the capture
+ *                ENGINE_JOB* pJob - copy to be performed. Its writer is the first
+ *                                   directory
+ *                const CAPTURE_NAME* pName - naming state of the first output
+ *                unsigned long long pInputSize - input bytes to preallocate
+ * Outputs      : returns -
+ *                Same as DataTee_Copy
+ * Description  : Opens a writer in every other directory, named after the first
+ *                output, and copies the input to all of them at once. A directory
+ *                that cannot be opened is left out of the copy. The first one is
+ *                closed by the caller
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE copyToDestinations(DATA_READER_CONTEXT* pContext, ENGINE_JOB* pJob, const CAPTURE_NAME* pName,
+                                     unsigned long long pInputSize)
+{
+    DATA_WRITER mirrors[MAX_DESTINATIONS - 1];
+    CAPTURE_NAME names[MAX_DESTINATIONS - 1];
+    DATA_WRITER* writers[MAX_DESTINATIONS] = { NULL };
+    TEE_STATS stats;
+    ERROR_TYPE ret;
+    unsigned int i;
+    memset(&stats, 0, sizeof(stats));
+    stats.destinations = pContext->mirrors + 1;
+    writers[0] = pJob->writer;
+    strcpy(stats.destination[0].output, pJob->writer->fileName);
+    for(i = 0; i < pContext->mirrors; i++)
+    {
+        char writeFile[MAX_FILEPATH_LENGTH] = { NULL_CHARACTER };
+        DESTINATION_STATS* destination = &stats.destination[i + 1];
+        /* The copy shares the time stamp of the first output. A taken name gets a
+           new one in this directory only */
+        names[i] = *pName;
+        names[i].writePath = pContext->mirrorPath[i];
+        if(!formatWriteFile(&names[i], writeFile, sizeof(writeFile), 0))
+        {
+            destination->result = ERROR_PATHTOOLONG;
+            continue;
+        }
+        destination->result = DataWriter_Open(&mirrors[i], writeFile, defineWriteFile, &names[i],
+                                              pContext->maxOutputFileSize, pContext->flushInterval, pContext->rotate,
+                                              pContext->directIo, pContext->checksum);
+        strcpy(destination->output, mirrors[i].fileName);
+        if(destination->result != ERROR_NOERROR)
+        {
+            continue;
+        }
+        writers[i + 1] = &mirrors[i];
+        if(pContext->preallocate)
+        {
+            DataWriter_Preallocate(&mirrors[i], pInputSize);
+        }
+        DataWriter_SetDurability(&mirrors[i], pContext->durability, (pContext->durability == DURABILITY_TIME) ?
+                                 pContext->syncInterval * 1000000ULL : pContext->syncInterval);
+    }
+    ret = DataTee_Copy(pJob, writers, stats.destinations, pContext->pipelineMemory, &stats);
+    for(i = 0; i < pContext->mirrors; i++)
+    {
+        if(writers[i + 1] != NULL)
+        {
+            ERROR_TYPE closed = DataWriter_Close(&mirrors[i]);
+            if(stats.destination[i + 1].result == ERROR_NOERROR)
+            {
+                stats.destination[i + 1].result = closed;
+            }
+        }
+    }
+    pthread_mutex_lock(&pContext->lock);
+    pContext->teeStats = stats;
+    pthread_mutex_unlock(&pContext->lock);
+    return(ret);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : saveCheckpoint
+ * Inputs       : void* pCheckpoint - CAPTURE_CHECKPOINT of the capture
+ *                const DATA_WRITER* pWriter - writer of the capture
+ * Outputs      :
+ * Description  : Records the input bytes written so far and the output holding
+ *                the last of them. Called by the writer as it progresses. A
+ *                checkpoint that cannot be saved never fails the capture, the
+ *                next one covers its data
+ -----------------------------------------------------------------------------------*/
+static void saveCheckpoint(void* pCheckpoint, const DATA_WRITER* pWriter)
+{
+    CAPTURE_CHECKPOINT* checkpoint = pCheckpoint;
+    CHECKPOINT* current = &checkpoint->checkpoint;
+    CHECKPOINT identity;
+    /* The size and time of the input tell whether it changes later */
+    if(DataCheckpoint_Identify(checkpoint->input, current->source, &identity))
+    {
+        current->size = identity.size;
+        current->modified = identity.modified;
+    }
+    current->offset = checkpoint->base + pWriter->written;
+    strcpy(current->stamp, checkpoint->name->timeStamp);
+    if((pWriter->output == NULL) && pWriter->segment && !pWriter->segmentSize)
+    {
+        /* Closing removed a trailing segment left empty by rotation. The data
+           ends in the full one before it */
+        current->segment = pWriter->segment - 1;
+        current->segmentStart = current->offset - pWriter->maxSize;
+        if(!formatWriteFile(checkpoint->name, current->output, sizeof(current->output), current->segment))
+        {
+            return;
+        }
+    }
+    else
+    {
+        current->segment = pWriter->segment;
+        current->segmentStart = current->offset - pWriter->segmentSize;
+        strcpy(current->output, pWriter->fileName);
+    }
+    (void)DataCheckpoint_Save(checkpoint->path, current);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : returnWriteFile
+ * Inputs       : char* pWriteFile - caller buffer loaded with the write file path
+ *                int pSize - size of the caller buffer
+ *                const char* pPath - write file path
+ * Outputs      :
+ * Description  : Copies at most pSize characters of the path. The terminating
+ *                NULL is copied when it fits, callers pass a cleared buffer
+ -----------------------------------------------------------------------------------*/
+static void returnWriteFile(char* pWriteFile, int pSize, const char* pPath)
+{
+    size_t length = strlen(pPath) + 1;
+    memcpy(pWriteFile, pPath, (length < (size_t)pSize) ? length : (size_t)pSize);
+}
 /*-----------------------------------------------------------------------------------
  * Name         : getTimeStamp
  * Inputs       : char* timestamp - Buffer to store the timestamp string
  * Outputs      :
- * Description  : Gets the current time stamp, replaces unsupported file fileName
-                  characters with '_' and stores the string to the passed buffer
+ * Description  : Gets the current time stamp with nanoseconds, followed by the
+                  process id, the thread id and a per process capture sequence
+                  number. The name is unique across threads and processes writing
+                  to the same directory without any coordination between them
  -----------------------------------------------------------------------------------*/
 static void getTimeStamp(char* timestamp)
 {
-    unsigned int i;
-    time_t t = time(NULL);
-    struct tm* currentTime = localtime(&t);
-    strftime(timestamp, TIMESTAMP_LENGTH, "%c", currentTime);
-    /* Remove space and unsupported file fileName characters */
-    for(i = 0; i < strlen(timestamp); i++)
+    struct timespec now;
+    struct tm currentTime;
+    unsigned int sequence = atomic_fetch_add(&fl_CaptureSequence, 1);
+    clock_gettime(CLOCK_REALTIME, &now);
+#ifdef _WIN32
+    localtime_s(&currentTime, &now.tv_sec);
+#else
+    localtime_r(&now.tv_sec, &currentTime);
+#endif
+    strftime(timestamp, TIMESTAMP_LENGTH, TIMESTAMP_DATE_FORMAT, &currentTime);
+    snprintf(timestamp + strlen(timestamp), TIMESTAMP_LENGTH - strlen(timestamp), TIMESTAMP_UNIQUE_FORMAT,
+             (long)now.tv_nsec, (unsigned long)_getpid(), getThreadId(), sequence);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : getThreadId
+ * Inputs       :
+ * Outputs      : Id of the calling thread
+ * Description  : Uses the kernel thread id where available, as shown by ps and top
+ -----------------------------------------------------------------------------------*/
+static unsigned long getThreadId(void)
+{
+#if defined(_WIN32)
+    return((unsigned long)GetCurrentThreadId());
+#elif defined(__linux__)
+    return((unsigned long)syscall(SYS_gettid));
+#else
+    return((unsigned long)(uintptr_t)pthread_self());
+#endif
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : getInputSize
+ * Inputs       : FILE* pInput - input of the capture
+ * Outputs      : Size of the input in bytes. WRITER_SIZE_UNKNOWN for pipes, devices
+ *                and terminals
+ * Description  : Sizes the preallocation of the output
+ -----------------------------------------------------------------------------------*/
+static unsigned long long getInputSize(FILE* pInput)
+{
+    struct stat inputStat;
+    if((fstat(fileno(pInput), &inputStat) != 0) || !S_ISREG(inputStat.st_mode))
     {
-        if((timestamp[i] == ' ') || (timestamp[i] == ':') || (timestamp[i] == '/'))
-        {
-            timestamp[i] = '_';
-        }
+        return WRITER_SIZE_UNKNOWN;
     }
+    return((unsigned long long)inputStat.st_size);
 }
 /*----------------------------------------------------------------------------------*/
\ No newline at end of file
@@ -0,0 +1,331 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include "DataStats.h"
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define NANOSECONDS_PER_SECOND 1000000000ULL
+#define BYTES_PER_MEGABYTE (1024.0 * 1024.0)
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* JSON text being formatted. Counts the full length even past the buffer */
+typedef struct
+{
+    char* buffer;
+    size_t size;
+    size_t length;
+} JSON_TEXT;
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static void recordCall(CALL_STATS* pCalls, unsigned long long pStart, unsigned long long pEnd, unsigned long long pBytes);
+static void recordSample(CAPTURE_STATS* pStats, unsigned long long pEnd, unsigned long long pBytes);
+static void appendText(JSON_TEXT* pText, const char* pFormat, ...);
+static void appendString(JSON_TEXT* pText, const char* pString);
+static void appendCalls(JSON_TEXT* pText, const char* pName, const CALL_STATS* pCalls);
+static double toMegabytesPerSecond(unsigned long long pBytes, unsigned long long pTime);
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+unsigned long long DataStats_Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((unsigned long long)now.tv_sec * NANOSECONDS_PER_SECOND + (unsigned long long)now.tv_nsec);
+}
+/*----------------------------------------------------------------------------------*/
+void DataStats_Start(CAPTURE_STATS* pStats)
+{
+    memset(pStats, 0, sizeof(CAPTURE_STATS));
+    pStats->sampleInterval = STATS_SAMPLE_INTERVAL_NS;
+    pStats->started = DataStats_Now();
+}
+/*----------------------------------------------------------------------------------*/
+void DataStats_RecordRead(CAPTURE_STATS* pStats, unsigned long long pStart, unsigned long long pBytes)
+{
+    if(pStats != NULL)
+    {
+        recordCall(&pStats->reads, pStart, DataStats_Now(), pBytes);
+    }
+}
+/*----------------------------------------------------------------------------------*/
+void DataStats_RecordWrite(CAPTURE_STATS* pStats, unsigned long long pStart, unsigned long long pBytes)
+{
+    if(pStats != NULL)
+    {
+        unsigned long long end = DataStats_Now();
+        recordCall(&pStats->writes, pStart, end, pBytes);
+        recordSample(pStats, end, pBytes);
+    }
+}
+/*----------------------------------------------------------------------------------*/
+void DataStats_RecordSync(CAPTURE_STATS* pStats, unsigned long long pStart, unsigned long long pEnd,
+                          unsigned long long pBytes)
+{
+    if(pStats != NULL)
+    {
+        recordCall(&pStats->syncs, pStart, pEnd, pBytes);
+    }
+}
+/*----------------------------------------------------------------------------------*/
+void DataStats_Finish(CAPTURE_STATS* pStats, unsigned int pSegments)
+{
+    pStats->duration = DataStats_Now() - pStats->started;
+    pStats->segments = pSegments;
+}
+/*----------------------------------------------------------------------------------*/
+unsigned long long DataStats_Percentile(const CALL_STATS* pCalls, unsigned int pPercent)
+{
+    /* Rank of the call at the percentile, rounded up */
+    unsigned long long rank = (pCalls->calls * pPercent + 99) / 100;
+    unsigned long long seen = 0;
+    unsigned int i;
+    if(!pCalls->calls)
+    {
+        return 0;
+    }
+    for(i = 0; i < (STATS_LATENCY_BUCKETS - 1); i++)
+    {
+        seen = seen + pCalls->buckets[i];
+        if(seen >= rank)
+        {
+            break;
+        }
+    }
+    /* The last bucket is open ended */
+    if(i == (STATS_LATENCY_BUCKETS - 1))
+    {
+        return pCalls->maxTime;
+    }
+    return((2ULL << i) - 1);
+}
+/*----------------------------------------------------------------------------------*/
+size_t DataStats_ToJson(const CAPTURE_STATS* pStats, const char* pOutput, ERROR_TYPE pResult,
+                        char* pBuffer, size_t pSize)
+{
+    JSON_TEXT text = { pBuffer, pSize, 0 };
+    unsigned int i;
+    if(pSize)
+    {
+        pBuffer[0] = NULL_CHARACTER;
+    }
+    appendText(&text, "{\"output\":");
+    appendString(&text, pOutput);
+    appendText(&text, ",\"result\":%d,\"duration_ns\":%llu,\"segments\":%u,\"flushes\":%llu,\"mbps\":%.2f,",
+               (int)pResult, pStats->duration, pStats->segments, pStats->flushes,
+               toMegabytesPerSecond(pStats->writes.bytes, pStats->duration));
+    appendCalls(&text, "reads", &pStats->reads);
+    appendText(&text, ",");
+    appendCalls(&text, "writes", &pStats->writes);
+    appendText(&text, ",");
+    appendCalls(&text, "syncs", &pStats->syncs);
+    appendText(&text, ",\"throughput\":{\"interval_ns\":%llu,\"mbps\":[", pStats->sampleInterval);
+    for(i = 0; i < pStats->samples; i++)
+    {
+        appendText(&text, "%s%.2f", i ? "," : "", toMegabytesPerSecond(pStats->sampleBytes[i], pStats->sampleInterval));
+    }
+    appendText(&text, "]}}");
+    return text.length;
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataStats_Append(const CAPTURE_STATS* pStats, const char* pFile, const char* pOutput,
+                            ERROR_TYPE pResult)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    size_t length = DataStats_ToJson(pStats, pOutput, pResult, NULL, 0);
+    char* line = malloc(length + 2);
+    FILE* file;
+    if(line == NULL)
+    {
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    (void)DataStats_ToJson(pStats, pOutput, pResult, line, length + 1);
+    line[length] = '\n';
+    line[length + 1] = NULL_CHARACTER;
+    file = fopen(pFile, "ab");
+    if(file == NULL)
+    {
+        free(line);
+        return(ERROR_WRITE_FILEOPEN);
+    }
+    /* A buffer holding the whole line makes the close write it at once */
+    (void)setvbuf(file, NULL, _IOFBF, length + 1);
+    if(fwrite(line, sizeof(char), length + 1, file) != (length + 1))
+    {
+        ret = ERROR_IO_FAILED;
+    }
+    if(fclose(file) != 0)
+    {
+        ret = ERROR_IO_FAILED;
+    }
+    free(line);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : recordCall
+ * Inputs       : CALL_STATS* pCalls - calls of the same kind
+ *                unsigned long long pStart - start of the call in nanoseconds
+ *                unsigned long long pEnd - end of the call in nanoseconds
+ *                unsigned long long pBytes - bytes moved by the call
+ * Outputs      :
+ * Description  : Counts the call in the bucket of the highest set bit of its
+ *                latency
+ -----------------------------------------------------------------------------------*/
+static void recordCall(CALL_STATS* pCalls, unsigned long long pStart, unsigned long long pEnd, unsigned long long pBytes)
+{
+    unsigned long long latency = pEnd - pStart;
+    unsigned int bucket = 63 - (unsigned int)__builtin_clzll(latency | 1);
+    if(bucket >= STATS_LATENCY_BUCKETS)
+    {
+        bucket = STATS_LATENCY_BUCKETS - 1;
+    }
+    pCalls->calls++;
+    pCalls->bytes = pCalls->bytes + pBytes;
+    pCalls->totalTime = pCalls->totalTime + latency;
+    pCalls->buckets[bucket]++;
+    if(latency > pCalls->maxTime)
+    {
+        pCalls->maxTime = latency;
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : recordSample
+ * Inputs       : CAPTURE_STATS* pStats - statistics of the capture
+ *                unsigned long long pEnd - end of the write in nanoseconds
+ *                unsigned long long pBytes - bytes written
+ * Outputs      :
+ * Description  : Adds the bytes to the sample of the write. A write past the last
+ *                sample merges the samples in pairs and doubles the interval, so
+ *                the memory is fixed whatever the length of the capture
+ -----------------------------------------------------------------------------------*/
+static void recordSample(CAPTURE_STATS* pStats, unsigned long long pEnd, unsigned long long pBytes)
+{
+    unsigned long long sample = (pEnd - pStats->started) / pStats->sampleInterval;
+    while(sample >= STATS_THROUGHPUT_SAMPLES)
+    {
+        unsigned int i;
+        for(i = 0; i < (STATS_THROUGHPUT_SAMPLES / 2); i++)
+        {
+            pStats->sampleBytes[i] = pStats->sampleBytes[2 * i] + pStats->sampleBytes[(2 * i) + 1];
+        }
+        memset(&pStats->sampleBytes[STATS_THROUGHPUT_SAMPLES / 2], 0,
+               (STATS_THROUGHPUT_SAMPLES / 2) * sizeof(pStats->sampleBytes[0]));
+        pStats->samples = (pStats->samples + 1) / 2;
+        pStats->sampleInterval = pStats->sampleInterval * 2;
+        sample = (pEnd - pStats->started) / pStats->sampleInterval;
+    }
+    pStats->sampleBytes[sample] = pStats->sampleBytes[sample] + pBytes;
+    if(sample >= pStats->samples)
+    {
+        pStats->samples = (unsigned int)sample + 1;
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : appendText
+ * Inputs       : JSON_TEXT* pText - text being formatted
+ *                const char* pFormat - printf format
+ * Outputs      :
+ * Description  : Appends as much as fits and counts the full length
+ -----------------------------------------------------------------------------------*/
+static void appendText(JSON_TEXT* pText, const char* pFormat, ...)
+{
+    va_list arguments;
+    int length;
+    va_start(arguments, pFormat);
+    if(pText->length < pText->size)
+    {
+        length = vsnprintf(pText->buffer + pText->length, pText->size - pText->length, pFormat, arguments);
+    }
+    else
+    {
+        length = vsnprintf(NULL, 0, pFormat, arguments);
+    }
+    va_end(arguments);
+    if(length > 0)
+    {
+        pText->length = pText->length + (size_t)length;
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : appendString
+ * Inputs       : JSON_TEXT* pText - text being formatted
+ *                const char* pString - string to be quoted. NULL - null
+ * Outputs      :
+ * Description  : Appends a quoted JSON string. Quotes, backslashes of Windows
+ *                paths and control characters are escaped
+ -----------------------------------------------------------------------------------*/
+static void appendString(JSON_TEXT* pText, const char* pString)
+{
+    if(pString == NULL)
+    {
+        appendText(pText, "null");
+        return;
+    }
+    appendText(pText, "\"");
+    for(; *pString; pString++)
+    {
+        unsigned char character = (unsigned char)*pString;
+        if((character == '"') || (character == '\\'))
+        {
+            appendText(pText, "\\%c", character);
+        }
+        else if(character < 0x20)
+        {
+            appendText(pText, "\\u%04x", character);
+        }
+        else
+        {
+            appendText(pText, "%c", character);
+        }
+    }
+    appendText(pText, "\"");
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : appendCalls
+ * Inputs       : JSON_TEXT* pText - text being formatted
+ *                const char* pName - key of the object
+ *                const CALL_STATS* pCalls - calls to be formatted
+ * Outputs      :
+ * Description  : Appends the counters, the percentiles and the non empty buckets
+ *                as [lowest latency in nanoseconds, calls] pairs
+ -----------------------------------------------------------------------------------*/
+static void appendCalls(JSON_TEXT* pText, const char* pName, const CALL_STATS* pCalls)
+{
+    bool first = true;
+    unsigned int i;
+    appendText(pText, "\"%s\":{\"calls\":%llu,\"bytes\":%llu,\"total_ns\":%llu,\"max_ns\":%llu,"
+               "\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"histogram\":[", pName, pCalls->calls,
+               pCalls->bytes, pCalls->totalTime, pCalls->maxTime, DataStats_Percentile(pCalls, 50),
+               DataStats_Percentile(pCalls, 90), DataStats_Percentile(pCalls, 99));
+    for(i = 0; i < STATS_LATENCY_BUCKETS; i++)
+    {
+        if(pCalls->buckets[i])
+        {
+            appendText(pText, "%s[%llu,%llu]", first ? "" : ",", i ? (1ULL << i) : 0ULL, pCalls->buckets[i]);
+            first = false;
+        }
+    }
+    appendText(pText, "]}");
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : toMegabytesPerSecond
+ * Inputs       : unsigned long long pBytes - bytes moved
+ *                unsigned long long pTime - time in nanoseconds
+ * Outputs      : Throughput in MB/s. 0 for no time
+ * Description  : Used for the whole capture and for the samples
+ -----------------------------------------------------------------------------------*/
+static double toMegabytesPerSecond(unsigned long long pBytes, unsigned long long pTime)
+{
+    if(!pTime)
+    {
+        return 0.0;
+    }
+    return((double)pBytes / BYTES_PER_MEGABYTE) / ((double)pTime / (double)NANOSECONDS_PER_SECOND);
+}
+/*----------------------------------------------------------------------------------*/
@@ -0,0 +1,476 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "DataTee.h"
+#include "DataStats.h"
+
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+/* Stall and wait times are reported in microseconds */
+#define TEE_NANOSECONDS_PER_MICROSECOND 1000ULL
+#define TEE_NANOSECONDS_PER_MILLISECOND 1000000ULL
+#define TEE_NANOSECONDS_PER_SECOND 1000000000ULL
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* One buffer of the ring */
+typedef struct
+{
+    char* data;
+    unsigned int size;
+} TEE_SLOT;
+
+struct TEE;
+
+/* Writer thread of one destination. Guarded by the lock of the tee */
+typedef struct
+{
+    struct TEE* tee;
+    DATA_WRITER* writer;
+    DESTINATION_STATS* stats;
+    unsigned long long next;    /* Sequence number of the next slot to write */
+    unsigned long long lag;     /* Time the reader waited for it while another destination
+                                   was ready, since it last kept up. In nanoseconds */
+    bool live;                  /* Takes data. Cleared when it fails or is dropped */
+    bool started;               /* Thread is running and must be joined */
+    pthread_t thread;
+} TEE_WRITER;
+
+/* State shared by the reader and the writer threads */
+typedef struct TEE
+{
+    ENGINE_JOB* job;
+    TEE_SLOT* slots;
+    unsigned int slotCount;
+    unsigned int slotSize;
+    unsigned long long produced;    /* Slots filled by the reader */
+    bool done;                      /* Reader stopped */
+    bool readerWaiting;             /* Reader is waiting for a free slot */
+    pthread_mutex_t lock;           /* Guards the sequence numbers, the flags and the stats */
+    pthread_cond_t filled;          /* A slot was published or the reader stopped */
+    pthread_cond_t drained;         /* A writer released a slot or stopped */
+    TEE_WRITER writers[MAX_DESTINATIONS];
+    unsigned int writerCount;
+    char* retired[MAX_DESTINATIONS];    /* Buffers still held by dropped writers */
+    unsigned int retiredCount;
+    TEE_STATS* stats;
+} TEE;
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static void* writerThread(void* pWriter);
+static void readInput(TEE* pTee);
+static bool waitForWriters(TEE* pTee);
+static void dropStalled(TEE* pTee, unsigned long long pTimeout);
+static bool allocateRing(TEE* pTee, unsigned int pBufferSize, unsigned long long pMemory);
+static void freeRing(TEE* pTee);
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataTee_Copy(ENGINE_JOB* pJob, DATA_WRITER* pWriters[], unsigned int pCount,
+                        unsigned long long pMemory, TEE_STATS* pStats)
+{
+    ERROR_TYPE ret = ERROR_UNKNOWN;
+    TEE tee;
+    unsigned int i;
+    unsigned int started = 0;
+    bool complete = false;
+    memset(&tee, 0, sizeof(tee));
+    tee.job = pJob;
+    tee.stats = pStats;
+    tee.writerCount = (pCount < MAX_DESTINATIONS) ? pCount : MAX_DESTINATIONS;
+    pStats->readerStalls = 0;
+    pStats->readerStallTime = 0;
+    if(!allocateRing(&tee, pJob->bufferSize, pMemory))
+    {
+        freeRing(&tee);
+        return(ERROR_MEMORY_ALLOCATION);
+    }
+    (void)pthread_mutex_init(&tee.lock, NULL);
+    (void)pthread_cond_init(&tee.filled, NULL);
+    (void)pthread_cond_init(&tee.drained, NULL);
+    for(i = 0; i < tee.writerCount; i++)
+    {
+        TEE_WRITER* writer = &tee.writers[i];
+        if(pWriters[i] == NULL)
+        {
+            continue;
+        }
+        writer->tee = &tee;
+        writer->writer = pWriters[i];
+        writer->stats = &pStats->destination[i];
+        writer->stats->result = ERROR_NOERROR;
+        writer->stats->bytes = 0;
+        writer->stats->waitTime = 0;
+        writer->live = true;
+        if(pthread_create(&writer->thread, NULL, writerThread, writer))
+        {
+            /* Only this destination is lost */
+            writer->live = false;
+            writer->stats->result = ERROR_IO_FAILED;
+        }
+        else
+        {
+            writer->started = true;
+            started++;
+        }
+    }
+    if(started)
+    {
+        /* The calling thread is the reader */
+        readInput(&tee);
+    }
+    for(i = 0; i < tee.writerCount; i++)
+    {
+        if(tee.writers[i].started)
+        {
+            (void)pthread_join(tee.writers[i].thread, NULL);
+        }
+    }
+    /* The capture is kept if any destination received all of it. Otherwise the
+       first destination tells why */
+    for(i = 0; i < tee.writerCount; i++)
+    {
+        if(pWriters[i] != NULL)
+        {
+            if(ret == ERROR_UNKNOWN)
+            {
+                ret = pStats->destination[i].result;
+            }
+            complete = complete || (pStats->destination[i].result == ERROR_NOERROR);
+        }
+    }
+    if(complete)
+    {
+        ret = ERROR_NOERROR;
+    }
+    else if(!started)
+    {
+        ret = ERROR_IO_FAILED;
+    }
+    (void)pthread_cond_destroy(&tee.drained);
+    (void)pthread_cond_destroy(&tee.filled);
+    (void)pthread_mutex_destroy(&tee.lock);
+    freeRing(&tee);
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : writerThread
+ * Inputs       : void* pWriter - TEE_WRITER of one destination
+ * Outputs      : NULL
+ * Description  : Writes the filled slots in order until end of input, until its
+ *                writer fails or until the reader drops it. The slot is written
+ *                outside of the lock, so destinations write in parallel
+ -----------------------------------------------------------------------------------*/
+static void* writerThread(void* pWriter)
+{
+    TEE_WRITER* writer = (TEE_WRITER*)pWriter;
+    TEE* tee = writer->tee;
+    pthread_mutex_lock(&tee->lock);
+    while(writer->live)
+    {
+        char* data;
+        unsigned int size;
+        ERROR_TYPE result;
+        if(writer->next == tee->produced)
+        {
+            unsigned long long start;
+            if(tee->done)
+            {
+                /* All of the input is written */
+                break;
+            }
+            start = DataStats_Now();
+            while(writer->live && (writer->next == tee->produced) && !tee->done)
+            {
+                pthread_cond_wait(&tee->filled, &tee->lock);
+            }
+            writer->stats->waitTime += (DataStats_Now() - start) / TEE_NANOSECONDS_PER_MICROSECOND;
+            continue;
+        }
+        data = tee->slots[writer->next % tee->slotCount].data;
+        size = tee->slots[writer->next % tee->slotCount].size;
+        pthread_mutex_unlock(&tee->lock);
+        result = DataWriter_Write(writer->writer, data, size);
+        pthread_mutex_lock(&tee->lock);
+        if(!writer->live)
+        {
+            /* Dropped during the write. The buffer was retired, not reused */
+            break;
+        }
+        if(result != ERROR_NOERROR)
+        {
+            /* Only this destination stops */
+            writer->stats->result = result;
+            writer->live = false;
+        }
+        else
+        {
+            writer->stats->bytes += size;
+            writer->next++;
+        }
+        if(tee->readerWaiting)
+        {
+            pthread_cond_signal(&tee->drained);
+        }
+    }
+    pthread_mutex_unlock(&tee->lock);
+    return NULL;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : readInput
+ * Inputs       : TEE* pTee - current tee
+ * Outputs      :
+ * Description  : Fills the slots from the input until end of input or until no
+ *                destination is left. The slot being filled is free in every
+ *                live destination, so it is read outside of the lock
+ -----------------------------------------------------------------------------------*/
+static void readInput(TEE* pTee)
+{
+    while(true)
+    {
+        TEE_SLOT* slot;
+        pthread_mutex_lock(&pTee->lock);
+        if(!waitForWriters(pTee))
+        {
+            pthread_mutex_unlock(&pTee->lock);
+            break;
+        }
+        slot = &pTee->slots[pTee->produced % pTee->slotCount];
+        pthread_mutex_unlock(&pTee->lock);
+        slot->size = DataEngine_Read(pTee->job, slot->data, pTee->slotSize);
+        if(!slot->size)
+        {
+            /* File read completed */
+            break;
+        }
+        /* Publish the slot to all writers */
+        pthread_mutex_lock(&pTee->lock);
+        pTee->produced++;
+        pthread_cond_broadcast(&pTee->filled);
+        pthread_mutex_unlock(&pTee->lock);
+    }
+    pthread_mutex_lock(&pTee->lock);
+    pTee->done = true;
+    pthread_cond_broadcast(&pTee->filled);
+    pthread_mutex_unlock(&pTee->lock);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : waitForWriters
+ * Inputs       : TEE* pTee - current tee. Locked by the caller
+ * Outputs      : True if the next slot is free in every live destination. False
+ *                if no destination is left
+ * Description  : Called by the reader. Waits while a destination is a full ring
+ *                behind. Each wait is a reader stall. The time the reader waits
+ *                for a destination while another one could take more data is
+ *                its lag. The lag adds up over the slots until the destination
+ *                is found keeping up, so one that only advances a slot at a time
+ *                builds it up as well as one that does not move. At
+ *                TEE_STALL_TIMEOUT_MS of lag it is dropped so that it no longer
+ *                holds the others back
+ -----------------------------------------------------------------------------------*/
+static bool waitForWriters(TEE* pTee)
+{
+    unsigned long long timeout = TEE_STALL_TIMEOUT_MS * TEE_NANOSECONDS_PER_MILLISECOND;
+    unsigned long long start = 0;
+    bool first = true;
+    while(true)
+    {
+        bool behind[MAX_DESTINATIONS] = { false };
+        unsigned long long largest = 0;
+        unsigned long long now;
+        unsigned long long wait;
+        struct timespec deadline;
+        unsigned int i;
+        bool live = false;
+        bool full = false;
+        bool ready = false;
+        for(i = 0; i < pTee->writerCount; i++)
+        {
+            TEE_WRITER* writer = &pTee->writers[i];
+            if(writer->live)
+            {
+                live = true;
+                if((pTee->produced - writer->next) >= pTee->slotCount)
+                {
+                    full = true;
+                    behind[i] = true;
+                    largest = (writer->lag > largest) ? writer->lag : largest;
+                }
+                else
+                {
+                    ready = true;
+                    if(first)
+                    {
+                        /* Keeping up when the reader has a new slot to fill */
+                        writer->lag = 0;
+                    }
+                }
+            }
+        }
+        first = false;
+        if(!live || !full)
+        {
+            if(start)
+            {
+                pTee->stats->readerStallTime += (DataStats_Now() - start) / TEE_NANOSECONDS_PER_MICROSECOND;
+            }
+            return(live);
+        }
+        now = DataStats_Now();
+        if(!start)
+        {
+            pTee->stats->readerStalls++;
+            start = now;
+        }
+        if(ready && (largest >= timeout))
+        {
+            /* The others would be held back by the stalled destinations */
+            dropStalled(pTee, timeout);
+            continue;
+        }
+        /* Wake up when the largest lag reaches the timeout */
+        wait = ready ? (timeout - largest) : timeout;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        wait = wait + (unsigned long long)deadline.tv_nsec;
+        deadline.tv_sec += (time_t)(wait / TEE_NANOSECONDS_PER_SECOND);
+        deadline.tv_nsec = (long)(wait % TEE_NANOSECONDS_PER_SECOND);
+        pTee->readerWaiting = true;
+        (void)pthread_cond_timedwait(&pTee->drained, &pTee->lock, &deadline);
+        pTee->readerWaiting = false;
+        if(ready)
+        {
+            wait = DataStats_Now() - now;
+            for(i = 0; i < pTee->writerCount; i++)
+            {
+                if(behind[i])
+                {
+                    pTee->writers[i].lag += wait;
+                }
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : dropStalled
+ * Inputs       : TEE* pTee - current tee. Locked by the caller
+ *                unsigned long long pTimeout - lag of a stalled destination in ns
+ * Outputs      :
+ * Description  : Drops every destination a full ring behind whose lag reached
+ *                pTimeout. A dropped writer may still be writing its slot, so the
+ *                buffer of the slot is retired until the writer is joined and
+ *                replaced by a new one. A destination is kept, with its lag
+ *                cleared, if no replacement can be allocated
+ -----------------------------------------------------------------------------------*/
+static void dropStalled(TEE* pTee, unsigned long long pTimeout)
+{
+    unsigned int i;
+    unsigned int j;
+    for(i = 0; i < pTee->writerCount; i++)
+    {
+        TEE_WRITER* writer = &pTee->writers[i];
+        if(writer->live && ((pTee->produced - writer->next) >= pTee->slotCount) && (writer->lag >= pTimeout))
+        {
+            TEE_SLOT* slot = &pTee->slots[writer->next % pTee->slotCount];
+            bool replaced = false;
+            /* Destinations stalled on the same slot share its retired buffer */
+            for(j = 0; j < i; j++)
+            {
+                if((pTee->writers[j].stats != NULL) && (pTee->writers[j].stats->result == ERROR_DESTINATION_STALLED) &&
+                   (pTee->writers[j].next == writer->next))
+                {
+                    replaced = true;
+                }
+            }
+            if(!replaced)
+            {
+                char* buffer = DataEngine_AllocateBuffer(pTee->slotSize);
+                if(buffer == NULL)
+                {
+                    writer->lag = 0;
+                    continue;
+                }
+                pTee->retired[pTee->retiredCount++] = slot->data;
+                slot->data = buffer;
+            }
+            writer->live = false;
+            writer->stats->result = ERROR_DESTINATION_STALLED;
+        }
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : allocateRing
+ * Inputs       : TEE* pTee - current tee
+ *                unsigned int pBufferSize - preferred slot size in bytes
+ *                unsigned long long pMemory - total memory of the ring in bytes
+ * Outputs      : True if all slots are allocated. False otherwise
+ * Description  : Splits the memory limit into slots of the I/O buffer size. When
+ *                the limit cannot hold MIN_TEE_SLOTS buffers, the slots are shrunk
+ *                instead so that the limit is honoured
+ -----------------------------------------------------------------------------------*/
+static bool allocateRing(TEE* pTee, unsigned int pBufferSize, unsigned long long pMemory)
+{
+    unsigned int i;
+    pTee->slotSize = pBufferSize;
+    if((pMemory / pBufferSize) < MIN_TEE_SLOTS)
+    {
+        pTee->slotSize = (unsigned int)(pMemory / MIN_TEE_SLOTS);
+        pTee->slotSize = pTee->slotSize - (pTee->slotSize % BUFFER_ALIGNMENT);
+        if(!pTee->slotSize)
+        {
+            pTee->slotSize = BUFFER_ALIGNMENT;
+        }
+    }
+    pTee->slotCount = (unsigned int)(pMemory / pTee->slotSize);
+    if(pTee->slotCount < MIN_TEE_SLOTS)
+    {
+        pTee->slotCount = MIN_TEE_SLOTS;
+    }
+    pTee->slots = calloc(pTee->slotCount, sizeof(TEE_SLOT));
+    if(pTee->slots == NULL)
+    {
+        return false;
+    }
+    for(i = 0; i < pTee->slotCount; i++)
+    {
+        pTee->slots[i].data = DataEngine_AllocateBuffer(pTee->slotSize);
+        if(pTee->slots[i].data == NULL)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : freeRing
+ * Inputs       : TEE* pTee - current tee
+ * Outputs      :
+ * Description  : Releases the slots allocated by allocateRing() and the buffers
+ *                retired by dropStalled()
+ -----------------------------------------------------------------------------------*/
+static void freeRing(TEE* pTee)
+{
+    unsigned int i;
+    if(pTee->slots != NULL)
+    {
+        for(i = 0; i < pTee->slotCount; i++)
+        {
+            if(pTee->slots[i].data != NULL)
+            {
+                DataEngine_FreeBuffer(pTee->slots[i].data);
+            }
+        }
+        free(pTee->slots);
+        pTee->slots = NULL;
+    }
+    for(i = 0; i < pTee->retiredCount; i++)
+    {
+        DataEngine_FreeBuffer(pTee->retired[i]);
+    }
+    pTee->retiredCount = 0;
+}
+/*----------------------------------------------------------------------------------*/
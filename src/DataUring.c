@@ -0,0 +1,495 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#include <stdlib.h>
+#include <string.h>
+#include "DataUring.h"
+#include "DataStats.h"
+#ifdef __linux__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif
+
+#ifdef __linux__
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define URING_READ 0
+#define URING_WRITE 1
+#define URING_USER_DATA(pSlot, pOperation) (((unsigned long long)(pSlot) << 1) | (pOperation))
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Submission and completion rings shared with the kernel */
+typedef struct
+{
+    int fd;
+    unsigned int* sqHead;
+    unsigned int* sqTail;
+    unsigned int* sqMask;
+    unsigned int* sqArray;
+    unsigned int sqEntries;
+    unsigned int sqLocalTail;   /* Entries prepared but not yet published */
+    unsigned int toSubmit;
+    struct io_uring_sqe* sqes;
+    unsigned int* cqHead;
+    unsigned int* cqTail;
+    unsigned int* cqMask;
+    struct io_uring_cqe* cqes;
+    void* sqRing;
+    size_t sqRingSize;
+    void* cqRing;
+    size_t cqRingSize;
+    size_t sqesSize;
+} URING;
+
+/* One registered buffer and the read/write pair using it */
+typedef struct
+{
+    char* data;
+    bool busy;
+    unsigned int length;        /* Bytes requested from the input */
+    int readResult;             /* Bytes actually read. -1 until the read completes */
+    unsigned int written;       /* Bytes of the buffer written so far */
+    off_t inputOffset;
+    off_t outputOffset;
+    unsigned long long started; /* Start of the pending read or write in nanoseconds */
+} URING_SLOT;
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static bool setupRing(URING* pRing, unsigned int pEntries);
+static void closeRing(URING* pRing);
+static struct io_uring_sqe* getSqe(URING* pRing);
+static int submitAndWait(URING* pRing);
+static void queueRead(URING* pRing, URING_SLOT* pSlot, unsigned int pIndex, int pInput);
+static void queueWrite(URING* pRing, URING_SLOT* pSlot, unsigned int pIndex, int pOutput, unsigned int pSize);
+#endif
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataUring_Copy(ENGINE_JOB* pJob, unsigned int pQueueDepth)
+{
+#ifdef __linux__
+    ERROR_TYPE ret = ERROR_NOERROR;
+    URING ring;
+    URING_SLOT* slots;
+    struct iovec* vectors;
+    struct stat inputStat;
+    DATA_WRITER* writer = pJob->writer;
+    int input = fileno(pJob->input);
+    int output;
+    off_t inputOffset;
+    off_t resumeInput;
+    off_t outputBase;
+    unsigned long long segmentStart;
+    unsigned long long segmentPlanned = 0;
+    unsigned int inFlight = 0;
+    unsigned int i;
+    bool inputDone = false;
+    /* Reads are issued at explicit offsets, which requires a regular file */
+    if((fstat(input, &inputStat) != 0) || !S_ISREG(inputStat.st_mode))
+    {
+        return(DataEngine_StdioCopy(pJob));
+    }
+    /* ftello accounts for data already read ahead by stdio */
+    inputOffset = ftello(pJob->input);
+    if((inputOffset < 0) || !setupRing(&ring, pQueueDepth * 2))
+    {
+        return(DataEngine_StdioCopy(pJob));
+    }
+    slots = calloc(pQueueDepth, sizeof(URING_SLOT));
+    vectors = calloc(pQueueDepth, sizeof(struct iovec));
+    for(i = 0; (slots != NULL) && (vectors != NULL) && (i < pQueueDepth); i++)
+    {
+        slots[i].data = DataEngine_AllocateBuffer(pJob->bufferSize);
+        if(slots[i].data == NULL)
+        {
+            ret = ERROR_MEMORY_ALLOCATION;
+            break;
+        }
+        vectors[i].iov_base = slots[i].data;
+        vectors[i].iov_len = pJob->bufferSize;
+    }
+    if((slots == NULL) || (vectors == NULL))
+    {
+        ret = ERROR_MEMORY_ALLOCATION;
+    }
+    if(ret == ERROR_NOERROR)
+    {
+        if(syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS, vectors, pQueueDepth) < 0)
+        {
+            /* Typically the locked memory limit. Use the existing path instead */
+            for(i = 0; i < pQueueDepth; i++)
+            {
+                DataEngine_FreeBuffer(slots[i].data);
+            }
+            free(slots);
+            free(vectors);
+            closeRing(&ring);
+            return(DataEngine_StdioCopy(pJob));
+        }
+    }
+    output = DataWriter_Descriptor(writer);
+    outputBase = lseek(output, 0, SEEK_CUR);
+    segmentStart = writer->segmentSize;
+    resumeInput = inputStat.st_size;
+    while(ret == ERROR_NOERROR)
+    {
+        unsigned long long space = writer->maxSize - segmentStart - segmentPlanned;
+        /* Keep every free buffer busy with a linked read and write */
+        for(i = 0; (i < pQueueDepth) && !inputDone && space; i++)
+        {
+            if(!slots[i].busy)
+            {
+                unsigned long long length = pJob->bufferSize;
+                if(inputOffset >= inputStat.st_size)
+                {
+                    inputDone = true;
+                    break;
+                }
+                if(length > (unsigned long long)(inputStat.st_size - inputOffset))
+                {
+                    length = (unsigned long long)(inputStat.st_size - inputOffset);
+                }
+                if(length > space)
+                {
+                    length = space;
+                }
+                slots[i].busy = true;
+                slots[i].length = (unsigned int)length;
+                slots[i].readResult = -1;
+                slots[i].written = 0;
+                slots[i].inputOffset = inputOffset;
+                slots[i].outputOffset = outputBase + (off_t)segmentPlanned;
+                slots[i].started = DataStats_Now();
+                queueRead(&ring, &slots[i], i, input);
+                queueWrite(&ring, &slots[i], i, output, slots[i].length);
+                inputOffset = inputOffset + (off_t)length;
+                segmentPlanned = segmentPlanned + length;
+                space = space - length;
+                inFlight++;
+            }
+        }
+        if(!inFlight)
+        {
+            if(!space && !inputDone && writer->rotate && (inputOffset < inputStat.st_size))
+            {
+                /* All writes of the full segment are complete. Continue in the next */
+                ret = DataWriter_Rotate(writer);
+                output = DataWriter_Descriptor(writer);
+                outputBase = 0;
+                segmentStart = 0;
+                segmentPlanned = 0;
+                continue;
+            }
+            break;
+        }
+        if(submitAndWait(&ring) < 0)
+        {
+            ret = ERROR_IO_FAILED;
+        }
+        /* Process all completions */
+        while((ret == ERROR_NOERROR) && (*ring.cqHead != __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE)))
+        {
+            struct io_uring_cqe* cqe = &ring.cqes[*ring.cqHead & *ring.cqMask];
+            URING_SLOT* slot = &slots[cqe->user_data >> 1];
+            unsigned int index = (unsigned int)(cqe->user_data >> 1);
+            int result = cqe->res;
+            __atomic_store_n(ring.cqHead, *ring.cqHead + 1, __ATOMIC_RELEASE);
+            if((cqe->user_data & 1) == URING_READ)
+            {
+                if(result >= 0)
+                {
+                    /* The linked write starts with the completion of the read */
+                    DataStats_RecordRead(pJob->stats, slot->started, (unsigned long long)result);
+                    slot->started = DataStats_Now();
+                }
+                if(result < 0)
+                {
+                    ret = ERROR_IO_FAILED;
+                }
+                else if((unsigned int)result < slot->length)
+                {
+                    /* Input shrank or ended early. The linked write is cancelled */
+                    slot->readResult = result;
+                    inputDone = true;
+                    if((slot->inputOffset + result) < resumeInput)
+                    {
+                        resumeInput = slot->inputOffset + result;
+                    }
+                }
+                else
+                {
+                    slot->readResult = result;
+                }
+            }
+            else if(result == -ECANCELED)
+            {
+                /* Write the part of a short read on its own */
+                if(slot->readResult > 0)
+                {
+                    slot->length = (unsigned int)slot->readResult;
+                    slot->started = DataStats_Now();
+                    queueWrite(&ring, slot, index, output, slot->length);
+                }
+                else
+                {
+                    slot->busy = false;
+                    inFlight--;
+                }
+            }
+            else if(result <= 0)
+            {
+                /* No further completion arrives for this slot */
+                ret = ERROR_IO_FAILED;
+                slot->busy = false;
+                inFlight--;
+            }
+            else
+            {
+                DataStats_RecordWrite(pJob->stats, slot->started, (unsigned long long)result);
+                DataWriter_Commit(writer, (unsigned int)result);
+                slot->written = slot->written + (unsigned int)result;
+                if(slot->written < slot->length)
+                {
+                    /* Short write. Queue the remainder */
+                    slot->started = DataStats_Now();
+                    queueWrite(&ring, slot, index, output, slot->length - slot->written);
+                }
+                else
+                {
+                    slot->busy = false;
+                    inFlight--;
+                }
+            }
+        }
+    }
+    /* Buffers cannot be released while the kernel may still use them */
+    while(inFlight && (submitAndWait(&ring) >= 0))
+    {
+        while(*ring.cqHead != __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE))
+        {
+            struct io_uring_cqe* cqe = &ring.cqes[*ring.cqHead & *ring.cqMask];
+            if((cqe->user_data & 1) == URING_WRITE)
+            {
+                inFlight--;
+            }
+            __atomic_store_n(ring.cqHead, *ring.cqHead + 1, __ATOMIC_RELEASE);
+        }
+    }
+    if(slots != NULL)
+    {
+        for(i = 0; i < pQueueDepth; i++)
+        {
+            DataEngine_FreeBuffer(slots[i].data);
+        }
+    }
+    free(slots);
+    free(vectors);
+    closeRing(&ring);
+    if(ret == ERROR_NOERROR)
+    {
+        /* Position both streams after the copied data. The stdio path then picks
+           up data appended since the start and reports a reached size limit */
+        if(inputOffset > resumeInput)
+        {
+            inputOffset = resumeInput;
+        }
+        (void)fseeko(pJob->input, inputOffset, SEEK_SET);
+        (void)fseeko(writer->output, outputBase + (off_t)(writer->segmentSize - segmentStart), SEEK_SET);
+        ret = DataEngine_StdioCopy(pJob);
+    }
+    return(ret);
+#else
+    /* io_uring is not available on this platform */
+    (void)pQueueDepth;
+    return(DataEngine_StdioCopy(pJob));
+#endif
+}
+#ifdef __linux__
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : setupRing
+ * Inputs       : URING* pRing - ring to be initialized
+ *                unsigned int pEntries - number of submission queue entries
+ * Outputs      : True if the ring is ready. False if io_uring is not available
+ * Description  : Creates the io_uring instance and maps its rings
+ -----------------------------------------------------------------------------------*/
+static bool setupRing(URING* pRing, unsigned int pEntries)
+{
+    struct io_uring_params params;
+    char* sqRing;
+    char* cqRing;
+    memset(pRing, 0, sizeof(URING));
+    memset(&params, 0, sizeof(params));
+    pRing->fd = (int)syscall(__NR_io_uring_setup, pEntries, &params);
+    if(pRing->fd < 0)
+    {
+        return false;
+    }
+    pRing->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    pRing->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if(params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if(pRing->cqRingSize > pRing->sqRingSize)
+        {
+            pRing->sqRingSize = pRing->cqRingSize;
+        }
+        pRing->cqRingSize = 0;
+    }
+    pRing->sqRing = mmap(NULL, pRing->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         pRing->fd, IORING_OFF_SQ_RING);
+    if(pRing->sqRing == MAP_FAILED)
+    {
+        close(pRing->fd);
+        return false;
+    }
+    pRing->cqRing = pRing->sqRing;
+    if(pRing->cqRingSize)
+    {
+        pRing->cqRing = mmap(NULL, pRing->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             pRing->fd, IORING_OFF_CQ_RING);
+        if(pRing->cqRing == MAP_FAILED)
+        {
+            munmap(pRing->sqRing, pRing->sqRingSize);
+            close(pRing->fd);
+            return false;
+        }
+    }
+    pRing->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    pRing->sqes = mmap(NULL, pRing->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       pRing->fd, IORING_OFF_SQES);
+    if(pRing->sqes == MAP_FAILED)
+    {
+        if(pRing->cqRingSize)
+        {
+            munmap(pRing->cqRing, pRing->cqRingSize);
+        }
+        munmap(pRing->sqRing, pRing->sqRingSize);
+        close(pRing->fd);
+        return false;
+    }
+    sqRing = pRing->sqRing;
+    cqRing = pRing->cqRing;
+    pRing->sqHead = (unsigned int*)(sqRing + params.sq_off.head);
+    pRing->sqTail = (unsigned int*)(sqRing + params.sq_off.tail);
+    pRing->sqMask = (unsigned int*)(sqRing + params.sq_off.ring_mask);
+    pRing->sqArray = (unsigned int*)(sqRing + params.sq_off.array);
+    pRing->sqEntries = params.sq_entries;
+    pRing->sqLocalTail = *pRing->sqTail;
+    pRing->cqHead = (unsigned int*)(cqRing + params.cq_off.head);
+    pRing->cqTail = (unsigned int*)(cqRing + params.cq_off.tail);
+    pRing->cqMask = (unsigned int*)(cqRing + params.cq_off.ring_mask);
+    pRing->cqes = (struct io_uring_cqe*)(cqRing + params.cq_off.cqes);
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : closeRing
+ * Inputs       : URING* pRing - ring created by setupRing()
+ * Outputs      :
+ * Description  : Unmaps the rings and closes the io_uring instance. Registered
+ *                buffers are released with it
+ -----------------------------------------------------------------------------------*/
+static void closeRing(URING* pRing)
+{
+    munmap(pRing->sqes, pRing->sqesSize);
+    if(pRing->cqRingSize)
+    {
+        munmap(pRing->cqRing, pRing->cqRingSize);
+    }
+    munmap(pRing->sqRing, pRing->sqRingSize);
+    close(pRing->fd);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : getSqe
+ * Inputs       : URING* pRing - current ring
+ * Outputs      : Cleared submission queue entry. NULL if the queue is full
+ * Description  : Reserves the next submission queue entry
+ -----------------------------------------------------------------------------------*/
+static struct io_uring_sqe* getSqe(URING* pRing)
+{
+    struct io_uring_sqe* sqe;
+    unsigned int index;
+    unsigned int head = __atomic_load_n(pRing->sqHead, __ATOMIC_ACQUIRE);
+    if((pRing->sqLocalTail - head) >= pRing->sqEntries)
+    {
+        return NULL;
+    }
+    index = pRing->sqLocalTail & *pRing->sqMask;
+    sqe = &pRing->sqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    pRing->sqArray[index] = index;
+    pRing->sqLocalTail++;
+    pRing->toSubmit++;
+    return sqe;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : submitAndWait
+ * Inputs       : URING* pRing - current ring
+ * Outputs      : 0 on success. -1 on failure
+ * Description  : Publishes the prepared entries and waits for one completion
+ -----------------------------------------------------------------------------------*/
+static int submitAndWait(URING* pRing)
+{
+    int submitted;
+    __atomic_store_n(pRing->sqTail, pRing->sqLocalTail, __ATOMIC_RELEASE);
+    do
+    {
+        submitted = (int)syscall(__NR_io_uring_enter, pRing->fd, pRing->toSubmit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+    } while((submitted < 0) && (errno == EINTR));
+    if(submitted < 0)
+    {
+        return -1;
+    }
+    pRing->toSubmit = pRing->toSubmit - (unsigned int)submitted;
+    return 0;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : queueRead
+ * Inputs       : URING* pRing - current ring
+ *                URING_SLOT* pSlot - buffer to read into
+ *                unsigned int pIndex - index of the registered buffer
+ *                int pInput - input descriptor
+ * Outputs      :
+ * Description  : Queues a fixed buffer read linked to the following write
+ -----------------------------------------------------------------------------------*/
+static void queueRead(URING* pRing, URING_SLOT* pSlot, unsigned int pIndex, int pInput)
+{
+    /* The ring holds two entries per buffer, so an entry is always available */
+    struct io_uring_sqe* sqe = getSqe(pRing);
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->flags = IOSQE_IO_LINK;
+    sqe->fd = pInput;
+    sqe->addr = (unsigned long long)(unsigned long)pSlot->data;
+    sqe->len = pSlot->length;
+    sqe->off = (unsigned long long)pSlot->inputOffset;
+    sqe->buf_index = (unsigned short)pIndex;
+    sqe->user_data = URING_USER_DATA(pIndex, URING_READ);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : queueWrite
+ * Inputs       : URING* pRing - current ring
+ *                URING_SLOT* pSlot - buffer to write from
+ *                unsigned int pIndex - index of the registered buffer
+ *                int pOutput - output descriptor
+ *                unsigned int pSize - bytes to write from the written position
+ * Outputs      :
+ * Description  : Queues a fixed buffer write of the unwritten part of the buffer
+ -----------------------------------------------------------------------------------*/
+static void queueWrite(URING* pRing, URING_SLOT* pSlot, unsigned int pIndex, int pOutput, unsigned int pSize)
+{
+    struct io_uring_sqe* sqe = getSqe(pRing);
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->fd = pOutput;
+    sqe->addr = (unsigned long long)(unsigned long)(pSlot->data + pSlot->written);
+    sqe->len = pSize;
+    sqe->off = (unsigned long long)(pSlot->outputOffset + pSlot->written);
+    sqe->buf_index = (unsigned short)pIndex;
+    sqe->user_data = URING_USER_DATA(pIndex, URING_WRITE);
+}
+#endif
+/*----------------------------------------------------------------------------------*/
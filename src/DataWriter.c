@@ -0,0 +1,860 @@
+/*----------------------------------------------------------------------------------*/
+/* Header includes */
+#ifdef __linux__
+/* Required for O_DIRECT. Must precede all system headers */
+#define _GNU_SOURCE
+#endif
+#include <string.h>
+#include <stdint.h>
+#include "DataWriter.h"
+#include "DataEngine.h"
+#include "DataStats.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#define WRITER_FILE_MODE (_S_IREAD | _S_IWRITE)
+#define truncateDescriptor _chsize_s
+#define seekDescriptor _lseeki64
+#else
+#include <unistd.h>
+#define WRITER_FILE_MODE 0644
+#define O_BINARY 0
+#define truncateDescriptor ftruncate
+#define seekDescriptor lseek
+#endif
+
+/*----------------------------------------------------------------------------------*/
+/* Custom data types */
+/* Capture waiting for a group sync. Lives on the stack of the waiting thread */
+typedef struct SYNC_MEMBER
+{
+    int descriptor;                         /* Segment to be made durable */
+    bool done;                              /* Set by the leader once the writeback started */
+    struct SYNC_MEMBER* next;
+} SYNC_MEMBER;
+
+/*----------------------------------------------------------------------------------*/
+/* Static variables */
+/* Group commit shared by all writers of the process */
+static pthread_mutex_t fl_GroupLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t fl_GroupDone = PTHREAD_COND_INITIALIZER;
+static SYNC_MEMBER* fl_GroupPending = NULL;     /* Members waiting for the next batch */
+static bool fl_GroupSyncing = false;            /* A leader is starting a batch */
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static ERROR_TYPE initializeWriter(DATA_WRITER* pWriter, const char* pWriteFile, WRITER_NAME_FN pDefineFile,
+                                   void* pNameContext, unsigned long long pMaxSize, unsigned long long pFlushInterval,
+                                   bool pRotate, bool pDirect, bool pChecksum);
+static FILE* openSegment(DATA_WRITER* pWriter, const char* pFileName);
+static bool writeOutput(DATA_WRITER* pWriter, const char* pData, unsigned int pSize);
+static bool flushStaging(DATA_WRITER* pWriter, bool pTail);
+static bool writeBlocks(int pDescriptor, const char* pData, unsigned int pSize);
+static void* closeSegment(void* pWriter);
+static void waitForClose(DATA_WRITER* pWriter);
+static void finishClose(DATA_WRITER* pWriter);
+static void reserveSpace(DATA_WRITER* pWriter);
+static void releaseSpace(DATA_WRITER* pWriter);
+static void syncOutput(DATA_WRITER* pWriter);
+static bool syncSegment(DATA_WRITER* pWriter, FILE* pOutput);
+static bool syncDescriptor(int pDescriptor, bool pMetadata);
+static bool syncGroup(int pDescriptor);
+static void startBatch(SYNC_MEMBER* pBatch);
+/*----------------------------------------------------------------------------------*/
+/* Extern function definitions */
+ERROR_TYPE DataWriter_Open(DATA_WRITER* pWriter, const char* pWriteFile, WRITER_NAME_FN pDefineFile,
+                           void* pNameContext, unsigned long long pMaxSize, unsigned long long pFlushInterval, bool pRotate,
+                           bool pDirect, bool pChecksum)
+{
+    unsigned int attempt;
+    ERROR_TYPE ret = initializeWriter(pWriter, pWriteFile, pDefineFile, pNameContext, pMaxSize, pFlushInterval,
+                                      pRotate, pDirect, pChecksum);
+    if(ret != ERROR_NOERROR)
+    {
+        return(ret);
+    }
+    pWriter->output = openSegment(pWriter, pWriter->fileName);
+    for(attempt = 1; (pWriter->output == NULL) && (errno == EEXIST) && (attempt < WRITER_CREATE_ATTEMPTS); attempt++)
+    {
+        /* The name is taken. Never overwrite, define a new one instead */
+        memset(pWriter->fileName, NULL_CHARACTER, sizeof(pWriter->fileName));
+        if(!pDefineFile(pNameContext, pWriter->fileName, sizeof(pWriter->fileName), 0))
+        {
+            break;
+        }
+        pWriter->output = openSegment(pWriter, pWriter->fileName);
+    }
+    if(pWriter->output == NULL)
+    {
+        DataEngine_FreeBuffer(pWriter->staging);
+        pWriter->staging = NULL;
+        return(ERROR_WRITE_FILEOPEN);
+    }
+    return(ERROR_NOERROR);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataWriter_Resume(DATA_WRITER* pWriter, const char* pWriteFile, unsigned int pSegment,
+                             unsigned long long pSegmentSize, WRITER_NAME_FN pDefineFile, void* pNameContext,
+                             unsigned long long pMaxSize, unsigned long long pFlushInterval, bool pRotate, bool pDirect)
+{
+    int descriptor;
+    ERROR_TYPE ret = initializeWriter(pWriter, pWriteFile, pDefineFile, pNameContext, pMaxSize, pFlushInterval,
+                                      pRotate, pDirect, false);
+    if(ret != ERROR_NOERROR)
+    {
+        return(ret);
+    }
+    /* The end of the file is not block aligned. Whole blocks are still staged,
+       but written through the page cache until the next segment */
+    descriptor = open(pWriter->fileName, O_WRONLY | O_BINARY);
+    if(descriptor >= 0)
+    {
+        if((truncateDescriptor(descriptor, (off_t)pSegmentSize) != 0) ||
+           (seekDescriptor(descriptor, (off_t)pSegmentSize, SEEK_SET) < 0) ||
+           ((pWriter->output = fdopen(descriptor, "wb")) == NULL))
+        {
+            close(descriptor);
+        }
+    }
+    if(pWriter->output == NULL)
+    {
+        DataEngine_FreeBuffer(pWriter->staging);
+        pWriter->staging = NULL;
+        return(ERROR_WRITE_FILEOPEN);
+    }
+    pWriter->segment = pSegment;
+    pWriter->segmentSize = pSegmentSize;
+    pWriter->reserved = pSegmentSize;
+    return(ERROR_NOERROR);
+}
+/*----------------------------------------------------------------------------------*/
+void DataWriter_SetProgress(DATA_WRITER* pWriter, WRITER_PROGRESS_FN pProgress, void* pContext,
+                            unsigned long long pInterval)
+{
+    pWriter->progress = pProgress;
+    pWriter->progressContext = pContext;
+    pWriter->progressInterval = pInterval;
+    pWriter->lastProgress = pWriter->written;
+}
+/*----------------------------------------------------------------------------------*/
+void DataWriter_Preallocate(DATA_WRITER* pWriter, unsigned long long pExpected)
+{
+#ifdef __linux__
+    pWriter->preallocate = true;
+    pWriter->expected = pExpected;
+    reserveSpace(pWriter);
+#else
+    (void)pWriter;
+    (void)pExpected;
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+void DataWriter_Reserve(DATA_WRITER* pWriter, unsigned long long pSize)
+{
+#ifdef __linux__
+    unsigned long long target = pWriter->segmentSize + pSize;
+    if(target > pWriter->maxSize)
+    {
+        target = pWriter->maxSize;
+    }
+    if((target > pWriter->reserved) && (fallocate(fileno(pWriter->output), FALLOC_FL_KEEP_SIZE,
+                                                  (off_t)pWriter->reserved, (off_t)(target - pWriter->reserved)) == 0))
+    {
+        pWriter->reserved = target;
+    }
+#else
+    (void)pWriter;
+    (void)pSize;
+#endif
+}
+/*----------------------------------------------------------------------------------*/
+void DataWriter_SetDurability(DATA_WRITER* pWriter, DURABILITY_TYPE pDurability, unsigned long long pInterval)
+{
+    pWriter->durability = pDurability;
+    pWriter->syncInterval = pInterval;
+    pWriter->unsynced = 0;
+    pWriter->lastSync = DataStats_Now();
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataWriter_Write(DATA_WRITER* pWriter, const char* pData, unsigned int pSize)
+{
+    while(pSize)
+    {
+        unsigned long long start;
+        unsigned long long writeSize = DataWriter_Space(pWriter);
+        if(writeSize == 0)
+        {
+            /* Segment is full. Continue in the next one or stop */
+            if(!pWriter->rotate)
+            {
+                return(ERROR_FILE_SIZELIMIT_REACHED);
+            }
+            ERROR_TYPE rotated = DataWriter_Rotate(pWriter);
+            if(rotated != ERROR_NOERROR)
+            {
+                return(rotated);
+            }
+            writeSize = DataWriter_Space(pWriter);
+        }
+        /* Limit the chunk to the space left in the segment */
+        if(writeSize > pSize)
+        {
+            writeSize = pSize;
+        }
+        start = DataStats_Now();
+        if(!writeOutput(pWriter, pData, (unsigned int)writeSize))
+        {
+            return(ERROR_IO_FAILED);
+        }
+        DataStats_RecordWrite(pWriter->stats, start, writeSize);
+        if(pWriter->checksum)
+        {
+            DataChecksum_Add(&pWriter->crc, pData, (unsigned int)writeSize);
+        }
+        pData = pData + writeSize;
+        pSize = pSize - (unsigned int)writeSize;
+        DataWriter_Commit(pWriter, (unsigned int)writeSize);
+        if(pWriter->syncFailed)
+        {
+            return(ERROR_IO_FAILED);
+        }
+        /* Flush only when the configured interval has been written */
+        if(pWriter->flushInterval && (pWriter->unflushed >= pWriter->flushInterval) &&
+           (DataWriter_Flush(pWriter) != ERROR_NOERROR))
+        {
+            return(ERROR_IO_FAILED);
+        }
+    }
+    return(ERROR_NOERROR);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataWriter_Flush(DATA_WRITER* pWriter)
+{
+    if(pWriter->direct)
+    {
+        /* Whole blocks only. The rest stays staged */
+        if(!flushStaging(pWriter, false))
+        {
+            return(ERROR_IO_FAILED);
+        }
+    }
+    else if(fflush(pWriter->output) != 0)
+    {
+        return(ERROR_IO_FAILED);
+    }
+    if(pWriter->stats != NULL)
+    {
+        pWriter->stats->flushes++;
+    }
+    pWriter->unflushed = 0;
+    return(ERROR_NOERROR);
+}
+/*----------------------------------------------------------------------------------*/
+unsigned long long DataWriter_Space(DATA_WRITER* pWriter)
+{
+    return(pWriter->maxSize - pWriter->segmentSize);
+}
+/*----------------------------------------------------------------------------------*/
+int DataWriter_Descriptor(DATA_WRITER* pWriter)
+{
+    int descriptor = fileno(pWriter->output);
+    if(pWriter->direct)
+    {
+        /* The caller writes at arbitrary offsets and sizes, which O_DIRECT refuses.
+           The rest of the capture goes through the page cache */
+        (void)flushStaging(pWriter, true);
+#ifdef O_DIRECT
+        (void)fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) & ~O_DIRECT);
+#endif
+        pWriter->direct = false;
+    }
+    fflush(pWriter->output);
+    return(descriptor);
+}
+/*----------------------------------------------------------------------------------*/
+int DataWriter_BlockDescriptor(DATA_WRITER* pWriter)
+{
+    /* Only a staged partial block leaves the segment unaligned */
+    (void)flushStaging(pWriter, true);
+    fflush(pWriter->output);
+    return(fileno(pWriter->output));
+}
+/*----------------------------------------------------------------------------------*/
+void DataWriter_Commit(DATA_WRITER* pWriter, unsigned int pSize)
+{
+    pWriter->segmentSize = pWriter->segmentSize + pSize;
+    pWriter->written = pWriter->written + pSize;
+    pWriter->unflushed = pWriter->unflushed + pSize;
+    if(pWriter->durability != DURABILITY_NONE)
+    {
+        pWriter->unsynced = pWriter->unsynced + pSize;
+        if(((pWriter->durability == DURABILITY_BYTES) && (pWriter->unsynced >= pWriter->syncInterval)) ||
+           ((pWriter->durability == DURABILITY_TIME) && ((DataStats_Now() - pWriter->lastSync) >= pWriter->syncInterval)))
+        {
+            syncOutput(pWriter);
+        }
+    }
+    if((pWriter->progress != NULL) && ((pWriter->written - pWriter->lastProgress) >= pWriter->progressInterval))
+    {
+        pWriter->lastProgress = pWriter->written;
+        pWriter->progress(pWriter->progressContext, pWriter);
+    }
+    /* Keep at least half a step reserved ahead of the writes */
+    if(pWriter->preallocate && ((pWriter->segmentSize + (PREALLOCATE_STEP / 2)) > pWriter->reserved))
+    {
+        reserveSpace(pWriter);
+    }
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataWriter_Rotate(DATA_WRITER* pWriter)
+{
+    char nextFile[MAX_FILEPATH_LENGTH] = { NULL_CHARACTER };
+    FILE* next;
+    /* Open the next segment before giving up the current one */
+    if(!pWriter->defineFile(pWriter->nameContext, nextFile, sizeof(nextFile), pWriter->segment + 1))
+    {
+        return(ERROR_WRITE_FILEOPEN);
+    }
+    next = openSegment(pWriter, nextFile);
+    if(next == NULL)
+    {
+        return(ERROR_WRITE_FILEOPEN);
+    }
+    if(!flushStaging(pWriter, true))
+    {
+        fclose(next);
+        remove(nextFile);
+        return(ERROR_IO_FAILED);
+    }
+    releaseSpace(pWriter);
+    if(pWriter->checksum)
+    {
+        ERROR_TYPE recorded = DataChecksum_WriteSidecar(&pWriter->crc, pWriter->fileName);
+        if(recorded != ERROR_NOERROR)
+        {
+            fclose(next);
+            remove(nextFile);
+            return(recorded);
+        }
+        DataChecksum_Free(&pWriter->crc);
+    }
+    /* Only one segment is closed in the background at any time */
+    waitForClose(pWriter);
+    pWriter->closing = pWriter->output;
+    pWriter->closingBytes = pWriter->unsynced;
+    if(pthread_create(&pWriter->closer, NULL, closeSegment, pWriter))
+    {
+        /* No thread available. Close in place */
+        (void)closeSegment(pWriter);
+        finishClose(pWriter);
+    }
+    pWriter->output = next;
+    strcpy(pWriter->fileName, nextFile);
+    pWriter->segment++;
+    pWriter->segmentSize = 0;
+    pWriter->unflushed = 0;
+    pWriter->unsynced = 0;
+    if(pWriter->preallocate)
+    {
+        reserveSpace(pWriter);
+    }
+    if(pWriter->progress != NULL)
+    {
+        pWriter->progress(pWriter->progressContext, pWriter);
+    }
+    return(ERROR_NOERROR);
+}
+/*----------------------------------------------------------------------------------*/
+ERROR_TYPE DataWriter_Close(DATA_WRITER* pWriter)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    waitForClose(pWriter);
+    if(pWriter->output != NULL)
+    {
+        if(!flushStaging(pWriter, true))
+        {
+            ret = ERROR_IO_FAILED;
+        }
+        releaseSpace(pWriter);
+        /* An empty trailing segment is removed below */
+        if((pWriter->durability != DURABILITY_NONE) && (pWriter->segmentSize || !pWriter->segment))
+        {
+            unsigned long long start = DataStats_Now();
+            if(!syncSegment(pWriter, pWriter->output))
+            {
+                pWriter->syncFailed = true;
+            }
+            DataStats_RecordSync(pWriter->stats, start, DataStats_Now(), pWriter->unsynced);
+            pWriter->unsynced = 0;
+        }
+        if(pWriter->syncFailed && (ret == ERROR_NOERROR))
+        {
+            ret = ERROR_IO_FAILED;
+        }
+        if((fclose(pWriter->output) != 0) && (ret == ERROR_NOERROR))
+        {
+            ret = ERROR_IO_FAILED;
+        }
+        pWriter->output = NULL;
+        /* Rotation opens a segment as soon as the previous one is full */
+        if(pWriter->segment && !pWriter->segmentSize)
+        {
+            remove(pWriter->fileName);
+        }
+        else if(pWriter->checksum && (ret == ERROR_NOERROR))
+        {
+            ret = DataChecksum_WriteSidecar(&pWriter->crc, pWriter->fileName);
+        }
+    }
+    DataChecksum_Free(&pWriter->crc);
+    DataEngine_FreeBuffer(pWriter->staging);
+    pWriter->staging = NULL;
+    return(ret);
+}
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : initializeWriter
+ * Inputs       : Same as DataWriter_Open
+ * Outputs      : returns -
+ *                ERROR_NOERROR - writer initialized
+ *                ERROR_MEMORY_ALLOCATION - direct staging buffer cannot be allocated
+ * Description  : Sets up a writer without an open segment
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE initializeWriter(DATA_WRITER* pWriter, const char* pWriteFile, WRITER_NAME_FN pDefineFile,
+                                   void* pNameContext, unsigned long long pMaxSize, unsigned long long pFlushInterval,
+                                   bool pRotate, bool pDirect, bool pChecksum)
+{
+    memset(pWriter, 0, sizeof(DATA_WRITER));
+    strncpy(pWriter->fileName, pWriteFile, sizeof(pWriter->fileName) - 1);
+    pWriter->defineFile = pDefineFile;
+    pWriter->nameContext = pNameContext;
+    pWriter->maxSize = pMaxSize;
+    pWriter->flushInterval = pFlushInterval;
+    pWriter->rotate = pRotate;
+    pWriter->checksum = pChecksum;
+#ifndef _WIN32
+    pWriter->direct = pDirect;
+#else
+    (void)pDirect;
+#endif
+    if(pWriter->direct)
+    {
+        pWriter->staging = DataEngine_AllocateBuffer(DIRECT_STAGING_SIZE);
+        if(pWriter->staging == NULL)
+        {
+            return(ERROR_MEMORY_ALLOCATION);
+        }
+    }
+    return(ERROR_NOERROR);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : openSegment
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ *                const char* pFileName - path of the segment
+ * Outputs      : Stream of the segment. NULL on failure, with errno EEXIST if the
+ *                file already exists
+ * Description  : Creates an output segment exclusively, so that an existing file
+ *                is never overwritten. In direct mode the descriptor is opened
+ *                with O_DIRECT, or F_NOCACHE where O_DIRECT is missing. File
+ *                systems refusing O_DIRECT get a normal descriptor
+ -----------------------------------------------------------------------------------*/
+static FILE* openSegment(DATA_WRITER* pWriter, const char* pFileName)
+{
+    FILE* output;
+    int flags = O_WRONLY | O_CREAT | O_EXCL | O_BINARY;
+    int descriptor = -1;
+#ifdef O_DIRECT
+    if(pWriter->direct)
+    {
+        descriptor = open(pFileName, flags | O_DIRECT, WRITER_FILE_MODE);
+        if((descriptor < 0) && (errno != EINVAL))
+        {
+            return NULL;
+        }
+    }
+#endif
+    if(descriptor < 0)
+    {
+        descriptor = open(pFileName, flags, WRITER_FILE_MODE);
+        if(descriptor < 0)
+        {
+            return NULL;
+        }
+    }
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    if(pWriter->direct)
+    {
+        (void)fcntl(descriptor, F_NOCACHE, 1);
+    }
+#endif
+    output = fdopen(descriptor, "wb");
+    if(output == NULL)
+    {
+        close(descriptor);
+    }
+    return output;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : writeOutput
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ *                const char* pData - data to be written
+ *                unsigned int pSize - size of the data in bytes
+ * Outputs      : True if all data is written or staged. False on write failure
+ * Description  : Writes through stdio, or in direct mode in whole aligned blocks.
+ *                Aligned engine buffers are written without a copy as long as
+ *                nothing is staged. Everything else goes through the staging
+ *                buffer
+ -----------------------------------------------------------------------------------*/
+static bool writeOutput(DATA_WRITER* pWriter, const char* pData, unsigned int pSize)
+{
+    if(!pWriter->direct)
+    {
+        return(fwrite(pData, sizeof(char), pSize, pWriter->output) == pSize);
+    }
+    while(pSize)
+    {
+        unsigned int copy;
+        if(!pWriter->staged && !((uintptr_t)pData % BUFFER_ALIGNMENT) && (pSize >= BUFFER_ALIGNMENT))
+        {
+            unsigned int blocks = pSize - (pSize % BUFFER_ALIGNMENT);
+            if(!writeBlocks(fileno(pWriter->output), pData, blocks))
+            {
+                return false;
+            }
+            pData = pData + blocks;
+            pSize = pSize - blocks;
+            continue;
+        }
+        copy = DIRECT_STAGING_SIZE - pWriter->staged;
+        if(copy > pSize)
+        {
+            copy = pSize;
+        }
+        memcpy(pWriter->staging + pWriter->staged, pData, copy);
+        pWriter->staged = pWriter->staged + copy;
+        pData = pData + copy;
+        pSize = pSize - copy;
+        if((pWriter->staged == DIRECT_STAGING_SIZE) && !flushStaging(pWriter, false))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : flushStaging
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ *                bool pTail - also write the partial block at the end
+ * Outputs      : True if the data is written. False on write failure
+ * Description  : Writes the whole blocks of the staging buffer. The partial
+ *                block at the end of a segment cannot be written with O_DIRECT,
+ *                so the descriptor leaves direct mode before writing it
+ -----------------------------------------------------------------------------------*/
+static bool flushStaging(DATA_WRITER* pWriter, bool pTail)
+{
+    unsigned int blocks;
+    if(!pWriter->direct || !pWriter->staged)
+    {
+        return true;
+    }
+    blocks = pWriter->staged - (pWriter->staged % BUFFER_ALIGNMENT);
+    if(blocks)
+    {
+        if(!writeBlocks(fileno(pWriter->output), pWriter->staging, blocks))
+        {
+            return false;
+        }
+        memmove(pWriter->staging, pWriter->staging + blocks, pWriter->staged - blocks);
+        pWriter->staged = pWriter->staged - blocks;
+    }
+    if(pTail && pWriter->staged)
+    {
+        int descriptor = fileno(pWriter->output);
+#ifdef O_DIRECT
+        (void)fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) & ~O_DIRECT);
+#endif
+        if(!writeBlocks(descriptor, pWriter->staging, pWriter->staged))
+        {
+            return false;
+        }
+        pWriter->staged = 0;
+    }
+    return true;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : writeBlocks
+ * Inputs       : int pDescriptor - output descriptor
+ *                const char* pData - data to be written
+ *                unsigned int pSize - size of the data in bytes
+ * Outputs      : True if all data is written. False on write failure
+ * Description  : Writes to the descriptor, retrying short and interrupted writes
+ -----------------------------------------------------------------------------------*/
+static bool writeBlocks(int pDescriptor, const char* pData, unsigned int pSize)
+{
+#ifdef _WIN32
+    (void)pDescriptor;
+    (void)pData;
+    return(pSize == 0);
+#else
+    while(pSize)
+    {
+        ssize_t written = write(pDescriptor, pData, pSize);
+        if(written < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        pData = pData + written;
+        pSize = pSize - (unsigned int)written;
+    }
+    return true;
+#endif
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : closeSegment
+ * Inputs       : void* pWriter - DATA_WRITER of the segment to be closed
+ * Outputs      : NULL
+ * Description  : Thread entry closing a finished segment. Syncs it first if the
+ *                durability policy asks for it. A failed sync or close is kept
+ *                in closingFailed. Only the closing fields of the writer are
+ *                written, and read only after the thread is joined
+ -----------------------------------------------------------------------------------*/
+static void* closeSegment(void* pWriter)
+{
+    DATA_WRITER* writer = (DATA_WRITER*)pWriter;
+    writer->closingFailed = false;
+    if(writer->durability != DURABILITY_NONE)
+    {
+        writer->closingStart = DataStats_Now();
+        writer->closingFailed = !syncSegment(writer, writer->closing);
+        writer->closingEnd = DataStats_Now();
+    }
+    /* The final flush of the stdio buffer can fail as well */
+    if(fclose(writer->closing) != 0)
+    {
+        writer->closingFailed = true;
+    }
+    return NULL;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : waitForClose
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ * Outputs      :
+ * Description  : Waits until the previous segment has been closed
+ -----------------------------------------------------------------------------------*/
+static void waitForClose(DATA_WRITER* pWriter)
+{
+    if(pWriter->closing != NULL)
+    {
+        (void)pthread_join(pWriter->closer, NULL);
+        finishClose(pWriter);
+    }
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : finishClose
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ * Outputs      :
+ * Description  : Counts the sync made while closing the previous segment, keeps
+ *                the failure of its sync or close and forgets the segment
+ -----------------------------------------------------------------------------------*/
+static void finishClose(DATA_WRITER* pWriter)
+{
+    if(pWriter->durability != DURABILITY_NONE)
+    {
+        DataStats_RecordSync(pWriter->stats, pWriter->closingStart, pWriter->closingEnd, pWriter->closingBytes);
+    }
+    pWriter->syncFailed = pWriter->syncFailed || pWriter->closingFailed;
+    pWriter->closing = NULL;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : reserveSpace
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ * Outputs      :
+ * Description  : Extends the reservation of the current segment by up to
+ *                PREALLOCATE_STEP, without passing the segment size or the input
+ *                left to be written. FALLOC_FL_KEEP_SIZE leaves the file size to
+ *                the writes. Preallocation stops on the first refusal
+ -----------------------------------------------------------------------------------*/
+static void reserveSpace(DATA_WRITER* pWriter)
+{
+#ifdef __linux__
+    unsigned long long target = pWriter->segmentSize + PREALLOCATE_STEP;
+    if(target > pWriter->maxSize)
+    {
+        target = pWriter->maxSize;
+    }
+    if(pWriter->expected != WRITER_SIZE_UNKNOWN)
+    {
+        unsigned long long remaining = (pWriter->expected > pWriter->written) ? pWriter->expected - pWriter->written : 0;
+        if(target > pWriter->segmentSize + remaining)
+        {
+            target = pWriter->segmentSize + remaining;
+        }
+    }
+    if(target <= pWriter->reserved)
+    {
+        return;
+    }
+    if(fallocate(fileno(pWriter->output), FALLOC_FL_KEEP_SIZE, (off_t)pWriter->reserved,
+                 (off_t)(target - pWriter->reserved)) != 0)
+    {
+        /* Not supported or no space left. The writes will find out which */
+        pWriter->preallocate = false;
+        return;
+    }
+    pWriter->reserved = target;
+#else
+    (void)pWriter;
+#endif
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : releaseSpace
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ * Outputs      :
+ * Description  : Releases the reservation beyond the data of a finished segment.
+ *                The stdio buffer is flushed first so the data is on the file.
+ *                Truncating to the current size frees the blocks past the end,
+ *                which punching a hole does not do on every file system
+ -----------------------------------------------------------------------------------*/
+static void releaseSpace(DATA_WRITER* pWriter)
+{
+#ifdef __linux__
+    if(pWriter->reserved > pWriter->segmentSize)
+    {
+        fflush(pWriter->output);
+        (void)ftruncate(fileno(pWriter->output), (off_t)pWriter->segmentSize);
+    }
+#endif
+    pWriter->reserved = 0;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : syncOutput
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ * Outputs      :
+ * Description  : Makes the data written so far durable with fdatasync. In direct
+ *                mode the partial block stays staged and is not covered
+ -----------------------------------------------------------------------------------*/
+static void syncOutput(DATA_WRITER* pWriter)
+{
+    unsigned long long start = DataStats_Now();
+    if(!flushStaging(pWriter, false) || (fflush(pWriter->output) != 0) ||
+       !syncDescriptor(fileno(pWriter->output), false))
+    {
+        pWriter->syncFailed = true;
+    }
+    pWriter->lastSync = DataStats_Now();
+    DataStats_RecordSync(pWriter->stats, start, pWriter->lastSync, pWriter->unsynced);
+    pWriter->unsynced = 0;
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : syncSegment
+ * Inputs       : DATA_WRITER* pWriter - current writer
+ *                FILE* pOutput - finished segment, its staged data written
+ * Outputs      : True if the segment is durable. False on failure
+ * Description  : Syncs a segment about to be closed, alone or in a group
+ -----------------------------------------------------------------------------------*/
+static bool syncSegment(DATA_WRITER* pWriter, FILE* pOutput)
+{
+    if(fflush(pOutput) != 0)
+    {
+        return false;
+    }
+    if(pWriter->durability == DURABILITY_GROUP)
+    {
+        return syncGroup(fileno(pOutput));
+    }
+    return syncDescriptor(fileno(pOutput), true);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : syncDescriptor
+ * Inputs       : int pDescriptor - file to be synced
+ *                bool pMetadata - also sync metadata not needed to read the data
+ * Outputs      : True if the data reached the device. False on failure
+ * Description  : fsync, or fdatasync without pMetadata where it exists
+ -----------------------------------------------------------------------------------*/
+static bool syncDescriptor(int pDescriptor, bool pMetadata)
+{
+#if defined(_WIN32)
+    (void)pMetadata;
+    return(_commit(pDescriptor) == 0);
+#elif defined(__linux__)
+    return((pMetadata ? fsync(pDescriptor) : fdatasync(pDescriptor)) == 0);
+#else
+    (void)pMetadata;
+    return(fsync(pDescriptor) == 0);
+#endif
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : syncGroup
+ * Inputs       : int pDescriptor - file to be synced
+ * Outputs      : True if the data reached the device. False on failure
+ * Description  : Joins the members waiting for the next batch. The first member
+ *                finding no batch being started leads: it takes all waiting
+ *                members, starts the writeback of their files and wakes them up.
+ *                Every member then syncs its own file. The syncs of a batch run
+ *                at the same time, so the file system commits their metadata in
+ *                one journal commit that all of them wait for
+ -----------------------------------------------------------------------------------*/
+static bool syncGroup(int pDescriptor)
+{
+    SYNC_MEMBER member = { pDescriptor, false, NULL };
+    pthread_mutex_lock(&fl_GroupLock);
+    member.next = fl_GroupPending;
+    fl_GroupPending = &member;
+    while(!member.done)
+    {
+        SYNC_MEMBER* batch;
+        if(fl_GroupSyncing)
+        {
+            pthread_cond_wait(&fl_GroupDone, &fl_GroupLock);
+            continue;
+        }
+        batch = fl_GroupPending;
+        fl_GroupPending = NULL;
+        fl_GroupSyncing = true;
+        pthread_mutex_unlock(&fl_GroupLock);
+        startBatch(batch);
+        pthread_mutex_lock(&fl_GroupLock);
+        while(batch != NULL)
+        {
+            /* The member may be gone once done is seen */
+            SYNC_MEMBER* next = batch->next;
+            batch->done = true;
+            batch = next;
+        }
+        fl_GroupSyncing = false;
+        pthread_cond_broadcast(&fl_GroupDone);
+    }
+    pthread_mutex_unlock(&fl_GroupLock);
+    return syncDescriptor(pDescriptor, true);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : startBatch
+ * Inputs       : SYNC_MEMBER* pBatch - members of one group sync
+ * Outputs      :
+ * Description  : Starts the writeback of the files of the members, and nothing
+ *                else, so the device works on them together before any member
+ *                waits. Only Linux can start a writeback without waiting for it
+ -----------------------------------------------------------------------------------*/
+static void startBatch(SYNC_MEMBER* pBatch)
+{
+#ifdef __linux__
+    SYNC_MEMBER* member;
+    if(pBatch->next != NULL)
+    {
+        for(member = pBatch; member != NULL; member = member->next)
+        {
+            (void)sync_file_range(member->descriptor, 0, 0, SYNC_FILE_RANGE_WRITE);
+        }
+    }
+#else
+    (void)pBatch;
+#endif
+}
+/*----------------------------------------------------------------------------------*/
@@ -1,21 +1,133 @@
 /*----------------------------------------------------------------------------------*/
 /* Header includes */
 #include "DataReader.h"
-#include "String.h"
+#include "DataBatch.h"
+#include "DataDaemon.h"
+#include "DataFollow.h"
+#include <string.h>
 
+/*----------------------------------------------------------------------------------*/
+/* Definitions */
+#define BATCH_INPUT_ARGUMENT "-i"
+#define BATCH_MANIFEST_ARGUMENT "-l"
+#define BATCH_WORKERS_ARGUMENT "-j"
+#define BATCH_VERIFY_ARGUMENT "-v"
+#define BATCH_RESTORE_ARGUMENT "-x"
+#define DAEMON_SOCKET_ARGUMENT "-o"
+#define FOLLOW_ARGUMENT "-F"
+
+/*----------------------------------------------------------------------------------*/
+/* Local function declarations */
+static ERROR_TYPE parseBatchArguments(int* pArgc, char* pArgv[], BATCH_LIST* pBatch, BATCH_LIST* pVerify,
+                                      BATCH_LIST* pRestore, unsigned int* pWorkers, const char** pSocket,
+                                      const char** pFollow);
+static void batchHelp(void);
 /*----------------------------------------------------------------------------------*/
 /* main() start */
 int main(int argc, char* argv[])
 {
     ERROR_TYPE result = ERROR_NOERROR;
+    BATCH_LIST batch = { 0 };
+    BATCH_LIST verify = { 0 };
+    BATCH_LIST restore = { 0 };
+    unsigned int workers = 0;
+    const char* socketPath = NULL;
+    const char* followFile = NULL;
+    /* The first argument is the program name. It can be skipped */
+    argc = argc - 1;
+    argv = &argv[1];
+    /* Batch arguments are removed before the capture arguments are parsed */
+    result = parseBatchArguments(&argc, argv, &batch, &verify, &restore, &workers, &socketPath, &followFile);
     /* Parse the arguments */
-    if(argc > 1)
+    if((result == ERROR_NOERROR) && (argc > 0))
     {
-        /* The first argument is the program name. It can be skipped */
-        result = DataReader_ParseArguments(argc - 1, &argv[1]);
+        result = DataReader_ParseArguments(argc, argv);
     }
 
-    if(result == ERROR_NOERROR)
+    if((result == ERROR_NOERROR) && (socketPath != NULL))
+    {
+        /* Every connection to the socket is captured until SIGINT or SIGTERM */
+        DAEMON_STATS stats;
+        printf("Listening on %s. Press Ctrl+C to stop\n", socketPath);
+        result = DataDaemon_Run(socketPath, workers, &stats);
+        DataBatch_Free(&verify);
+        DataBatch_Free(&restore);
+        DataBatch_Free(&batch);
+        if(result != ERROR_NOERROR)
+        {
+            printf("Error - %s\n", DataReader_ConvertErrorToString(result));
+            return(1);
+        }
+        printf("Connections: %llu, completed: %llu, failed: %llu, bytes: %llu\n", stats.accepted,
+               stats.completed, stats.failed, stats.bytes);
+        return(stats.failed ? 1 : 0);
+    }
+    else if((result == ERROR_NOERROR) && (followFile != NULL))
+    {
+        /* Data appended to the file is captured until SIGINT or SIGTERM */
+        char writeFile[MAX_FILEPATH_LENGTH] = { NULL_CHARACTER };
+        FOLLOW_STATS stats;
+        printf("Following %s. Press Ctrl+C to stop\n", followFile);
+        result = DataFollow_Run(followFile, false, writeFile, sizeof(writeFile) - 1, &stats);
+        DataBatch_Free(&verify);
+        DataBatch_Free(&restore);
+        DataBatch_Free(&batch);
+        if(result != ERROR_NOERROR)
+        {
+            printf("Error - %s\n", DataReader_ConvertErrorToString(result));
+            return(1);
+        }
+        printf("Write file path - %s\n", writeFile);
+        printf("Bytes: %llu, truncations: %llu, rotations: %llu, result: %s\n", stats.bytes, stats.truncations,
+               stats.rotations, DataReader_ConvertErrorToString(stats.result));
+        return((stats.result != ERROR_NOERROR) ? 1 : 0);
+    }
+    else if((result == ERROR_NOERROR) && verify.count)
+    {
+        /* Non-interactive verification. Exit status is non-zero if any file failed */
+        unsigned int failed;
+        if(!workers)
+        {
+            workers = DataBatch_DefaultWorkers(&verify);
+        }
+        printf("Verifying %u files with %u workers\n", verify.count, workers);
+        failed = DataBatch_Verify(&verify, workers);
+        DataBatch_Report(&verify, stdout);
+        DataBatch_Free(&verify);
+        DataBatch_Free(&restore);
+        DataBatch_Free(&batch);
+        return(failed ? 1 : 0);
+    }
+    else if((result == ERROR_NOERROR) && restore.count)
+    {
+        /* Non-interactive restore of deduplicated captures */
+        unsigned int failed;
+        if(!workers)
+        {
+            workers = DataBatch_DefaultWorkers(&restore);
+        }
+        printf("Restoring %u recipes with %u workers\n", restore.count, workers);
+        failed = DataBatch_Restore(&restore, workers);
+        DataBatch_Report(&restore, stdout);
+        DataBatch_Free(&restore);
+        DataBatch_Free(&batch);
+        return(failed ? 1 : 0);
+    }
+    else if((result == ERROR_NOERROR) && batch.count)
+    {
+        /* Non-interactive batch mode. Exit status is the number of failed inputs */
+        unsigned int failed;
+        if(!workers)
+        {
+            workers = DataBatch_DefaultWorkers(&batch);
+        }
+        printf("Capturing %u inputs with %u workers\n", batch.count, workers);
+        failed = DataBatch_Run(&batch, workers);
+        DataBatch_Report(&batch, stdout);
+        DataBatch_Free(&batch);
+        return(failed ? 1 : 0);
+    }
+    else if(result == ERROR_NOERROR)
     {
         /* Start data read */
         while(1)
@@ -29,7 +141,11 @@ int main(int argc, char* argv[])
             printf("f - Read from file\n");
             printf("e - Exit\n");
             printf("Enter you choice: ");
-            (void)scanf("%c", &choice);
+            if(scanf("%c", &choice) != 1)
+            {
+                /* End of input. Nothing more can be selected */
+                choice = 'e';
+            }
             (void)getchar(); /* Added to capture an unwanted newline */
             switch(choice)
             {
@@ -69,6 +185,22 @@ int main(int argc, char* argv[])
             {
                 printf("-----------------------------------------------------\n");
                 printf("Write file path - %s\n", writeFile);
+                if(DataReader_GetResumedBytes())
+                {
+                    printf("Resumed after %llu bytes\n", DataReader_GetResumedBytes());
+                }
+                if(DataReader_GetDestinationPath(1) != NULL)
+                {
+                    /* Copies in the other directories succeed or fail on their own */
+                    TEE_STATS tee;
+                    unsigned int i;
+                    DataReader_GetTeeStats(&tee);
+                    for(i = 1; i < tee.destinations; i++)
+                    {
+                        printf("Copy file path - %s (%s)\n", tee.destination[i].output,
+                               DataReader_ConvertErrorToString(tee.destination[i].result));
+                    }
+                }
                 printf("-----------------------------------------------------\n");
             }
             if(ERROR_NOERROR != result)
@@ -82,13 +214,122 @@ int main(int argc, char* argv[])
     else if(result == ERROR_HELP_INVOKED)
     {
         DataReader_Help();
+        batchHelp();
     }
     else
     {
         printf("Error - %s\n", DataReader_ConvertErrorToString(result));
     }
-
+    DataBatch_Free(&batch);
+    DataBatch_Free(&verify);
+    DataBatch_Free(&restore);
     return 0;
 }
 /* main() end */
+/*----------------------------------------------------------------------------------*/
+/* Local function definitions */
+/*-----------------------------------------------------------------------------------
+ * Name         : parseBatchArguments
+ * Inputs       : int* pArgc - argument count. Reduced by the batch arguments
+ *                char* pArgv[] - arguments. Batch arguments are removed
+ *                BATCH_LIST* pBatch - Loaded with the batch inputs
+ *                BATCH_LIST* pVerify - Loaded with the files to be verified
+ *                BATCH_LIST* pRestore - Loaded with the recipes to be restored
+ *                unsigned int* pWorkers - Loaded with the worker count. 0 - default
+ *                const char** pSocket - Loaded with the daemon socket. NULL - none
+ *                const char** pFollow - Loaded with the file to follow. NULL - none
+ * Outputs      : returns -
+ *                ERROR_NOERROR - batch arguments parsed
+ *                ERROR_INVALIDARG - batch argument without value or invalid count
+ *                Errors of DataBatch_Add() and DataBatch_LoadManifest()
+ * Description  : Collects the inputs given with -i and the manifests given with -l,
+ *                the files to be verified given with -v, the recipes to be restored
+ *                given with -x, the worker count given with -j, the daemon
+ *                socket given with -o and the file to follow given with -F. All
+ *                other arguments are kept in order for DataReader_ParseArguments()
+ -----------------------------------------------------------------------------------*/
+static ERROR_TYPE parseBatchArguments(int* pArgc, char* pArgv[], BATCH_LIST* pBatch, BATCH_LIST* pVerify,
+                                      BATCH_LIST* pRestore, unsigned int* pWorkers, const char** pSocket,
+                                      const char** pFollow)
+{
+    ERROR_TYPE ret = ERROR_NOERROR;
+    int kept = 0;
+    int i;
+    for(i = 0; (i < *pArgc) && (ret == ERROR_NOERROR); i++)
+    {
+        bool input = !strcmp(pArgv[i], BATCH_INPUT_ARGUMENT);
+        bool manifest = !strcmp(pArgv[i], BATCH_MANIFEST_ARGUMENT);
+        bool workers = !strcmp(pArgv[i], BATCH_WORKERS_ARGUMENT);
+        bool verify = !strcmp(pArgv[i], BATCH_VERIFY_ARGUMENT);
+        bool restore = !strcmp(pArgv[i], BATCH_RESTORE_ARGUMENT);
+        bool daemon = !strcmp(pArgv[i], DAEMON_SOCKET_ARGUMENT);
+        bool follow = !strcmp(pArgv[i], FOLLOW_ARGUMENT);
+        if(!input && !manifest && !workers && !verify && !restore && !daemon && !follow)
+        {
+            pArgv[kept++] = pArgv[i];
+            continue;
+        }
+        if((i + 1) >= *pArgc)
+        {
+            ret = ERROR_INVALIDARG;
+            break;
+        }
+        i++;
+        if(input)
+        {
+            ret = DataBatch_Add(pBatch, pArgv[i]);
+        }
+        else if(manifest)
+        {
+            ret = DataBatch_LoadManifest(pBatch, pArgv[i]);
+        }
+        else if(verify)
+        {
+            ret = DataBatch_Add(pVerify, pArgv[i]);
+        }
+        else if(restore)
+        {
+            ret = DataBatch_Add(pRestore, pArgv[i]);
+        }
+        else if(daemon)
+        {
+            *pSocket = pArgv[i];
+        }
+        else if(follow)
+        {
+            *pFollow = pArgv[i];
+        }
+        else
+        {
+            char* end = NULL;
+            unsigned long count = strtoul(pArgv[i], &end, 10);
+            if((*end != NULL_CHARACTER) || !count || (pArgv[i][0] == '-'))
+            {
+                ret = ERROR_INVALIDARG;
+            }
+            *pWorkers = (unsigned int)count;
+        }
+    }
+    *pArgc = kept;
+    return(ret);
+}
+/*-----------------------------------------------------------------------------------
+ * Name         : batchHelp
+ * Inputs       :
+ * Outputs      :
+ * Description  : Prints the help information for the batch mode
+ -----------------------------------------------------------------------------------*/
+static void batchHelp(void)
+{
+    printf("Batch mode (no menu, inputs captured in parallel): \n");
+    printf("%s : Input file to capture. May be repeated \n", BATCH_INPUT_ARGUMENT);
+    printf("%s : Manifest file listing one input file per line \n", BATCH_MANIFEST_ARGUMENT);
+    printf("%s : Number of parallel captures (default - cores, limited per disk) \n", BATCH_WORKERS_ARGUMENT);
+    printf("%s : File to verify against its .crc sidecar instead of capturing. May be repeated \n", BATCH_VERIFY_ARGUMENT);
+    printf("%s : Recipe of a deduplicated capture to restore to a .dat file. May be repeated \n", BATCH_RESTORE_ARGUMENT);
+    printf("%s : UNIX domain socket to listen on. Every connection is captured to its own file by -j workers \n",
+           DAEMON_SOCKET_ARGUMENT);
+    printf("%s : File to follow like tail -F. Data appended to it is captured until Ctrl+C \n", FOLLOW_ARGUMENT);
+    printf("-----------------------------------------------------\n");
+}
 /*----------------------------------------------------------------------------------*/
\ No newline at end of file
@@ -1,7 +1,7 @@
 /*----------------------------------------------------------------------------------*/
 /* Header includes */
 #include <stdio.h>
-#include "lib\CuTest.h"
+#include "lib/CuTest.h"
 
 /*----------------------------------------------------------------------------------*/
 /* Test Suites */
@@ -4,21 +4,106 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#ifdef _WIN32
 #include <direct.h>
+#else
+#include <unistd.h>
+#include <sys/stat.h>
+#define _getcwd getcwd
+#define _mkdir(pPath) mkdir(pPath, 0777)
+#define _chdir chdir
+#define _rmdir rmdir
+#endif
+#ifdef __linux__
+#include <dirent.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 
-#include "lib\CuTest.h"
+#include "lib/CuTest.h"
 #include "DataReader.h"
+#include "DataBatch.h"
+#include "DataDaemon.h"
+#include "DataFollow.h"
+#include "DataCheckpoint.h"
+#include "DataCompress.h"
+#include "DataChecksum.h"
+#include "DataDedup.h"
+#include "DataFrame.h"
+#include "DataLines.h"
+#include "DataStats.h"
+#include "DataTee.h"
 
 /*----------------------------------------------------------------------------------*/
 /* Test Definitions */
 #define TEST_OUTPUT_FILESIZE_LIMIT_KB "1"
+#define TEST_IO_BUFFER_SIZE_KB "1"
+#define TEST_FLUSH_INTERVAL_KB "4"
+#define TEST_ENGINE_KERNEL "kernel"
+#define TEST_ENGINE_MMAP "mmap"
+#define TEST_ENGINE_PIPELINE "pipeline"
+#define TEST_PIPELINE_MEMORY "8K"
+#define TEST_ENGINE_URING "uring"
+#define TEST_ENGINE_PARALLEL "parallel"
+#define TEST_QUEUE_DEPTH "4"
+#define TEST_WRITE_FAILURE_LIMIT 8192
+#define TEST_CLOSE_FAILURE_LIMIT 512
+#define TEST_SEGMENT_SUFFIX "_0000.dat"
+#ifdef _WIN32
 #define TEST_WRITE_FILE_DIR "\\dummy\\"
+#define TEST_CONSOLE "CON"
+#else
+#define TEST_WRITE_FILE_DIR "/dummy/"
+#define TEST_CONSOLE "/dev/tty"
+#endif
 #define TEST_WRITE_FILE_NAME_PREFIX "test_"
 #define TEST_STRING "This is a test line"
 #define TEST_STDIN "input.txt"
 #define TEST_CUSTOM_INPUT_FILE "custom.txt"
 #define TEST_BUFFER_SIZE 1024
 #define TEST_INVALID_READ_FILE "*dummy"
+#define TEST_BATCH_INPUTS 4
+#define TEST_BATCH_MANIFEST "manifest.txt"
+#define TEST_CONTEXTS 2
+#define TEST_COMPRESS_INPUT_SIZE (256 * 1024)
+#define TEST_COMPRESS_BLOCK_KB "64"
+#define TEST_COMPRESS_LIMIT_INPUT_SIZE (64 * 1024)
+#define TEST_COMPRESS_LIMIT_BLOCK_KB "4"
+#define TEST_COMPRESS_SEGMENT_KB "20"
+#define TEST_COMPRESS_SEGMENT_BLOCKS 4      /* Raw blocks of 4 KB with their index in 20 KB */
+#define TEST_EXPANDED_FILE "expanded.txt"
+#define TEST_CRC32C_CHECK 0xE3069283U     /* CRC32C of "123456789" */
+#define TEST_CHECKSUM_SEGMENTS 3
+#define TEST_DEDUP_INPUT_SIZE (256 * 1024)
+#define TEST_FRAME_INPUT_SIZE 10000
+#define TEST_FRAME_SEGMENT_KB "4"
+#define TEST_LINES_INPUT_SIZE (320 * 1024)
+#define TEST_LINES_SEGMENT_KB "128"
+#define TEST_LINES_MAX_LENGTH 40
+#define TEST_STATS_FILE "stats.json"
+#define TEST_PREALLOCATE_LIMIT "1M"
+#define TEST_TEE_DIR_FIRST "tee1"
+#define TEST_TEE_DIR_SECOND "tee2"
+#define TEST_TEE_DIR_MISSING "missing"
+#define TEST_TEE_FAST_FILE "teefast.dat"
+#define TEST_TEE_SLOW_FILE "teeslow.dat"
+#define TEST_TEE_SLOT_SIZE (64 * 1024)
+#define TEST_TEE_SLOTS 4
+#define TEST_TEE_THROTTLE_INPUT_SIZE (128 * TEST_TEE_SLOT_SIZE)
+#define TEST_TEE_THROTTLE_US 100000      /* 128 slots take longer than the stall timeout */
+#define TEST_DAEMON_SOCKET "daemon.sock"
+#define TEST_DAEMON_DIR "daemon"
+#define TEST_DAEMON_CLIENTS 32
+#define TEST_DAEMON_WORKERS 2
+#define TEST_FOLLOW_DIR "follow"
+#define TEST_FOLLOW_FILE "source.log"
+#define TEST_FOLLOW_ROTATED "source.log.1"
+#define TEST_CHECKPOINT_INPUT_SIZE 5220
+#define TEST_CHECKPOINT_SEGMENTS 6
 /*----------------------------------------------------------------------------------*/
 /* static variables */
 static char  fl_WorkingDirectory[MAX_FILEPATH_LENGTH] = { '\0' };
@@ -31,7 +116,7 @@ void RedirectInput()
 }
 void RestoreInput()
 {
-    (void)freopen("CON", "r", stdin);
+    (void)freopen(TEST_CONSOLE, "r", stdin);
     remove(TEST_STDIN);
 }
 void WriteData(const char* pFileName, const char* pData, const int pSize)
@@ -63,6 +148,13 @@ void ResetFilePath(const char* pFilePath)
     (void)_rmdir(pFilePath);
 }
 
+void AppendData(const char* pFileName, const char* pData, const int pSize)
+{
+    FILE* file = fopen(pFileName, "ab");
+    fwrite(pData, sizeof(char), pSize, file);
+    fclose(file);
+}
+
 int GetFileSize(const char* pFilePath)
 {
     FILE* output = fopen(pFilePath, "r");
@@ -71,6 +163,36 @@ int GetFileSize(const char* pFilePath)
     fclose(output);
     return fileSize;
 }
+void GetSegmentFile(const char* pFirstSegment, unsigned int pSegment, char* pSegmentFile)
+{
+    /* Segments differ from the first one only in the sequence number */
+    strcpy(pSegmentFile, pFirstSegment);
+    sprintf(pSegmentFile + strlen(pSegmentFile) - strlen(TEST_SEGMENT_SUFFIX), "_%04u.dat", pSegment);
+}
+void RemoveChunks(const char* pRecipe)
+{
+    /* Removes the chunks listed in a recipe from the store in the working directory */
+    char line[128];
+    char hash[DEDUP_HASH_LENGTH + 1];
+    char chunkFile[MAX_FILEPATH_LENGTH];
+    FILE* recipe = fopen(pRecipe, "r");
+    while((recipe != NULL) && (fgets(line, sizeof(line), recipe) != NULL))
+    {
+        if(sscanf(line, "chunk %64s", hash) == 1)
+        {
+            sprintf(chunkFile, "%s%c%.2s", DEDUP_STORE_DIRECTORY, PATH_DELIMITER, hash);
+            sprintf(chunkFile + strlen(chunkFile), "%c%s", PATH_DELIMITER, hash);
+            remove(chunkFile);
+            chunkFile[strlen(chunkFile) - DEDUP_HASH_LENGTH - 1] = '\0';
+            (void)_rmdir(chunkFile);
+        }
+    }
+    if(recipe != NULL)
+    {
+        fclose(recipe);
+    }
+    remove(pRecipe);
+}
 /*----------------------------------------------------------------------------------*/
 /* DataReader Test */
 /*-----------------------------------------------------------------------------------
@@ -193,6 +315,155 @@ void TestParseArguments_ValidInvalidFileSizeLimit(CuTest* tc)
     RestoreInput();
 }
 /*-----------------------------------------------------------------------------------
+Test Name     : Test ParseArguments - buffer size and flush interval
+PreConditions : Clear any existing configurations
+Action        : 1. Invoke DataReader_ParseArguments() with buffer size and flush interval
+Expectation   : 1. Returns No Error
+                2. Buffer size will be updated
+                3. Flush interval will be updated
+------------------------------------------------------------------------------------*/
+void TestParseArguments_BufferSizeFlushInterval(CuTest* tc)
+{
+    /*Test setup */
+    RedirectInput();
+    DataReader_ResetArguments();
+    /* Action */
+    int iArgC = 4;
+    char* iArgV[] = { "-b", TEST_IO_BUFFER_SIZE_KB, "-f", TEST_FLUSH_INTERVAL_KB };
+    ERROR_TYPE actual = DataReader_ParseArguments(iArgC, iArgV);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    CuAssertIntEquals_Msg(tc, "BufferSize", atoi(TEST_IO_BUFFER_SIZE_KB), DataReader_GetBufferSize());
+    CuAssertIntEquals_Msg(tc, "FlushInterval", atoi(TEST_FLUSH_INTERVAL_KB), DataReader_GetFlushInterval());
+    /* Test Cleanup */
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ParseArguments - invalid buffer size
+PreConditions : Clear any existing configurations
+Action        : 1. Invoke DataReader_ParseArguments() with a buffer size above the limit
+Expectation   : 1. Returns Invalid buffer size error
+                2. Buffer size will be zero
+------------------------------------------------------------------------------------*/
+void TestParseArguments_InvalidBufferSize(CuTest* tc)
+{
+    /*Test setup */
+    RedirectInput();
+    DataReader_ResetArguments();
+    /* Action */
+    char bufferSize[TEST_BUFFER_SIZE] = { '\0' };
+    sprintf(bufferSize, "%d", MAX_BUFFER_SIZE_KB + 1);
+    int iArgC = 2;
+    char* iArgV[] = { "-b", bufferSize };
+    ERROR_TYPE actual = DataReader_ParseArguments(iArgC, iArgV);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_INVALIDBUFFERSIZE, actual);
+    CuAssertIntEquals_Msg(tc, "BufferSize", 0, DataReader_GetBufferSize());
+    /* Test Cleanup */
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ParseArguments - copy engine
+PreConditions : Clear any existing configurations
+Action        : 1. Invoke DataReader_ParseArguments() with a valid and an invalid engine
+Expectation   : 1. Valid engine returns No Error and updates the engine
+                2. Invalid engine returns Invalid engine error
+------------------------------------------------------------------------------------*/
+void TestParseArguments_Engine(CuTest* tc)
+{
+    /*Test setup */
+    RedirectInput();
+    DataReader_ResetArguments();
+    /* Action */
+    int iArgC = 2;
+    char* iArgV[] = { "-e", TEST_ENGINE_KERNEL };
+    ERROR_TYPE actual = DataReader_ParseArguments(iArgC, iArgV);
+    char* iInvalidArgV[] = { "-e", "invalid" };
+    ERROR_TYPE actualInvalid = DataReader_ParseArguments(iArgC, iInvalidArgV);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    CuAssertIntEquals_Msg(tc, "Engine", ENGINE_KERNEL, DataReader_GetEngine());
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_INVALIDENGINE, actualInvalid);
+    /* Test Cleanup */
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ParseArguments - io_uring queue depth
+PreConditions : Clear any existing configurations
+Action        : 1. Invoke DataReader_ParseArguments() with valid and invalid depths
+Expectation   : 1. Returns No Error and the depth is stored
+                2. Zero, too large and non numeric depths return Invalid queue depth
+------------------------------------------------------------------------------------*/
+void TestParseArguments_QueueDepth(CuTest* tc)
+{
+    /*Test setup */
+    RedirectInput();
+    DataReader_ResetArguments();
+    /* Action */
+    int iArgC = 4;
+    char* iArgV[] = { "-e", TEST_ENGINE_URING, "-q", TEST_QUEUE_DEPTH };
+    ERROR_TYPE actual = DataReader_ParseArguments(iArgC, iArgV);
+    char* iZeroArgV[] = { "-q", "0" };
+    ERROR_TYPE actualZero = DataReader_ParseArguments(2, iZeroArgV);
+    char* iLargeArgV[] = { "-q", "65" };
+    ERROR_TYPE actualLarge = DataReader_ParseArguments(2, iLargeArgV);
+    char* iInvalidArgV[] = { "-q", "4K" };
+    ERROR_TYPE actualInvalid = DataReader_ParseArguments(2, iInvalidArgV);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    CuAssertIntEquals_Msg(tc, "Engine", ENGINE_URING, DataReader_GetEngine());
+    CuAssertIntEquals_Msg(tc, "Queue depth", 4, DataReader_GetQueueDepth());
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_INVALIDQUEUEDEPTH, actualZero);
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_INVALIDQUEUEDEPTH, actualLarge);
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_INVALIDQUEUEDEPTH, actualInvalid);
+    /* Test Cleanup */
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ParseArguments - file size limit with unit suffix
+PreConditions : Clear any existing configurations
+Action        : 1. Invoke DataReader_ParseArguments() with suffixed file size limits
+Expectation   : 1. Returns No Error and the limit is converted to KB
+                2. Limits above 4 GB are stored without overflow
+                3. Unknown suffix returns Invalid File size limit error
+------------------------------------------------------------------------------------*/
+void TestParseArguments_FileSizeLimitSuffix(CuTest* tc)
+{
+    /*Test setup */
+    RedirectInput();
+    DataReader_ResetArguments();
+    /* Action */
+    int iArgC = 2;
+    char* iArgV[] = { "-s", "2M" };
+    ERROR_TYPE actual = DataReader_ParseArguments(iArgC, iArgV);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    CuAssertIntEquals_Msg(tc, "MaxOutputFileSize", 2 * 1024, DataReader_GetMaxOutputFileSize());
+    /* Action */
+    char* iLargeArgV[] = { "-s", "200G" };
+    actual = DataReader_ParseArguments(iArgC, iLargeArgV);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    CuAssertTrue(tc, DataReader_GetMaxOutputFileSize() == 200ULL * 1024 * 1024);
+    /* Action */
+    char* iTeraArgV[] = { "-s", "8t" };
+    actual = DataReader_ParseArguments(iArgC, iTeraArgV);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    CuAssertTrue(tc, DataReader_GetMaxOutputFileSize() == 8ULL * 1024 * 1024 * 1024);
+    /* Action */
+    char* iInvalidArgV[] = { "-s", "10X" };
+    actual = DataReader_ParseArguments(iArgC, iInvalidArgV);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_INVALIDFILESIZE, actual);
+    /* Test Cleanup */
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
 Test Name     : Test ParseArguments - help
 PreConditions : NA
 Action        : 1. Invoke DataReader_ParseArguments() with help argument
@@ -426,6 +697,2029 @@ void TestReadData_FileReadFileSizeLimitReached(CuTest* tc)
     RestoreInput();
 }
 /*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Read from file with a small buffer and flush interval
+PreConditions : 1. Set 1 KB buffer size and flush interval.
+Action        : 1. Invoke DataReader_ReadData() with a ReadFile spanning several buffers
+Expectation   : 1. Returns No Error
+                2. Complete input is saved to the output file
+------------------------------------------------------------------------------------*/
+void TestReadData_FileReadSmallBuffer(CuTest* tc)
+{
+    /*Test setup */
+    /* Add data larger than the I/O buffer to the Test read file */
+    char dataBuffer[TEST_BUFFER_SIZE * 3] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 4;
+    char* iArgV[] = { "-b", TEST_IO_BUFFER_SIZE_KB, "-f", TEST_IO_BUFFER_SIZE_KB };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    char readData[TEST_BUFFER_SIZE * 3] = { '\0' };
+    ReadData(writeFile, readData, strlen(dataBuffer));
+    CuAssertStrEquals_Msg(tc, "Saved Data", dataBuffer, readData);
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Read from file with the kernel copy engine
+PreConditions : 1. Select the kernel copy engine.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns No Error
+                2. Complete input is saved to the output file
+------------------------------------------------------------------------------------*/
+void TestReadData_FileReadKernelEngine(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 3] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 2;
+    char* iArgV[] = { "-e", TEST_ENGINE_KERNEL };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    char readData[TEST_BUFFER_SIZE * 3] = { '\0' };
+    ReadData(writeFile, readData, strlen(dataBuffer));
+    CuAssertStrEquals_Msg(tc, "Saved Data", dataBuffer, readData);
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Kernel copy engine with Max File size limit reached
+PreConditions : 1. Select the kernel copy engine and set custom output file size limit.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns Max file size limit error
+                2. Output file is exactly the allowed limit
+------------------------------------------------------------------------------------*/
+void TestReadData_KernelEngineFileSizeLimitReached(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 2] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 4;
+    char* iArgV[] = { "-e", TEST_ENGINE_KERNEL, "-s", "1" };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_FILE_SIZELIMIT_REACHED, actual);
+    CuAssertIntEquals_Msg(tc, "File size", 1024, GetFileSize(writeFile));
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Read from file with the memory mapped engine
+PreConditions : 1. Select the mmap engine.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns No Error
+                2. Complete input is saved to the output file
+------------------------------------------------------------------------------------*/
+void TestReadData_FileReadMmapEngine(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 3] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 2;
+    char* iArgV[] = { "-e", TEST_ENGINE_MMAP };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    char readData[TEST_BUFFER_SIZE * 3] = { '\0' };
+    ReadData(writeFile, readData, strlen(dataBuffer));
+    CuAssertStrEquals_Msg(tc, "Saved Data", dataBuffer, readData);
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Memory mapped engine with Max File size limit reached
+PreConditions : 1. Select the mmap engine and set custom output file size limit.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns Max file size limit error
+                2. Output file is exactly the allowed limit
+------------------------------------------------------------------------------------*/
+void TestReadData_MmapEngineFileSizeLimitReached(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 2] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 4;
+    char* iArgV[] = { "-e", TEST_ENGINE_MMAP, "-s", "1" };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_FILE_SIZELIMIT_REACHED, actual);
+    CuAssertIntEquals_Msg(tc, "File size", 1024, GetFileSize(writeFile));
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Read from file with the pipelined engine
+PreConditions : 1. Select the pipeline engine with a small ring and I/O buffer.
+Action        : 1. Invoke DataReader_ReadData() with a ReadFile spanning many buffers
+Expectation   : 1. Returns No Error
+                2. Complete input is saved to the output file in order
+------------------------------------------------------------------------------------*/
+void TestReadData_FileReadPipelineEngine(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 16] = { '\0' };
+    int i = 0;
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING) + 8)
+    {
+        sprintf(dataBuffer + strlen(dataBuffer), "%s %d", TEST_STRING, i++);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 6;
+    char* iArgV[] = { "-e", TEST_ENGINE_PIPELINE, "-b", TEST_IO_BUFFER_SIZE_KB, "-m", TEST_PIPELINE_MEMORY };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    char readData[TEST_BUFFER_SIZE * 16] = { '\0' };
+    ReadData(writeFile, readData, strlen(dataBuffer));
+    CuAssertStrEquals_Msg(tc, "Saved Data", dataBuffer, readData);
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Pipelined engine with Max File size limit reached
+PreConditions : 1. Select the pipeline engine and set custom output file size limit.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns Max file size limit error
+                2. Output file is exactly the allowed limit
+------------------------------------------------------------------------------------*/
+void TestReadData_PipelineEngineFileSizeLimitReached(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 8] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 8;
+    char* iArgV[] = { "-e", TEST_ENGINE_PIPELINE, "-s", "1", "-b", TEST_IO_BUFFER_SIZE_KB, "-m", TEST_PIPELINE_MEMORY };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_FILE_SIZELIMIT_REACHED, actual);
+    CuAssertIntEquals_Msg(tc, "File size", 1024, GetFileSize(writeFile));
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Read from file with the io_uring engine
+PreConditions : 1. Select the uring engine with a small queue and I/O buffer.
+Action        : 1. Invoke DataReader_ReadData() with a ReadFile spanning many buffers
+Expectation   : 1. Returns No Error
+                2. Complete input is saved to the output file in order
+------------------------------------------------------------------------------------*/
+void TestReadData_FileReadUringEngine(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 16] = { '\0' };
+    int i = 0;
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING) + 8)
+    {
+        sprintf(dataBuffer + strlen(dataBuffer), "%s %d", TEST_STRING, i++);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 6;
+    char* iArgV[] = { "-e", TEST_ENGINE_URING, "-b", TEST_IO_BUFFER_SIZE_KB, "-q", TEST_QUEUE_DEPTH };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    char readData[TEST_BUFFER_SIZE * 16] = { '\0' };
+    ReadData(writeFile, readData, strlen(dataBuffer));
+    CuAssertStrEquals_Msg(tc, "Saved Data", dataBuffer, readData);
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - io_uring engine with Max File size limit reached
+PreConditions : 1. Select the uring engine and set custom output file size limit.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns Max file size limit error
+                2. Output file is exactly the allowed limit
+------------------------------------------------------------------------------------*/
+void TestReadData_UringEngineFileSizeLimitReached(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 8] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 8;
+    char* iArgV[] = { "-e", TEST_ENGINE_URING, "-s", "1", "-b", TEST_IO_BUFFER_SIZE_KB, "-q", TEST_QUEUE_DEPTH };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_FILE_SIZELIMIT_REACHED, actual);
+    CuAssertIntEquals_Msg(tc, "File size", 1024, GetFileSize(writeFile));
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - io_uring engine with a failing write
+PreConditions : 1. Select the uring engine with several requests in flight.
+                2. Limit the size of files written by the process below the input
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns I/O failed error instead of waiting for completions
+                   that never arrive
+                2. Output file holds the data written up to the limit
+------------------------------------------------------------------------------------*/
+void TestReadData_UringEngineWriteFailure(CuTest* tc)
+{
+#ifdef __linux__
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 16] = { '\0' };
+    struct rlimit limit;
+    struct rlimit failing;
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 6;
+    char* iArgV[] = { "-e", TEST_ENGINE_URING, "-b", TEST_IO_BUFFER_SIZE_KB, "-q", TEST_QUEUE_DEPTH };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Writes past the limit fail with EFBIG once SIGXFSZ is ignored */
+    (void)getrlimit(RLIMIT_FSIZE, &limit);
+    failing = limit;
+    failing.rlim_cur = TEST_WRITE_FAILURE_LIMIT;
+    (void)signal(SIGXFSZ, SIG_IGN);
+    (void)setrlimit(RLIMIT_FSIZE, &failing);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    (void)setrlimit(RLIMIT_FSIZE, &limit);
+    (void)signal(SIGXFSZ, SIG_DFL);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_IO_FAILED, actual);
+    CuAssertIntEquals_Msg(tc, "File size", TEST_WRITE_FAILURE_LIMIT, GetFileSize(writeFile));
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+#else
+    /* The uring engine copies with stdio on this platform */
+    CuAssertTrue(tc, true);
+#endif
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Read from file with the parallel engine
+PreConditions : 1. Select the parallel engine with small buffers and 4 threads
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns No Error
+                2. The ranges copied by the threads form the input in order
+------------------------------------------------------------------------------------*/
+void TestReadData_FileReadParallelEngine(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 16] = { '\0' };
+    int i = 0;
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING) + 8)
+    {
+        sprintf(dataBuffer + strlen(dataBuffer), "%s %d", TEST_STRING, i++);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 6;
+    char* iArgV[] = { "-e", TEST_ENGINE_PARALLEL, "-b", TEST_IO_BUFFER_SIZE_KB, "-q", TEST_QUEUE_DEPTH };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    CuAssertIntEquals_Msg(tc, "Engine", ENGINE_PARALLEL, DataReader_GetEngine());
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    CuAssertIntEquals_Msg(tc, "File size", strlen(dataBuffer), GetFileSize(writeFile));
+    char readData[TEST_BUFFER_SIZE * 16] = { '\0' };
+    ReadData(writeFile, readData, strlen(dataBuffer));
+    CuAssertStrEquals_Msg(tc, "Saved Data", dataBuffer, readData);
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - parallel engine with Max File size limit reached
+PreConditions : 1. Select the parallel engine and set custom output file size limit.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns Max file size limit error
+                2. Output file is exactly the allowed limit
+------------------------------------------------------------------------------------*/
+void TestReadData_ParallelEngineFileSizeLimitReached(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 8] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 8;
+    char* iArgV[] = { "-e", TEST_ENGINE_PARALLEL, "-s", "1", "-b", TEST_IO_BUFFER_SIZE_KB, "-q", TEST_QUEUE_DEPTH };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_FILE_SIZELIMIT_REACHED, actual);
+    CuAssertIntEquals_Msg(tc, "File size", 1024, GetFileSize(writeFile));
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    remove(writeFile);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Direct I/O output
+PreConditions : 1. Enable direct I/O with an aligned I/O buffer.
+Action        : 1. Invoke DataReader_ReadData() with a ReadFile that does not end on
+                   a block boundary, once per engine
+Expectation   : 1. Returns No Error
+                2. Complete input including the unaligned tail is saved in order
+                3. Invalid direct I/O mode returns Invalid direct I/O error
+------------------------------------------------------------------------------------*/
+void TestReadData_DirectIoOutput(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 16] = { '\0' };
+    int i = 0;
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING) + 8)
+    {
+        sprintf(dataBuffer + strlen(dataBuffer), "%s %d", TEST_STRING, i++);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    char* engines[] = { "stdio", TEST_ENGINE_KERNEL, TEST_ENGINE_MMAP, TEST_ENGINE_PIPELINE, TEST_ENGINE_URING,
+                        TEST_ENGINE_PARALLEL };
+    unsigned int j;
+    for(j = 0; j < sizeof(engines) / sizeof(engines[0]); j++)
+    {
+        /* PreConditions */
+        DataReader_ResetArguments();
+        int iArgC = 6;
+        char* iArgV[] = { "-e", engines[j], "-b", "4", "-d", "on" };
+        (void)DataReader_ParseArguments(iArgC, iArgV);
+        CuAssertTrue(tc, DataReader_GetDirectIo());
+        /* Action */
+        char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+        ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+        /* Expectation */
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+        CuAssertIntEquals_Msg(tc, "File size", strlen(dataBuffer), GetFileSize(writeFile));
+        char readData[TEST_BUFFER_SIZE * 16] = { '\0' };
+        ReadData(writeFile, readData, strlen(dataBuffer));
+        CuAssertStrEquals_Msg(tc, "Saved Data", dataBuffer, readData);
+        /* Test Cleanup */
+        remove(writeFile);
+    }
+    char* iInvalidArgV[] = { "-d", "direct" };
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_INVALIDDIRECTIO, DataReader_ParseArguments(2, iInvalidArgV));
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Compressed output
+PreConditions : 1. Enable compression with custom buffer size.
+                2. Create a text input and an input of random bytes.
+Action        : 1. Invoke DataReader_ReadData() with each input
+Expectation   : 1. Returns No Error
+                2. Text blocks are compressed, random blocks are stored raw
+                3. Output expands to the input, in full and block by block
+                4. Invalid compression mode returns Invalid compression error
+------------------------------------------------------------------------------------*/
+void TestReadData_CompressedOutput(CuTest* tc)
+{
+    /*Test setup */
+    char* input = malloc(TEST_COMPRESS_INPUT_SIZE);
+    char* expanded = malloc(TEST_COMPRESS_INPUT_SIZE);
+    unsigned int blocks = TEST_COMPRESS_INPUT_SIZE / (atoi(TEST_COMPRESS_BLOCK_KB) * 1024);
+    unsigned int j;
+    RedirectInput();
+    for(j = 0; j < 2; j++)
+    {
+        unsigned int i;
+        for(i = 0; i < TEST_COMPRESS_INPUT_SIZE; i++)
+        {
+            /* Numbered text lines, then random bytes */
+            input[i] = j ? (char)rand() : (char)(TEST_STRING[i % strlen(TEST_STRING)] + ((i / 512) % 10));
+        }
+        FILE* file = fopen(TEST_CUSTOM_INPUT_FILE, "wb");
+        fwrite(input, sizeof(char), TEST_COMPRESS_INPUT_SIZE, file);
+        fclose(file);
+        /* PreConditions */
+        DataReader_ResetArguments();
+        int iArgC = 4;
+        char* iArgV[] = { "-z", "on", "-b", TEST_COMPRESS_BLOCK_KB };
+        (void)DataReader_ParseArguments(iArgC, iArgV);
+        CuAssertTrue(tc, DataReader_GetCompression());
+        /* Action */
+        char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+        ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+        /* Expectation */
+        COMPRESS_STATS stats;
+        DataReader_GetCompressStats(&stats);
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+        CuAssertIntEquals_Msg(tc, "Blocks", blocks, stats.blocks);
+        CuAssertIntEquals_Msg(tc, "Raw blocks", j ? blocks : 0, stats.rawBlocks);
+        if(!j)
+        {
+            CuAssertTrue(tc, GetFileSize(writeFile) < (TEST_COMPRESS_INPUT_SIZE / 4));
+        }
+        FILE* compressed = fopen(writeFile, "rb");
+        FILE* output = fopen(TEST_EXPANDED_FILE, "wb");
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, DataCompress_Expand(compressed, output));
+        fclose(output);
+        memset(expanded, 0, TEST_COMPRESS_INPUT_SIZE);
+        output = fopen(TEST_EXPANDED_FILE, "rb");
+        CuAssertIntEquals_Msg(tc, "File size", TEST_COMPRESS_INPUT_SIZE,
+                              fread(expanded, sizeof(char), TEST_COMPRESS_INPUT_SIZE, output));
+        fclose(output);
+        CuAssertTrue(tc, memcmp(input, expanded, TEST_COMPRESS_INPUT_SIZE) == 0);
+        COMPRESS_INDEX index;
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, DataCompress_ReadIndex(compressed, &index));
+        CuAssertIntEquals_Msg(tc, "Index", blocks, index.count);
+        for(i = blocks; i > 0; i--)
+        {
+            const COMPRESS_BLOCK* block = &index.blocks[i - 1];
+            memset(expanded, 0, TEST_COMPRESS_INPUT_SIZE);
+            CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, DataCompress_ReadBlock(compressed, block, expanded));
+            CuAssertTrue(tc, memcmp(input + block->rawOffset, expanded, block->rawSize) == 0);
+        }
+        DataCompress_FreeIndex(&index);
+        fclose(compressed);
+        /* Test Cleanup */
+        remove(writeFile);
+        remove(TEST_EXPANDED_FILE);
+    }
+    char* iInvalidArgV[] = { "-z", "lz" };
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_INVALIDCOMPRESSION, DataReader_ParseArguments(2, iInvalidArgV));
+    /* Test Cleanup */
+    free(input);
+    free(expanded);
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Compressed output size limit
+PreConditions : 1. Enable compression with custom buffer and output file size.
+                2. Create an input of random bytes larger than a segment.
+Action        : 1. Invoke DataReader_ReadData() without and with rotation
+Expectation   : 1. Returns File size limit reached error without rotation and
+                   No Error with rotation
+                2. Every segment has its own header, index and footer
+                3. The segments expand to the start of the input, or all of it
+------------------------------------------------------------------------------------*/
+void TestReadData_CompressedOutputSizeLimit(CuTest* tc)
+{
+    /*Test setup */
+    char* input = malloc(TEST_COMPRESS_LIMIT_INPUT_SIZE);
+    char* expanded = malloc(TEST_COMPRESS_LIMIT_INPUT_SIZE);
+    unsigned int blockSize = atoi(TEST_COMPRESS_LIMIT_BLOCK_KB) * 1024;
+    unsigned int segmentSize = blockSize * TEST_COMPRESS_SEGMENT_BLOCKS;
+    unsigned int segments = TEST_COMPRESS_LIMIT_INPUT_SIZE / segmentSize;
+    unsigned int i;
+    unsigned int j;
+    for(i = 0; i < TEST_COMPRESS_LIMIT_INPUT_SIZE; i++)
+    {
+        input[i] = (char)rand();
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, input, TEST_COMPRESS_LIMIT_INPUT_SIZE);
+    RedirectInput();
+    for(j = 0; j < 2; j++)
+    {
+        /* PreConditions */
+        DataReader_ResetArguments();
+        int iArgC = j ? 8 : 6;
+        char* iArgV[] = { "-z", "on", "-b", TEST_COMPRESS_LIMIT_BLOCK_KB, "-s", TEST_COMPRESS_SEGMENT_KB, "-r", "on" };
+        (void)DataReader_ParseArguments(iArgC, iArgV);
+        /* Action */
+        char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+        ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+        /* Expectation */
+        COMPRESS_STATS stats;
+        DataReader_GetCompressStats(&stats);
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", j ? ERROR_NOERROR : ERROR_FILE_SIZELIMIT_REACHED, actual);
+        CuAssertIntEquals_Msg(tc, "Blocks", TEST_COMPRESS_SEGMENT_BLOCKS * (j ? segments : 1), stats.blocks);
+        for(i = 0; i < (j ? segments : 1); i++)
+        {
+            char segmentFile[MAX_FILEPATH_LENGTH] = { '\0' };
+            COMPRESS_INDEX index;
+            unsigned int k;
+            if(j)
+            {
+                GetSegmentFile(writeFile, i, segmentFile);
+            }
+            else
+            {
+                strcpy(segmentFile, writeFile);
+            }
+            CuAssertTrue(tc, GetFileSize(segmentFile) <= (atoi(TEST_COMPRESS_SEGMENT_KB) * 1024));
+            FILE* compressed = fopen(segmentFile, "rb");
+            FILE* output = fopen(TEST_EXPANDED_FILE, "wb");
+            CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, DataCompress_Expand(compressed, output));
+            fclose(output);
+            output = fopen(TEST_EXPANDED_FILE, "rb");
+            CuAssertIntEquals_Msg(tc, "File size", segmentSize,
+                                  fread(expanded, sizeof(char), TEST_COMPRESS_LIMIT_INPUT_SIZE, output));
+            fclose(output);
+            CuAssertTrue(tc, memcmp(input + i * segmentSize, expanded, segmentSize) == 0);
+            CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, DataCompress_ReadIndex(compressed, &index));
+            CuAssertIntEquals_Msg(tc, "Index", TEST_COMPRESS_SEGMENT_BLOCKS, index.count);
+            for(k = 0; k < index.count; k++)
+            {
+                const COMPRESS_BLOCK* block = &index.blocks[k];
+                CuAssertIntEquals_Msg(tc, "Raw offset", i * segmentSize + k * blockSize, block->rawOffset);
+                CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, DataCompress_ReadBlock(compressed, block, expanded));
+                CuAssertTrue(tc, memcmp(input + block->rawOffset, expanded, block->rawSize) == 0);
+            }
+            DataCompress_FreeIndex(&index);
+            fclose(compressed);
+            remove(segmentFile);
+        }
+        /* Test Cleanup */
+        remove(TEST_EXPANDED_FILE);
+    }
+    /* Test Cleanup */
+    free(input);
+    free(expanded);
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Deduplicated output
+PreConditions : 1. Enable deduplication.
+                2. Create an input and a copy of it with one byte inserted in front.
+Action        : 1. Invoke DataReader_ReadData() with each input, the second one
+                   with the output synced on close
+Expectation   : 1. Returns No Error
+                2. Each capture is saved as a recipe
+                3. The second capture adds only the chunks around the insertion
+                4. The recipe restores the second input
+                5. Invalid deduplication mode returns Invalid deduplication error
+------------------------------------------------------------------------------------*/
+void TestReadData_DeduplicatedOutput(CuTest* tc)
+{
+    /*Test setup */
+    char* input = malloc(TEST_DEDUP_INPUT_SIZE + 1);
+    char* restored = malloc(TEST_DEDUP_INPUT_SIZE + 1);
+    char writeFile[2][MAX_FILEPATH_LENGTH] = { { '\0' } };
+    DEDUP_STATS stats[2];
+    ERROR_TYPE actual[2];
+    unsigned int i;
+    input[0] = '!';
+    for(i = 1; i <= TEST_DEDUP_INPUT_SIZE; i++)
+    {
+        input[i] = (char)rand();
+    }
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 2;
+    char* iArgV[] = { "-u", "on" };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    CuAssertTrue(tc, DataReader_GetDedup());
+    /* Action */
+    for(i = 0; i < 2; i++)
+    {
+        /* Without and with the inserted byte */
+        FILE* file = fopen(TEST_CUSTOM_INPUT_FILE, "wb");
+        fwrite(i ? input : input + 1, sizeof(char), TEST_DEDUP_INPUT_SIZE + i, file);
+        fclose(file);
+        if(i)
+        {
+            /* Stored and reused chunks are synced with the recipe */
+            char* iSyncArgV[] = { "-y", "close" };
+            (void)DataReader_ParseArguments(2, iSyncArgV);
+        }
+        actual[i] = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile[i], sizeof(writeFile[i]));
+        DataReader_GetDedupStats(&stats[i]);
+    }
+    ERROR_TYPE restore = DataDedup_Restore(writeFile[1], TEST_EXPANDED_FILE, NULL);
+    /* Expectation */
+    for(i = 0; i < 2; i++)
+    {
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual[i]);
+        CuAssertStrEquals(tc, DEDUP_RECIPE_EXTENSION, writeFile[i] + strlen(writeFile[i]) - strlen(DEDUP_RECIPE_EXTENSION));
+        CuAssertTrue(tc, GetFileSize(writeFile[i]) < (TEST_DEDUP_INPUT_SIZE / 16));
+    }
+    CuAssertIntEquals_Msg(tc, "New chunks", stats[0].chunks, stats[0].newChunks);
+    CuAssertTrue(tc, stats[0].chunks > 4);
+    CuAssertTrue(tc, stats[1].newChunks <= 2);
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, restore);
+    FILE* output = fopen(TEST_EXPANDED_FILE, "rb");
+    CuAssertIntEquals_Msg(tc, "File size", TEST_DEDUP_INPUT_SIZE + 1,
+                          fread(restored, sizeof(char), TEST_DEDUP_INPUT_SIZE + 1, output));
+    fclose(output);
+    CuAssertTrue(tc, memcmp(input, restored, TEST_DEDUP_INPUT_SIZE + 1) == 0);
+    char* iInvalidArgV[] = { "-u", "yes" };
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_INVALIDDEDUP, DataReader_ParseArguments(2, iInvalidArgV));
+    /* Test Cleanup */
+    RemoveChunks(writeFile[0]);
+    RemoveChunks(writeFile[1]);
+    (void)_rmdir(DEDUP_STORE_DIRECTORY);
+    free(input);
+    free(restored);
+    remove(TEST_EXPANDED_FILE);
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Framed output
+PreConditions : 1. Enable framing and rotation with custom buffer and output file size.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns No Error
+                2. Every segment is complete and records its input
+                3. Records read by number in reverse order rebuild the input
+                4. A segment without its footer is incomplete
+------------------------------------------------------------------------------------*/
+void TestReadData_FramedOutput(CuTest* tc)
+{
+    /*Test setup */
+    char input[TEST_FRAME_INPUT_SIZE];
+    char record[TEST_BUFFER_SIZE];
+    unsigned long long position = TEST_FRAME_INPUT_SIZE;
+    unsigned int segments = 0;
+    unsigned int i;
+    for(i = 0; i < TEST_FRAME_INPUT_SIZE; i++)
+    {
+        input[i] = (char)rand();
+    }
+    FILE* file = fopen(TEST_CUSTOM_INPUT_FILE, "wb");
+    fwrite(input, sizeof(char), TEST_FRAME_INPUT_SIZE, file);
+    fclose(file);
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 8;
+    char* iArgV[] = { "-t", "on", "-r", "on", "-b", TEST_IO_BUFFER_SIZE_KB, "-s", TEST_FRAME_SEGMENT_KB };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    CuAssertTrue(tc, DataReader_GetFraming());
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    /* Walk the segments backwards, from the last one found */
+    char segmentFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    GetSegmentFile(writeFile, 0, segmentFile);
+    while((file = fopen(segmentFile, "rb")) != NULL)
+    {
+        fclose(file);
+        GetSegmentFile(writeFile, ++segments, segmentFile);
+    }
+    CuAssertTrue(tc, segments > 2);
+    for(i = segments; i > 0; i--)
+    {
+        FRAME_INFO info;
+        unsigned long long j;
+        GetSegmentFile(writeFile, i - 1, segmentFile);
+        file = fopen(segmentFile, "rb");
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, DataFrame_Open(file, &info));
+        CuAssertIntEquals_Msg(tc, "Segment", i - 1, info.segment);
+        CuAssertStrEquals(tc, TEST_CUSTOM_INPUT_FILE, info.source);
+        CuAssertTrue(tc, GetFileSize(segmentFile) <= (atoi(TEST_FRAME_SEGMENT_KB) * 1024));
+        for(j = info.records; j > 0; j--)
+        {
+            unsigned int size = 0;
+            CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR,
+                                  DataFrame_ReadRecord(file, &info, j - 1, record, sizeof(record), &size));
+            position = position - size;
+            CuAssertTrue(tc, memcmp(input + position, record, size) == 0);
+        }
+        fclose(file);
+    }
+    CuAssertIntEquals_Msg(tc, "Position", 0, position);
+    /* Drop the footer of the first segment */
+    GetSegmentFile(writeFile, 0, segmentFile);
+    int size = GetFileSize(segmentFile);
+    char* truncated = malloc(size);
+    file = fopen(segmentFile, "rb");
+    CuAssertIntEquals_Msg(tc, "File size", size, fread(truncated, sizeof(char), size, file));
+    fclose(file);
+    file = fopen(segmentFile, "wb");
+    fwrite(truncated, sizeof(char), size - FRAME_FOOTER_SIZE, file);
+    fclose(file);
+    FRAME_INFO info;
+    file = fopen(segmentFile, "rb");
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_IO_FAILED, DataFrame_Open(file, &info));
+    fclose(file);
+    /* Test Cleanup */
+    free(truncated);
+    for(i = 0; i < segments; i++)
+    {
+        GetSegmentFile(writeFile, i, segmentFile);
+        remove(segmentFile);
+    }
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Line boundaries
+PreConditions : 1. Enable line boundaries with an index, rotation, a small buffer and
+                   a custom output file size.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns No Error
+                2. Every segment but the last ends with a complete line
+                3. The segments rebuild the input
+                4. DataLines_Seek() finds lines before, on and after index entries
+                5. DataLines_Count() matches a byte by byte count at any size
+------------------------------------------------------------------------------------*/
+void TestReadData_LineBoundaries(CuTest* tc)
+{
+    /*Test setup */
+    char* input = malloc(TEST_LINES_INPUT_SIZE);
+    char* segment = malloc(TEST_LINES_INPUT_SIZE);
+    unsigned long long lines[] = { 0, 1, 1023, 1024, 1025, 2047, 2048, 2500 };
+    unsigned long long position = 0;
+    unsigned int segments = 0;
+    unsigned int i;
+    for(i = 0; i < TEST_LINES_INPUT_SIZE; i++)
+    {
+        input[i] = (rand() % TEST_LINES_MAX_LENGTH) ? (char)('a' + (rand() % 26)) : LINE_DELIMITER;
+    }
+    /* Unterminated last line */
+    input[TEST_LINES_INPUT_SIZE - 1] = 'z';
+    FILE* file = fopen(TEST_CUSTOM_INPUT_FILE, "wb");
+    fwrite(input, sizeof(char), TEST_LINES_INPUT_SIZE, file);
+    fclose(file);
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 8;
+    char* iArgV[] = { "-w", "index", "-r", "on", "-b", TEST_IO_BUFFER_SIZE_KB, "-s", TEST_LINES_SEGMENT_KB };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    CuAssertTrue(tc, DataReader_GetLines());
+    CuAssertTrue(tc, DataReader_GetLineIndex());
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    char segmentFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    GetSegmentFile(writeFile, 0, segmentFile);
+    while((file = fopen(segmentFile, "rb")) != NULL)
+    {
+        int size = GetFileSize(segmentFile);
+        CuAssertTrue(tc, (position + size) <= TEST_LINES_INPUT_SIZE);
+        CuAssertIntEquals_Msg(tc, "File size", size, fread(segment, sizeof(char), size, file));
+        fclose(file);
+        CuAssertTrue(tc, memcmp(input + position, segment, size) == 0);
+        position = position + size;
+        if(position < TEST_LINES_INPUT_SIZE)
+        {
+            CuAssertTrue(tc, segment[size - 1] == LINE_DELIMITER);
+        }
+        if(segments == 0)
+        {
+            /* Line offsets of the first segment */
+            unsigned int j;
+            for(j = 0; j < (sizeof(lines) / sizeof(lines[0])); j++)
+            {
+                unsigned long long offset = 0;
+                unsigned long long expected = 0;
+                unsigned long long line;
+                for(line = 0; line < lines[j]; line++)
+                {
+                    expected = (char*)memchr(segment + expected, LINE_DELIMITER, size - expected) - segment + 1;
+                }
+                CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, DataLines_Seek(segmentFile, lines[j], &offset));
+                CuAssertTrue(tc, offset == expected);
+            }
+            unsigned long long offset = 0;
+            CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_INVALIDARG,
+                                  DataLines_Seek(segmentFile, DataLines_Count(segment, size, LINE_DELIMITER), &offset));
+        }
+        GetSegmentFile(writeFile, ++segments, segmentFile);
+    }
+    CuAssertTrue(tc, segments > 1);
+    CuAssertIntEquals_Msg(tc, "Position", TEST_LINES_INPUT_SIZE, position);
+    /* Unaligned starts and sizes around the vector widths */
+    for(i = 0; i < 100; i++)
+    {
+        unsigned long long expected = 0;
+        unsigned int j;
+        for(j = 0; j < i; j++)
+        {
+            expected = expected + (input[i + j] == LINE_DELIMITER);
+        }
+        CuAssertTrue(tc, DataLines_Count(input + i, i, LINE_DELIMITER) == expected);
+        char* last = NULL;
+        for(j = 0; j < i; j++)
+        {
+            last = (input[i + j] == LINE_DELIMITER) ? input + i + j : last;
+        }
+        CuAssertTrue(tc, DataLines_FindLast(input + i, i, LINE_DELIMITER) == (last ? (size_t)(last - input - i + 1) : 0));
+    }
+    /* Test Cleanup */
+    for(i = 0; i < segments; i++)
+    {
+        char indexFile[MAX_FILEPATH_LENGTH + sizeof(LINE_INDEX_EXTENSION)];
+        GetSegmentFile(writeFile, i, segmentFile);
+        sprintf(indexFile, "%s%s", segmentFile, LINE_INDEX_EXTENSION);
+        remove(indexFile);
+        remove(segmentFile);
+    }
+    free(segment);
+    free(input);
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Output rotation
+PreConditions : 1. Enable rotation and set custom output file size limit.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile, once per engine
+Expectation   : 1. Returns No Error
+                2. Input is split into sequence numbered segments of the size limit
+                3. No empty trailing segment is left behind
+------------------------------------------------------------------------------------*/
+void TestReadData_RotateOutput(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 2 + 100] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    char* engines[] = { "stdio", TEST_ENGINE_KERNEL, TEST_ENGINE_MMAP, TEST_ENGINE_PIPELINE, TEST_ENGINE_URING,
+                        TEST_ENGINE_PARALLEL };
+    unsigned int i;
+    for(i = 0; i < sizeof(engines) / sizeof(engines[0]); i++)
+    {
+        /* PreConditions */
+        DataReader_ResetArguments();
+        int iArgC = 6;
+        char* iArgV[] = { "-e", engines[i], "-s", "1", "-r", "on" };
+        (void)DataReader_ParseArguments(iArgC, iArgV);
+        /* Action */
+        char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+        char segmentFile[MAX_FILEPATH_LENGTH] = { '\0' };
+        ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+        /* Expectation */
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+        CuAssertTrue(tc, strstr(writeFile, TEST_SEGMENT_SUFFIX) != NULL);
+        CuAssertIntEquals_Msg(tc, "Segment 0 size", 1024, GetFileSize(writeFile));
+        GetSegmentFile(writeFile, 1, segmentFile);
+        CuAssertIntEquals_Msg(tc, "Segment 1 size", 1024, GetFileSize(segmentFile));
+        remove(segmentFile);
+        GetSegmentFile(writeFile, 2, segmentFile);
+        CuAssertIntEquals_Msg(tc, "Segment 2 size", strlen(dataBuffer) - 2048, GetFileSize(segmentFile));
+        remove(segmentFile);
+        GetSegmentFile(writeFile, 3, segmentFile);
+        CuAssertPtrEquals_Msg(tc, "Segment 3", NULL, fopen(segmentFile, "r"));
+        /* Test Cleanup */
+        remove(writeFile);
+    }
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Rotated segment fails to close
+PreConditions : 1. Enable rotation and set custom output file size limit.
+                2. Limit the size of files written by the process between the
+                   size of the last segment and the size limit
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns I/O failed error although the last segment is closed
+                   without error, as the final flush of a rotated segment failed
+------------------------------------------------------------------------------------*/
+void TestReadData_RotatedSegmentCloseFailure(CuTest* tc)
+{
+#ifdef __linux__
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 2 + 100] = { '\0' };
+    struct rlimit limit;
+    struct rlimit failing;
+    unsigned int i;
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 4;
+    char* iArgV[] = { "-s", "1", "-r", "on" };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* The segments stay in the stdio buffer until they are closed */
+    (void)getrlimit(RLIMIT_FSIZE, &limit);
+    failing = limit;
+    failing.rlim_cur = TEST_CLOSE_FAILURE_LIMIT;
+    (void)signal(SIGXFSZ, SIG_IGN);
+    (void)setrlimit(RLIMIT_FSIZE, &failing);
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    char segmentFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    (void)setrlimit(RLIMIT_FSIZE, &limit);
+    (void)signal(SIGXFSZ, SIG_DFL);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_IO_FAILED, actual);
+    GetSegmentFile(writeFile, 2, segmentFile);
+    CuAssertIntEquals_Msg(tc, "Segment 2 size", strlen(dataBuffer) - 2048, GetFileSize(segmentFile));
+    /* Test Cleanup */
+    for(i = 0; i < 3; i++)
+    {
+        GetSegmentFile(writeFile, i, segmentFile);
+        remove(segmentFile);
+    }
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+#else
+    /* The file size limit used to fail the flush is not available */
+    CuAssertTrue(tc, true);
+#endif
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Capture statistics
+PreConditions : 1. Enable rotation with custom output file size limit and a
+                   statistics file.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile, once per engine
+Expectation   : 1. Returns No Error
+                2. All bytes are counted as read and written, in every histogram
+                   and throughput sample
+                3. Every capture appends one JSON line to the statistics file
+------------------------------------------------------------------------------------*/
+void TestReadData_CaptureStats(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 2 + 100] = { '\0' };
+    char line[4096];
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    remove(TEST_STATS_FILE);
+    RedirectInput();
+    char* engines[] = { "stdio", TEST_ENGINE_KERNEL, TEST_ENGINE_MMAP, TEST_ENGINE_PIPELINE, TEST_ENGINE_URING,
+                        TEST_ENGINE_PARALLEL };
+    unsigned int i;
+    for(i = 0; i < sizeof(engines) / sizeof(engines[0]); i++)
+    {
+        /* PreConditions */
+        DataReader_ResetArguments();
+        int iArgC = 8;
+        char* iArgV[] = { "-e", engines[i], "-s", "1", "-r", "on", "-g", TEST_STATS_FILE };
+        (void)DataReader_ParseArguments(iArgC, iArgV);
+        CuAssertStrEquals(tc, TEST_STATS_FILE, DataReader_GetStatsFile());
+        /* Action */
+        char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+        char segmentFile[MAX_FILEPATH_LENGTH] = { '\0' };
+        ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+        /* Expectation */
+        CAPTURE_STATS stats;
+        unsigned long long readCalls = 0;
+        unsigned long long writeCalls = 0;
+        unsigned long long sampled = 0;
+        unsigned int j;
+        DataReader_GetCaptureStats(&stats);
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+        CuAssertTrue(tc, stats.reads.bytes == strlen(dataBuffer));
+        CuAssertTrue(tc, stats.writes.bytes == strlen(dataBuffer));
+        CuAssertIntEquals_Msg(tc, "Segments", 3, stats.segments);
+        for(j = 0; j < STATS_LATENCY_BUCKETS; j++)
+        {
+            readCalls = readCalls + stats.reads.buckets[j];
+            writeCalls = writeCalls + stats.writes.buckets[j];
+        }
+        for(j = 0; j < stats.samples; j++)
+        {
+            sampled = sampled + stats.sampleBytes[j];
+        }
+        CuAssertTrue(tc, (readCalls == stats.reads.calls) && (writeCalls == stats.writes.calls));
+        CuAssertTrue(tc, stats.writes.calls >= 3);
+        CuAssertTrue(tc, sampled == stats.writes.bytes);
+        CuAssertTrue(tc, stats.writes.maxTime <= stats.duration);
+        CuAssertTrue(tc, DataStats_Percentile(&stats.writes, 50) <= DataStats_Percentile(&stats.writes, 99));
+        /* A short buffer holds the start of the same object */
+        CuAssertTrue(tc, DataStats_ToJson(&stats, writeFile, actual, line, 16) ==
+                         DataStats_ToJson(&stats, writeFile, actual, line, sizeof(line)));
+        /* Test Cleanup */
+        for(j = 0; j < 3; j++)
+        {
+            GetSegmentFile(writeFile, j, segmentFile);
+            remove(segmentFile);
+        }
+    }
+    FILE* file = fopen(TEST_STATS_FILE, "r");
+    CuAssertPtrNotNull(tc, file);
+    for(i = 0; fgets(line, sizeof(line), file) != NULL; i++)
+    {
+        CuAssertTrue(tc, strncmp(line, "{\"output\":\"", strlen("{\"output\":\"")) == 0);
+        CuAssertTrue(tc, strstr(line, "\"result\":0,") != NULL);
+        CuAssertTrue(tc, strcmp(line + strlen(line) - strlen("]}}\n"), "]}}\n") == 0);
+    }
+    fclose(file);
+    CuAssertIntEquals_Msg(tc, "JSON lines", sizeof(engines) / sizeof(engines[0]), i);
+    remove(TEST_STATS_FILE);
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Preallocated output
+PreConditions : 1. Enable preallocation with rotation and custom output file size
+                   limit, then with compression and a large limit.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile, once per engine
+                2. Invoke DataReader_ReadData() with a compressible ReadFile
+Expectation   : 1. Returns No Error and the segments have the sizes of the data
+                2. The output keeps no blocks of the reservation sized by its input
+                   and expands to the input
+------------------------------------------------------------------------------------*/
+void TestReadData_PreallocatedOutput(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 2 + 100] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    char* engines[] = { "stdio", TEST_ENGINE_KERNEL, TEST_ENGINE_MMAP, TEST_ENGINE_PIPELINE, TEST_ENGINE_URING,
+                        TEST_ENGINE_PARALLEL };
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    char segmentFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual;
+    unsigned int i;
+    for(i = 0; i < sizeof(engines) / sizeof(engines[0]); i++)
+    {
+        /* PreConditions */
+        DataReader_ResetArguments();
+        int iArgC = 8;
+        char* iArgV[] = { "-e", engines[i], "-s", "1", "-r", "on", "-a", "on" };
+        (void)DataReader_ParseArguments(iArgC, iArgV);
+        CuAssertTrue(tc, DataReader_GetPreallocation());
+        /* Action */
+        memset(writeFile, 0, sizeof(writeFile));
+        actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+        /* Expectation */
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+        CuAssertIntEquals_Msg(tc, "Segment 0 size", 1024, GetFileSize(writeFile));
+        GetSegmentFile(writeFile, 1, segmentFile);
+        CuAssertIntEquals_Msg(tc, "Segment 1 size", 1024, GetFileSize(segmentFile));
+        remove(segmentFile);
+        GetSegmentFile(writeFile, 2, segmentFile);
+        CuAssertIntEquals_Msg(tc, "Segment 2 size", strlen(dataBuffer) - 2048, GetFileSize(segmentFile));
+        remove(segmentFile);
+        /* Test Cleanup */
+        remove(writeFile);
+    }
+    /* Compression writes far less than the input the space is reserved for */
+    char* input = malloc(TEST_COMPRESS_INPUT_SIZE);
+    char* expanded = malloc(TEST_COMPRESS_INPUT_SIZE);
+    for(i = 0; i < TEST_COMPRESS_INPUT_SIZE; i++)
+    {
+        input[i] = (char)(TEST_STRING[i % strlen(TEST_STRING)] + ((i / 512) % 10));
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, input, TEST_COMPRESS_INPUT_SIZE);
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 6;
+    char* iArgV[] = { "-z", "on", "-s", TEST_PREALLOCATE_LIMIT, "-a", "on" };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    memset(writeFile, 0, sizeof(writeFile));
+    actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    CuAssertTrue(tc, GetFileSize(writeFile) < (TEST_COMPRESS_INPUT_SIZE / 4));
+#ifndef _WIN32
+    struct stat outputStat;
+    CuAssertIntEquals_Msg(tc, "stat", 0, stat(writeFile, &outputStat));
+    CuAssertTrue(tc, ((unsigned long long)outputStat.st_blocks * 512) < (TEST_COMPRESS_INPUT_SIZE / 2));
+#endif
+    FILE* compressed = fopen(writeFile, "rb");
+    FILE* output = fopen(TEST_EXPANDED_FILE, "wb");
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, DataCompress_Expand(compressed, output));
+    fclose(output);
+    fclose(compressed);
+    output = fopen(TEST_EXPANDED_FILE, "rb");
+    CuAssertIntEquals_Msg(tc, "File size", TEST_COMPRESS_INPUT_SIZE,
+                          fread(expanded, sizeof(char), TEST_COMPRESS_INPUT_SIZE, output));
+    fclose(output);
+    CuAssertTrue(tc, memcmp(input, expanded, TEST_COMPRESS_INPUT_SIZE) == 0);
+    /* Test Cleanup */
+    remove(TEST_EXPANDED_FILE);
+    remove(writeFile);
+    free(expanded);
+    free(input);
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Checksum sidecars
+PreConditions : 1. Enable checksums and rotation with the kernel engine and set
+                   custom output file size limit.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+                2. Verify the segments with DataBatch_Verify()
+                3. Corrupt one segment and verify it again
+Expectation   : 1. Returns No Error and the CRC32C check value is computed
+                2. Every segment has a sidecar and passes the check
+                3. The corrupt segment fails in its first block
+------------------------------------------------------------------------------------*/
+void TestReadData_ChecksumSidecar(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 2 + 100] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 8;
+    char* iArgV[] = { "-e", TEST_ENGINE_KERNEL, "-s", "1", "-r", "on", "-k", "on" };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    CuAssertTrue(tc, DataReader_GetChecksum());
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    BATCH_LIST segments = { 0 };
+    unsigned int i;
+    for(i = 0; i < TEST_CHECKSUM_SEGMENTS; i++)
+    {
+        char segmentFile[MAX_FILEPATH_LENGTH] = { '\0' };
+        GetSegmentFile(writeFile, i, segmentFile);
+        (void)DataBatch_Add(&segments, segmentFile);
+    }
+    unsigned int failed = DataBatch_Verify(&segments, TEST_CHECKSUM_SEGMENTS);
+    FILE* segment = fopen(segments.items[1].input, "r+b");
+    fputc('!', segment);
+    fclose(segment);
+    unsigned long long badBlock = 1;
+    ERROR_TYPE corrupt = DataChecksum_Verify(segments.items[1].input, &badBlock);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    CuAssertIntEquals_Msg(tc, "CRC32C", TEST_CRC32C_CHECK, DataChecksum_Crc32c(0, "123456789", 9));
+    CuAssertIntEquals_Msg(tc, "Failed", 0, failed);
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_CHECKSUM_MISMATCH, corrupt);
+    CuAssertIntEquals_Msg(tc, "Bad block", 0, badBlock);
+    /* Test Cleanup */
+    for(i = 0; i < TEST_CHECKSUM_SEGMENTS; i++)
+    {
+        char sidecarFile[MAX_FILEPATH_LENGTH + sizeof(CHECKSUM_SIDECAR_EXTENSION)];
+        sprintf(sidecarFile, "%s%s", segments.items[i].input, CHECKSUM_SIDECAR_EXTENSION);
+        remove(segments.items[i].input);
+        remove(sidecarFile);
+    }
+    DataBatch_Free(&segments);
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Unique output names
+PreConditions : 1. Clear any existing configurations
+Action        : 1. Invoke DataReader_ReadData() twice in a row with the same ReadFile
+Expectation   : 1. Both return No Error
+                2. Each capture is saved to its own output file
+------------------------------------------------------------------------------------*/
+void TestReadData_UniqueOutputNames(CuTest* tc)
+{
+    /*Test setup */
+    WriteData(TEST_CUSTOM_INPUT_FILE, TEST_STRING, strlen(TEST_STRING));
+    RedirectInput();
+    DataReader_ResetArguments();
+    /* Action */
+    char firstFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    char secondFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE first = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, firstFile, sizeof(firstFile));
+    ERROR_TYPE second = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, secondFile, sizeof(secondFile));
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, first);
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, second);
+    CuAssertTrue(tc, strcmp(firstFile, secondFile) != 0);
+    CuAssertIntEquals_Msg(tc, "First size", strlen(TEST_STRING), GetFileSize(firstFile));
+    CuAssertIntEquals_Msg(tc, "Second size", strlen(TEST_STRING), GetFileSize(secondFile));
+    /* Test Cleanup */
+    remove(firstFile);
+    remove(secondFile);
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Multiple destinations
+PreConditions : 1. Configure three output directories, the last one missing, with
+                   rotation and a custom output file size limit
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile
+Expectation   : 1. Returns No Error although one directory cannot be written
+                2. The existing directories hold the same segments with the same
+                   names, the missing one reports its own error
+                3. Too many or empty directories and transforming modes are
+                   rejected
+------------------------------------------------------------------------------------*/
+void TestReadData_MultipleDestinations(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 2 + 100] = { '\0' };
+    char copyData[sizeof(dataBuffer)] = { '\0' };
+    char workingDirectory[MAX_FILEPATH_LENGTH] = { '\0' };
+    char paths[3][MAX_FILEPATH_LENGTH + sizeof(TEST_TEE_DIR_MISSING) + 1];
+    char pathList[3 * sizeof(paths[0])];
+    char tooMany[5 * sizeof(paths[0])];
+    char empty[2 * sizeof(paths[0]) + 1];
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    (void)_getcwd(workingDirectory, sizeof(workingDirectory));
+    snprintf(paths[0], sizeof(paths[0]), "%s%c%s", workingDirectory, PATH_DELIMITER, TEST_TEE_DIR_FIRST);
+    snprintf(paths[1], sizeof(paths[1]), "%s%c%s", workingDirectory, PATH_DELIMITER, TEST_TEE_DIR_SECOND);
+    snprintf(paths[2], sizeof(paths[2]), "%s%c%s", workingDirectory, PATH_DELIMITER, TEST_TEE_DIR_MISSING);
+    (void)_mkdir(paths[0]);
+    (void)_mkdir(paths[1]);
+    snprintf(pathList, sizeof(pathList), "%s%c%s%c%s", paths[0], DESTINATION_DELIMITER, paths[1], DESTINATION_DELIMITER, paths[2]);
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 6;
+    char* iArgV[] = { "-p", pathList, "-s", "1", "-r", "on" };
+    CuAssertIntEquals_Msg(tc, "Parse", ERROR_NOERROR, DataReader_ParseArguments(iArgC, iArgV));
+    CuAssertTrue(tc, strstr(DataReader_GetDestinationPath(0), TEST_TEE_DIR_FIRST) != NULL);
+    CuAssertTrue(tc, strstr(DataReader_GetDestinationPath(2), TEST_TEE_DIR_MISSING) != NULL);
+    CuAssertPtrEquals_Msg(tc, "Destination 3", NULL, (void*)DataReader_GetDestinationPath(3));
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    char segmentFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    /* Expectation */
+    TEE_STATS stats;
+    DataReader_GetTeeStats(&stats);
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    CuAssertIntEquals_Msg(tc, "Destinations", 3, stats.destinations);
+    CuAssertStrEquals(tc, writeFile, stats.destination[0].output);
+    CuAssertIntEquals_Msg(tc, "First result", ERROR_NOERROR, stats.destination[0].result);
+    CuAssertIntEquals_Msg(tc, "Second result", ERROR_NOERROR, stats.destination[1].result);
+    CuAssertIntEquals_Msg(tc, "Missing result", ERROR_WRITE_FILEOPEN, stats.destination[2].result);
+    CuAssertIntEquals_Msg(tc, "First bytes", strlen(dataBuffer), stats.destination[0].bytes);
+    CuAssertIntEquals_Msg(tc, "Second bytes", strlen(dataBuffer), stats.destination[1].bytes);
+    /* The copy is named after the first output */
+    CuAssertStrEquals(tc, strrchr(writeFile, PATH_DELIMITER), strrchr(stats.destination[1].output, PATH_DELIMITER));
+    GetSegmentFile(stats.destination[1].output, 2, segmentFile);
+    CuAssertIntEquals_Msg(tc, "Copy segment 2 size", strlen(dataBuffer) - 2048, GetFileSize(segmentFile));
+    ReadData(segmentFile, copyData, strlen(dataBuffer) - 2048);
+    CuAssertTrue(tc, memcmp(copyData, dataBuffer + 2048, strlen(dataBuffer) - 2048) == 0);
+    unsigned int i;
+    for(i = 0; i < 3; i++)
+    {
+        GetSegmentFile(writeFile, i, segmentFile);
+        remove(segmentFile);
+        GetSegmentFile(stats.destination[1].output, i, segmentFile);
+        remove(segmentFile);
+    }
+    /* Invalid lists and modes */
+    snprintf(tooMany, sizeof(tooMany), "%s%c%s%c%s%c%s%c%s", paths[0], DESTINATION_DELIMITER, paths[1],
+             DESTINATION_DELIMITER, paths[0], DESTINATION_DELIMITER, paths[1], DESTINATION_DELIMITER, paths[0]);
+    snprintf(empty, sizeof(empty), "%s%c%c%s", paths[0], DESTINATION_DELIMITER, DESTINATION_DELIMITER, paths[1]);
+    char* tooManyArgV[] = { "-p", tooMany };
+    char* emptyArgV[] = { "-p", empty };
+    CuAssertIntEquals_Msg(tc, "Too many", ERROR_INVALIDDESTINATIONS, DataReader_ParseArguments(2, tooManyArgV));
+    CuAssertIntEquals_Msg(tc, "Empty", ERROR_INVALIDDESTINATIONS, DataReader_ParseArguments(2, emptyArgV));
+    char* compressArgV[] = { "-z", "on" };
+    (void)DataReader_ParseArguments(2, compressArgV);
+    memset(writeFile, '\0', sizeof(writeFile));
+    actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+    CuAssertIntEquals_Msg(tc, "Compressed copies", ERROR_INVALIDDESTINATIONS, actual);
+    /* Test Cleanup */
+    (void)_rmdir(paths[0]);
+    (void)_rmdir(paths[1]);
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Helper : Progress of a destination that takes a slot at a time, slowly
+------------------------------------------------------------------------------------*/
+void ThrottleWriter(void* pContext, const struct DATA_WRITER* pWriter)
+{
+    (void)pContext;
+    (void)pWriter;
+#ifndef _WIN32
+    usleep(TEST_TEE_THROTTLE_US);
+#endif
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test Tee - Throttled destination
+PreConditions : 1. Open a destination and one that sleeps after every slot, always
+                   advancing within the stall timeout.
+Action        : 1. Invoke DataTee_Copy() with an input the slow destination takes
+                   longer than the stall timeout to write
+Expectation   : 1. Returns No Error
+                2. The slow destination is dropped as stalled
+                3. The other destination receives all of the input
+------------------------------------------------------------------------------------*/
+void TestTee_ThrottledDestination(CuTest* tc)
+{
+#ifndef _WIN32
+    /*Test setup */
+    char* input = calloc(TEST_TEE_THROTTLE_INPUT_SIZE, sizeof(char));
+    DATA_WRITER writers[2];
+    DATA_WRITER* destinations[2] = { &writers[0], &writers[1] };
+    TEE_STATS stats;
+    ENGINE_JOB job;
+    WriteData(TEST_CUSTOM_INPUT_FILE, input, TEST_TEE_THROTTLE_INPUT_SIZE);
+    memset(&stats, 0, sizeof(stats));
+    memset(&job, 0, sizeof(job));
+    job.input = fopen(TEST_CUSTOM_INPUT_FILE, "rb");
+    job.bufferSize = TEST_TEE_SLOT_SIZE;
+    /* PreConditions */
+    CuAssertIntEquals_Msg(tc, "Open", ERROR_NOERROR, DataWriter_Open(&writers[0], TEST_TEE_FAST_FILE, NULL, NULL,
+                                                                     ULLONG_MAX, 0, false, false, false));
+    CuAssertIntEquals_Msg(tc, "Open", ERROR_NOERROR, DataWriter_Open(&writers[1], TEST_TEE_SLOW_FILE, NULL, NULL,
+                                                                     ULLONG_MAX, 0, false, false, false));
+    DataWriter_SetProgress(&writers[1], ThrottleWriter, NULL, TEST_TEE_SLOT_SIZE);
+    /* Action */
+    ERROR_TYPE actual = DataTee_Copy(&job, destinations, 2, TEST_TEE_SLOTS * TEST_TEE_SLOT_SIZE, &stats);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+    CuAssertIntEquals_Msg(tc, "Fast result", ERROR_NOERROR, stats.destination[0].result);
+    CuAssertIntEquals_Msg(tc, "Slow result", ERROR_DESTINATION_STALLED, stats.destination[1].result);
+    CuAssertIntEquals_Msg(tc, "Fast bytes", TEST_TEE_THROTTLE_INPUT_SIZE, stats.destination[0].bytes);
+    CuAssertTrue(tc, stats.destination[1].bytes < TEST_TEE_THROTTLE_INPUT_SIZE);
+    CuAssertIntEquals_Msg(tc, "Close", ERROR_NOERROR, DataWriter_Close(&writers[0]));
+    (void)DataWriter_Close(&writers[1]);
+    CuAssertIntEquals_Msg(tc, "File size", TEST_TEE_THROTTLE_INPUT_SIZE, GetFileSize(TEST_TEE_FAST_FILE));
+    /* Test Cleanup */
+    fclose(job.input);
+    free(input);
+    remove(TEST_TEE_FAST_FILE);
+    remove(TEST_TEE_SLOW_FILE);
+    remove(TEST_CUSTOM_INPUT_FILE);
+#else
+    CuAssertTrue(tc, true);
+#endif
+}
+/*-----------------------------------------------------------------------------------
+Helper : Capture of one context run on its own thread
+------------------------------------------------------------------------------------*/
+typedef struct
+{
+    DATA_READER_CONTEXT* context;
+    const char* input;
+    char output[MAX_FILEPATH_LENGTH];
+    ERROR_TYPE result;
+} CONTEXT_CAPTURE;
+
+void* ContextCaptureThread(void* pCapture)
+{
+    CONTEXT_CAPTURE* capture = (CONTEXT_CAPTURE*)pCapture;
+    capture->result = DataReader_ContextReadData(capture->context, capture->input, capture->output,
+                                                 sizeof(capture->output) - 1);
+    return NULL;
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test Context - Captures on independent contexts
+PreConditions : 1. Create two contexts, one with a custom file name prefix and one
+                   with a different prefix and an output file size limit of 1 KB.
+                2. Create an input larger than the limit.
+Action        : 1. Invoke DataReader_ContextReadData() on both contexts in parallel
+Expectation   : 1. Each capture uses the configuration of its own context
+                2. The default context is not modified
+------------------------------------------------------------------------------------*/
+void TestContext_IndependentCaptures(CuTest* tc)
+{
+    /*Test setup */
+    char data[TEST_BUFFER_SIZE * 2];
+    char* prefixes[TEST_CONTEXTS] = { "ctxa_", "ctxb_" };
+    CONTEXT_CAPTURE captures[TEST_CONTEXTS];
+    pthread_t threads[TEST_CONTEXTS];
+    unsigned int i;
+    memset(data, 'c', sizeof(data));
+    WriteData(TEST_CUSTOM_INPUT_FILE, data, sizeof(data));
+    DataReader_ResetArguments();
+    /* PreConditions */
+    char* iArgV0[] = { "-n", prefixes[0] };
+    char* iArgV1[] = { "-n", prefixes[1], "-s", TEST_OUTPUT_FILESIZE_LIMIT_KB };
+    memset(captures, 0, sizeof(captures));
+    for(i = 0; i < TEST_CONTEXTS; i++)
+    {
+        captures[i].context = DataReader_ContextCreate();
+        captures[i].input = TEST_CUSTOM_INPUT_FILE;
+        CuAssertPtrNotNull(tc, captures[i].context);
+    }
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR,
+                          DataReader_ContextParseArguments(captures[0].context, 2, iArgV0));
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR,
+                          DataReader_ContextParseArguments(captures[1].context, 4, iArgV1));
+    /* Action */
+    for(i = 0; i < TEST_CONTEXTS; i++)
+    {
+        CuAssertIntEquals_Msg(tc, "Thread", 0, pthread_create(&threads[i], NULL, ContextCaptureThread, &captures[i]));
+    }
+    for(i = 0; i < TEST_CONTEXTS; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+    }
+    /* Expectation */
+    char readData[TEST_BUFFER_SIZE * 2] = { '\0' };
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, captures[0].result);
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_FILE_SIZELIMIT_REACHED, captures[1].result);
+    for(i = 0; i < TEST_CONTEXTS; i++)
+    {
+        const char* name = strrchr(captures[i].output, PATH_DELIMITER);
+        name = name ? name + 1 : captures[i].output;
+        CuAssertIntEquals_Msg(tc, "Prefix", 0, strncmp(name, prefixes[i], strlen(prefixes[i])));
+        CuAssertStrEquals_Msg(tc, "Prefix", prefixes[i], DataReader_ContextGetWriteFileNamePrefix(captures[i].context));
+    }
+    ReadData(captures[0].output, readData, sizeof(data));
+    CuAssertIntEquals_Msg(tc, "Saved Data", 0, memcmp(data, readData, sizeof(data)));
+    memset(readData, 0, sizeof(readData));
+    ReadData(captures[1].output, readData, sizeof(data));
+    CuAssertIntEquals_Msg(tc, "Saved Size", TEST_BUFFER_SIZE, strlen(readData));
+    CuAssertTrue(tc, DataReader_GetMaxOutputFileSize() != DataReader_ContextGetMaxOutputFileSize(captures[1].context));
+    /* Test Cleanup */
+    for(i = 0; i < TEST_CONTEXTS; i++)
+    {
+        remove(captures[i].output);
+        DataReader_ContextDestroy(captures[i].context);
+    }
+    remove(TEST_CUSTOM_INPUT_FILE);
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test Context - Durability policies
+PreConditions : 1. Enable rotation with custom output file size limit and each
+                   durability policy in turn, then group commit on two contexts.
+Action        : 1. Invoke DataReader_ReadData() with valid ReadFile per policy
+                2. Invoke DataReader_ContextReadData() on both contexts in parallel
+                3. Parse invalid policies
+Expectation   : 1. Returns No Error. Every byte is counted in exactly one sync,
+                   and none without a policy
+                2. Both group captures succeed with all their bytes synced
+                3. Returns invalid durability error
+------------------------------------------------------------------------------------*/
+void TestContext_DurabilityPolicies(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_BUFFER_SIZE * 2 + 100] = { '\0' };
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, strlen(dataBuffer));
+    RedirectInput();
+    char* policies[] = { "none", "1K", "1ms", "close", "group" };
+    DURABILITY_TYPE types[] = { DURABILITY_NONE, DURABILITY_BYTES, DURABILITY_TIME, DURABILITY_CLOSE, DURABILITY_GROUP };
+    char* invalid[] = { "0", "0ms", "fast", "5s" };
+    char segmentFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    CAPTURE_STATS stats;
+    unsigned int i, j;
+    for(i = 0; i < sizeof(policies) / sizeof(policies[0]); i++)
+    {
+        /* PreConditions */
+        DataReader_ResetArguments();
+        int iArgC = 6;
+        char* iArgV[] = { "-s", "1", "-r", "on", "-y", policies[i] };
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, DataReader_ParseArguments(iArgC, iArgV));
+        CuAssertIntEquals_Msg(tc, "Durability", types[i], DataReader_GetDurability());
+        CuAssertTrue(tc, DataReader_GetSyncInterval() == (((types[i] == DURABILITY_BYTES) || (types[i] == DURABILITY_TIME)) ? 1 : 0));
+        /* Action */
+        char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+        ERROR_TYPE actual = DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile));
+        /* Expectation */
+        DataReader_GetCaptureStats(&stats);
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, actual);
+        CuAssertIntEquals_Msg(tc, "Segments", 3, stats.segments);
+        if(types[i] == DURABILITY_NONE)
+        {
+            CuAssertTrue(tc, stats.syncs.calls == 0);
+        }
+        else
+        {
+            CuAssertTrue(tc, stats.syncs.calls >= stats.segments);
+            CuAssertTrue(tc, stats.syncs.bytes == strlen(dataBuffer));
+        }
+        /* Test Cleanup */
+        for(j = 0; j < 3; j++)
+        {
+            GetSegmentFile(writeFile, j, segmentFile);
+            remove(segmentFile);
+        }
+    }
+    /* Concurrent captures share the syncs of their segments */
+    CONTEXT_CAPTURE captures[TEST_CONTEXTS];
+    pthread_t threads[TEST_CONTEXTS];
+    char* iArgVGroup[] = { "-s", "1", "-r", "on", "-y", "group" };
+    memset(captures, 0, sizeof(captures));
+    for(i = 0; i < TEST_CONTEXTS; i++)
+    {
+        captures[i].context = DataReader_ContextCreate();
+        captures[i].input = TEST_CUSTOM_INPUT_FILE;
+        CuAssertPtrNotNull(tc, captures[i].context);
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR,
+                              DataReader_ContextParseArguments(captures[i].context, 6, iArgVGroup));
+    }
+    for(i = 0; i < TEST_CONTEXTS; i++)
+    {
+        CuAssertIntEquals_Msg(tc, "Thread", 0, pthread_create(&threads[i], NULL, ContextCaptureThread, &captures[i]));
+    }
+    for(i = 0; i < TEST_CONTEXTS; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+    }
+    for(i = 0; i < TEST_CONTEXTS; i++)
+    {
+        DataReader_ContextGetCaptureStats(captures[i].context, &stats);
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, captures[i].result);
+        CuAssertTrue(tc, stats.syncs.calls == stats.segments);
+        CuAssertTrue(tc, stats.syncs.bytes == strlen(dataBuffer));
+        for(j = 0; j < 3; j++)
+        {
+            GetSegmentFile(captures[i].output, j, segmentFile);
+            remove(segmentFile);
+        }
+        DataReader_ContextDestroy(captures[i].context);
+    }
+    for(i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    {
+        char* iArgV[] = { "-y", invalid[i] };
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_INVALIDDURABILITY, DataReader_ParseArguments(2, iArgV));
+    }
+    /* Test Cleanup */
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test Batch - Capture several inputs in parallel
+PreConditions : 1. Create input files and a manifest listing them with a comment,
+                   an empty line and an invalid input.
+Action        : 1. Invoke DataBatch_LoadManifest() and DataBatch_Run() with as many
+                   workers as inputs
+Expectation   : 1. Only the invalid input fails
+                2. Every valid input is saved to its own output file
+------------------------------------------------------------------------------------*/
+void TestBatch_ParallelCapture(CuTest* tc)
+{
+    /*Test setup */
+    char inputs[TEST_BATCH_INPUTS][MAX_FILEPATH_LENGTH];
+    char data[TEST_BATCH_INPUTS][TEST_BUFFER_SIZE];
+    FILE* manifest = fopen(TEST_BATCH_MANIFEST, "w");
+    BATCH_LIST batch = { 0 };
+    unsigned int i;
+    fprintf(manifest, "# Batch test\n\n");
+    for(i = 0; i < TEST_BATCH_INPUTS; i++)
+    {
+        sprintf(inputs[i], "batch_%u.txt", i);
+        sprintf(data[i], "%s %u", TEST_STRING, i);
+        WriteData(inputs[i], data[i], strlen(data[i]));
+        fprintf(manifest, "%s\n", inputs[i]);
+    }
+    fprintf(manifest, "%s\n", TEST_INVALID_READ_FILE);
+    fclose(manifest);
+    RedirectInput();
+    DataReader_ResetArguments();
+    /* Action */
+    ERROR_TYPE loaded = DataBatch_LoadManifest(&batch, TEST_BATCH_MANIFEST);
+    unsigned int failed = DataBatch_Run(&batch, TEST_BATCH_INPUTS + 1);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, loaded);
+    CuAssertIntEquals_Msg(tc, "Inputs", TEST_BATCH_INPUTS + 1, batch.count);
+    CuAssertIntEquals_Msg(tc, "Failed", 1, failed);
+    CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_READ_FILEOPEN, batch.items[TEST_BATCH_INPUTS].result);
+    for(i = 0; i < TEST_BATCH_INPUTS; i++)
+    {
+        char readData[TEST_BUFFER_SIZE] = { '\0' };
+        CuAssertIntEquals_Msg(tc, "ERROR_TYPE", ERROR_NOERROR, batch.items[i].result);
+        ReadData(batch.items[i].output, readData, strlen(data[i]));
+        CuAssertStrEquals_Msg(tc, "Saved Data", data[i], readData);
+    }
+    /* Test Cleanup */
+    for(i = 0; i < TEST_BATCH_INPUTS; i++)
+    {
+        remove(batch.items[i].output);
+        remove(inputs[i]);
+    }
+    remove(TEST_BATCH_MANIFEST);
+    DataBatch_Free(&batch);
+    DataReader_ResetArguments();
+    RestoreInput();
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test Daemon - Concurrent clients
+PreConditions : 1. Configure a write path and a custom output file size limit
+Action        : 1. Start the daemon with fewer workers than clients
+                2. Connect all clients before any of them sends, then send and
+                   close. One client sends more than the size limit
+Expectation   : 1. Every connection is captured to its own output file
+                2. Only the oversized connection fails and keeps the data up to
+                   the limit
+------------------------------------------------------------------------------------*/
+void TestDaemon_ConcurrentClients(CuTest* tc)
+{
+#ifdef __linux__
+    /*Test setup */
+    char writePath[MAX_FILEPATH_LENGTH] = { '\0' };
+    char dataBuffer[TEST_BUFFER_SIZE * 2 + 100] = { '\0' };
+    char message[64];
+    int clients[TEST_DAEMON_CLIENTS + 1];
+    unsigned int found[TEST_DAEMON_CLIENTS + 1] = { 0 };
+    struct sockaddr_un address;
+    DATA_DAEMON* daemon;
+    DAEMON_STATS stats;
+    unsigned int i;
+    while((sizeof(dataBuffer) - strlen(dataBuffer)) > strlen(TEST_STRING))
+    {
+        strcat(dataBuffer, TEST_STRING);
+    }
+    (void)_getcwd(writePath, sizeof(writePath));
+    sprintf(writePath + strlen(writePath), "%c%s", PATH_DELIMITER, TEST_DAEMON_DIR);
+    (void)_mkdir(writePath);
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 4;
+    char* iArgV[] = { "-p", writePath, "-s", "1" };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    CuAssertIntEquals_Msg(tc, "Start", ERROR_NOERROR, DataDaemon_Start(&daemon, TEST_DAEMON_SOCKET, TEST_DAEMON_WORKERS));
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, TEST_DAEMON_SOCKET);
+    for(i = 0; i <= TEST_DAEMON_CLIENTS; i++)
+    {
+        clients[i] = socket(AF_UNIX, SOCK_STREAM, 0);
+        CuAssertIntEquals_Msg(tc, "connect", 0, connect(clients[i], (struct sockaddr*)&address, sizeof(address)));
+    }
+    for(i = 0; i < TEST_DAEMON_CLIENTS; i++)
+    {
+        sprintf(message, "client %u", i);
+        CuAssertIntEquals_Msg(tc, "send", strlen(message), send(clients[i], message, strlen(message), MSG_NOSIGNAL));
+        close(clients[i]);
+    }
+    /* The oversized client may see its connection closed */
+    (void)send(clients[TEST_DAEMON_CLIENTS], dataBuffer, strlen(dataBuffer), MSG_NOSIGNAL);
+    close(clients[TEST_DAEMON_CLIENTS]);
+    for(i = 0; i < 500; i++)
+    {
+        DataDaemon_GetStats(daemon, &stats);
+        if((stats.completed + stats.failed) == (TEST_DAEMON_CLIENTS + 1))
+        {
+            break;
+        }
+        usleep(10000);
+    }
+    DataDaemon_Stop(daemon, &stats);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "Accepted", TEST_DAEMON_CLIENTS + 1, stats.accepted);
+    CuAssertIntEquals_Msg(tc, "Completed", TEST_DAEMON_CLIENTS, stats.completed);
+    CuAssertIntEquals_Msg(tc, "Failed", 1, stats.failed);
+    CuAssertIntEquals_Msg(tc, "Active", 0, stats.active);
+    CuAssertPtrEquals_Msg(tc, "Socket removed", NULL, fopen(TEST_DAEMON_SOCKET, "r"));
+    DIR* directory = opendir(writePath);
+    struct dirent* entry;
+    while((entry = readdir(directory)) != NULL)
+    {
+        char outputFile[MAX_FILEPATH_LENGTH + sizeof(entry->d_name) + 1];
+        char content[TEST_BUFFER_SIZE + 1] = { '\0' };
+        unsigned int client;
+        if(entry->d_name[0] == '.')
+        {
+            continue;
+        }
+        snprintf(outputFile, sizeof(outputFile), "%s%c%s", writePath, PATH_DELIMITER, entry->d_name);
+        ReadData(outputFile, content, TEST_BUFFER_SIZE);
+        if(sscanf(content, "client %u", &client) == 1)
+        {
+            CuAssertTrue(tc, client < TEST_DAEMON_CLIENTS);
+            sprintf(message, "client %u", client);
+            CuAssertStrEquals(tc, message, content);
+        }
+        else
+        {
+            client = TEST_DAEMON_CLIENTS;
+            CuAssertIntEquals_Msg(tc, "Oversized size", 1024, GetFileSize(outputFile));
+            CuAssertTrue(tc, memcmp(content, dataBuffer, 1024) == 0);
+        }
+        found[client]++;
+        remove(outputFile);
+    }
+    closedir(directory);
+    for(i = 0; i <= TEST_DAEMON_CLIENTS; i++)
+    {
+        CuAssertIntEquals_Msg(tc, "Output files of the client", 1, found[i]);
+    }
+    /* Test Cleanup */
+    (void)_rmdir(writePath);
+    DataReader_ResetArguments();
+#else
+    /* The daemon needs epoll and UNIX domain sockets */
+    DATA_DAEMON* daemon;
+    CuAssertIntEquals_Msg(tc, "Start", ERROR_IO_FAILED, DataDaemon_Start(&daemon, TEST_DAEMON_SOCKET, 1));
+#endif
+}
+#ifdef __linux__
+bool WaitForFollow(DATA_FOLLOW* pFollow, unsigned long long pBytes, unsigned long long pTruncations,
+                   unsigned long long pRotations)
+{
+    FOLLOW_STATS stats;
+    unsigned int i;
+    for(i = 0; i < 500; i++)
+    {
+        DataFollow_GetStats(pFollow, &stats);
+        if((stats.bytes == pBytes) && (stats.truncations == pTruncations) && (stats.rotations == pRotations))
+        {
+            return true;
+        }
+        usleep(10000);
+    }
+    return false;
+}
+#endif
+/*-----------------------------------------------------------------------------------
+Test Name     : Test Follow - Appended, truncated and rotated file
+PreConditions : 1. Configure a write path. Create a file with some content
+Action        : 1. Follow the file from its end and append to it
+                2. Truncate the file and append to it again
+                3. Rename the file and create a new one under its name
+Expectation   : 1. Only the appended data is captured
+                2. The truncated file is captured again from its start
+                3. The new file is captured from its start into the same output
+------------------------------------------------------------------------------------*/
+void TestFollow_AppendTruncateRotate(CuTest* tc)
+{
+#ifdef __linux__
+    /*Test setup */
+    char writePath[MAX_FILEPATH_LENGTH] = { '\0' };
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    char readFile[2 * MAX_FILEPATH_LENGTH];
+    char rotatedFile[2 * MAX_FILEPATH_LENGTH];
+    char content[TEST_BUFFER_SIZE] = { '\0' };
+    DATA_FOLLOW* follow;
+    FOLLOW_STATS stats;
+    FILE* input;
+    (void)_getcwd(writePath, sizeof(writePath));
+    sprintf(writePath + strlen(writePath), "%c%s", PATH_DELIMITER, TEST_FOLLOW_DIR);
+    (void)_mkdir(writePath);
+    sprintf(readFile, "%s%c%s", writePath, PATH_DELIMITER, TEST_FOLLOW_FILE);
+    sprintf(rotatedFile, "%s%c%s", writePath, PATH_DELIMITER, TEST_FOLLOW_ROTATED);
+    WriteData(readFile, "old\n", 4);
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 2;
+    char* iArgV[] = { "-p", writePath };
+    (void)DataReader_ParseArguments(iArgC, iArgV);
+    /* Action */
+    CuAssertIntEquals_Msg(tc, "Start", ERROR_NOERROR,
+                          DataFollow_Start(&follow, readFile, false, writeFile, sizeof(writeFile) - 1));
+    input = fopen(readFile, "a");
+    fputs("one\n", input);
+    fclose(input);
+    CuAssertTrue(tc, WaitForFollow(follow, 4, 0, 0));
+    /* Truncated first, so that the new data cannot hide the truncation */
+    fclose(fopen(readFile, "w"));
+    CuAssertTrue(tc, WaitForFollow(follow, 4, 1, 0));
+    input = fopen(readFile, "a");
+    fputs("two\n", input);
+    fclose(input);
+    CuAssertTrue(tc, WaitForFollow(follow, 8, 1, 0));
+    CuAssertIntEquals(tc, 0, rename(readFile, rotatedFile));
+    WriteData(readFile, "three\n", 6);
+    CuAssertTrue(tc, WaitForFollow(follow, 14, 1, 1));
+    DataFollow_Stop(follow, &stats);
+    /* Expectation */
+    CuAssertIntEquals_Msg(tc, "Result", ERROR_NOERROR, stats.result);
+    CuAssertTrue(tc, !stats.active);
+    CuAssertIntEquals_Msg(tc, "Output size", 14, GetFileSize(writeFile));
+    ReadData(writeFile, content, TEST_BUFFER_SIZE);
+    CuAssertStrEquals(tc, "one\ntwo\nthree\n", content);
+    /* Test Cleanup */
+    remove(writeFile);
+    remove(readFile);
+    remove(rotatedFile);
+    (void)_rmdir(writePath);
+    DataReader_ResetArguments();
+#else
+    /* Follow mode needs inotify */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    DATA_FOLLOW* follow;
+    CuAssertIntEquals_Msg(tc, "Start", ERROR_IO_FAILED,
+                          DataFollow_Start(&follow, TEST_FOLLOW_FILE, false, writeFile, sizeof(writeFile) - 1));
+#endif
+}
+/*-----------------------------------------------------------------------------------
+Test Name     : Test ReadData - Capture resumed from a checkpoint
+PreConditions : 1. Configure 1 KB rotated segments and checkpoints
+Action        : 1. Capture a file, append to it and capture it again
+                2. Cut the last segment short and capture the file again
+                3. Grow the file to a segment boundary and beyond, capturing it
+                   each time
+                4. Shrink the file and capture it
+                5. Enable compression and capture it
+Expectation   : 1. The second capture continues the segments of the first
+                2. The lost data is captured again in place
+                3. Every capture continues where the last one stopped
+                4. The file is captured again into a new output
+                5. Returns ERROR_INVALIDCHECKPOINT
+------------------------------------------------------------------------------------*/
+void TestReadData_ResumeCheckpoint(CuTest* tc)
+{
+    /*Test setup */
+    char dataBuffer[TEST_CHECKPOINT_INPUT_SIZE];
+    char copyData[TEST_CHECKPOINT_INPUT_SIZE];
+    char checkpointFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    char segmentFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    unsigned int i;
+    unsigned int copied;
+    for(i = 0; i < sizeof(dataBuffer); i++)
+    {
+        dataBuffer[i] = (char)('a' + ((i * 7) % 26));
+    }
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, 3000);
+    /* PreConditions */
+    DataReader_ResetArguments();
+    int iArgC = 6;
+    char* iArgV[] = { "-s", "1", "-r", "on", "-C", "on" };
+    CuAssertIntEquals_Msg(tc, "Parse", ERROR_NOERROR, DataReader_ParseArguments(iArgC, iArgV));
+    CuAssertTrue(tc, DataReader_GetCheckpoint());
+    /* Action */
+    char writeFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    char resumedFile[MAX_FILEPATH_LENGTH] = { '\0' };
+    CuAssertIntEquals_Msg(tc, "First", ERROR_NOERROR,
+                          DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, writeFile, sizeof(writeFile)));
+    CuAssertIntEquals_Msg(tc, "First resumed", 0, DataReader_GetResumedBytes());
+    CuAssertTrue(tc, DataCheckpoint_Path(DataReader_GetWriteFilePath(), DataReader_GetWriteFileNamePrefix(),
+                                         TEST_CUSTOM_INPUT_FILE, checkpointFile, sizeof(checkpointFile)));
+    AppendData(TEST_CUSTOM_INPUT_FILE, dataBuffer + 3000, 2000);
+    CuAssertIntEquals_Msg(tc, "Appended", ERROR_NOERROR,
+                          DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, resumedFile, sizeof(resumedFile)));
+    /* Expectation */
+    GetSegmentFile(writeFile, 2, segmentFile);
+    CuAssertStrEquals(tc, segmentFile, resumedFile);
+    CuAssertIntEquals_Msg(tc, "Appended resumed", 3000, DataReader_GetResumedBytes());
+    CuAssertIntEquals_Msg(tc, "Continued segment size", 1024, GetFileSize(segmentFile));
+    /* The data lost from the last segment is captured again */
+    GetSegmentFile(writeFile, 4, segmentFile);
+    WriteData(segmentFile, dataBuffer + 4096, 100);
+    memset(resumedFile, '\0', sizeof(resumedFile));
+    CuAssertIntEquals_Msg(tc, "Cut short", ERROR_NOERROR,
+                          DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, resumedFile, sizeof(resumedFile)));
+    CuAssertStrEquals(tc, segmentFile, resumedFile);
+    CuAssertIntEquals_Msg(tc, "Cut short resumed", 4196, DataReader_GetResumedBytes());
+    /* A full last segment is continued in the next one */
+    AppendData(TEST_CUSTOM_INPUT_FILE, dataBuffer + 5000, 120);
+    CuAssertIntEquals_Msg(tc, "Boundary", ERROR_NOERROR,
+                          DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, resumedFile, sizeof(resumedFile)));
+    CuAssertIntEquals_Msg(tc, "Boundary resumed", 5000, DataReader_GetResumedBytes());
+    AppendData(TEST_CUSTOM_INPUT_FILE, dataBuffer + 5120, 100);
+    CuAssertIntEquals_Msg(tc, "Beyond", ERROR_NOERROR,
+                          DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, resumedFile, sizeof(resumedFile)));
+    CuAssertIntEquals_Msg(tc, "Beyond resumed", 5120, DataReader_GetResumedBytes());
+    for(i = 0, copied = 0; i < TEST_CHECKPOINT_SEGMENTS; i++)
+    {
+        GetSegmentFile(writeFile, i, segmentFile);
+        CuAssertIntEquals_Msg(tc, "Segment size", (i < 5) ? 1024 : 100, GetFileSize(segmentFile));
+        ReadData(segmentFile, copyData + copied, GetFileSize(segmentFile));
+        copied = copied + GetFileSize(segmentFile);
+        remove(segmentFile);
+    }
+    CuAssertTrue(tc, memcmp(copyData, dataBuffer, sizeof(dataBuffer)) == 0);
+    /* A shrunk file is not the one captured */
+    WriteData(TEST_CUSTOM_INPUT_FILE, dataBuffer, 1000);
+    memset(resumedFile, '\0', sizeof(resumedFile));
+    CuAssertIntEquals_Msg(tc, "Shrunk", ERROR_NOERROR,
+                          DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, resumedFile, sizeof(resumedFile)));
+    CuAssertTrue(tc, strcmp(writeFile, resumedFile) != 0);
+    CuAssertIntEquals_Msg(tc, "Shrunk resumed", 0, DataReader_GetResumedBytes());
+    CuAssertIntEquals_Msg(tc, "Shrunk size", 1000, GetFileSize(resumedFile));
+    remove(resumedFile);
+    /* A checkpoint covers a plain copy only */
+    char* compressArgV[] = { "-z", "on" };
+    (void)DataReader_ParseArguments(2, compressArgV);
+    memset(resumedFile, '\0', sizeof(resumedFile));
+    CuAssertIntEquals_Msg(tc, "Compressed", ERROR_INVALIDCHECKPOINT,
+                          DataReader_ReadData(TEST_CUSTOM_INPUT_FILE, resumedFile, sizeof(resumedFile)));
+    /* Test Cleanup */
+    remove(checkpointFile);
+    remove(TEST_CUSTOM_INPUT_FILE);
+    DataReader_ResetArguments();
+}
+/*-----------------------------------------------------------------------------------
 Test Name     : Test ReadData - Read with invalid write file path
 PreConditions : 1. Set custom invalid write file path.
 Action        : 1. Invoke DataReader_ReadData() with empty ReadFile
@@ -475,6 +2769,11 @@ CuSuite* DataReaderGetSuite(void)
     SUITE_ADD_TEST(suite, TestParseArguments_InvalidArgs);
     SUITE_ADD_TEST(suite, TestParseArguments_ValidInvalidArgs);
     SUITE_ADD_TEST(suite, TestParseArguments_ValidInvalidFileSizeLimit);
+    SUITE_ADD_TEST(suite, TestParseArguments_QueueDepth);
+    SUITE_ADD_TEST(suite, TestParseArguments_FileSizeLimitSuffix);
+    SUITE_ADD_TEST(suite, TestParseArguments_BufferSizeFlushInterval);
+    SUITE_ADD_TEST(suite, TestParseArguments_InvalidBufferSize);
+    SUITE_ADD_TEST(suite, TestParseArguments_Engine);
     SUITE_ADD_TEST(suite, TestParseArguments_Help);
     SUITE_ADD_TEST(suite, TestReadData_StdinDefaultConfig);
     SUITE_ADD_TEST(suite, TestReadData_FileReadDefaultConfig);
@@ -482,6 +2781,38 @@ CuSuite* DataReaderGetSuite(void)
     SUITE_ADD_TEST(suite, TestReadData_FileReadValidWritePath);
     SUITE_ADD_TEST(suite, TestReadData_StdinFileSizeLimitReached);
     SUITE_ADD_TEST(suite, TestReadData_FileReadFileSizeLimitReached);
+    SUITE_ADD_TEST(suite, TestReadData_FileReadSmallBuffer);
+    SUITE_ADD_TEST(suite, TestReadData_FileReadKernelEngine);
+    SUITE_ADD_TEST(suite, TestReadData_KernelEngineFileSizeLimitReached);
+    SUITE_ADD_TEST(suite, TestReadData_FileReadMmapEngine);
+    SUITE_ADD_TEST(suite, TestReadData_MmapEngineFileSizeLimitReached);
+    SUITE_ADD_TEST(suite, TestReadData_FileReadPipelineEngine);
+    SUITE_ADD_TEST(suite, TestReadData_PipelineEngineFileSizeLimitReached);
+    SUITE_ADD_TEST(suite, TestReadData_FileReadUringEngine);
+    SUITE_ADD_TEST(suite, TestReadData_UringEngineFileSizeLimitReached);
+    SUITE_ADD_TEST(suite, TestReadData_UringEngineWriteFailure);
+    SUITE_ADD_TEST(suite, TestReadData_FileReadParallelEngine);
+    SUITE_ADD_TEST(suite, TestReadData_ParallelEngineFileSizeLimitReached);
+    SUITE_ADD_TEST(suite, TestReadData_DirectIoOutput);
+    SUITE_ADD_TEST(suite, TestReadData_CompressedOutput);
+    SUITE_ADD_TEST(suite, TestReadData_CompressedOutputSizeLimit);
+    SUITE_ADD_TEST(suite, TestReadData_DeduplicatedOutput);
+    SUITE_ADD_TEST(suite, TestReadData_FramedOutput);
+    SUITE_ADD_TEST(suite, TestReadData_LineBoundaries);
+    SUITE_ADD_TEST(suite, TestReadData_RotateOutput);
+    SUITE_ADD_TEST(suite, TestReadData_RotatedSegmentCloseFailure);
+    SUITE_ADD_TEST(suite, TestReadData_CaptureStats);
+    SUITE_ADD_TEST(suite, TestReadData_PreallocatedOutput);
+    SUITE_ADD_TEST(suite, TestReadData_ChecksumSidecar);
+    SUITE_ADD_TEST(suite, TestReadData_UniqueOutputNames);
+    SUITE_ADD_TEST(suite, TestReadData_MultipleDestinations);
+    SUITE_ADD_TEST(suite, TestTee_ThrottledDestination);
+    SUITE_ADD_TEST(suite, TestContext_IndependentCaptures);
+    SUITE_ADD_TEST(suite, TestContext_DurabilityPolicies);
+    SUITE_ADD_TEST(suite, TestBatch_ParallelCapture);
+    SUITE_ADD_TEST(suite, TestDaemon_ConcurrentClients);
+    SUITE_ADD_TEST(suite, TestFollow_AppendTruncateRotate);
+    SUITE_ADD_TEST(suite, TestReadData_ResumeCheckpoint);
     SUITE_ADD_TEST(suite, TestReadData_InvalidWritePath);
     SUITE_ADD_TEST(suite, TestReadData_InvalidReadFile);
 